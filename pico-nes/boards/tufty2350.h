@@ -110,7 +110,9 @@ pico_board_cmake_set_default(PICO_RP2350_A2_SUPPORTED, 1)
 
 #define SMS_SINGLE_FILE 1
 
-// Sound - PWM on unused pin (muted, no speaker)
+// Sound - PWM on unused pin (muted, no speaker). Build with
+// -DPWM_AUDIO_PIN=<gpio> to drive a speaker / RC filter from the
+// DMA-fed PWM backend (drivers/audio/audio_pwm.c) instead
 #define AUDIO_PWM_PIN  0xFF
 #define AUDIO_DATA_PIN  0xFF
 #define AUDIO_CLOCK_PIN 0xFF
@@ -27,6 +27,9 @@
 
 #include "audio.h"
 
+#include "pico.h"
+#include "hardware/irq.h"
+
 #ifdef AUDIO_PWM_PIN
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
@@ -184,6 +187,76 @@ void i2s_dma_write(i2s_config_t *i2s_config,const int16_t *samples) {
                                          i2s_config->dma_trans_count);
 }
 
+/*
+ * Ring drain: the DMA ping-pongs between two buffers and its completion
+ * IRQ restarts on the other one before refilling the finished one from
+ * the ring, so the emulator never waits on the DAC.
+ */
+static i2s_config_t *ring_config;
+static audio_ring_t *ring_source;
+static uint16_t *ring_dma_buf[2];
+static int ring_dma_active;
+
+static void __not_in_flash_func(i2s_ring_fill)(uint16_t *dma_buf) {
+    const i2s_config_t *i2s_config = ring_config;
+    audio_ring_pop(ring_source, (audio_frame_t *)dma_buf, i2s_config->dma_trans_count);
+
+#ifdef AUDIO_PWM_PIN
+    for(uint16_t i=0;i<i2s_config->dma_trans_count*2;i++) {
+        dma_buf[i] = (65536/2+((int16_t)dma_buf[i]))>>(4+i2s_config->volume);
+    }
+#else
+    if(i2s_config->volume!=0) {
+        for(uint16_t i=0;i<i2s_config->dma_trans_count*2;i++) {
+            dma_buf[i] = ((int16_t)dma_buf[i])>>i2s_config->volume;
+        }
+    }
+#endif
+}
+
+static void __not_in_flash_func(i2s_ring_irq)(void) {
+    const uint channel = ring_config->dma_channel;
+    if (!dma_channel_get_irq1_status(channel)) {
+        return;
+    }
+    dma_channel_acknowledge_irq1(channel);
+
+    const int done = ring_dma_active;
+    ring_dma_active ^= 1;
+    dma_channel_transfer_from_buffer_now(channel,
+                                         ring_dma_buf[ring_dma_active],
+                                         ring_config->dma_trans_count);
+    i2s_ring_fill(ring_dma_buf[done]);
+}
+
+/**
+ * Feed the DMA from an audio ring instead of i2s_dma_write (non blocking)
+ * i2s_config: I2S context already set up by i2s_init()
+ *       ring: ring the emulator pushes into; drained from DMA_IRQ_1 ( video owns DMA_IRQ_0 )
+ */
+void i2s_dma_start_ring(i2s_config_t *i2s_config,audio_ring_t *ring) {
+    ring_config = i2s_config;
+    ring_source = ring;
+    ring_dma_buf[0] = i2s_config->dma_buf;
+    ring_dma_buf[1] = malloc(i2s_config->dma_trans_count*sizeof(uint32_t));
+    if (!ring_dma_buf[1]) {
+        panic("i2s_dma_start_ring: no memory for %u DMA frames", (unsigned)i2s_config->dma_trans_count);
+    }
+    ring_dma_active = 0;
+
+    /* Start on silence ( or whatever is already queued ) */
+    i2s_ring_fill(ring_dma_buf[1]);
+    i2s_ring_fill(ring_dma_buf[0]);
+
+    dma_channel_set_irq1_enabled(i2s_config->dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, i2s_ring_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    dma_channel_transfer_from_buffer_now(i2s_config->dma_channel,
+                                         ring_dma_buf[0],
+                                         i2s_config->dma_trans_count);
+}
+
 /**
  * Adjust the output volume
  * i2s_config: I2S context obtained by i2s_get_default_config()
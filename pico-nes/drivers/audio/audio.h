@@ -33,6 +33,8 @@ extern "C" {
 #include <hardware/clocks.h>
 #include <hardware/dma.h>
 #include "audio_i2s.pio.h"
+#include "audio_ring.h"
+#include "audio_mix.h"
 
 typedef struct i2s_config 
 {
@@ -53,6 +55,7 @@ i2s_config_t i2s_get_default_config(void);
 void i2s_init(i2s_config_t *i2s_config);
 void i2s_write(const i2s_config_t *i2s_config,const int16_t *samples,const size_t len);
 void i2s_dma_write(i2s_config_t *i2s_config,const int16_t *samples);
+void i2s_dma_start_ring(i2s_config_t *i2s_config,audio_ring_t *ring);
 void i2s_volume(i2s_config_t *i2s_config,uint8_t volume);
 void i2s_increase_volume(i2s_config_t *i2s_config);
 void i2s_decrease_volume(i2s_config_t *i2s_config);
@@ -0,0 +1,212 @@
+#include "pico.h"
+#include "audio_mix.h"
+
+#if defined(__ARM_FEATURE_SIMD32) && !defined(AUDIO_MIX_SCALAR)
+#include <arm_acle.h>
+#define AUDIO_MIX_DSP
+#elif defined(__SSE2__) && !defined(AUDIO_MIX_SCALAR)
+#include <emmintrin.h>
+#define AUDIO_MIX_SSE
+#endif
+
+// The DAC output is never negative; centre it so silence sits at the
+// same offset as full scale does on the other side
+#define AUDIO_MIX_CENTER 16384
+
+// Largest pulse + TND output, shared out so their sum fits an int16:
+// the tables top out at 8405 + 24352 = 32757. Any more and the SIMD
+// paths, which add saturating, would part from the C one
+#define AUDIO_MIX_FULL_SCALE 32640.0
+
+// Default stereo image, the one the old weighted mix had: pulse 1 at
+// 6:3 left, pulse 2 at 3:6 right
+static const int16_t audio_mix_default_pan[AUDIO_MIX_CHANNELS] = { -128, 128, 0, 0, 0, 0 };
+
+void audio_mix_init(audio_mix_t* mix) {
+    // pulse_out = 95.52 / ( 8128 / ( p1 + p2 ) + 100 ), p in 0 .. 15
+    // tnd_out = 163.67 / ( 24329 / ( 3 t + 2 n + d ) + 100 ), t, n in 0 .. 15, d in 0 .. 127
+    for (int i = 0; i < AUDIO_MIX_PULSE_SIZE; i++) {
+        const double n = i / 17.0;
+        mix->pulse[i] = (int16_t)(i ? 95.52 / (8128.0 / n + 100.0) * AUDIO_MIX_FULL_SCALE + 0.5 : 0);
+    }
+    for (int i = 0; i < AUDIO_MIX_TND_SIZE; i++) {
+        const double n = i / 16.0;
+        mix->tnd[i] = (int16_t)(i ? 163.67 / (24329.0 / n + 100.0) * AUDIO_MIX_FULL_SCALE + 0.5 : 0);
+    }
+
+    for (int ch = 0; ch < AUDIO_MIX_CHANNELS; ch++) {
+        audio_mix_set_channel(mix, ch, AUDIO_MIX_UNITY, audio_mix_default_pan[ch]);
+    }
+    mix->volume = AUDIO_MIX_VOLUME_UNITY;
+}
+
+void audio_mix_set_channel(audio_mix_t* mix, const int channel, int gain, int pan) {
+    if (gain < 0) gain = 0;
+    if (gain > AUDIO_MIX_UNITY) gain = AUDIO_MIX_UNITY;
+    if (pan < -256) pan = -256;
+    if (pan > 256) pan = 256;
+
+    // Balance law: the far side is turned down, the near side stays
+    mix->gain[channel][0] = (uint16_t)(pan > 0 ? gain * (256 - pan) / 256 : gain);
+    mix->gain[channel][1] = (uint16_t)(pan < 0 ? gain * (256 + pan) / 256 : gain);
+    audio_mix_update(mix);
+}
+
+static inline uint32_t audio_mix_pack(const uint32_t low, const uint32_t high) {
+    return (low & 0xffff) | (high << 16);
+}
+
+void audio_mix_update(audio_mix_t* mix) {
+    for (int ch = 0; ch < AUDIO_MIX_CHANNELS; ch++) {
+        for (int side = 0; side < 2; side++) {
+            if (mix->gain[ch][side] > AUDIO_MIX_UNITY)
+                mix->gain[ch][side] = AUDIO_MIX_UNITY;
+        }
+    }
+    mix->pulse_left = audio_mix_pack(mix->gain[0][0], mix->gain[1][0]);
+    mix->pulse_right = audio_mix_pack(mix->gain[0][1], mix->gain[1][1]);
+    mix->tnd_left = audio_mix_pack(3 * mix->gain[2][0], 32 * mix->gain[3][0]);
+    mix->tnd_right = audio_mix_pack(3 * mix->gain[2][1], 32 * mix->gain[3][1]);
+    mix->dpcm_left = 32 * mix->gain[4][0];
+    mix->dpcm_right = 32 * mix->gain[4][1];
+}
+
+static inline int16_t audio_mix_level(const int sum, const int volume) {
+    const int level = ((sum - AUDIO_MIX_CENTER) * volume) >> 2;
+    return (int16_t)(level < -32768 ? -32768 : level > 32767 ? 32767 : level);
+}
+
+// Reference implementation, also the tail of the SIMD loops
+static void __not_in_flash_func(audio_mix_scalar)(const audio_mix_t* mix, int i, const int samples,
+                                                  const uint8_t* wave1, const uint8_t* wave2,
+                                                  const uint8_t* wave3, const uint8_t* wave4,
+                                                  const uint8_t* wave5, int16_t* out) {
+    const int g1l = mix->gain[0][0], g1r = mix->gain[0][1];
+    const int g2l = mix->gain[1][0], g2r = mix->gain[1][1];
+    const int g3l = 3 * mix->gain[2][0], g3r = 3 * mix->gain[2][1];
+    const int g4l = 32 * mix->gain[3][0], g4r = 32 * mix->gain[3][1];
+    const int g5l = 32 * mix->gain[4][0], g5r = 32 * mix->gain[4][1];
+    for (; i < samples; i++) {
+        const int w1 = wave1[i];
+        const int w2 = wave2[i];
+        const int w3 = wave3[i];
+        const int w4 = wave4[i];
+        const int w5 = wave5[i];
+        const int pulse_l = (g1l * w1 + g2l * w2) >> 8;
+        const int pulse_r = (g1r * w1 + g2r * w2) >> 8;
+        const int tnd_l = (g3l * w3 + g4l * w4 + g5l * w5) >> 8;
+        const int tnd_r = (g3r * w3 + g4r * w4 + g5r * w5) >> 8;
+        out[2 * i] = audio_mix_level(mix->pulse[pulse_l] + mix->tnd[tnd_l], mix->volume);
+        out[2 * i + 1] = audio_mix_level(mix->pulse[pulse_r] + mix->tnd[tnd_r], mix->volume);
+    }
+}
+
+// The expansion chip mixes linearly on the cartridge: added on top of
+// the APU output, at the same master volume
+static void __not_in_flash_func(audio_mix_ext)(const audio_mix_t* mix, const int samples, const uint8_t* wave6,
+                                               int16_t* out) {
+    const int gl = mix->gain[AUDIO_MIX_EXT][0] * AUDIO_MIX_EXT_SCALE;
+    const int gr = mix->gain[AUDIO_MIX_EXT][1] * AUDIO_MIX_EXT_SCALE;
+    for (int i = 0; i < samples; i++) {
+        const int left = out[2 * i] + ((((wave6[i] * gl) >> 8) * mix->volume) >> 2);
+        const int right = out[2 * i + 1] + ((((wave6[i] * gr) >> 8) * mix->volume) >> 2);
+        out[2 * i] = (int16_t)(left > 32767 ? 32767 : left);
+        out[2 * i + 1] = (int16_t)(right > 32767 ? 32767 : right);
+    }
+}
+
+void __not_in_flash_func(audio_mix_run)(const audio_mix_t* mix, const int samples, const uint8_t* wave1,
+                                        const uint8_t* wave2, const uint8_t* wave3, const uint8_t* wave4,
+                                        const uint8_t* wave5, const uint8_t* wave6, int16_t* out) {
+    int i = 0;
+
+#if defined(AUDIO_MIX_DSP)
+    uint32_t* frames = (uint32_t *)out;
+    const int16_t volume = (int16_t)mix->volume;
+    for (; i < samples; i++) {
+        // Both lookup pairs of a side in one dual multiply-accumulate
+        const uint32_t w12 = audio_mix_pack(wave1[i], wave2[i]);
+        const uint32_t w34 = audio_mix_pack(wave3[i], wave4[i]);
+        const uint32_t w5 = wave5[i];
+        const uint32_t pulse_l = (uint32_t)__smuad(w12, mix->pulse_left) >> 8;
+        const uint32_t pulse_r = (uint32_t)__smuad(w12, mix->pulse_right) >> 8;
+        const uint32_t tnd_l = (uint32_t)__smlad(w5, mix->dpcm_left, __smuad(w34, mix->tnd_left)) >> 8;
+        const uint32_t tnd_r = (uint32_t)__smlad(w5, mix->dpcm_right, __smuad(w34, mix->tnd_right)) >> 8;
+
+        // Left / right in one word from here on
+        const uint32_t pulse = audio_mix_pack((uint16_t)mix->pulse[pulse_l], (uint16_t)mix->pulse[pulse_r]);
+        const uint32_t tnd = audio_mix_pack((uint16_t)mix->tnd[tnd_l], (uint16_t)mix->tnd[tnd_r]);
+        uint32_t frame = __qsub16(__qadd16(pulse, tnd), audio_mix_pack(AUDIO_MIX_CENTER, AUDIO_MIX_CENTER));
+        if (volume != AUDIO_MIX_VOLUME_UNITY) {
+            const int32_t left = __ssat(__smulbb((int32_t)frame, volume) >> 2, 16);
+            const int32_t right = __ssat(__smultb((int32_t)frame, volume) >> 2, 16);
+            frame = audio_mix_pack(left, right);
+        }
+        frames[i] = frame;
+    }
+#elif defined(AUDIO_MIX_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i pulse_left = _mm_set1_epi32(mix->pulse_left);
+    const __m128i pulse_right = _mm_set1_epi32(mix->pulse_right);
+    const __m128i tnd_left = _mm_set1_epi32(mix->tnd_left);
+    const __m128i tnd_right = _mm_set1_epi32(mix->tnd_right);
+    const __m128i dpcm_left = _mm_set1_epi32(mix->dpcm_left);
+    const __m128i dpcm_right = _mm_set1_epi32(mix->dpcm_right);
+    const __m128i center = _mm_set1_epi16(AUDIO_MIX_CENTER);
+    const __m128i volume = _mm_set1_epi16((int16_t)mix->volume);
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i w1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(wave1 + i)), zero);
+        const __m128i w2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(wave2 + i)), zero);
+        const __m128i w3 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(wave3 + i)), zero);
+        const __m128i w4 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(wave4 + i)), zero);
+        const __m128i w5 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(wave5 + i)), zero);
+
+        // ( w1, w2 ) / ( w3, w4 ) / ( w5, 0 ) pairs against the packed gains
+        __m128i w12[2] = { _mm_unpacklo_epi16(w1, w2), _mm_unpackhi_epi16(w1, w2) };
+        __m128i w34[2] = { _mm_unpacklo_epi16(w3, w4), _mm_unpackhi_epi16(w3, w4) };
+        __m128i w50[2] = { _mm_unpacklo_epi16(w5, zero), _mm_unpackhi_epi16(w5, zero) };
+
+        int32_t index[4][8];
+        for (int half = 0; half < 2; half++) {
+            _mm_storeu_si128((__m128i *)&index[0][4 * half],
+                             _mm_srai_epi32(_mm_madd_epi16(w12[half], pulse_left), 8));
+            _mm_storeu_si128((__m128i *)&index[1][4 * half],
+                             _mm_srai_epi32(_mm_madd_epi16(w12[half], pulse_right), 8));
+            _mm_storeu_si128((__m128i *)&index[2][4 * half],
+                             _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(w34[half], tnd_left),
+                                                          _mm_madd_epi16(w50[half], dpcm_left)), 8));
+            _mm_storeu_si128((__m128i *)&index[3][4 * half],
+                             _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(w34[half], tnd_right),
+                                                          _mm_madd_epi16(w50[half], dpcm_right)), 8));
+        }
+
+        // No gather in SSE2: look up into interleaved left / right lanes
+        int16_t pulse[16], tnd[16];
+        for (int k = 0; k < 8; k++) {
+            pulse[2 * k] = mix->pulse[index[0][k]];
+            pulse[2 * k + 1] = mix->pulse[index[1][k]];
+            tnd[2 * k] = mix->tnd[index[2][k]];
+            tnd[2 * k + 1] = mix->tnd[index[3][k]];
+        }
+
+        for (int half = 0; half < 2; half++) {
+            __m128i frame = _mm_subs_epi16(_mm_adds_epi16(_mm_loadu_si128((const __m128i *)&pulse[8 * half]),
+                                                          _mm_loadu_si128((const __m128i *)&tnd[8 * half])),
+                                           center);
+            if (mix->volume != AUDIO_MIX_VOLUME_UNITY) {
+                const __m128i low = _mm_mullo_epi16(frame, volume);
+                const __m128i high = _mm_mulhi_epi16(frame, volume);
+                frame = _mm_packs_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(low, high), 2),
+                                        _mm_srai_epi32(_mm_unpackhi_epi16(low, high), 2));
+            }
+            _mm_storeu_si128((__m128i *)&out[2 * i + 8 * half], frame);
+        }
+    }
+#endif
+
+    audio_mix_scalar(mix, i, samples, wave1, wave2, wave3, wave4, wave5, out);
+
+    if (wave6) {
+        audio_mix_ext(mix, samples, wave6, out);
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+ * Stereo mixer for the APU channel waves of InfoNES_SoundOutput.
+ *
+ * Uses the NES DAC model instead of a weighted sum: the two pulse
+ * channels go through one nonlinear table, triangle / noise / DPCM
+ * through another, as the 2A03 output stage does. Every channel has a
+ * left and a right gain ( gain and pan ) applied before the lookup, and
+ * both sides are computed as packed 2x16-bit lanes: SMUAD / SMLAD /
+ * QADD16 on the Cortex-M33, SSE2 on the host, plain C elsewhere. All
+ * three give the same samples. A cartridge sound chip ( VRC6, N163, 5B )
+ * comes as a sixth, linear wave that is added after the DAC model, as
+ * it is on the cartridge. Plain C that only needs pico.h ( the host
+ * build has a stand-in ) so every backend ( I2S, PWM, host ) uses the
+ * very same mixer.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_MIX_CHANNELS 6
+
+// Channel of the expansion wave
+#define AUDIO_MIX_EXT 5
+
+// Output per expansion wave step at unity gain: a VRC6 pulse at full
+// volume ( 60 ) comes out as loud as an APU pulse at full volume
+#define AUDIO_MIX_EXT_SCALE 80
+
+// Gains are Q8 ( 256 = 1.0 ) and never above 1.0, so the table indices
+// stay in range
+#define AUDIO_MIX_UNITY 256
+
+// Table sizes: pulse index is w1 + w2 ( 17 per NES volume step ),
+// TND index is 3 * w3 + 32 * w4 + 32 * w5 ( 16 per NES step ). Nothing
+// clamps the waves here: noise must stay in 0 .. 15 and DPCM in 0 .. 63
+#define AUDIO_MIX_PULSE_SIZE (255 * 2 + 1)
+#define AUDIO_MIX_TND_SIZE (3 * 255 + 32 * 15 + 32 * 63 + 1)
+
+// Master volume: 4 is unity, like settings.snd_vol
+#define AUDIO_MIX_VOLUME_UNITY 4
+
+typedef struct audio_mix {
+    // Left / right gain per channel ( pulse 1, pulse 2, triangle, noise, DPCM,
+    // expansion ).
+    // Edit, then call audio_mix_update()
+    uint16_t gain[AUDIO_MIX_CHANNELS][2];
+    int volume;
+
+    // Derived from gain[]: left in the low half, right in the high half
+    // of each word, or the two channels of a lookup pair per word
+    uint32_t pulse_left, pulse_right;  // ( g1, g2 )
+    uint32_t tnd_left, tnd_right;      // ( 3 * g3, 32 * g4 )
+    uint32_t dpcm_left, dpcm_right;    // ( 32 * g5, 0 )
+
+    int16_t pulse[AUDIO_MIX_PULSE_SIZE];
+    int16_t tnd[AUDIO_MIX_TND_SIZE];
+} audio_mix_t;
+
+// Build the DAC tables and load the default stereo image: pulse 1 leans
+// left, pulse 2 right, the rest centred, master volume at unity
+void audio_mix_init(audio_mix_t* mix);
+
+// gain 0 .. AUDIO_MIX_UNITY, pan -256 ( left ) .. 256 ( right )
+void audio_mix_set_channel(audio_mix_t* mix, int channel, int gain, int pan);
+
+// Recompute the packed gains after editing gain[]
+void audio_mix_update(audio_mix_t* mix);
+
+// Mix samples of the waves into interleaved int16 left / right; wave6
+// is the expansion chip, NULL when the cartridge has none
+void audio_mix_run(const audio_mix_t* mix, int samples, const uint8_t* wave1, const uint8_t* wave2,
+                   const uint8_t* wave3, const uint8_t* wave4, const uint8_t* wave5, const uint8_t* wave6,
+                   int16_t* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+#include "audio_pwm.h"
+
+#include <stdlib.h>
+#include "pico.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+
+static pwm_audio_config_t* pwm_config;
+static audio_ring_t* pwm_ring;
+static int pwm_dma_active;
+
+static void __not_in_flash_func(pwm_audio_fill)(uint32_t* dma_buf) {
+    audio_ring_pop(pwm_ring, dma_buf, pwm_config->dma_trans_count);
+    pwm_audio_encode(dma_buf, pwm_config->dma_trans_count, pwm_config->bits, pwm_config->stereo,
+                     pwm_config->volume);
+}
+
+static void __not_in_flash_func(pwm_audio_irq)(void) {
+    const uint channel = pwm_config->dma_channel;
+    if (!dma_channel_get_irq1_status(channel)) {
+        return;
+    }
+    dma_channel_acknowledge_irq1(channel);
+
+    const int done = pwm_dma_active;
+    pwm_dma_active ^= 1;
+    dma_channel_transfer_from_buffer_now(channel, pwm_config->dma_buf[pwm_dma_active],
+                                         pwm_config->dma_trans_count);
+    pwm_audio_fill(pwm_config->dma_buf[done]);
+}
+
+void pwm_audio_init(pwm_audio_config_t* config) {
+    if (!config->bits) {
+        config->bits = PWM_AUDIO_BITS;
+    }
+
+    // Carrier: free-running slice at clk_sys / 2^bits, both channels at mid level
+    const uint slice = pwm_gpio_to_slice_num(config->pin);
+    if (config->stereo) {
+        gpio_set_function(config->pin & ~1u, GPIO_FUNC_PWM);
+        gpio_set_function(config->pin | 1u, GPIO_FUNC_PWM);
+    } else {
+        gpio_set_function(config->pin, GPIO_FUNC_PWM);
+    }
+    pwm_config c_pwm = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&c_pwm, 1);
+    pwm_config_set_wrap(&c_pwm, (1u << config->bits) - 1);
+    pwm_init(slice, &c_pwm, false);
+    pwm_set_both_levels(slice, 1u << (config->bits - 1), 1u << (config->bits - 1));
+    pwm_set_enabled(slice, true);
+
+    // Sample clock: a DMA timer, not the PWM wrap, so the carrier and the
+    // sample rate are independent
+    uint16_t num, den;
+    pwm_audio_timer_fraction(clock_get_hz(clk_sys), config->sample_freq, &num, &den);
+    config->dma_timer = (uint8_t)dma_claim_unused_timer(true);
+    dma_timer_set_fraction(config->dma_timer, num, den);
+
+    for (int i = 0; i < 2; i++) {
+        config->dma_buf[i] = malloc(config->dma_trans_count * sizeof(uint32_t));
+        if (!config->dma_buf[i]) {
+            panic("pwm_audio_init: no memory for %u DMA frames", (unsigned)config->dma_trans_count);
+        }
+    }
+
+    config->dma_channel = (uint8_t)dma_claim_unused_channel(true);
+    dma_channel_config dma_config = dma_channel_get_default_config(config->dma_channel);
+    channel_config_set_read_increment(&dma_config, true);
+    channel_config_set_write_increment(&dma_config, false);
+    channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_32);
+    channel_config_set_dreq(&dma_config, dma_get_timer_dreq(config->dma_timer));
+    dma_channel_configure(config->dma_channel,
+                          &dma_config,
+                          &pwm_hw->slice[slice].cc,  // Destination pointer
+                          config->dma_buf[0],        // Source pointer
+                          config->dma_trans_count,   // Number of 32 bits words to transfer
+                          false                      // Start later
+    );
+}
+
+void pwm_audio_start(pwm_audio_config_t* config, audio_ring_t* ring) {
+    pwm_config = config;
+    pwm_ring = ring;
+    pwm_dma_active = 0;
+
+    pwm_audio_fill(config->dma_buf[1]);
+    pwm_audio_fill(config->dma_buf[0]);
+
+    dma_channel_set_irq1_enabled(config->dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, pwm_audio_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    dma_channel_transfer_from_buffer_now(config->dma_channel, config->dma_buf[0], config->dma_trans_count);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+/*
+ * DMA-fed PWM audio for boards without an I2S DAC.
+ *
+ * A PWM slice runs a carrier well above the audio band ( clk_sys /
+ * 2^bits ) and a DMA channel paced by a DMA timer writes one duty word
+ * per sample into its CC register, so the CPU only touches the stream
+ * when a block completes: the IRQ pops the next block from the audio
+ * ring ( the one the I2S backend drains ) and encodes it in place. The
+ * encoder and the timer maths below are plain C with no SDK dependency;
+ * the host build has a stub of the driver that records the duty stream.
+ */
+
+#include <stdint.h>
+
+#include "audio_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Duty resolution: 10 bits keeps the carrier above 140 kHz from 150 MHz up
+#ifndef PWM_AUDIO_BITS
+#define PWM_AUDIO_BITS 10
+#endif
+
+typedef struct pwm_audio_config {
+    uint8_t pin;               // GPIO of the speaker ( either channel of a slice )
+    uint8_t stereo;            // left on channel A, right on channel B of the slice
+    uint8_t bits;              // duty resolution, PWM wrap is 2^bits - 1
+    uint8_t volume;            // 0 ( loudest ) .. 16, a right shift like i2s_config_t
+    uint32_t sample_freq;
+    uint16_t dma_trans_count;  // samples per DMA block
+    uint8_t dma_channel;
+    uint8_t dma_timer;
+    uint32_t* dma_buf[2];
+} pwm_audio_config_t;
+
+// One CC word: channel A duty in the low half, channel B in the high half.
+// Mono sends the average of both sides to both channels.
+static inline uint32_t pwm_audio_duty(const audio_frame_t frame, const unsigned bits, const int stereo,
+                                      const unsigned volume) {
+    int left = audio_frame_left(frame) >> volume;
+    int right = audio_frame_right(frame) >> volume;
+    if (!stereo) {
+        left = right = (left + right) >> 1;
+    }
+    const uint32_t a = (uint32_t)(left + 32768) >> (16 - bits);
+    const uint32_t b = (uint32_t)(right + 32768) >> (16 - bits);
+    return a | (b << 16);
+}
+
+// Encode count frames in place ( frames and duty words are both 32-bit )
+static inline void pwm_audio_encode(uint32_t* buf, const uint32_t count, const unsigned bits, const int stereo,
+                                    const unsigned volume) {
+    for (uint32_t i = 0; i < count; i++) {
+        buf[i] = pwm_audio_duty(buf[i], bits, stereo, volume);
+    }
+}
+
+// The sample a duty word stands for, for checking the encoder
+static inline int16_t pwm_audio_level(const uint32_t duty, const unsigned bits) {
+    return (int16_t)((int32_t)((duty & 0xffff) << (16 - bits)) - 32768);
+}
+
+// DMA timer pacing: clk_sys * num / den, both 16-bit, as close to rate
+// as they get. Returns the resulting sample rate in mHz.
+static inline uint64_t pwm_audio_timer_fraction(const uint32_t clk_sys, const uint32_t rate,
+                                                uint16_t* num, uint16_t* den) {
+    uint64_t best_error = UINT64_MAX;
+    uint64_t best_mhz = 0;
+    *num = 1;
+    *den = 0xffff;
+    for (uint32_t n = 1; n <= 0xffff; n++) {
+        const uint64_t d = ((uint64_t)clk_sys * n + rate / 2) / rate;
+        if (d > 0xffff)
+            break;
+        if (d < n)
+            continue;
+        const uint64_t mhz = (uint64_t)clk_sys * n * 1000 / d;
+        const uint64_t error = mhz > (uint64_t)rate * 1000 ? mhz - (uint64_t)rate * 1000 : (uint64_t)rate * 1000 - mhz;
+        if (error < best_error) {
+            best_error = error;
+            best_mhz = mhz;
+            *num = (uint16_t)n;
+            *den = (uint16_t)d;
+        }
+    }
+    return best_mhz;
+}
+
+// Claim the slice, DMA channel and timer; dma_trans_count and sample_freq must be set
+void pwm_audio_init(pwm_audio_config_t* config);
+
+// Start draining ring from DMA_IRQ_1 ( video owns DMA_IRQ_0 )
+void pwm_audio_start(pwm_audio_config_t* config, audio_ring_t* ring);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,37 @@
+#include "audio_resample.h"
+
+#include <math.h>
+#include <string.h>
+
+void audio_resample_init(audio_resample_t* rs, const uint32_t ratio) {
+    // Pass band to 90% of the lower of the two Nyquist frequencies,
+    // relative to the input rate ( 1.0 = input Nyquist )
+    const float cutoff = 0.9f * (ratio > (1u << 16) ? 65536.0f / ratio : 1.0f);
+    const float half = AUDIO_RESAMPLE_TAPS / 2;
+
+    for (int p = 0; p < AUDIO_RESAMPLE_PHASES; p++) {
+        // Blackman-windowed sinc centred between the two middle taps
+        float taps[AUDIO_RESAMPLE_TAPS];
+        float sum = 0;
+        for (int i = 0; i < AUDIO_RESAMPLE_TAPS; i++) {
+            const float x = i - (half - 1) - (p + 0.5f) / AUDIO_RESAMPLE_PHASES;
+            const float sinc = x == 0 ? cutoff : sinf(M_PI * cutoff * x) / (M_PI * x);
+            const float window = 0.42f + 0.5f * cosf(M_PI * x / half) + 0.08f * cosf(2 * M_PI * x / half);
+            taps[i] = sinc * window;
+            sum += taps[i];
+        }
+
+        // Unity gain at DC on every phase, the rounding goes to the
+        // nearer middle tap
+        int total = 0;
+        for (int i = 0; i < AUDIO_RESAMPLE_TAPS; i++) {
+            rs->kernel[p][i] = (int16_t)lrintf(taps[i] / sum * AUDIO_RESAMPLE_ONE);
+            total += rs->kernel[p][i];
+        }
+        rs->kernel[p][AUDIO_RESAMPLE_TAPS / 2 - 1 + (2 * p >= AUDIO_RESAMPLE_PHASES)] +=
+            (int16_t)(AUDIO_RESAMPLE_ONE - total);
+    }
+
+    memset(rs->hist, 0, sizeof rs->hist);
+    rs->pos = 0;
+}
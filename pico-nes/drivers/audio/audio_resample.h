@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ * Polyphase FIR resampler between the APU and the output rate.
+ *
+ * The APU synthesizes at a rate derived from the CPU clock ( 1789773 / 40
+ * Hz ), which no DAC runs at, so the producer converts on the way into
+ * the audio ring. Every output frame is a windowed sinc over the
+ * AUDIO_RESAMPLE_TAPS nearest input frames, with the taps taken from one
+ * of AUDIO_RESAMPLE_PHASES precomputed fractional positions. When the
+ * output rate is the lower one the cutoff follows it, so downsampling to
+ * 22050 or 32000 does not fold the top octave back. Frames are packed
+ * int16 stereo, left in the low half ( audio_frame_t of audio_ring.h ).
+ * Plain C with no SDK dependency so the host tools run the same code.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Output rate of the DAC / PWM backends ( APU_RATE in CMake )
+#ifndef AUDIO_OUTPUT_RATE
+#define AUDIO_OUTPUT_RATE 44100
+#endif
+
+// Display refresh the output is locked to, in mHz ( AUDIO_REFRESH_MHZ in CMake )
+#ifndef AUDIO_REFRESH_MHZ
+#define AUDIO_REFRESH_MHZ 60000
+#endif
+
+#define AUDIO_RESAMPLE_TAPS 16
+#define AUDIO_RESAMPLE_PHASE_BITS 6
+#define AUDIO_RESAMPLE_PHASES (1 << AUDIO_RESAMPLE_PHASE_BITS)
+
+// Taps are Q14, every phase sums to exactly 1.0
+#define AUDIO_RESAMPLE_ONE (1 << 14)
+
+typedef struct audio_resample {
+    int16_t kernel[AUDIO_RESAMPLE_PHASES][AUDIO_RESAMPLE_TAPS];
+    // Input history, every frame stored twice so the last TAPS frames
+    // are always contiguous from hist + pos + 1, oldest first
+    uint32_t hist[2 * AUDIO_RESAMPLE_TAPS];
+    uint32_t pos;
+} audio_resample_t;
+
+// Build the kernel for ratio ( input frames per output frame, 16.16 )
+// and clear the history
+void audio_resample_init(audio_resample_t* rs, uint32_t ratio);
+
+static inline void audio_resample_push(audio_resample_t* rs, const uint32_t frame) {
+    rs->pos = (rs->pos + 1) & (AUDIO_RESAMPLE_TAPS - 1);
+    rs->hist[rs->pos] = rs->hist[rs->pos + AUDIO_RESAMPLE_TAPS] = frame;
+}
+
+static inline int32_t audio_resample_clamp(const int32_t v) {
+    return v < -32768 ? -32768 : v > 32767 ? 32767 : v;
+}
+
+// The output frame at phase ( 16.16, below 1.0 ) past the older of the
+// two middle frames of the history: AUDIO_RESAMPLE_TAPS / 2 frames of
+// latency
+static inline uint32_t audio_resample_frame(const audio_resample_t* rs, const uint32_t phase) {
+    const int16_t* k = rs->kernel[phase >> (16 - AUDIO_RESAMPLE_PHASE_BITS)];
+    const uint32_t* x = rs->hist + rs->pos + 1;
+    int32_t left = AUDIO_RESAMPLE_ONE / 2;
+    int32_t right = AUDIO_RESAMPLE_ONE / 2;
+    for (int i = 0; i < AUDIO_RESAMPLE_TAPS; i++) {
+        left += k[i] * (int16_t)x[i];
+        right += k[i] * (int16_t)(x[i] >> 16);
+    }
+    left = audio_resample_clamp(left >> 14);
+    right = audio_resample_clamp(right >> 14);
+    return (uint16_t)left | ((uint32_t)(uint16_t)right << 16);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,210 @@
+#pragma once
+
+/*
+ * Audio hand-off between the emulation core and the output DMA.
+ *
+ * The emulator pushes int16 stereo frames into a single-producer /
+ * single-consumer ring and never waits; the DMA completion IRQ pops one
+ * transfer worth of frames at a time. A small rate controller watches
+ * the ring level and nudges the producer's resampling step so the fill
+ * (and with it the output latency) settles on a target instead of
+ * drifting into underruns or overruns when the emulated frame rate and
+ * the DAC clock disagree. Plain C with no SDK dependency so the host
+ * tools run the very same code.
+ */
+
+#include <stdint.h>
+
+#include "audio_resample.h"
+
+// One stereo frame: left in the low half, right in the high half, the
+// layout the I2S state machine shifts out of a 32-bit FIFO word
+typedef uint32_t audio_frame_t;
+
+static inline audio_frame_t audio_frame(const int16_t left, const int16_t right) {
+    return (uint16_t)left | ((uint32_t)(uint16_t)right << 16);
+}
+
+static inline int16_t audio_frame_left(const audio_frame_t frame) { return (int16_t)frame; }
+static inline int16_t audio_frame_right(const audio_frame_t frame) { return (int16_t)(frame >> 16); }
+
+typedef struct audio_ring {
+    audio_frame_t* buf;
+    uint32_t mask;               // capacity - 1, capacity is a power of two
+    volatile uint32_t head;      // written by the producer only
+    volatile uint32_t tail;      // written by the consumer only
+    audio_frame_t last;          // last frame popped, repeated on underrun
+    volatile uint32_t overruns;  // frames dropped because the ring was full
+    volatile uint32_t underruns; // pops that came up short
+} audio_ring_t;
+
+static inline void audio_ring_init(audio_ring_t* ring, audio_frame_t* buf, const uint32_t capacity) {
+    ring->buf = buf;
+    ring->mask = capacity - 1;
+    ring->head = ring->tail = 0;
+    ring->last = audio_frame(0, 0);
+    ring->overruns = ring->underruns = 0;
+}
+
+// Frames queued; either side may ask
+static inline uint32_t audio_ring_level(const audio_ring_t* ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t audio_ring_free(const audio_ring_t* ring) {
+    return ring->mask + 1 - audio_ring_level(ring);
+}
+
+// Watermark checks: the consumer starts once the ring is above its start
+// level, the producer may back off while it is above a high mark
+static inline int audio_ring_above(const audio_ring_t* ring, const uint32_t watermark) {
+    return audio_ring_level(ring) >= watermark;
+}
+
+static inline int audio_ring_below(const audio_ring_t* ring, const uint32_t watermark) {
+    return audio_ring_level(ring) < watermark;
+}
+
+// Producer side. Never blocks: frames that do not fit are dropped and
+// counted. Returns the number of frames queued.
+static inline uint32_t audio_ring_push(audio_ring_t* ring, const audio_frame_t* frames, const uint32_t count) {
+    const uint32_t head = ring->head;
+    const uint32_t space = ring->mask + 1 - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+    const uint32_t n = count < space ? count : space;
+    for (uint32_t i = 0; i < n; i++) {
+        ring->buf[(head + i) & ring->mask] = frames[i];
+    }
+    __atomic_store_n(&ring->head, head + n, __ATOMIC_RELEASE);
+    if (n < count) {
+        ring->overruns += count - n;
+    }
+    return n;
+}
+
+// Consumer side. Always fills count frames: a short ring is padded with
+// the last frame played ( a held level instead of a click ) and counted.
+// Returns the number of frames that came from the ring.
+static inline uint32_t audio_ring_pop(audio_ring_t* ring, audio_frame_t* frames, const uint32_t count) {
+    const uint32_t tail = ring->tail;
+    const uint32_t avail = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    const uint32_t n = count < avail ? count : avail;
+    for (uint32_t i = 0; i < n; i++) {
+        frames[i] = ring->buf[(tail + i) & ring->mask];
+    }
+    __atomic_store_n(&ring->tail, tail + n, __ATOMIC_RELEASE);
+    if (n) {
+        ring->last = frames[n - 1];
+    }
+    if (n < count) {
+        for (uint32_t i = n; i < count; i++) {
+            frames[i] = ring->last;
+        }
+        ring->underruns++;
+    }
+    return n;
+}
+
+/*
+ * Rate control. The producer resamples its frames by step ( input frames
+ * per output frame, 16.16 ) through the polyphase FIR of
+ * audio_resample.h. The nominal step, ratio, comes from the APU rate,
+ * the output rate and the display refresh; the controller corrects it
+ * from the ring level seen at every push. Proportional plus a slow
+ * integral term, clamped to +-AUDIO_RATE_MAX_PPM so the pitch shift
+ * stays inaudible.
+ */
+
+#ifndef AUDIO_RATE_MAX_PPM
+#define AUDIO_RATE_MAX_PPM 10000
+#endif
+
+typedef struct audio_rate {
+    uint32_t target;   // ring level to hold, in frames
+    uint32_t ratio;    // nominal input frames per output frame, 16.16
+    uint32_t step;     // ratio with the correction applied
+    uint32_t phase;    // position past the middle of the FIR history, 16.16
+    int64_t integral;  // sum of level error * input frames
+    uint32_t input_hz; // input frames per second, 0 until the ratio is set
+    int enabled;
+    audio_resample_t fir;
+} audio_rate_t;
+
+static inline void audio_rate_init(audio_rate_t* rate, const uint32_t target) {
+    rate->target = target;
+    rate->ratio = rate->step = 1u << 16;
+    rate->phase = 0;
+    rate->integral = 0;
+    rate->input_hz = 0;
+    rate->enabled = 1;
+    audio_resample_init(&rate->fir, rate->ratio);
+}
+
+// Lock the output to the display: frame16 input frames ( 16.16 ) make
+// one emulated frame and the backend plays rate frames per second, so
+// rate / refresh output frames per emulated frame keep the ring level
+// while the emulation runs at the display refresh ( in mHz ). The
+// controller is left with the clock errors only.
+static inline void audio_rate_set_ratio(audio_rate_t* rate, const uint64_t frame16, const uint32_t rate_hz,
+                                        const uint32_t refresh_mhz) {
+    rate->ratio = rate->step = (uint32_t)(frame16 * refresh_mhz / ((uint64_t)rate_hz * 1000));
+    rate->input_hz = (uint32_t)(((uint64_t)rate_hz * rate->ratio) >> 16);
+    audio_resample_init(&rate->fir, rate->ratio);
+}
+
+// Signed step offset from ratio in parts per million
+static inline int32_t audio_rate_ppm(const audio_rate_t* rate) {
+    return (int32_t)(((int64_t)rate->step - rate->ratio) * 1000000 / rate->ratio);
+}
+
+// Re-evaluate step after `frames` input frames were produced at `level`.
+// A full target of error asks for AUDIO_RATE_MAX_PPM / 2; the integral
+// removes the remaining offset over a few seconds, the same at every
+// output rate since it counts input frames at input_hz.
+static inline void audio_rate_update(audio_rate_t* rate, const uint32_t level, const uint32_t frames) {
+    if (!rate->enabled || !rate->target || !rate->input_hz) {
+        rate->step = rate->ratio;
+        return;
+    }
+    const int64_t error = (int64_t)level - rate->target;
+    const int64_t limit = (int64_t)rate->target * rate->input_hz * 8;
+    rate->integral += error * frames;
+    if (rate->integral > limit)
+        rate->integral = limit;
+    if (rate->integral < -limit)
+        rate->integral = -limit;
+
+    const int64_t max16 = (int64_t)AUDIO_RATE_MAX_PPM * 65536 / 1000000;
+    int64_t adjust = error * max16 / (2 * (int64_t)rate->target) +
+                     rate->integral * max16 / limit;
+    if (adjust > max16)
+        adjust = max16;
+    if (adjust < -max16)
+        adjust = -max16;
+    rate->step = (uint32_t)(rate->ratio + ((rate->ratio * adjust) >> 16));
+}
+
+// Resample count input frames by rate->step and push the result. The
+// controller is updated once per call. Returns the output frames queued.
+static inline uint32_t audio_ring_push_rate(audio_ring_t* ring, audio_rate_t* rate,
+                                            const audio_frame_t* frames, const uint32_t count) {
+    audio_rate_update(rate, audio_ring_level(ring), count);
+
+    audio_frame_t out[64];
+    uint32_t n = 0;
+    uint32_t queued = 0;
+    uint32_t phase = rate->phase;
+    for (uint32_t i = 0; i < count; i++) {
+        audio_resample_push(&rate->fir, frames[i]);
+        while (phase < (1u << 16)) {
+            out[n++] = audio_resample_frame(&rate->fir, phase);
+            if (n == sizeof out / sizeof out[0]) {
+                queued += audio_ring_push(ring, out, n);
+                n = 0;
+            }
+            phase += rate->step;
+        }
+        phase -= 1u << 16;
+    }
+    rate->phase = phase;
+    return queued + audio_ring_push(ring, out, n);
+}
@@ -98,6 +98,10 @@ static int graphics_buffer_shift_y = 0;
 
 enum graphics_mode_t graphics_mode = GRAPHICSMODE_DEFAULT;
 
+// Line hashes of the graphics buffer as last sent to the glass
+static uint32_t glass_hash[SCREEN_HEIGHT];
+static bool glass_valid = false;
+
 static const uint8_t init_seq[] = {
     1, 20, 0x01, // Software reset
     1, 10, 0x11, // Exit sleep mode
@@ -150,10 +154,14 @@ static inline void lcd_set_window(const uint16_t x,
                                   const uint16_t height) {
     static uint8_t screen_width_cmd[] = { 0x2a, 0x00, 0x00, SCREEN_WIDTH >> 8, SCREEN_WIDTH & 0xff };
     static uint8_t screen_height_command[] = { 0x2b, 0x00, 0x00, SCREEN_HEIGHT >> 8, SCREEN_HEIGHT & 0xff };
+    screen_width_cmd[1] = x >> 8;
     screen_width_cmd[2] = x;
+    screen_width_cmd[3] = (x + width - 1) >> 8;
     screen_width_cmd[4] = x + width - 1;
 
+    screen_height_command[1] = y >> 8;
     screen_height_command[2] = y;
+    screen_height_command[3] = (y + height - 1) >> 8;
     screen_height_command[4] = y + height - 1;
     lcd_write_cmd(screen_width_cmd, 5);
     lcd_write_cmd(screen_height_command, 5);
@@ -280,6 +288,7 @@ void graphics_init() {
 }
 
 void inline graphics_set_mode(const enum graphics_mode_t mode) {
+    glass_valid = false;
     graphics_mode = -1;
     sleep_ms(16);
     clrScr(0);
@@ -302,6 +311,7 @@ void graphics_set_offset(const int x, const int y) {
 }
 
 void clrScr(const uint8_t color) {
+    glass_valid = false;
     memset(&graphics_buffer[0], 0, graphics_buffer_height * graphics_buffer_width);
     lcd_set_window(0, 0,SCREEN_WIDTH,SCREEN_HEIGHT);
     uint32_t i = SCREEN_WIDTH * SCREEN_HEIGHT;
@@ -324,6 +334,8 @@ void st7789_dma_pixels(const uint16_t* pixels, const uint num_pixels) {
 #endif
 
 void __inline __scratch_y("refresh_lcd") refresh_lcd() {
+    // Whatever is sent here is not covered by line hashes
+    glass_valid = false;
     switch (graphics_mode) {
         case TEXTMODE_DEFAULT:
             lcd_set_window(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
@@ -362,6 +374,39 @@ void __inline __scratch_y("refresh_lcd") refresh_lcd() {
 }
 
 
+/*
+ * Send only the lines of the graphics buffer whose hash changed since the
+ * last call, one window per run of changed lines. Falls back to a full
+ * refresh outside graphics mode and after anything else touched the glass.
+ */
+void __not_in_flash_func(refresh_lcd_lines)(const uint32_t* line_hash) {
+    if (graphics_mode != GRAPHICSMODE_DEFAULT) {
+        refresh_lcd();
+        return;
+    }
+    if (!glass_valid) {
+        // Differs from every possible hash run below: all lines are sent
+        for (uint y = 0; y < graphics_buffer_height; y++)
+            glass_hash[y] = ~line_hash[y];
+        glass_valid = true;
+    }
+
+    uint y = 0;
+    uint height;
+    while ((height = st7789_next_dirty_run(line_hash, glass_hash, graphics_buffer_height, &y, ST7789_MERGE_GAP))) {
+        const uint8_t* bitmap = graphics_buffer + y * graphics_buffer_width;
+        lcd_set_window(graphics_buffer_shift_x, graphics_buffer_shift_y + y, graphics_buffer_width, height);
+        uint32_t i = graphics_buffer_width * height;
+        start_pixels();
+        while (i--) {
+            st7789_lcd_put_pixel(pio, sm, palette[*bitmap++]);
+        }
+        stop_pixels();
+        y += height;
+    }
+}
+
 void graphics_set_palette(const uint8_t i, const uint32_t color) {
     palette[i] = (uint16_t)color;
+    glass_valid = false;
 }
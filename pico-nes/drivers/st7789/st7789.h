@@ -1,5 +1,7 @@
 #pragma once
 
+#include "st7789_dirty.h"
+
 #ifdef TFT_PARALLEL
 
 // Parallel mode pin definitions (set in board header)
@@ -76,3 +78,6 @@ inline static void graphics_set_flashmode(bool flash_line, bool flash_frame) {
     // dummy
 }
 void refresh_lcd();
+
+// Send only changed lines; line_hash[] has one st7789_line_hash() per line
+void refresh_lcd_lines(const uint32_t* line_hash);
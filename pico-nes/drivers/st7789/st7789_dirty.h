@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+ * Changed-line tracking for the ST7789 refresh.
+ *
+ * The frame producer hashes every line it renders; the driver keeps the
+ * hashes of what is on the glass and only re-sends runs of lines whose
+ * hash changed, one lcd_set_window() per run. Plain C with no SDK
+ * dependency so the host LCD simulator runs the very same planner.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+// Clean lines between two dirty runs that are sent anyway: re-sending a
+// few lines is cheaper than the CASET/RASET/RAMWR round trip on this bus
+#ifndef ST7789_MERGE_GAP
+#define ST7789_MERGE_GAP 4
+#endif
+
+// FNV-1a over 32-bit words; width must be a multiple of 4
+static inline uint32_t st7789_line_hash(const uint8_t* line, const unsigned width) {
+    const uint32_t* word = (const uint32_t *)line;
+    uint32_t hash = 2166136261u;
+    for (unsigned i = 0; i < width / 4; i++) {
+        hash = (hash ^ word[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Find the next run of changed lines at or after *y and mark it as sent
+// in glass[]. Returns the run height with *y at its first line, or 0
+// when the rest of the frame is unchanged.
+static inline unsigned st7789_next_dirty_run(const uint32_t* hash, uint32_t* glass,
+                                             const unsigned height, unsigned* y,
+                                             const unsigned merge_gap) {
+    unsigned top = *y;
+    while (top < height && hash[top] == glass[top])
+        top++;
+    if (top >= height)
+        return 0;
+
+    unsigned bottom = top + 1; // one past the last dirty line
+    unsigned scan = bottom;
+    while (scan < height && scan - bottom <= merge_gap) {
+        if (hash[scan] != glass[scan])
+            bottom = scan + 1;
+        scan++;
+    }
+
+    memcpy(&glass[top], &hash[top], (bottom - top) * sizeof glass[0]);
+    *y = top;
+    return bottom - top;
+}
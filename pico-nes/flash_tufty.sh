@@ -6,6 +6,7 @@
 #   ./flash_tufty.sh          # Full clean build + flash
 #   ./flash_tufty.sh --flash  # Flash only (skip build)
 #   ./flash_tufty.sh --build  # Build only (skip flash)
+#   ./flash_tufty.sh --roms   # Repack ROMs/ and flash only the ROM pack
 #
 
 set -euo pipefail
@@ -15,6 +16,12 @@ SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 PROJECT_DIR="$SCRIPT_DIR"
 BUILD_DIR="$PROJECT_DIR/build"
 ELF_FILE="$PROJECT_DIR/bin/Release/tufty-nes-TFT-PARALLEL-PWM-305.elf"
+ROM_PACK="$PROJECT_DIR/roms.pack"
+# Must match ROM_PACK_OFFSET of the firmware build
+ROM_PACK_OFFSET="${ROM_PACK_OFFSET:-0x400000}"
+# ON: pack every bank LZ4-compressed and build the firmware to decode them
+# ( delete roms.pack after switching so it is repacked )
+ROM_LZ4="${ROM_LZ4:-OFF}"
 
 # Toolchain paths - adjust these for your system
 PICO_SDK_PATH="${PICO_SDK_PATH:-/Users/minibrain/pico-sdk}"
@@ -63,28 +70,36 @@ preflight() {
     fi
 }
 
-# ── ROM table generation ───────────────────────────────────────────
+# ── ROM pack generation ────────────────────────────────────────────
+pack_roms() {
+    if [ "$ROM_LZ4" = "ON" ]; then
+        python3 "$PROJECT_DIR/tools/convert_roms.py" --lz4 -o "$ROM_PACK"
+    else
+        python3 "$PROJECT_DIR/tools/convert_roms.py" -o "$ROM_PACK"
+    fi
+}
+
 generate_roms() {
-    if [ ! -f "$PROJECT_DIR/src/rom_table.h" ]; then
-        info "Generating ROM table header..."
-        python3 "$PROJECT_DIR/tools/convert_roms.py"
-        ok "ROM table generated"
+    if [ ! -f "$ROM_PACK" ]; then
+        info "Generating ROM pack..."
+        pack_roms
+        ok "ROM pack generated"
     else
-        # Regenerate if any ROM is newer than the header
+        # Regenerate if any ROM is newer than the pack
         local rom_newer=0
         for rom in "$PROJECT_DIR/ROMs/"*.nes; do
             [ -f "$rom" ] || continue
-            if [ "$rom" -nt "$PROJECT_DIR/src/rom_table.h" ]; then
+            if [ "$rom" -nt "$ROM_PACK" ]; then
                 rom_newer=1
                 break
             fi
         done
         if [ $rom_newer -eq 1 ]; then
-            info "ROM files changed, regenerating ROM table..."
-            python3 "$PROJECT_DIR/tools/convert_roms.py"
-            ok "ROM table regenerated"
+            info "ROM files changed, regenerating ROM pack..."
+            pack_roms
+            ok "ROM pack regenerated"
         else
-            info "ROM table is up to date"
+            info "ROM pack is up to date"
         fi
     fi
 }
@@ -103,6 +118,8 @@ build() {
         -DCMAKE_CXX_COMPILER="$ARM_GPP" \
         -DCMAKE_ASM_COMPILER="$ARM_GCC" \
         -DCMAKE_MAKE_PROGRAM="$MAKE" \
+        -DROM_PACK_OFFSET="$ROM_PACK_OFFSET" \
+        -DROM_LZ4="$ROM_LZ4" \
         "$PROJECT_DIR"
     cd "$PROJECT_DIR"
 
@@ -118,13 +135,7 @@ build() {
 }
 
 # ── Flash ───────────────────────────────────────────────────────────
-flash() {
-    if [ ! -f "$ELF_FILE" ]; then
-        err "ELF file not found: $ELF_FILE"
-        err "Run a build first: ./flash_tufty.sh --build"
-        exit 1
-    fi
-
+wait_device() {
     info "Checking for Tufty in bootloader mode..."
     if ! "$PICOTOOL" info &>/dev/null; then
         warn "Device not detected in bootloader mode."
@@ -144,6 +155,31 @@ flash() {
     fi
 
     ok "Device detected"
+}
+
+flash_roms() {
+    local reboot="${1:-}"
+
+    if [ ! -f "$ROM_PACK" ]; then
+        err "ROM pack not found: $ROM_PACK"
+        err "Generate it first: python3 tools/convert_roms.py"
+        exit 1
+    fi
+
+    info "Flashing ROM pack at +$ROM_PACK_OFFSET..."
+    "$PICOTOOL" load -f $reboot "$ROM_PACK" -t bin -o "$(printf '0x%x' $((0x10000000 + ROM_PACK_OFFSET)))"
+    ok "ROM pack flashed"
+}
+
+flash() {
+    if [ ! -f "$ELF_FILE" ]; then
+        err "ELF file not found: $ELF_FILE"
+        err "Run a build first: ./flash_tufty.sh --build"
+        exit 1
+    fi
+
+    wait_device
+    flash_roms
     info "Flashing firmware..."
     "$PICOTOOL" load -f -x "$ELF_FILE"
     ok "Flash complete - device is rebooting"
@@ -163,6 +199,12 @@ main() {
         --flash)
             flash
             ;;
+        --roms)
+            generate_roms
+            wait_device
+            flash_roms -x
+            ok "Device is rebooting"
+            ;;
         --build)
             generate_roms
             build
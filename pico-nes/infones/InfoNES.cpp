@@ -214,8 +214,8 @@ WORD *WorkFrame;
 WORD WorkFrameIdx;
 #else
 // WORD WorkFrame[ NES_DISP_WIDTH * NES_DISP_HEIGHT ];
-WORD *WorkLine = nullptr;
-void __not_in_flash_func(InfoNES_SetLineBuffer)(WORD *p, WORD size)
+BYTE *WorkLine = nullptr;
+void __not_in_flash_func(InfoNES_SetLineBuffer)(BYTE *p, WORD size)
 {
   assert(size >= NES_DISP_WIDTH);
   WorkLine = p;
@@ -225,6 +225,24 @@ void __not_in_flash_func(InfoNES_SetLineBuffer)(WORD *p, WORD size)
 /* Update flag for ChrBuf */
 BYTE ChrBufUpdate;
 
+/*
+ *  Background tile-row cache. About 17 KB a slot, so the two slots take
+ *  34 KB of SRAM; with the 180 KB of triple-buffered FRAMES that is well
+ *  inside the RP2350's 520 KB.
+ */
+#define BG_CACHE_SLOTS 2
+
+struct bg_cache_tag
+{
+  BYTE *pbyPage;           // Name table page this slot mirrors
+  BYTE byValid[32];        // Decoded fine-y rows ( bit n = fine-y n )
+  BYTE byPal[32][32];      // Palette offset in PalTable per tile
+  WORD wPat[32][8][32];    // 2bpp pixels, leftmost pixel in bits 15-14
+};
+static struct bg_cache_tag s_BgCache[BG_CACHE_SLOTS];
+static BYTE *s_pbyBgCacheChr[4];
+static int s_nBgCacheLru;
+
 /* Palette Table */
 WORD PalTable[32];
 
@@ -298,6 +316,9 @@ BYTE ROM_Trainer;
 /* Four screen VRAM  */
 BYTE ROM_FourScr;
 
+/* Cartridge information from a ROM database */
+struct RomInfo_tag RomInfo;
+
 /*===================================================================*/
 /*                                                                   */
 /*                InfoNES_Init() : Initialize InfoNES                */
@@ -415,24 +436,43 @@ int InfoNES_Reset()
   /*  Get information on the cassette                                  */
   /*-------------------------------------------------------------------*/
 
-  // Get Mapper Number
-  MapperNo = NesHeader.byInfo1 >> 4;
-
-  // Check bit counts of Mapper No.
-  for (nIdx = 4; nIdx < 8 && NesHeader.byReserve[nIdx] == 0; ++nIdx)
-    ;
-
-  if (nIdx == 8)
+  if (RomInfo.byKnown)
   {
-    // Mapper Number is 8bits
-    MapperNo |= (NesHeader.byInfo2 & 0xf0);
+    // A known cartridge: the ROM database overrides the header
+    if (RomInfo.wMapperNo > 0xff)
+    {
+      InfoNES_Error("Mapper #%d is unsupported.", RomInfo.wMapperNo);
+      return -1;
+    }
+    MapperNo = (BYTE)RomInfo.wMapperNo;
+    ROM_Mirroring = RomInfo.byMirroring == 1;
+    ROM_SRAM = RomInfo.byBattery;
+    ROM_FourScr = RomInfo.byMirroring == 2;
   }
+  else
+  {
+    // Get Mapper Number
+    MapperNo = NesHeader.byInfo1 >> 4;
+
+    // Check bit counts of Mapper No.
+    for (nIdx = 4; nIdx < 8 && NesHeader.byReserve[nIdx] == 0; ++nIdx)
+      ;
+
+    if (nIdx == 8)
+    {
+      // Mapper Number is 8bits
+      MapperNo |= (NesHeader.byInfo2 & 0xf0);
+    }
 
-  // Get information on the ROM
-  ROM_Mirroring = NesHeader.byInfo1 & 1;
-  ROM_SRAM = NesHeader.byInfo1 & 2;
+    // Get information on the ROM
+    ROM_Mirroring = NesHeader.byInfo1 & 1;
+    ROM_SRAM = NesHeader.byInfo1 & 2;
+    ROM_FourScr = NesHeader.byInfo1 & 8;
+  }
   ROM_Trainer = NesHeader.byInfo1 & 4;
-  ROM_FourScr = NesHeader.byInfo1 & 8;
+
+  // Per-game quirks
+  K6502_IdleSkip = !(RomInfo.dwQuirks & ROMINFO_NO_IDLE_SKIP);
 
   /*-------------------------------------------------------------------*/
   /*  Initialize resources                                             */
@@ -480,14 +520,9 @@ int InfoNES_Reset()
   /*  Initialize Mapper                                                */
   /*-------------------------------------------------------------------*/
   InfoNES_MessageBox("Using Mapper #%d\n", MapperNo);
-  // Get Mapper Table Index
-  for (nIdx = 0; MapperTable[nIdx].nMapperNo != -1; ++nIdx)
-  {
-    if (MapperTable[nIdx].nMapperNo == MapperNo)
-      break;
-  }
+  const struct MapperDesc_tag *pMapper = InfoNES_GetMapper(MapperNo);
 
-  if (MapperTable[nIdx].nMapperNo == -1)
+  if (pMapper->pMapperInit == NULL)
   {
     // Non support mapper
     InfoNES_Error("Mapper #%d is unsupported.", MapperNo);
@@ -495,7 +530,11 @@ int InfoNES_Reset()
   }
 
   // Set up a mapper initialization function
-  MapperTable[nIdx].pMapperInit();
+  pMapper->pMapperInit();
+
+  // The descriptor tells the truth about the callbacks the mapper set
+  assert(((pMapper->byFlags & MAPPER_IRQ_MASK) != MAPPER_IRQ_NONE) == (MapperHSync != Map0_HSync));
+  assert(((pMapper->byFlags & MAPPER_PPU) != 0) == (MapperPPU != Map0_PPU));
 
   /*-------------------------------------------------------------------*/
   /*  Reset CPU                                                        */
@@ -566,6 +605,9 @@ void InfoNES_SetupPPU()
   /* Mirroring of Name Table */
   InfoNES_Mirroring(ROM_Mirroring);
 
+  /* Forget decoded background rows */
+  InfoNES_BgCacheFlush();
+
   /* Reset VRAM Write Enable */
   byVramWriteEnable = (NesHeader.byVRomSize == 0) ? 1 : 0;
 }
@@ -683,6 +725,7 @@ bool __not_in_flash_func(InfoNES_Cycle)()
 
     // A mapper function in H-Sync
     MapperHSync();
+    K6502_MapPrg();
 
     // A function in H-Sync
     auto todo = InfoNES_HSync();
@@ -829,6 +872,7 @@ int __not_in_flash_func(InfoNES_HSync)()
 
     // A mapper function in V-Sync
     MapperVSync();
+    K6502_MapPrg();
 
     // Get the condition of the joypad
     InfoNES_PadState(&PAD1_Latch, &PAD2_Latch, &PAD_System);
@@ -855,19 +899,37 @@ int __not_in_flash_func(InfoNES_HSync)()
 
 namespace
 {
+  // Background pixels that hide sprites behind them: one bit per pixel,
+  // most significant bit first, starting at the left end tile.
+  // Screen pixel x is bit x + PPU_Scr_H_Bit.
+  inline BYTE __attribute__((always_inline)) patOpaque(unsigned pat)
+  {
+    // 2bpp interleaved pattern -> 8 bits of "pixel is not 0"
+    pat = (pat | (pat >> 1)) & 0x5555;
+    pat = (pat | (pat >> 1)) & 0x3333;
+    pat = (pat | (pat >> 2)) & 0x0f0f;
+    return (pat | (pat >> 4)) & 0xff;
+  }
+
   void __not_in_flash_func(compositeSprite)(const uint16_t *pal,
                                             const uint8_t *spr,
-                                            uint16_t *buf)
+                                            uint8_t *buf,
+                                            const uint8_t *bgOpaque,
+                                            int bgBit)
   {
-    auto sprEnd = spr + NES_DISP_WIDTH;
+    int x = 0;
     do
     {
       auto proc = [=](int i) __attribute__((always_inline))
       {
         int v = spr[i];
-        if (v && ((v >> 7) || (buf[i] >> 15)))
+        if (v)
         {
-          buf[i] = pal[v & 0xf];
+          const int b = x + i + bgBit;
+          if ((v >> 7) || !((bgOpaque[b >> 3] << (b & 7)) & 0x80))
+          {
+            buf[i] = pal[v & 0xf];
+          }
         }
       };
 
@@ -878,13 +940,162 @@ namespace
       proc(3);
       buf += 4;
       spr += 4;
+      x += 4;
 #else
       proc(0);
       buf += 1;
       spr += 1;
+      x += 1;
 #endif
-    } while (spr < sprEnd);
+    } while (x < NES_DISP_WIDTH);
+  }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*       InfoNES_BgCacheFlush() : Drop every cached tile row         */
+/*                                                                   */
+/*===================================================================*/
+void __not_in_flash_func(InfoNES_BgCacheFlush)()
+{
+  for (int nSlot = 0; nSlot < BG_CACHE_SLOTS; ++nSlot)
+  {
+    s_BgCache[nSlot].pbyPage = NULL;
+    InfoNES_MemorySet(s_BgCache[nSlot].byValid, 0, sizeof s_BgCache[nSlot].byValid);
+  }
+  s_pbyBgCacheChr[0] = s_pbyBgCacheChr[1] = s_pbyBgCacheChr[2] = s_pbyBgCacheChr[3] = NULL;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*   InfoNES_BgCacheWriteNT() : Name table byte written via $2007    */
+/*                                                                   */
+/*===================================================================*/
+void __not_in_flash_func(InfoNES_BgCacheWriteNT)(WORD wAddr)
+{
+  /*
+   *  A tile byte invalidates its own row, an attribute byte the four
+   *  rows it colours. Both mirrors written by $2007 are checked.
+   */
+  BYTE *pbyPage0 = PPUBANK[wAddr >> 10];
+  BYTE *pbyPage1 = PPUBANK[(wAddr ^ 0x1000) >> 10];
+  int nOfs = wAddr & 0x3ff;
+
+  for (int nSlot = 0; nSlot < BG_CACHE_SLOTS; ++nSlot)
+  {
+    struct bg_cache_tag *pSlot = &s_BgCache[nSlot];
+    if (pSlot->pbyPage != pbyPage0 && pSlot->pbyPage != pbyPage1)
+      continue;
+
+    pSlot->byValid[nOfs >> 5] = 0;
+    if (nOfs >= 0x3c0)
+    {
+      BYTE *pbyValid = &pSlot->byValid[((nOfs - 0x3c0) >> 3) << 2];
+      pbyValid[0] = pbyValid[1] = pbyValid[2] = pbyValid[3] = 0;
+    }
+  }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_BgCacheWriteChr() : Pattern byte written via $2007       */
+/*                                                                   */
+/*===================================================================*/
+void __not_in_flash_func(InfoNES_BgCacheWriteChr)(BYTE *pbyBank)
+{
+  if (pbyBank == s_pbyBgCacheChr[0] || pbyBank == s_pbyBgCacheChr[1] ||
+      pbyBank == s_pbyBgCacheChr[2] || pbyBank == s_pbyBgCacheChr[3])
+  {
+    InfoNES_BgCacheFlush();
+  }
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*   InfoNES_BgCacheForget() : A CHR bank's memory now holds another */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_BgCacheForget(BYTE *pbyBank)
+{
+  /*
+   *  The rows decoded through it, as pattern or as name table, are
+   *  keyed by its address ( ROM_LZ4 bank cache refilling a slot ).
+   */
+  bool bStale = pbyBank == s_pbyBgCacheChr[0] || pbyBank == s_pbyBgCacheChr[1] ||
+                pbyBank == s_pbyBgCacheChr[2] || pbyBank == s_pbyBgCacheChr[3];
+  for (int nSlot = 0; nSlot < BG_CACHE_SLOTS; ++nSlot)
+    bStale = bStale || s_BgCache[nSlot].pbyPage == pbyBank;
+
+  if (bStale)
+    InfoNES_BgCacheFlush();
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_BgCacheRow() : Cached pixels of one background row    */
+/*                                                                   */
+/*===================================================================*/
+static struct bg_cache_tag *__not_in_flash_func(InfoNES_BgCacheRow)(int nNameTable, int nY, int nYBit, int bankOfsBG, struct bg_cache_tag *pOther)
+{
+  /*
+   *  Find ( or claim ) the slot mirroring the name table, then decode
+   *  the requested fine-y row if it has not been seen since the last
+   *  invalidation. nYBit is the fine-y offset 0-7.
+   */
+  BYTE *pbyPage = PPUBANK[nNameTable];
+  struct bg_cache_tag *pSlot = &s_BgCache[0];
+
+  if (pSlot->pbyPage != pbyPage)
+  {
+    pSlot = &s_BgCache[1];
+    if (pSlot->pbyPage != pbyPage)
+    {
+      // Evict the least recently claimed slot that this scanline doesn't use
+      pSlot = &s_BgCache[s_nBgCacheLru];
+      if (pSlot == pOther)
+        pSlot = &s_BgCache[s_nBgCacheLru ^ 1];
+      s_nBgCacheLru = (pSlot - s_BgCache) ^ 1;
+      pSlot->pbyPage = pbyPage;
+      InfoNES_MemorySet(pSlot->byValid, 0, sizeof pSlot->byValid);
+    }
+  }
+
+  BYTE byValid = pSlot->byValid[nY];
+  if (byValid & (1 << nYBit))
+    return pSlot;
+
+  const BYTE *pbyNameTable = pbyPage + (nY << 5);
+
+  if (!byValid)
+  {
+    // Palette of each tile from the attribute table
+    const BYTE *pAttrBase = pbyPage + 0x3c0 + ((nY >> 2) << 3);
+    const int nY4 = (nY & 2) << 1;
+    BYTE *pbyPal = pSlot->byPal[nY];
+    for (int nX = 0; nX < 32; ++nX)
+      pbyPal[nX] = ((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2;
   }
+
+  WORD *pwPat = pSlot->wPat[nY][nYBit];
+  for (int nX = 0; nX < 32; ++nX)
+  {
+    const int ch = pbyNameTable[nX];
+    const BYTE *data = PPUBANK[(ch >> 6) + bankOfsBG] + ((ch & 63) << 4) + nYBit;
+
+    // Interleave the two bit planes: pixel n ends up in bits 15-2n, 14-2n
+    DWORD pl0 = data[0];
+    DWORD pl1 = data[8];
+    pl0 = (pl0 | (pl0 << 4)) & 0x0f0f;
+    pl0 = (pl0 | (pl0 << 2)) & 0x3333;
+    pl0 = (pl0 | (pl0 << 1)) & 0x5555;
+    pl1 = (pl1 | (pl1 << 4)) & 0x0f0f;
+    pl1 = (pl1 | (pl1 << 2)) & 0x3333;
+    pl1 = (pl1 | (pl1 << 1)) & 0x5555;
+    pwPat[nX] = pl0 | (pl1 << 1);
+  }
+
+  pSlot->byValid[nY] = byValid | (1 << nYBit);
+  return pSlot;
 }
 
 /*===================================================================*/
@@ -905,7 +1116,7 @@ void __not_in_flash_func(InfoNES_DrawLine)()
   int nYBit;
   WORD *pPalTbl;
   BYTE *pAttrBase;
-  WORD *pPoint;
+  BYTE *pPoint;
   int nNameTable;
   BYTE *pbyNameTable;
   BYTE *pbyChrData;
@@ -916,6 +1127,7 @@ void __not_in_flash_func(InfoNES_DrawLine)()
   int nSprData;
   BYTE bySprCol;
   BYTE pSprBuf[NES_DISP_WIDTH + 7];
+  BYTE pBgOpaque[NES_DISP_WIDTH / 8 + 1];
 
   /*-------------------------------------------------------------------*/
   /*  Render Background                                                */
@@ -932,7 +1144,8 @@ void __not_in_flash_func(InfoNES_DrawLine)()
   // Clear a scanline if screen is off
   if (!(PPU_R1 & R1_SHOW_SCR))
   {
-    InfoNES_MemorySet(pPoint, 0, NES_DISP_WIDTH << 1);
+    InfoNES_MemorySet(pPoint, 0, NES_DISP_WIDTH);
+    InfoNES_MemorySet(pBgOpaque, 0xff, sizeof pBgOpaque);
   }
   else
   {
@@ -997,6 +1210,7 @@ void __not_in_flash_func(InfoNES_DrawLine)()
       const auto pl1 = data[8];
       const auto pat0 = (pl0 & 0x55) | ((pl1 << 1) & 0xaa);
       const auto pat1 = ((pl0 >> 1) & 0x55) | (pl1 & 0xaa);
+      pBgOpaque[0] = pl0 | pl1;
       switch (PPU_Scr_H_Bit)
       {
       case 0:
@@ -1025,65 +1239,59 @@ void __not_in_flash_func(InfoNES_DrawLine)()
     MapperPPU(PATTBL(pbyChrData));
 
     ++nX;
-    ++pbyNameTable;
+
+    /*-------------------------------------------------------------------*/
+    /*  Look up the tile-row cache                                       */
+    /*-------------------------------------------------------------------*/
+
+    // The callback above may latch new banks ( MMC2/MMC4 ), so take the
+    // pattern table signature only now
+    if (s_pbyBgCacheChr[0] != PPUBANK[bankOfsBG + 0] || s_pbyBgCacheChr[1] != PPUBANK[bankOfsBG + 1] ||
+        s_pbyBgCacheChr[2] != PPUBANK[bankOfsBG + 2] || s_pbyBgCacheChr[3] != PPUBANK[bankOfsBG + 3])
+    {
+      InfoNES_BgCacheFlush();
+      s_pbyBgCacheChr[0] = PPUBANK[bankOfsBG + 0];
+      s_pbyBgCacheChr[1] = PPUBANK[bankOfsBG + 1];
+      s_pbyBgCacheChr[2] = PPUBANK[bankOfsBG + 2];
+      s_pbyBgCacheChr[3] = PPUBANK[bankOfsBG + 3];
+    }
+
+    struct bg_cache_tag *pLeft = InfoNES_BgCacheRow(nNameTable, nY, yOfsModBG, bankOfsBG, NULL);
+    struct bg_cache_tag *pRight = InfoNES_BgCacheRow(nNameTable ^ NAME_TABLE_H_MASK, nY, yOfsModBG, bankOfsBG, pLeft);
 
     /*-------------------------------------------------------------------*/
     /*  Rendering of the left table                                      */
     /*-------------------------------------------------------------------*/
 
-    auto putBG = [&](int nX) __attribute__((always_inline))
+    BYTE *pOpaque = pBgOpaque + 1;
+
+    auto putBG = [&](const struct bg_cache_tag *pSlot, int nX) __attribute__((always_inline))
     {
-      const auto pal = &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2)];
-      const auto palAddr = reinterpret_cast<uintptr_t>(pal);
-      const int ch = *pbyNameTable;
-      const int bank = (ch >> 6) + bankOfsBG;
-      const int addrOfs = ((ch & 63) << 4) + yOfsModBG;
-      const auto data = PPUBANK[bank] + addrOfs;
-      const auto pl0 = data[0];
-      const auto pl1 = data[8];
-      // const auto pat0 = (pl0 & 0x55) | ((pl1 << 1) & 0xaa);
-      // const auto pat1 = ((pl0 >> 1) & 0x55) | (pl1 & 0xaa);
-      const auto pat0 = ((pl0 & 0x55) << 1) | ((pl1 & 0x55) << 2);
-      const auto pat1 = ((pl0 & 0xaa) << 0) | ((pl1 & 0xaa) << 1);
+      const auto palAddr = reinterpret_cast<uintptr_t>(&PalTable[pSlot->byPal[nY][nX]]);
+      const unsigned pat = pSlot->wPat[nY][yOfsModBG][nX];
+      *pOpaque++ = patOpaque(pat);
 
       auto readPal = [&](int ofs)
       {
         return *reinterpret_cast<const WORD *>(palAddr + ofs);
       };
-      pPoint[0] = readPal((pat1 >> 6) & 6);
-      pPoint[1] = readPal((pat0 >> 6) & 6);
-      pPoint[2] = readPal((pat1 >> 4) & 6);
-      pPoint[3] = readPal((pat0 >> 4) & 6);
-      pPoint[4] = readPal((pat1 >> 2) & 6);
-      pPoint[5] = readPal((pat0 >> 2) & 6);
-      pPoint[6] = readPal((pat1 >> 0) & 6);
-      pPoint[7] = readPal((pat0 >> 0) & 6);
+      pPoint[0] = readPal((pat >> 13) & 6);
+      pPoint[1] = readPal((pat >> 11) & 6);
+      pPoint[2] = readPal((pat >> 9) & 6);
+      pPoint[3] = readPal((pat >> 7) & 6);
+      pPoint[4] = readPal((pat >> 5) & 6);
+      pPoint[5] = readPal((pat >> 3) & 6);
+      pPoint[6] = readPal((pat >> 1) & 6);
+      pPoint[7] = readPal((pat << 1) & 6);
       pPoint += 8;
     };
 
+    // Every tile of a scanline reports the same address to MapperPPU(),
+    // and all mapper callbacks are idempotent for a repeated address, so
+    // the call after the left end block stands for the whole row
     for (; nX < 32; ++nX)
     {
-#if 0
-      pbyChrData = PPU_BG_Base + (*pbyNameTable << 6) + nYBit;
-      pPalTbl = &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2)];
-
-      pPoint[0] = pPalTbl[pbyChrData[0]];
-      pPoint[1] = pPalTbl[pbyChrData[1]];
-      pPoint[2] = pPalTbl[pbyChrData[2]];
-      pPoint[3] = pPalTbl[pbyChrData[3]];
-      pPoint[4] = pPalTbl[pbyChrData[4]];
-      pPoint[5] = pPalTbl[pbyChrData[5]];
-      pPoint[6] = pPalTbl[pbyChrData[6]];
-      pPoint[7] = pPalTbl[pbyChrData[7]];
-      pPoint += 8;
-#else
-      putBG(nX);
-#endif
-
-      // Callback at PPU read/write
-      MapperPPU(PATTBL(pbyChrData));
-
-      ++pbyNameTable;
+      putBG(pLeft, nX);
     }
 
     // Holizontal Mirror
@@ -1098,28 +1306,9 @@ void __not_in_flash_func(InfoNES_DrawLine)()
 
     for (nX = 0; nX < PPU_Scr_H_Byte; ++nX)
     {
-#if 0
-      pbyChrData = PPU_BG_Base + (*pbyNameTable << 6) + nYBit;
-      pPalTbl = &PalTable[(((pAttrBase[nX >> 2] >> ((nX & 2) + nY4)) & 3) << 2)];
-
-      pPoint[0] = pPalTbl[pbyChrData[0]];
-      pPoint[1] = pPalTbl[pbyChrData[1]];
-      pPoint[2] = pPalTbl[pbyChrData[2]];
-      pPoint[3] = pPalTbl[pbyChrData[3]];
-      pPoint[4] = pPalTbl[pbyChrData[4]];
-      pPoint[5] = pPalTbl[pbyChrData[5]];
-      pPoint[6] = pPalTbl[pbyChrData[6]];
-      pPoint[7] = pPalTbl[pbyChrData[7]];
-      pPoint += 8;
-#else
-      putBG(nX);
-#endif
-
-      // Callback at PPU read/write
-      MapperPPU(PATTBL(pbyChrData));
-
-      ++pbyNameTable;
+      putBG(pRight, nX);
     }
+    pbyNameTable += nX;
 
     /*-------------------------------------------------------------------*/
     /*  Rendering of the block of the right end                          */
@@ -1143,6 +1332,7 @@ void __not_in_flash_func(InfoNES_DrawLine)()
       const auto pl1 = data[8];
       const auto pat0 = (pl0 & 0x55) | ((pl1 << 1) & 0xaa);
       const auto pat1 = ((pl0 >> 1) & 0x55) | (pl1 & 0xaa);
+      *pOpaque = pl0 | pl1;
       //      const auto [pat0, pat1] = getPatBG(ch);
       switch (PPU_Scr_H_Bit)
       {
@@ -1178,11 +1368,13 @@ void __not_in_flash_func(InfoNES_DrawLine)()
     /*-------------------------------------------------------------------*/
     if (!(PPU_R1 & R1_CLIP_BG))
     {
-      WORD *pPointTop;
+      BYTE *pPointTop;
 
       // pPointTop = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
       pPointTop = WorkLine;
-      InfoNES_MemorySet(pPointTop, 0, 8 << 1);
+      InfoNES_MemorySet(pPointTop, 0, 8);
+      pBgOpaque[0] |= 0xff >> PPU_Scr_H_Bit;
+      pBgOpaque[1] |= 0xff00 >> PPU_Scr_H_Bit;
     }
 
     /*-------------------------------------------------------------------*/
@@ -1191,11 +1383,12 @@ void __not_in_flash_func(InfoNES_DrawLine)()
     if (PPU_UpDown_Clip &&
         (SCAN_ON_SCREEN_START > PPU_Scanline || PPU_Scanline > SCAN_BOTTOM_OFF_SCREEN_START))
     {
-      WORD *pPointTop;
+      BYTE *pPointTop;
 
       // pPointTop = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
       pPointTop = WorkLine;
-      InfoNES_MemorySet(pPointTop, 0, NES_DISP_WIDTH << 1);
+      InfoNES_MemorySet(pPointTop, 0, NES_DISP_WIDTH);
+      InfoNES_MemorySet(pBgOpaque, 0xff, sizeof pBgOpaque);
     }
   }
 
@@ -1410,52 +1603,18 @@ void __not_in_flash_func(InfoNES_DrawLine)()
     pPoint = WorkLine;
     //   pPoint -= (NES_DISP_WIDTH - PPU_Scr_H_Bit);
 
-#if 1
-    compositeSprite(PalTable + 0x10, pSprBuf, pPoint);
-#else
-    {
-      const auto *pal = &PalTable[0x10];
-      const auto *spr = pSprBuf;
-      const auto *sprEnd = spr + NES_DISP_WIDTH;
-      // for (nX = 0; nX < NES_DISP_WIDTH; ++nX)
-      while (spr != sprEnd)
-      {
-        // nSprData = pSprBuf[nX];
-        auto proc = [=](int i) __attribute__((always_inline))
-        {
-          int v = spr[i];
-          if (v && ((v >> 7) || (pPoint[i] >> 15)))
-          {
-            pPoint[i] = pal[v & 0xf];
-          }
-        };
-
-#if 1
-        proc(0);
-        proc(1);
-        proc(2);
-        proc(3);
-        pPoint += 4;
-        spr += 4;
-#else
-        proc(0);
-        pPoint += 1;
-        spr += 1;
-#endif
-      }
-    }
-#endif
+    compositeSprite(PalTable + 0x10, pSprBuf, pPoint, pBgOpaque, PPU_Scr_H_Bit);
 
     /*-------------------------------------------------------------------*/
     /*  Sprite Clipping                                                  */
     /*-------------------------------------------------------------------*/
     if (!(PPU_R1 & R1_CLIP_SP))
     {
-      WORD *pPointTop;
+      BYTE *pPointTop;
 
       // pPointTop = &WorkFrame[PPU_Scanline * NES_DISP_WIDTH];
       pPointTop = WorkLine;
-      InfoNES_MemorySet(pPointTop, 0, 8 << 1);
+      InfoNES_MemorySet(pPointTop, 0, 8);
     }
 
     if (nSprCnt >= 8)
@@ -1656,284 +1815,63 @@ void __not_in_flash_func(InfoNES_SetupChr)()
 #endif
 }
 
-#include "InfoNES.h"
-#include "InfoNES_Mapper.h"
-#include "InfoNES_pAPU.h"
-extern BYTE SP; extern BYTE F; extern BYTE A; extern BYTE X; extern BYTE Y;
-
-extern BYTE IRQ_Wiring;
-extern BYTE NMI_Wiring;
-extern WORD g_wPassedClocks;
-extern BYTE g_byTestTable[ 256 ];
-
-extern struct value_table_tag g_ASLTable[ 256 ];
-extern struct value_table_tag g_LSRTable[ 256 ];
-extern struct value_table_tag g_ROLTable[ 2 ][ 256 ];
-extern struct value_table_tag g_RORTable[ 2 ][ 256 ];
-
-extern DWORD Map1_bank1;
-extern DWORD Map1_bank2;
-extern DWORD Map1_bank3;
-extern DWORD Map1_bank4;
-extern BYTE  Map1_Regs[ 4 ];
-extern DWORD Map1_Cnt;
-extern BYTE  Map1_Latch;
-extern WORD  Map1_Last_Write_Addr;
-extern DWORD Map1_HI1;
-extern DWORD Map1_HI2;
-
-extern DWORD Map1_256K_base;
-extern DWORD Map1_swap;
-
-extern BYTE  Map4_Regs[ 8 ];
-extern DWORD Map4_Rom_Bank;
-extern DWORD Map4_Prg0, Map4_Prg1;
-extern DWORD Map4_Chr01, Map4_Chr23;
-extern DWORD Map4_Chr4, Map4_Chr5, Map4_Chr6, Map4_Chr7;
-
-extern BYTE Map4_IRQ_Enable;
-extern BYTE Map4_IRQ_Cnt;
-extern BYTE Map4_IRQ_Latch;
-extern BYTE Map4_IRQ_Request;
-extern BYTE Map4_IRQ_Present;
-extern BYTE Map4_IRQ_Present_Vbl;
+#include "InfoNES_State.h"
 #include "ff.h"
 static FATFS fs;
-char* replaceSpecialCharacters(const char* str) {
-    int length = strlen(str);
-    char* newStr = static_cast<char *>(malloc(length + 1)); // Add space for the null terminator
-    int i;
-
-    for (i = 0; i < length; i++) {
-        if (isalpha(str[i]) || isdigit(str[i])) {
-            newStr[i] = str[i];
-        } else {
-            newStr[i] = '_';
-        }
-    }
 
-    newStr[length] = '\0'; // Add null terminator
+// NES\<rom>.save, with whatever is not a letter or digit as '_'
+static void state_pathname(char *pathname, size_t size, const char *rom_filename)
+{
+    char name[128];
+    size_t i;
+
+    for (i = 0; rom_filename[i] && i < sizeof(name) - 1; i++)
+        name[i] = isalnum((unsigned char)rom_filename[i]) ? rom_filename[i] : '_';
+    name[i] = '\0';
 
-    return newStr;
+    snprintf(pathname, size, "%s\\%s.save", "NES", name);
 }
+
 void save_state(const char * rom_filename)
 {
     char pathname[255];
-    sprintf(pathname, "%s\\%s.save", "NES", replaceSpecialCharacters(rom_filename));
-    FRESULT fr = f_mount(&fs, "", 1);
+    state_pathname(pathname, sizeof pathname, rom_filename);
+
+    // The state is built in RAM and goes out in one write
+    DWORD size = InfoNES_StateSize();
+    BYTE *state = static_cast<BYTE *>(malloc(size));
+    if (!state)
+        return;
+    size = InfoNES_SaveState(state, size);
+
     FIL fd;
-    fr = f_open(&fd, pathname, FA_CREATE_ALWAYS | FA_WRITE);
     UINT bw;
-
-    f_write(&fd, &PC, 2, &bw);
-    f_write(&fd, &SP, 1, &bw);
-    f_write(&fd, &F, 1, &bw);
-    f_write(&fd, &A, 1, &bw);
-    f_write(&fd, &X, 1, &bw);
-    f_write(&fd, &Y, 1, &bw);
-    f_write(&fd, RAM, RAM_SIZE, &bw);
-    f_write(&fd, SRAM, SRAM_SIZE, &bw);
-    f_write(&fd, PPURAM, PPURAM_SIZE, &bw);
-    f_write(&fd, SPRRAM, SPRRAM_SIZE, &bw);
-    f_write(&fd, *PPUBANK, 16 * sizeof(*PPUBANK), &bw);
-    f_write(&fd, ChrBuf, 256 * 2 * 8 * 8 , &bw);
-    f_write(&fd, &ROMBANK0, 4, &bw);
-    f_write(&fd, &ROMBANK1, 4, &bw);
-    f_write(&fd, &ROMBANK2, 4, &bw);
-    f_write(&fd, &ROMBANK3, 4, &bw);
-    f_write(&fd, &IRQ_Wiring, 1, &bw);
-    f_write(&fd, &NMI_Wiring, 1, &bw);
-    f_write(&fd, &g_wPassedClocks, 2, &bw);
-    f_write(&fd, g_byTestTable, 256, &bw);
-    f_write(&fd, g_ASLTable, 256 * 2, &bw);
-    f_write(&fd, g_LSRTable, 256 * 2, &bw);
-    f_write(&fd, g_ROLTable, 256 * 2 * 2, &bw);
-    f_write(&fd, g_RORTable, 256 * 2 * 2, &bw);
-
-    f_write(&fd, &PPU_R1, 1, &bw);
-    f_write(&fd, &PPU_R2, 1, &bw);
-    f_write(&fd, &PPU_R3, 1, &bw);
-    f_write(&fd, &PPU_R7, 1, &bw);
-
-    f_write(&fd, &PPU_Addr, 2, &bw);
-    f_write(&fd, &PPU_Temp, 2, &bw);
-    f_write(&fd, &PPU_Increment, 2, &bw);
-
-    f_write(&fd, PalTable, 32 * 2, &bw);
-
-
-    f_write(&fd, &PPU_Scr_H_Byte, 1, &bw);
-    f_write(&fd, &PPU_Scr_H_Bit, 1, &bw);
-
-    f_write(&fd, PPU_ScanTable, 263, &bw);
-    f_write(&fd, &PPU_NameTableBank, 1, &bw);
-    f_write(&fd, &PPU_Latch_Flag, 1, &bw);
-
-    f_write(&fd, &IRQ_State, 1, &bw);
-    f_write(&fd, &IRQ_Wiring, 1, &bw);
-    f_write(&fd, &NMI_State, 1, &bw);
-    f_write(&fd, &NMI_Wiring, 1, &bw);
-
-    f_write(&fd, APU_Reg, 0x18, &bw);
-    f_write(&fd, &ChrBufUpdate, 1, &bw);
-
-    f_write(&fd, &PPU_UpDown_Clip, 1, &bw);
-    f_write(&fd, &FrameIRQ_Enable, 1, &bw);
-    f_write(&fd, &FrameStep, 2, &bw);
-
-    f_write(&fd, &byVramWriteEnable, 1, &bw);
-    f_write(&fd, &SpriteJustHit, 4, &bw);
-
-    f_write(&fd, &FrameCnt, 2, &bw);
-
-    if(MapperNo == 1)
+    if (size && f_mount(&fs, "", 1) == FR_OK && f_open(&fd, pathname, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK)
     {
-        f_write(&fd, &Map1_bank1, 4, &bw);
-        f_write(&fd, &Map1_bank2, 4, &bw);
-        f_write(&fd, &Map1_bank3, 4, &bw);
-        f_write(&fd, &Map1_bank4, 4, &bw);
-        f_write(&fd, Map1_Regs, 4, &bw);
-
-        f_write(&fd, &Map1_Cnt, 4, &bw);
-        f_write(&fd, &Map1_Latch, 1, &bw);
-        f_write(&fd, &Map1_Last_Write_Addr, 2, &bw);
-        f_write(&fd, &Map1_HI1, 4, &bw);
-        f_write(&fd, &Map1_HI2, 4, &bw);
-        f_write(&fd, &Map1_256K_base, 4, &bw);
-        f_write(&fd, &Map1_swap, 4, &bw);
+        f_write(&fd, state, size, &bw);
+        f_close(&fd);
     }
-    if(MapperNo == 4)
-    {
-        f_write(&fd, Map4_Regs, 8, &bw);
-        f_write(&fd, &Map4_Rom_Bank, 4, &bw);
-        f_write(&fd, &Map4_Prg0, 4, &bw);
-        f_write(&fd, &Map4_Prg1, 4, &bw);
-        f_write(&fd, &Map4_Chr01, 4, &bw);
-        f_write(&fd, &Map4_Chr23, 4, &bw);
-        f_write(&fd, &Map4_Chr4, 4, &bw);
-        f_write(&fd, &Map4_Chr5, 4, &bw);
-        f_write(&fd, &Map4_Chr6, 4, &bw);
-        f_write(&fd, &Map4_Chr7, 4, &bw);
-
-        f_write(&fd, &Map4_IRQ_Enable, 1, &bw);
-        f_write(&fd, &Map4_IRQ_Cnt, 1, &bw);
-        f_write(&fd, &Map4_IRQ_Latch, 1, &bw);
-        f_write(&fd, &Map4_IRQ_Request, 1, &bw);
-        f_write(&fd, &Map4_IRQ_Present, 1, &bw);
-        f_write(&fd, &Map4_IRQ_Present_Vbl, 1, &bw);
-    }
-
-    f_close(&fd);
-
-    return;
+    free(state);
 }
 
 void load_state(const char * rom_filename)
 {
     char pathname[255];
-    sprintf(pathname, "%s\\%s.save", "NES", replaceSpecialCharacters(rom_filename));
-    FRESULT fr = f_mount(&fs, "", 1);
+    state_pathname(pathname, sizeof pathname, rom_filename);
+
     FIL fd;
-    fr = f_open(&fd, pathname, FA_READ);
     UINT br;
+    if (f_mount(&fs, "", 1) != FR_OK || f_open(&fd, pathname, FA_READ) != FR_OK)
+        return;
 
-    f_read(&fd, &PC, 2, &br);
-    f_read(&fd, &SP, 1, &br);
-    f_read(&fd, &F, 1, &br);
-    f_read(&fd, &A, 1, &br);
-    f_read(&fd, &X, 1, &br);
-    f_read(&fd, &Y, 1, &br);
-    f_read(&fd, RAM, RAM_SIZE, &br);
-    f_read(&fd, SRAM, SRAM_SIZE, &br);
-    f_read(&fd, PPURAM, PPURAM_SIZE, &br);
-    f_read(&fd, SPRRAM, SPRRAM_SIZE, &br);
-    f_read(&fd, *PPUBANK, 16 * sizeof(*PPUBANK), &br);
-    f_read(&fd, ChrBuf, 256 * 2 * 8 * 8 , &br);
-    f_read(&fd, &ROMBANK0, 4, &br);
-    f_read(&fd, &ROMBANK1, 4, &br);
-    f_read(&fd, &ROMBANK2, 4, &br);
-    f_read(&fd, &ROMBANK3, 4, &br);
-    f_read(&fd, &IRQ_Wiring, 1, &br);
-    f_read(&fd, &NMI_Wiring, 1, &br);
-    f_read(&fd, &g_wPassedClocks, 2, &br);
-    f_read(&fd, g_byTestTable, 256, &br);
-    f_read(&fd, g_ASLTable, 256 * 2, &br);
-    f_read(&fd, g_LSRTable, 256 * 2, &br);
-    f_read(&fd, g_ROLTable, 256 * 2 * 2, &br);
-    f_read(&fd, g_RORTable, 256 * 2 * 2, &br);
-
-    f_read(&fd, &PPU_R1, 1, &br);
-    f_read(&fd, &PPU_R2, 1, &br);
-    f_read(&fd, &PPU_R3, 1, &br);
-    f_read(&fd, &PPU_R7, 1, &br);
-
-    f_read(&fd, &PPU_Addr, 2, &br);
-    f_read(&fd, &PPU_Temp, 2, &br);
-    f_read(&fd, &PPU_Increment, 2, &br);
-
-    f_read(&fd, PalTable, 32 * 2, &br);
-
-    f_read(&fd, &PPU_Scr_H_Byte, 1, &br);
-    f_read(&fd, &PPU_Scr_H_Bit, 1, &br);
-
-    f_read(&fd, PPU_ScanTable, 263, &br);
-    f_read(&fd, &PPU_NameTableBank, 1, &br);
-    f_read(&fd, &PPU_Latch_Flag, 1, &br);
-
-    f_read(&fd, &IRQ_State, 1, &br);
-    f_read(&fd, &IRQ_Wiring, 1, &br);
-    f_read(&fd, &NMI_State, 1, &br);
-    f_read(&fd, &NMI_Wiring, 1, &br);
-
-    f_read(&fd, APU_Reg, 0x18, &br);
-    f_read(&fd, &ChrBufUpdate, 1, &br);
-
-    f_read(&fd, &PPU_UpDown_Clip, 1, &br);
-    f_read(&fd, &FrameIRQ_Enable, 1, &br);
-    f_read(&fd, &FrameStep, 2, &br);
-
-    f_read(&fd, &byVramWriteEnable, 1, &br);
-    f_read(&fd, &SpriteJustHit, 4, &br);
-
-    f_read(&fd, &FrameCnt, 2, &br);
-
-
-    if(MapperNo == 1)
+    // A state of this game is exactly this size; anything else is rejected
+    DWORD size = InfoNES_StateSize();
+    BYTE *state = static_cast<BYTE *>(malloc(size));
+    if (state)
     {
-        f_read(&fd, &Map1_bank1, 4, &br);
-        f_read(&fd, &Map1_bank2, 4, &br);
-        f_read(&fd, &Map1_bank3, 4, &br);
-        f_read(&fd, &Map1_bank4, 4, &br);
-        f_read(&fd, Map1_Regs, 4, &br);
-
-        f_read(&fd, &Map1_Cnt, 4, &br);
-        f_read(&fd, &Map1_Latch, 1, &br);
-        f_read(&fd, &Map1_Last_Write_Addr, 2, &br);
-        f_read(&fd, &Map1_HI1, 4, &br);
-        f_read(&fd, &Map1_HI2, 4, &br);
-        f_read(&fd, &Map1_256K_base, 4, &br);
-        f_read(&fd, &Map1_swap, 4, &br);
-    }
-
-    if(MapperNo == 4)
-    {
-        f_read(&fd, Map4_Regs, 8, &br);
-        f_read(&fd, &Map4_Rom_Bank, 4, &br);
-        f_read(&fd, &Map4_Prg0, 4, &br);
-        f_read(&fd, &Map4_Prg1, 4, &br);
-        f_read(&fd, &Map4_Chr01, 4, &br);
-        f_read(&fd, &Map4_Chr23, 4, &br);
-        f_read(&fd, &Map4_Chr4, 4, &br);
-        f_read(&fd, &Map4_Chr5, 4, &br);
-        f_read(&fd, &Map4_Chr6, 4, &br);
-        f_read(&fd, &Map4_Chr7, 4, &br);
-
-        f_read(&fd, &Map4_IRQ_Enable, 1, &br);
-        f_read(&fd, &Map4_IRQ_Cnt, 1, &br);
-        f_read(&fd, &Map4_IRQ_Latch, 1, &br);
-        f_read(&fd, &Map4_IRQ_Request, 1, &br);
-        f_read(&fd, &Map4_IRQ_Present, 1, &br);
-        f_read(&fd, &Map4_IRQ_Present_Vbl, 1, &br);
+        f_read(&fd, state, size, &br);
+        InfoNES_LoadState(state, br);
+        free(state);
     }
     f_close(&fd);
-}
\ No newline at end of file
+}
@@ -296,6 +296,22 @@ extern BYTE ROM_SRAM;
 extern BYTE ROM_Trainer;
 extern BYTE ROM_FourScr;
 
+/* Cartridge information from a ROM database, in place of the header */
+struct RomInfo_tag
+{
+  BYTE byKnown;     /* 0 : InfoNES_Reset() reads the header */
+  BYTE byMirroring; /* 0:Horizontal 1:Vertical 2:Four screen */
+  WORD wMapperNo;
+  BYTE byBattery;   /* SRAM is saved */
+  DWORD dwQuirks;
+};
+
+/* RomInfo_tag::dwQuirks */
+#define ROMINFO_NO_IDLE_SKIP 0x1 /* Run idle loops instruction by instruction */
+
+/* Set by InfoNES_ReadRom(), cleared by InfoNES_ReleaseRom() */
+extern struct RomInfo_tag RomInfo;
+
 /*-------------------------------------------------------------------*/
 /*  Function prototypes                                              */
 /*-------------------------------------------------------------------*/
@@ -338,7 +354,13 @@ void InfoNES_GetSprHitY();
 /* Develop character data */
 void InfoNES_SetupChr();
 
-void InfoNES_SetLineBuffer(WORD *p, WORD size);
+/* Background tile-row cache */
+void InfoNES_BgCacheFlush();
+void InfoNES_BgCacheWriteNT(WORD wAddr);
+void InfoNES_BgCacheWriteChr(BYTE *pbyBank);
+void InfoNES_BgCacheForget(BYTE *pbyBank);
+
+void InfoNES_SetLineBuffer(BYTE *p, WORD size);
 
 void *InfoNes_GetRAM(size_t *size);
 
@@ -13,6 +13,8 @@
 #include "InfoNES.h"
 #include "InfoNES_Mapper.h"
 #include "K6502.h"
+#include "InfoNES_System.h"
+#include "InfoNES_pAPU.h"
 #include <pico.h>
 
 /*-------------------------------------------------------------------*/
@@ -23,154 +25,197 @@
 BYTE DRAM[DRAM_SIZE];
 
 /*-------------------------------------------------------------------*/
-/*  Table of Mapper initialize function                              */
+/*  Table of Mapper descriptors                                      */
 /*-------------------------------------------------------------------*/
 
-struct MapperTable_tag MapperTable[] =
+/* One line per supported mapper, by number */
+struct MapperList_tag
+{
+  int nMapperNo;
+  struct MapperDesc_tag Desc;
+};
+
+static constexpr struct MapperList_tag MapperList[] =
+    {
+        {0, {Map0_Init, "NROM", MAPPER_IRQ_NONE, NULL}},
+        {1, {Map1_Init, "MMC1", MAPPER_IRQ_NONE, Map1_State}},
+        {2, {Map2_Init, "UNROM", MAPPER_IRQ_NONE, NULL}},
+        {3, {Map3_Init, "CNROM", MAPPER_IRQ_NONE, NULL}},
+        {4, {Map4_Init, "MMC3", MAPPER_IRQ_SCANLINE, Map4_State}},
+        //{5, {Map5_Init, "MMC5", MAPPER_IRQ_SCANLINE | MAPPER_EXT_AUDIO, NULL}},
+        //{6, {Map6_Init, "FFE F4xxx", MAPPER_IRQ_SCANLINE, NULL}},
+        {7, {Map7_Init, "AOROM", MAPPER_IRQ_NONE, NULL}},
+        {8, {Map8_Init, "FFE F3xxx", MAPPER_IRQ_NONE, NULL}},
+        {9, {Map9_Init, "MMC2", MAPPER_PPU, Map9_State}},
+        {10, {Map10_Init, "MMC4", MAPPER_PPU, Map10_State}},
+        {11, {Map11_Init, "Color Dreams", MAPPER_IRQ_NONE, NULL}},
+        {13, {Map13_Init, "CPROM", MAPPER_IRQ_NONE, NULL}},
+        {15, {Map15_Init, "100-in-1", MAPPER_IRQ_NONE, NULL}},
+        {16, {Map16_Init, "Bandai", MAPPER_IRQ_CYCLE, Map16_State}},
+        {17, {Map17_Init, "FFE F8xxx", MAPPER_IRQ_CYCLE, Map17_State}},
+        {18, {Map18_Init, "Jaleco SS8806", MAPPER_IRQ_CYCLE, Map18_State}},
+        {19, {Map19_Init, "Namcot 106", MAPPER_IRQ_CYCLE | MAPPER_EXT_AUDIO, Map19_State}},
+        {21, {Map21_Init, "Konami VRC4 2A", MAPPER_IRQ_SCANLINE, Map21_State}},
+        {22, {Map22_Init, "Konami VRC2 type A", MAPPER_IRQ_NONE, NULL}},
+        {23, {Map23_Init, "Konami VRC2 type B", MAPPER_IRQ_NONE, Map23_State}},
+        {24, {Map24_Init, "Konami VRC6", MAPPER_IRQ_SCANLINE | MAPPER_EXT_AUDIO, Map24_State}},
+        {25, {Map25_Init, "Konami VRC4 type B", MAPPER_IRQ_SCANLINE, Map25_State}},
+        {26, {Map26_Init, "Konami VRC6V", MAPPER_IRQ_SCANLINE | MAPPER_EXT_AUDIO, Map26_State}},
+        {32, {Map32_Init, "Irem G-101", MAPPER_IRQ_NONE, Map32_State}},
+        {33, {Map33_Init, "Taito TC0190/TC0350", MAPPER_IRQ_NONE, Map33_State}},
+        {34, {Map34_Init, "Nina-1", MAPPER_IRQ_NONE, NULL}},
+        {40, {Map40_Init, "SMB2J", MAPPER_IRQ_SCANLINE, Map40_State}},
+        {41, {Map41_Init, "", MAPPER_IRQ_NONE, Map41_State}},
+        {42, {Map42_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map42_State}},
+        {43, {Map43_Init, "SMB2J", MAPPER_IRQ_CYCLE, Map43_State}},
+        {44, {Map44_Init, "Nin1", MAPPER_IRQ_SCANLINE, Map44_State}},
+        {45, {Map45_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map45_State}},
+        {46, {Map46_Init, "Color Dreams", MAPPER_IRQ_NONE, Map46_State}},
+        {47, {Map47_Init, "MMC", MAPPER_IRQ_SCANLINE, Map47_State}},
+        {48, {Map48_Init, "Taito TC0190V", MAPPER_IRQ_SCANLINE, Map48_State}},
+        {49, {Map49_Init, "Nin1", MAPPER_IRQ_SCANLINE, Map49_State}},
+        {50, {Map50_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map50_State}},
+        {51, {Map51_Init, "11-in-1", MAPPER_IRQ_NONE, Map51_State}},
+        {57, {Map57_Init, "", MAPPER_IRQ_NONE, Map57_State}},
+        {58, {Map58_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {60, {Map60_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {61, {Map61_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {62, {Map62_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {64, {Map64_Init, "Tengen RAMBO-1", MAPPER_IRQ_NONE, Map64_State}},
+        {65, {Map65_Init, "Irem H3001", MAPPER_IRQ_CYCLE, Map65_State}},
+        {66, {Map66_Init, "GNROM", MAPPER_IRQ_NONE, NULL}},
+        {67, {Map67_Init, "Sunsoft Mapper #3", MAPPER_IRQ_SCANLINE, Map67_State}},
+        {68, {Map68_Init, "Sunsoft Mapper #4", MAPPER_IRQ_NONE, Map68_State}},
+        {69, {Map69_Init, "Sunsoft FME-7", MAPPER_IRQ_CYCLE | MAPPER_EXT_AUDIO, Map69_State}},
+        {70, {Map70_Init, "74161/32 Bandai", MAPPER_IRQ_NONE, NULL}},
+        {71, {Map71_Init, "Camerica", MAPPER_IRQ_NONE, NULL}},
+        {72, {Map72_Init, "Jaleco Early Mapper #0", MAPPER_IRQ_NONE, NULL}},
+        {73, {Map73_Init, "Konami VRC3", MAPPER_IRQ_CYCLE, Map73_State}},
+        {74, {Map74_Init, "Metal Max", MAPPER_IRQ_SCANLINE, Map74_State}},
+        {75, {Map75_Init, "Konami VRC1 / Jaleco SS8805", MAPPER_IRQ_NONE, Map75_State}},
+        {76, {Map76_Init, "Namcot 109", MAPPER_IRQ_NONE, Map76_State}},
+        {77, {Map77_Init, "Irem Early Mapper #0", MAPPER_IRQ_NONE, NULL}},
+        {78, {Map78_Init, "74161/32 Irem", MAPPER_IRQ_NONE, NULL}},
+        {79, {Map79_Init, "AVE / Sachen", MAPPER_IRQ_NONE, NULL}},
+        {80, {Map80_Init, "Taito X1-005", MAPPER_IRQ_NONE, NULL}},
+        {82, {Map82_Init, "Taito X1-17", MAPPER_IRQ_NONE, Map82_State}},
+        {83, {Map83_Init, "Pirates", MAPPER_IRQ_CYCLE, Map83_State}},
+        //{85, {Map85_Init, "Konami VRC7", MAPPER_IRQ_SCANLINE | MAPPER_EXT_AUDIO, NULL}},
+        {86, {Map86_Init, "Jaleco", MAPPER_IRQ_NONE, NULL}},
+        {87, {Map87_Init, "74161/32", MAPPER_IRQ_NONE, NULL}},
+        {88, {Map88_Init, "Namco 118", MAPPER_IRQ_NONE, Map88_State}},
+        {89, {Map89_Init, "Sunsoft", MAPPER_IRQ_NONE, NULL}},
+        {90, {Map90_Init, "PC-JY-??", MAPPER_IRQ_SCANLINE, Map90_State}},
+        {91, {Map91_Init, "Pirates", MAPPER_IRQ_NONE, NULL}},
+        {92, {Map92_Init, "Jaleco Early Mapper #1", MAPPER_IRQ_NONE, NULL}},
+        {93, {Map93_Init, "74161/32", MAPPER_IRQ_NONE, NULL}},
+        {94, {Map94_Init, "74161/32 Capcom", MAPPER_IRQ_NONE, NULL}},
+        {95, {Map95_Init, "Namco 1??", MAPPER_IRQ_NONE, Map95_State}},
+        {96, {Map96_Init, "Bandai 74161", MAPPER_PPU, Map96_State}},
+        {97, {Map97_Init, "74161/32 Irem", MAPPER_IRQ_NONE, NULL}},
+        {100, {Map100_Init, "Nestile MMC3", MAPPER_IRQ_SCANLINE, Map100_State}},
+        {101, {Map101_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {105, {Map105_Init, "Nintendo World Championship", MAPPER_IRQ_CYCLE, Map105_State}},
+        {107, {Map107_Init, "Magic Dragon", MAPPER_IRQ_NONE, NULL}},
+        {108, {Map108_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {109, {Map109_Init, "Sachen SA-019", MAPPER_IRQ_NONE, Map109_State}},
+        {110, {Map110_Init, "", MAPPER_IRQ_NONE, Map110_State}},
+        {112, {Map112_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map112_State}},
+        {113, {Map113_Init, "PC-Sachen/Hacker", MAPPER_IRQ_NONE, NULL}},
+        {114, {Map114_Init, "PC-SuperGames", MAPPER_IRQ_SCANLINE, Map114_State}},
+        {115, {Map115_Init, "CartSaint", MAPPER_IRQ_SCANLINE, Map115_State}},
+        {116, {Map116_Init, "CartSaint", MAPPER_IRQ_SCANLINE, Map116_State}},
+        {117, {Map117_Init, "PC-Future", MAPPER_IRQ_SCANLINE, Map117_State}},
+        {118, {Map118_Init, "Others", MAPPER_IRQ_SCANLINE, Map118_State}},
+        {119, {Map119_Init, "TQROM", MAPPER_IRQ_SCANLINE, Map119_State}},
+        {122, {Map122_Init, "Sunsoft", MAPPER_IRQ_NONE, NULL}},
+        {133, {Map133_Init, "Sachen", MAPPER_IRQ_NONE, NULL}},
+        {134, {Map134_Init, "", MAPPER_IRQ_NONE, Map134_State}},
+        {135, {Map135_Init, "Sachen", MAPPER_IRQ_NONE, Map135_State}},
+        {140, {Map140_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {151, {Map151_Init, "VS Unisystem", MAPPER_IRQ_NONE, NULL}},
+        {160, {Map160_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map160_State}},
+        {180, {Map180_Init, "Nichibutsu", MAPPER_IRQ_NONE, NULL}},
+        {181, {Map181_Init, "Hacker International Type2", MAPPER_IRQ_NONE, NULL}},
+        {182, {Map182_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map182_State}},
+        {183, {Map183_Init, "Gimmick (Bootleg)", MAPPER_IRQ_CYCLE, Map183_State}},
+        {185, {Map185_Init, "Tecmo", MAPPER_IRQ_NONE, Map185_State}},
+        {187, {Map187_Init, "Street Fighter Zero 2 97", MAPPER_IRQ_SCANLINE, Map187_State}},
+        {188, {Map188_Init, "Bandai", MAPPER_IRQ_NONE, Map188_State}},
+        {189, {Map189_Init, "Pirates", MAPPER_IRQ_SCANLINE, Map189_State}},
+        {191, {Map191_Init, "Sachen Super Cartridge", MAPPER_IRQ_NONE, Map191_State}},
+        {193, {Map193_Init, "Mega Soft (NTDEC)", MAPPER_IRQ_NONE, NULL}},
+        {194, {Map194_Init, "Meikyuu Jiin Dababa", MAPPER_IRQ_NONE, NULL}},
+        {200, {Map200_Init, "1200-in-1", MAPPER_IRQ_NONE, NULL}},
+        {201, {Map201_Init, "21-in-1", MAPPER_IRQ_NONE, NULL}},
+        {202, {Map202_Init, "150-in-1", MAPPER_IRQ_NONE, NULL}},
+        //{206, {Map206_Init, "Namcot 118", MAPPER_IRQ_NONE, NULL}},
+        {212, {Map212_Init, "BMC Super HiK 300-in-1", MAPPER_IRQ_NONE, NULL}},
+        {222, {Map222_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {225, {Map225_Init, "72-in-1", MAPPER_IRQ_NONE, NULL}},
+        {226, {Map226_Init, "76-in-1", MAPPER_IRQ_NONE, Map226_State}},
+        {227, {Map227_Init, "1200-in-1", MAPPER_IRQ_NONE, NULL}},
+        {228, {Map228_Init, "Action 52", MAPPER_IRQ_NONE, NULL}},
+        {229, {Map229_Init, "31-in-1", MAPPER_IRQ_NONE, NULL}},
+        {230, {Map230_Init, "22-in-1", MAPPER_IRQ_NONE, Map230_State}},
+        {231, {Map231_Init, "20-in-1", MAPPER_IRQ_NONE, NULL}},
+        {232, {Map232_Init, "Quattro Games", MAPPER_IRQ_NONE, Map232_State}},
+        {233, {Map233_Init, "42-in-1", MAPPER_IRQ_NONE, NULL}},
+        {234, {Map234_Init, "Maxi-15", MAPPER_IRQ_NONE, Map234_State}},
+        {235, {Map235_Init, "150-in-1", MAPPER_IRQ_NONE, Map235_State}},
+        {236, {Map236_Init, "800-in-1", MAPPER_IRQ_NONE, Map236_State}},
+        {240, {Map240_Init, "Gen Ke Le Zhuan", MAPPER_IRQ_NONE, NULL}},
+        {241, {Map241_Init, "Fon Serm Bon", MAPPER_IRQ_NONE, NULL}},
+        {242, {Map242_Init, "Wai Xing Zhan Shi", MAPPER_IRQ_NONE, NULL}},
+        {243, {Map243_Init, "Pirates", MAPPER_IRQ_NONE, Map243_State}},
+        {244, {Map244_Init, "", MAPPER_IRQ_NONE, NULL}},
+        {245, {Map245_Init, "Yong Zhe Dou E Long", MAPPER_IRQ_SCANLINE, Map245_State}},
+        {246, {Map246_Init, "Phone Serm Berm", MAPPER_IRQ_NONE, NULL}},
+        {248, {Map248_Init, "Bao Qing Tian", MAPPER_IRQ_SCANLINE, Map248_State}},
+        {249, {Map249_Init, "MMC3", MAPPER_IRQ_SCANLINE, Map249_State}},
+        {251, {Map251_Init, "", MAPPER_IRQ_NONE, Map251_State}},
+        {252, {Map252_Init, "Sangokushi", MAPPER_IRQ_SCANLINE, Map252_State}},
+        {255, {Map255_Init, "110-in-1", MAPPER_IRQ_NONE, Map255_State}},
+};
+
+/* A number listed twice would silently lose one of its descriptors */
+static constexpr bool MapperList_Valid()
+{
+  for (size_t i = 0; i < sizeof(MapperList) / sizeof(MapperList[0]); ++i)
+  {
+    if (MapperList[i].nMapperNo < 0 || MapperList[i].nMapperNo > 255)
+      return false;
+    for (size_t j = 0; j < i; ++j)
     {
-        {212, Map212_Init},
-        {0, Map0_Init},
-        {1, Map1_Init},
-        {2, Map2_Init},
-        {3, Map3_Init},
-        {4, Map4_Init},
-                //{5, Map5_Init},
-        //{6, Map6_Init},
-        {7, Map7_Init},
-        {11, Map11_Init},
-        //{19, Map19_Init},
-        //{ 206, Map206_Init},
-        {8, Map8_Init},
-        {9, Map9_Init},
-        {10, Map10_Init},
-        {11, Map11_Init},
-        {13, Map13_Init},
-        {15, Map15_Init},
-        {16, Map16_Init},
-        {17, Map17_Init},
-        {18, Map18_Init},
-        //{19, Map19_Init},
-        {21, Map21_Init},
-        {22, Map22_Init},
-        {23, Map23_Init},
-        {24, Map24_Init},
-        {25, Map25_Init},
-        {26, Map26_Init},
-        {32, Map32_Init},
-        {33, Map33_Init},
-        {34, Map34_Init},
-        {40, Map40_Init},
-        {41, Map41_Init},
-        {42, Map42_Init},
-        {43, Map43_Init},
-        {44, Map44_Init},
-        {45, Map45_Init},
-        {46, Map46_Init},
-        {47, Map47_Init},
-        {48, Map48_Init},
-        {49, Map49_Init},
-        {50, Map50_Init},
-        {51, Map51_Init},
-        {57, Map57_Init},
-        {58, Map58_Init},
-        {60, Map60_Init},
-        {61, Map61_Init},
-        {62, Map62_Init},
-        {64, Map64_Init},
-        {65, Map65_Init},
-        {66, Map66_Init},
-        {67, Map67_Init},
-        {68, Map68_Init},
-        {69, Map69_Init},
-        {70, Map70_Init},
-        {71, Map71_Init},
-        {72, Map72_Init},
-        {73, Map73_Init},
-        {74, Map74_Init},
-        {75, Map75_Init},
-        {76, Map76_Init},
-        {77, Map77_Init},
-        {78, Map78_Init},
-        {79, Map79_Init},
-        {80, Map80_Init},
-        {82, Map82_Init},
-        {83, Map83_Init},
-        //  {  85, Map85_Init  },
-        {86, Map86_Init},
-        {87, Map87_Init},
-        {88, Map88_Init},
-        {89, Map89_Init},
-        {90, Map90_Init},
-        {91, Map91_Init},
-        {92, Map92_Init},
-        {93, Map93_Init},
-        {94, Map94_Init},
-        {95, Map95_Init},
-        {96, Map96_Init},
-        {97, Map97_Init},
-        {100, Map100_Init},
-        {101, Map101_Init},
-        {105, Map105_Init},
-        {107, Map107_Init},
-        {108, Map108_Init},
-        {109, Map109_Init},
-        {110, Map110_Init},
-        {112, Map112_Init},
-        {113, Map113_Init},
-        {114, Map114_Init},
-        {115, Map115_Init},
-        {116, Map116_Init},
-        {117, Map117_Init},
-        {118, Map118_Init},
-        {119, Map119_Init},
-        {122, Map122_Init},
-        {133, Map133_Init},
-        {134, Map134_Init},
-        {135, Map135_Init},
-        {140, Map140_Init},
-        {151, Map151_Init},
-        {160, Map160_Init},
-        {180, Map180_Init},
-        {181, Map181_Init},
-        {182, Map182_Init},
-        {183, Map183_Init},
-        {185, Map185_Init},
-        {187, Map187_Init},
-        {188, Map188_Init},
-        {189, Map189_Init},
-        {191, Map191_Init},
-        {193, Map193_Init},
-        {194, Map194_Init},
-        {200, Map200_Init},
-        {201, Map201_Init},
-        {202, Map202_Init},
-        {222, Map222_Init},
-        {225, Map225_Init},
-        {226, Map226_Init},
-        {227, Map227_Init},
-        {228, Map228_Init},
-        {229, Map229_Init},
-        {230, Map230_Init},
-        {231, Map231_Init},
-        {232, Map232_Init},
-        {233, Map233_Init},
-        {234, Map234_Init},
-        {235, Map235_Init},
-        {236, Map236_Init},
-        {240, Map240_Init},
-        {241, Map241_Init},
-        {242, Map242_Init},
-        {243, Map243_Init},
-        {244, Map244_Init},
-        {245, Map245_Init},
-        {246, Map246_Init},
-        {248, Map248_Init},
-        {249, Map249_Init},
-        {251, Map251_Init},
-        {252, Map252_Init},
-        {255, Map255_Init},
-        /* */
-        {-1, NULL}};
+      if (MapperList[j].nMapperNo == MapperList[i].nMapperNo)
+        return false;
+    }
+  }
+  return true;
+}
+
+static_assert(MapperList_Valid(), "MapperList has a mapper number twice or out of range");
+
+/* Indexed by mapper number, so the lookup at reset and in the ROM menu is one load */
+struct MapperTable_tag
+{
+  struct MapperDesc_tag aDesc[256];
+};
+
+static constexpr struct MapperTable_tag MapperTable_Build()
+{
+  struct MapperTable_tag Table = {};
+  for (const struct MapperList_tag &Entry : MapperList)
+    Table.aDesc[Entry.nMapperNo] = Entry.Desc;
+  return Table;
+}
+
+static constexpr struct MapperTable_tag MapperTable = MapperTable_Build();
+
+const struct MapperDesc_tag *InfoNES_GetMapper(BYTE byMapperNo)
+{
+  return &MapperTable.aDesc[byMapperNo];
+}
 
 /*-------------------------------------------------------------------*/
 /*  body of Mapper functions                                         */
@@ -198,7 +243,7 @@ struct MapperTable_tag MapperTable[] =
 #include "mapper/InfoNES_Mapper_016.cpp"
 #include "mapper/InfoNES_Mapper_017.cpp"
 #include "mapper/InfoNES_Mapper_018.cpp"
-//#include "mapper/InfoNES_Mapper_019.cpp"
+#include "mapper/InfoNES_Mapper_019.cpp"
 #include "mapper/InfoNES_Mapper_021.cpp"
 #include "mapper/InfoNES_Mapper_022.cpp"
 #include "mapper/InfoNES_Mapper_023.cpp"
@@ -14,6 +14,10 @@
 /*-------------------------------------------------------------------*/
 
 #include "InfoNES_Types.h"
+#include "InfoNES_State.h"
+#ifdef ROM_LZ4
+#include "InfoNES_RomCache.h"
+#endif
 
 /*-------------------------------------------------------------------*/
 /*  Constants                                                        */
@@ -32,12 +36,19 @@ extern BYTE DRAM[];
 /*  Macros                                                           */
 /*-------------------------------------------------------------------*/
 
+#ifdef ROM_LZ4
+/* Banks of an LZ4 packed image are decoded into a cache on demand */
+#define ROMPAGE(a) InfoNES_RomPage(a)
+#define ROMLASTPAGE(a) InfoNES_RomPage(NesHeader.byRomSize * 2 - ((a) + 1))
+#define VROMPAGE(a) InfoNES_VRomPage(a)
+#else
 /* The address of 8Kbytes unit of the ROM */
 #define ROMPAGE(a) &ROM[(a)*0x2000]
 /* From behind the ROM, the address of 8kbytes unit */
 #define ROMLASTPAGE(a) &ROM[NesHeader.byRomSize * 0x4000 - ((a) + 1) * 0x2000]
 /* The address of 1Kbytes unit of the VROM */
 #define VROMPAGE(a) &VROM[(a)*0x400]
+#endif
 /* The address of 1Kbytes unit of the CRAM */
 #define CRAMPAGE(a) &PPURAM[0x0000 + ((a)&0x1F) * 0x400]
 /* The address of 1Kbytes unit of the VRAM */
@@ -46,16 +57,31 @@ extern BYTE DRAM[];
 #define PATTBL(a) (((a)-ChrBuf) >> 2)
 
 /*-------------------------------------------------------------------*/
-/*  Table of Mapper initialize function                              */
+/*  Table of Mapper descriptors                                      */
 /*-------------------------------------------------------------------*/
 
-struct MapperTable_tag
+/* MapperDesc_tag::byFlags */
+#define MAPPER_IRQ_MASK 0x03
+#define MAPPER_IRQ_NONE 0x00     /* No IRQ source */
+#define MAPPER_IRQ_SCANLINE 0x01 /* IRQ counter steps once per scanline */
+#define MAPPER_IRQ_CYCLE 0x02    /* IRQ counter steps by CPU clocks */
+#define MAPPER_PPU 0x04          /* Watches pattern fetches ( MapperPPU ) */
+#define MAPPER_EXT_AUDIO 0x08    /* Sound chip on the cartridge */
+
+struct MapperDesc_tag
 {
-  int nMapperNo;
-  void (*pMapperInit)();
+  void (*pMapperInit)(); /* NULL : Not supported, the rest is zero */
+  const char *pszName;   /* Board name, "" when it has none */
+  BYTE byFlags;
+  void (*pMapperState)(struct InfoNES_State_tag *pState); /* NULL : Only its banks are saved */
 };
 
-extern struct MapperTable_tag MapperTable[];
+/*
+ *  The descriptor of every mapper number, built at compile time from
+ *  the list in InfoNES_Mapper.cpp. Always returns a descriptor, one
+ *  with a NULL pMapperInit for the unsupported mappers.
+ */
+const struct MapperDesc_tag *InfoNES_GetMapper(BYTE byMapperNo);
 
 /*-------------------------------------------------------------------*/
 /*  Function prototypes                                              */
@@ -74,6 +100,7 @@ void Map0_RenderScreen(BYTE byMode);
 void Map1_Init();
 void Map1_Write(WORD wAddr, BYTE byData);
 void Map1_set_ROM_banks();
+void Map1_State(struct InfoNES_State_tag *pState);
 
 void Map2_Init();
 void Map2_Write(WORD wAddr, BYTE byData);
@@ -86,6 +113,7 @@ void Map4_Write(WORD wAddr, BYTE byData);
 void Map4_HSync();
 void Map4_Set_CPU_Banks();
 void Map4_Set_PPU_Banks();
+void Map4_State(struct InfoNES_State_tag *pState);
 
 void Map5_Init();
 void Map5_Write(WORD wAddr, BYTE byData);
@@ -109,10 +137,12 @@ void Map8_Write(WORD wAddr, BYTE byData);
 void Map9_Init();
 void Map9_Write(WORD wAddr, BYTE byData);
 void Map9_PPU(WORD wAddr);
+void Map9_State(struct InfoNES_State_tag *pState);
 
 void Map10_Init();
 void Map10_Write(WORD wAddr, BYTE byData);
 void Map10_PPU(WORD wAddr);
+void Map10_State(struct InfoNES_State_tag *pState);
 
 void Map11_Init();
 void Map11_Write(WORD wAddr, BYTE byData);
@@ -126,24 +156,30 @@ void Map15_Write(WORD wAddr, BYTE byData);
 void Map16_Init();
 void Map16_Write(WORD wAddr, BYTE byData);
 void Map16_HSync();
+void Map16_State(struct InfoNES_State_tag *pState);
 
 void Map17_Init();
 void Map17_Apu(WORD wAddr, BYTE byData);
 void Map17_HSync();
+void Map17_State(struct InfoNES_State_tag *pState);
 
 void Map18_Init();
 void Map18_Write(WORD wAddr, BYTE byData);
 void Map18_HSync();
+void Map18_State(struct InfoNES_State_tag *pState);
 
 void Map19_Init();
 void Map19_Write(WORD wAddr, BYTE byData);
 void Map19_Apu(WORD wAddr, BYTE byData);
 BYTE Map19_ReadApu(WORD wAddr);
 void Map19_HSync();
+void Map19_Sound_Init();
+void Map19_State(struct InfoNES_State_tag *pState);
 
 void Map21_Init();
 void Map21_Write(WORD wAddr, BYTE byData);
 void Map21_HSync();
+void Map21_State(struct InfoNES_State_tag *pState);
 
 void Map22_Init();
 void Map22_Write(WORD wAddr, BYTE byData);
@@ -151,26 +187,35 @@ void Map22_Write(WORD wAddr, BYTE byData);
 void Map23_Init();
 void Map23_Write(WORD wAddr, BYTE byData);
 void Map23_HSync();
+void Map23_State(struct InfoNES_State_tag *pState);
 
 void Map24_Init();
 void Map24_Write(WORD wAddr, BYTE byData);
 void Map24_HSync();
+void Map24_Sound_Init();
+void Map24_Sound(WORD wAddr, BYTE byData);
+void Map24_Sound_State(struct InfoNES_State_tag *pState);
+void Map24_State(struct InfoNES_State_tag *pState);
 
 void Map25_Init();
 void Map25_Write(WORD wAddr, BYTE byData);
 void Map25_Sync_Vrom(int nBank);
 void Map25_HSync();
+void Map25_State(struct InfoNES_State_tag *pState);
 
 void Map26_Init();
 void Map26_Write(WORD wAddr, BYTE byData);
 void Map26_HSync();
+void Map26_State(struct InfoNES_State_tag *pState);
 
 void Map32_Init();
 void Map32_Write(WORD wAddr, BYTE byData);
+void Map32_State(struct InfoNES_State_tag *pState);
 
 void Map33_Init();
 void Map33_Write(WORD wAddr, BYTE byData);
 void Map33_HSync();
+void Map33_State(struct InfoNES_State_tag *pState);
 
 void Map34_Init();
 void Map34_Write(WORD wAddr, BYTE byData);
@@ -179,26 +224,31 @@ void Map34_Sram(WORD wAddr, BYTE byData);
 void Map40_Init();
 void Map40_Write(WORD wAddr, BYTE byData);
 void Map40_HSync();
+void Map40_State(struct InfoNES_State_tag *pState);
 
 void Map41_Init();
 void Map41_Write(WORD wAddr, BYTE byData);
 void Map41_Sram(WORD wAddr, BYTE byData);
+void Map41_State(struct InfoNES_State_tag *pState);
 
 void Map42_Init();
 void Map42_Write(WORD wAddr, BYTE byData);
 void Map42_HSync();
+void Map42_State(struct InfoNES_State_tag *pState);
 
 void Map43_Init();
 void Map43_Write(WORD wAddr, BYTE byData);
 void Map43_Apu(WORD wAddr, BYTE byData);
 BYTE Map43_ReadApu(WORD wAddr);
 void Map43_HSync();
+void Map43_State(struct InfoNES_State_tag *pState);
 
 void Map44_Init();
 void Map44_Write(WORD wAddr, BYTE byData);
 void Map44_HSync();
 void Map44_Set_CPU_Banks();
 void Map44_Set_PPU_Banks();
+void Map44_State(struct InfoNES_State_tag *pState);
 
 void Map45_Init();
 void Map45_Sram(WORD wAddr, BYTE byData);
@@ -209,11 +259,13 @@ void Map45_Set_CPU_Bank5(BYTE byData);
 void Map45_Set_CPU_Bank6(BYTE byData);
 void Map45_Set_CPU_Bank7(BYTE byData);
 void Map45_Set_PPU_Banks();
+void Map45_State(struct InfoNES_State_tag *pState);
 
 void Map46_Init();
 void Map46_Sram(WORD wAddr, BYTE byData);
 void Map46_Write(WORD wAddr, BYTE byData);
 void Map46_Set_ROM_Banks();
+void Map46_State(struct InfoNES_State_tag *pState);
 
 void Map47_Init();
 void Map47_Sram(WORD wAddr, BYTE byData);
@@ -221,10 +273,12 @@ void Map47_Write(WORD wAddr, BYTE byData);
 void Map47_HSync();
 void Map47_Set_CPU_Banks();
 void Map47_Set_PPU_Banks();
+void Map47_State(struct InfoNES_State_tag *pState);
 
 void Map48_Init();
 void Map48_Write(WORD wAddr, BYTE byData);
 void Map48_HSync();
+void Map48_State(struct InfoNES_State_tag *pState);
 
 void Map49_Init();
 void Map49_Sram(WORD wAddr, BYTE byData);
@@ -232,18 +286,22 @@ void Map49_Write(WORD wAddr, BYTE byData);
 void Map49_HSync();
 void Map49_Set_CPU_Banks();
 void Map49_Set_PPU_Banks();
+void Map49_State(struct InfoNES_State_tag *pState);
 
 void Map50_Init();
 void Map50_Apu(WORD wAddr, BYTE byData);
 void Map50_HSync();
+void Map50_State(struct InfoNES_State_tag *pState);
 
 void Map51_Init();
 void Map51_Sram(WORD wAddr, BYTE byData);
 void Map51_Write(WORD wAddr, BYTE byData);
 void Map51_Set_CPU_Banks();
+void Map51_State(struct InfoNES_State_tag *pState);
 
 void Map57_Init();
 void Map57_Write(WORD wAddr, BYTE byData);
+void Map57_State(struct InfoNES_State_tag *pState);
 
 void Map58_Init();
 void Map58_Write(WORD wAddr, BYTE byData);
@@ -259,10 +317,12 @@ void Map62_Write(WORD wAddr, BYTE byData);
 
 void Map64_Init();
 void Map64_Write(WORD wAddr, BYTE byData);
+void Map64_State(struct InfoNES_State_tag *pState);
 
 void Map65_Init();
 void Map65_Write(WORD wAddr, BYTE byData);
 void Map65_HSync();
+void Map65_State(struct InfoNES_State_tag *pState);
 
 void Map66_Init();
 void Map66_Write(WORD wAddr, BYTE byData);
@@ -270,14 +330,18 @@ void Map66_Write(WORD wAddr, BYTE byData);
 void Map67_Init();
 void Map67_Write(WORD wAddr, BYTE byData);
 void Map67_HSync();
+void Map67_State(struct InfoNES_State_tag *pState);
 
 void Map68_Init();
 void Map68_Write(WORD wAddr, BYTE byData);
 void Map68_SyncMirror();
+void Map68_State(struct InfoNES_State_tag *pState);
 
 void Map69_Init();
 void Map69_Write(WORD wAddr, BYTE byData);
 void Map69_HSync();
+void Map69_Sound_Init();
+void Map69_State(struct InfoNES_State_tag *pState);
 
 void Map70_Init();
 void Map70_Write(WORD wAddr, BYTE byData);
@@ -291,18 +355,22 @@ void Map72_Write(WORD wAddr, BYTE byData);
 void Map73_Init();
 void Map73_Write(WORD wAddr, BYTE byData);
 void Map73_HSync();
+void Map73_State(struct InfoNES_State_tag *pState);
 
 void Map74_Init();
 void Map74_Write(WORD wAddr, BYTE byData);
 void Map74_HSync();
 void Map74_Set_CPU_Banks();
 void Map74_Set_PPU_Banks();
+void Map74_State(struct InfoNES_State_tag *pState);
 
 void Map75_Init();
 void Map75_Write(WORD wAddr, BYTE byData);
+void Map75_State(struct InfoNES_State_tag *pState);
 
 void Map76_Init();
 void Map76_Write(WORD wAddr, BYTE byData);
+void Map76_State(struct InfoNES_State_tag *pState);
 
 void Map77_Init();
 void Map77_Write(WORD wAddr, BYTE byData);
@@ -318,12 +386,14 @@ void Map80_Sram(WORD wAddr, BYTE byData);
 
 void Map82_Init();
 void Map82_Sram(WORD wAddr, BYTE byData);
+void Map82_State(struct InfoNES_State_tag *pState);
 
 void Map83_Init();
 void Map83_Write(WORD wAddr, BYTE byData);
 void Map83_Apu(WORD wAddr, BYTE byData);
 BYTE Map83_ReadApu(WORD wAddr);
 void Map83_HSync();
+void Map83_State(struct InfoNES_State_tag *pState);
 
 void Map85_Init();
 void Map85_Write(WORD wAddr, BYTE byData);
@@ -337,6 +407,7 @@ void Map87_Sram(WORD wAddr, BYTE byData);
 
 void Map88_Init();
 void Map88_Write(WORD wAddr, BYTE byData);
+void Map88_State(struct InfoNES_State_tag *pState);
 
 void Map89_Init();
 void Map89_Write(WORD wAddr, BYTE byData);
@@ -349,6 +420,7 @@ void Map90_HSync();
 void Map90_Sync_Mirror(void);
 void Map90_Sync_Prg_Banks(void);
 void Map90_Sync_Chr_Banks(void);
+void Map90_State(struct InfoNES_State_tag *pState);
 
 void Map91_Init();
 void Map91_Sram(WORD wAddr, BYTE byData);
@@ -366,11 +438,13 @@ void Map95_Init();
 void Map95_Write(WORD wAddr, BYTE byData);
 void Map95_Set_CPU_Banks();
 void Map95_Set_PPU_Banks();
+void Map95_State(struct InfoNES_State_tag *pState);
 
 void Map96_Init();
 void Map96_Write(WORD wAddr, BYTE byData);
 void Map96_PPU(WORD wAddr);
 void Map96_Set_Banks();
+void Map96_State(struct InfoNES_State_tag *pState);
 
 void Map97_Init();
 void Map97_Write(WORD wAddr, BYTE byData);
@@ -380,6 +454,7 @@ void Map100_Write(WORD wAddr, BYTE byData);
 void Map100_HSync();
 void Map100_Set_CPU_Banks();
 void Map100_Set_PPU_Banks();
+void Map100_State(struct InfoNES_State_tag *pState);
 
 void Map101_Init();
 void Map101_Write(WORD wAddr, BYTE byData);
@@ -387,6 +462,7 @@ void Map101_Write(WORD wAddr, BYTE byData);
 void Map105_Init();
 void Map105_Write(WORD wAddr, BYTE byData);
 void Map105_HSync();
+void Map105_State(struct InfoNES_State_tag *pState);
 
 void Map107_Init();
 void Map107_Write(WORD wAddr, BYTE byData);
@@ -397,15 +473,18 @@ void Map108_Write(WORD wAddr, BYTE byData);
 void Map109_Init();
 void Map109_Apu(WORD wAddr, BYTE byData);
 void Map109_Set_PPU_Banks();
+void Map109_State(struct InfoNES_State_tag *pState);
 
 void Map110_Init();
 void Map110_Apu(WORD wAddr, BYTE byData);
+void Map110_State(struct InfoNES_State_tag *pState);
 
 void Map112_Init();
 void Map112_Write(WORD wAddr, BYTE byData);
 void Map112_HSync();
 void Map112_Set_CPU_Banks();
 void Map112_Set_PPU_Banks();
+void Map112_State(struct InfoNES_State_tag *pState);
 
 void Map113_Init();
 void Map113_Apu(WORD wAddr, BYTE byData);
@@ -417,6 +496,7 @@ void Map114_Write(WORD wAddr, BYTE byData);
 void Map114_HSync();
 void Map114_Set_CPU_Banks();
 void Map114_Set_PPU_Banks();
+void Map114_State(struct InfoNES_State_tag *pState);
 
 void Map115_Init();
 void Map115_Sram(WORD wAddr, BYTE byData);
@@ -424,28 +504,33 @@ void Map115_Write(WORD wAddr, BYTE byData);
 void Map115_HSync();
 void Map115_Set_CPU_Banks();
 void Map115_Set_PPU_Banks();
+void Map115_State(struct InfoNES_State_tag *pState);
 
 void Map116_Init();
 void Map116_Write(WORD wAddr, BYTE byData);
 void Map116_HSync();
 void Map116_Set_CPU_Banks();
 void Map116_Set_PPU_Banks();
+void Map116_State(struct InfoNES_State_tag *pState);
 
 void Map117_Init();
 void Map117_Write(WORD wAddr, BYTE byData);
 void Map117_HSync();
+void Map117_State(struct InfoNES_State_tag *pState);
 
 void Map118_Init();
 void Map118_Write(WORD wAddr, BYTE byData);
 void Map118_HSync();
 void Map118_Set_CPU_Banks();
 void Map118_Set_PPU_Banks();
+void Map118_State(struct InfoNES_State_tag *pState);
 
 void Map119_Init();
 void Map119_Write(WORD wAddr, BYTE byData);
 void Map119_HSync();
 void Map119_Set_CPU_Banks();
 void Map119_Set_PPU_Banks();
+void Map119_State(struct InfoNES_State_tag *pState);
 
 void Map122_Init();
 void Map122_Sram(WORD wAddr, BYTE byData);
@@ -455,10 +540,12 @@ void Map133_Apu(WORD wAddr, BYTE byData);
 
 void Map134_Init();
 void Map134_Apu(WORD wAddr, BYTE byData);
+void Map134_State(struct InfoNES_State_tag *pState);
 
 void Map135_Init();
 void Map135_Apu(WORD wAddr, BYTE byData);
 void Map135_Set_PPU_Banks();
+void Map135_State(struct InfoNES_State_tag *pState);
 
 void Map140_Init();
 void Map140_Sram(WORD wAddr, BYTE byData);
@@ -470,6 +557,7 @@ void Map151_Write(WORD wAddr, BYTE byData);
 void Map160_Init();
 void Map160_Write(WORD wAddr, BYTE byData);
 void Map160_HSync();
+void Map160_State(struct InfoNES_State_tag *pState);
 
 void Map180_Init();
 void Map180_Write(WORD wAddr, BYTE byData);
@@ -480,13 +568,16 @@ void Map181_Apu(WORD wAddr, BYTE byData);
 void Map182_Init();
 void Map182_Write(WORD wAddr, BYTE byData);
 void Map182_HSync();
+void Map182_State(struct InfoNES_State_tag *pState);
 
 void Map183_Init();
 void Map183_Write(WORD wAddr, BYTE byData);
 void Map183_HSync();
+void Map183_State(struct InfoNES_State_tag *pState);
 
 void Map185_Init();
 void Map185_Write(WORD wAddr, BYTE byData);
+void Map185_State(struct InfoNES_State_tag *pState);
 
 void Map187_Init();
 void Map187_Write(WORD wAddr, BYTE byData);
@@ -495,19 +586,23 @@ BYTE Map187_ReadApu(WORD wAddr);
 void Map187_HSync();
 void Map187_Set_CPU_Banks();
 void Map187_Set_PPU_Banks();
+void Map187_State(struct InfoNES_State_tag *pState);
 
 void Map188_Init();
 void Map188_Write(WORD wAddr, BYTE byData);
+void Map188_State(struct InfoNES_State_tag *pState);
 
 void Map189_Init();
 void Map189_Apu(WORD wAddr, BYTE byData);
 void Map189_Write(WORD wAddr, BYTE byData);
 void Map189_HSync();
+void Map189_State(struct InfoNES_State_tag *pState);
 
 void Map191_Init();
 void Map191_Apu(WORD wAddr, BYTE byData);
 void Map191_Set_CPU_Banks();
 void Map191_Set_PPU_Banks();
+void Map191_State(struct InfoNES_State_tag *pState);
 
 void Map193_Init();
 void Map193_Sram(WORD wAddr, BYTE byData);
@@ -534,6 +629,7 @@ void Map225_Write(WORD wAddr, BYTE byData);
 
 void Map226_Init();
 void Map226_Write(WORD wAddr, BYTE byData);
+void Map226_State(struct InfoNES_State_tag *pState);
 
 void Map227_Init();
 void Map227_Write(WORD wAddr, BYTE byData);
@@ -546,12 +642,14 @@ void Map229_Write(WORD wAddr, BYTE byData);
 
 void Map230_Init();
 void Map230_Write(WORD wAddr, BYTE byData);
+void Map230_State(struct InfoNES_State_tag *pState);
 
 void Map231_Init();
 void Map231_Write(WORD wAddr, BYTE byData);
 
 void Map232_Init();
 void Map232_Write(WORD wAddr, BYTE byData);
+void Map232_State(struct InfoNES_State_tag *pState);
 
 void Map233_Init();
 void Map233_Write(WORD wAddr, BYTE byData);
@@ -559,12 +657,15 @@ void Map233_Write(WORD wAddr, BYTE byData);
 void Map234_Init();
 void Map234_Write(WORD wAddr, BYTE byData);
 void Map234_Set_Banks();
+void Map234_State(struct InfoNES_State_tag *pState);
 
 void Map235_Init();
 void Map235_Write(WORD wAddr, BYTE byData);
+void Map235_State(struct InfoNES_State_tag *pState);
 
 void Map236_Init();
 void Map236_Write(WORD wAddr, BYTE byData);
+void Map236_State(struct InfoNES_State_tag *pState);
 
 void Map240_Init();
 void Map240_Apu(WORD wAddr, BYTE byData);
@@ -577,6 +678,7 @@ void Map242_Write(WORD wAddr, BYTE byData);
 
 void Map243_Init();
 void Map243_Apu(WORD wAddr, BYTE byData);
+void Map243_State(struct InfoNES_State_tag *pState);
 
 void Map244_Init();
 void Map244_Write(WORD wAddr, BYTE byData);
@@ -588,6 +690,7 @@ void Map245_HSync();
 void Map245_Set_CPU_Banks();
 void Map245_Set_PPU_Banks();
 #endif
+void Map245_State(struct InfoNES_State_tag *pState);
 
 void Map246_Init();
 void Map246_Sram(WORD wAddr, BYTE byData);
@@ -599,25 +702,30 @@ void Map248_Sram(WORD wAddr, BYTE byData);
 void Map248_HSync();
 void Map248_Set_CPU_Banks();
 void Map248_Set_PPU_Banks();
+void Map248_State(struct InfoNES_State_tag *pState);
 
 void Map249_Init();
 void Map249_Write(WORD wAddr, BYTE byData);
 void Map249_Apu(WORD wAddr, BYTE byData);
 void Map249_HSync();
+void Map249_State(struct InfoNES_State_tag *pState);
 
 void Map251_Init();
 void Map251_Write(WORD wAddr, BYTE byData);
 void Map251_Sram(WORD wAddr, BYTE byData);
 void Map251_Set_Banks();
+void Map251_State(struct InfoNES_State_tag *pState);
 
 void Map252_Init();
 void Map252_Write(WORD wAddr, BYTE byData);
 void Map252_HSync();
+void Map252_State(struct InfoNES_State_tag *pState);
 
 void Map255_Init();
 void Map255_Write(WORD wAddr, BYTE byData);
 void Map255_Apu(WORD wAddr, BYTE byData);
 BYTE Map255_ReadApu(WORD wAddr);
+void Map255_State(struct InfoNES_State_tag *pState);
 
 void Map212_Init();
 void Map212_Write(WORD wAddr, BYTE byData);
@@ -0,0 +1,357 @@
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_RomCache.cpp : Bank cache for LZ4 packed ROM images      */
+/*                                                                   */
+/*===================================================================*/
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include "InfoNES_RomCache.h"
+
+#ifdef ROM_LZ4
+
+#include "InfoNES.h"
+#include "InfoNES_pAPU.h"
+#include "K6502.h"
+#include <pico.h>
+#include <string.h>
+
+/*-------------------------------------------------------------------*/
+/*  Cache resources                                                  */
+/*-------------------------------------------------------------------*/
+
+struct rom_cache_tag
+{
+  BYTE *pbySlots;   // nSlots banks of dwBankSize bytes
+  short *pnSlotOf;  // Slot of each bank of the image ( -1 : not decoded )
+  short *pnBankOf;  // Bank in each slot ( -1 : empty )
+  DWORD *pdwUsed;   // Stamp of the last time each slot was mapped
+  int nSlots;
+  DWORD dwBankSize;
+  int nBanks;       // Banks in the image
+  int nFirst;       // Their first entry in the bank table
+};
+
+static BYTE s_byPrgSlots[ROM_CACHE_PRG][0x2000];
+static short s_nPrgSlotOf[0x100 * 2];
+static short s_nPrgBankOf[ROM_CACHE_PRG];
+static DWORD s_dwPrgUsed[ROM_CACHE_PRG];
+
+static BYTE s_byChrSlots[ROM_CACHE_CHR][0x400];
+static short s_nChrSlotOf[0x100 * 8];
+static short s_nChrBankOf[ROM_CACHE_CHR];
+static DWORD s_dwChrUsed[ROM_CACHE_CHR];
+
+static struct rom_cache_tag s_RomCache[2] = {
+    {&s_byPrgSlots[0][0], s_nPrgSlotOf, s_nPrgBankOf, s_dwPrgUsed, ROM_CACHE_PRG, 0x2000},
+    {&s_byChrSlots[0][0], s_nChrSlotOf, s_nChrBankOf, s_dwChrUsed, ROM_CACHE_CHR, 0x400},
+};
+
+/* The open image ( NULL : none ) and its bank table */
+static const BYTE *s_pbyImage;
+static const BYTE *s_pbyTable;
+static DWORD s_dwStamp;
+
+DWORD g_dwRomCacheFills[2];
+
+/*-------------------------------------------------------------------*/
+/*  Bank table entries are little-endian and may sit in flash        */
+/*-------------------------------------------------------------------*/
+static inline DWORD InfoNES_RomCacheEntry(const BYTE *pbyTable, int nIdx)
+{
+  const BYTE *pbyEntry = pbyTable + (nIdx << 2);
+  return pbyEntry[0] | (pbyEntry[1] << 8) | (pbyEntry[2] << 16) | ((DWORD)pbyEntry[3] << 24);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_Lz4Decode() : Decode one LZ4 block, no frame       */
+/*                                                                   */
+/*===================================================================*/
+static bool __not_in_flash_func(InfoNES_Lz4Decode)(const BYTE *pbySrc, DWORD dwSrc, BYTE *pbyDst, DWORD dwDst)
+{
+  /*
+   *  Every length is checked against both buffers, so a corrupt
+   *  block fails instead of writing past the slot.
+   *
+   *  Return values
+   *    true  : The block filled exactly dwDst bytes
+   *    false : Corrupt block
+   */
+  const BYTE *pbySrcEnd = pbySrc + dwSrc;
+  BYTE *pbyOut = pbyDst;
+  BYTE *pbyOutEnd = pbyDst + dwDst;
+
+  while (pbySrc < pbySrcEnd)
+  {
+    const BYTE byToken = *pbySrc++;
+
+    // Literals
+    DWORD dwLen = byToken >> 4;
+    if (dwLen == 15)
+    {
+      BYTE byMore;
+      do
+      {
+        if (pbySrc == pbySrcEnd)
+          return false;
+        byMore = *pbySrc++;
+        dwLen += byMore;
+      } while (byMore == 255);
+    }
+    if (dwLen > (DWORD)(pbySrcEnd - pbySrc) || dwLen > (DWORD)(pbyOutEnd - pbyOut))
+      return false;
+    memcpy(pbyOut, pbySrc, dwLen);
+    pbySrc += dwLen;
+    pbyOut += dwLen;
+
+    // The last sequence has no match
+    if (pbySrc == pbySrcEnd)
+      break;
+
+    // Match
+    if (pbySrcEnd - pbySrc < 2)
+      return false;
+    const DWORD dwOffset = pbySrc[0] | (pbySrc[1] << 8);
+    pbySrc += 2;
+    if (dwOffset == 0 || dwOffset > (DWORD)(pbyOut - pbyDst))
+      return false;
+
+    dwLen = byToken & 15;
+    if (dwLen == 15)
+    {
+      BYTE byMore;
+      do
+      {
+        if (pbySrc == pbySrcEnd)
+          return false;
+        byMore = *pbySrc++;
+        dwLen += byMore;
+      } while (byMore == 255);
+    }
+    dwLen += 4;
+    if (dwLen > (DWORD)(pbyOutEnd - pbyOut))
+      return false;
+
+    const BYTE *pbyMatch = pbyOut - dwOffset;
+    if (dwOffset >= dwLen)
+    {
+      memcpy(pbyOut, pbyMatch, dwLen);
+      pbyOut += dwLen;
+    }
+    else
+    {
+      // Overlapping: a run repeating the last dwOffset bytes
+      while (dwLen--)
+        *pbyOut++ = *pbyMatch++;
+    }
+  }
+
+  return pbyOut == pbyOutEnd;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_RomCacheOpen() : Check the bank table of an image     */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_RomCacheOpen(const BYTE *pbyImage, DWORD dwSize)
+{
+  /*
+   *  Check the bank table of an image
+   *
+   *  Remarks
+   *    The offsets have to be in order, inside the image and no
+   *    block longer than its bank, which a raw bank is exactly; the
+   *    lookups trust the table after this.
+   */
+  InfoNES_RomCacheClose();
+
+  if (dwSize < 16)
+    return -1;
+  const int nPrg = pbyImage[4] * 2;
+  const int nChr = pbyImage[5] * 8;
+  const DWORD dwTable = 16 + ((pbyImage[6] & 4) ? 512 : 0);
+  const DWORD dwBlocks = dwTable + ((nPrg + nChr + 1) << 2);
+  if (nPrg == 0 || dwBlocks > dwSize)
+    return -1;
+
+  DWORD dwPrev = dwBlocks;
+  for (int nIdx = 0; nIdx <= nPrg + nChr; ++nIdx)
+  {
+    const DWORD dwOffset = InfoNES_RomCacheEntry(pbyImage + dwTable, nIdx);
+    if (dwOffset < dwPrev || dwOffset > dwSize)
+      return -1;
+    if (nIdx > 0 && dwOffset - dwPrev > (nIdx <= nPrg ? 0x2000 : 0x400))
+      return -1;
+    dwPrev = dwOffset;
+  }
+
+  s_RomCache[0].nBanks = nPrg;
+  s_RomCache[0].nFirst = 0;
+  s_RomCache[1].nBanks = nChr;
+  s_RomCache[1].nFirst = nPrg;
+  for (int nKind = 0; nKind < 2; ++nKind)
+  {
+    struct rom_cache_tag *pCache = &s_RomCache[nKind];
+    for (int nBank = 0; nBank < pCache->nBanks; ++nBank)
+      pCache->pnSlotOf[nBank] = -1;
+    for (int nSlot = 0; nSlot < pCache->nSlots; ++nSlot)
+    {
+      pCache->pnBankOf[nSlot] = -1;
+      pCache->pdwUsed[nSlot] = 0;
+    }
+    g_dwRomCacheFills[nKind] = 0;
+  }
+  s_dwStamp = 0;
+
+  s_pbyImage = pbyImage;
+  s_pbyTable = pbyImage + dwTable;
+  return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*    InfoNES_RomCacheClose() : Back to the flat ROM / VROM arrays   */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_RomCacheClose()
+{
+  s_pbyImage = NULL;
+  s_pbyTable = NULL;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*    InfoNES_RomCacheMapped() : A bank pointer refers to the slot   */
+/*                                                                   */
+/*===================================================================*/
+static inline bool __not_in_flash_func(InfoNES_RomCacheMapped)(int nKind, const BYTE *pbySlot)
+{
+  if (nKind == 0)
+  {
+    return pbySlot == ROMBANK0 || pbySlot == ROMBANK1 || pbySlot == ROMBANK2 ||
+           pbySlot == ROMBANK3 || pbySlot == SRAMBANK;
+  }
+
+  for (int nPage = 0; nPage < 16; ++nPage)
+  {
+    if (pbySlot == PPUBANK[nPage])
+      return true;
+  }
+  return false;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_RomCacheBank() : A bank, decoded on a miss         */
+/*                                                                   */
+/*===================================================================*/
+static BYTE *__not_in_flash_func(InfoNES_RomCacheBank)(int nKind, int nBank)
+{
+  /*
+   *  A bank, decoded on a miss
+   *
+   *  Remarks
+   *    A miss refills the least recently mapped slot that no bank
+   *    pointer refers to. Whatever still keys on the slot's address
+   *    is told its bytes changed: the idle loop cache and the DPCM
+   *    prefetch for PRG, the background row cache for CHR.
+   */
+  struct rom_cache_tag *pCache = &s_RomCache[nKind];
+  if (pCache->nBanks == 0)
+    return pCache->pbySlots;
+  nBank = (unsigned)nBank % (unsigned)pCache->nBanks;
+
+  int nSlot = pCache->pnSlotOf[nBank];
+  if (nSlot < 0)
+  {
+    nSlot = -1;
+    for (int nIdx = 0; nIdx < pCache->nSlots; ++nIdx)
+    {
+      if ((nSlot < 0 || pCache->pdwUsed[nIdx] < pCache->pdwUsed[nSlot]) &&
+          !InfoNES_RomCacheMapped(nKind, pCache->pbySlots + nIdx * pCache->dwBankSize))
+        nSlot = nIdx;
+    }
+
+    BYTE *pbySlot = pCache->pbySlots + nSlot * pCache->dwBankSize;
+    if (pCache->pnBankOf[nSlot] >= 0)
+    {
+      pCache->pnSlotOf[pCache->pnBankOf[nSlot]] = -1;
+      if (nKind == 0)
+      {
+        K6502_ForgetBank(pbySlot);
+        InfoNES_pAPUForgetBank(pbySlot);
+      }
+      else
+      {
+        InfoNES_BgCacheForget(pbySlot);
+      }
+    }
+
+    const DWORD dwStart = InfoNES_RomCacheEntry(s_pbyTable, pCache->nFirst + nBank);
+    const DWORD dwEnd = InfoNES_RomCacheEntry(s_pbyTable, pCache->nFirst + nBank + 1);
+    if (dwEnd - dwStart == pCache->dwBankSize)
+    {
+      memcpy(pbySlot, s_pbyImage + dwStart, pCache->dwBankSize);
+    }
+    else if (!InfoNES_Lz4Decode(s_pbyImage + dwStart, dwEnd - dwStart, pbySlot, pCache->dwBankSize))
+    {
+      // Open bus rather than the last bank's bytes
+      memset(pbySlot, 0xff, pCache->dwBankSize);
+    }
+
+    pCache->pnSlotOf[nBank] = nSlot;
+    pCache->pnBankOf[nSlot] = nBank;
+    ++g_dwRomCacheFills[nKind];
+  }
+
+  pCache->pdwUsed[nSlot] = ++s_dwStamp;
+  return pCache->pbySlots + nSlot * pCache->dwBankSize;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_RomPage() : The address of an 8 KB PRG bank      */
+/*                                                                   */
+/*===================================================================*/
+BYTE *__not_in_flash_func(InfoNES_RomPage)(int nPage)
+{
+  if (s_pbyImage == NULL)
+    return &ROM[nPage * 0x2000];
+  return InfoNES_RomCacheBank(0, nPage);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_VRomPage() : The address of a 1 KB CHR bank      */
+/*                                                                   */
+/*===================================================================*/
+BYTE *__not_in_flash_func(InfoNES_VRomPage)(int nPage)
+{
+  if (s_pbyImage == NULL)
+    return &VROM[nPage * 0x400];
+  return InfoNES_RomCacheBank(1, nPage);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_RomCacheOffset() : A slot pointer as an image offset  */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_RomCacheOffset(int nKind, const BYTE *pbyPtr)
+{
+  const struct rom_cache_tag *pCache = &s_RomCache[nKind];
+  if (s_pbyImage == NULL || pbyPtr < pCache->pbySlots ||
+      pbyPtr >= pCache->pbySlots + pCache->nSlots * pCache->dwBankSize)
+    return -1;
+
+  const int nSlot = (pbyPtr - pCache->pbySlots) / pCache->dwBankSize;
+  if (pCache->pnBankOf[nSlot] < 0)
+    return -1;
+  return pCache->pnBankOf[nSlot] * pCache->dwBankSize + (pbyPtr - pCache->pbySlots) % pCache->dwBankSize;
+}
+
+#endif /* ROM_LZ4 */
@@ -0,0 +1,72 @@
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_RomCache.h : Bank cache for LZ4 packed ROM images        */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef InfoNES_ROMCACHE_H_INCLUDED
+#define InfoNES_ROMCACHE_H_INCLUDED
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include "InfoNES_Types.h"
+
+/*-------------------------------------------------------------------*/
+/*  Constants                                                        */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  Slots of decoded banks. A mapper keeps up to five PRG banks
+ *  ( ROMBANK0-3, SRAMBANK ) and sixteen CHR banks ( PPUBANK ) mapped,
+ *  and those are never evicted, so one more is the least that works.
+ */
+#ifndef ROM_CACHE_PRG
+#define ROM_CACHE_PRG 8 /* 8 KB each */
+#endif
+#ifndef ROM_CACHE_CHR
+#define ROM_CACHE_CHR 32 /* 1 KB each */
+#endif
+
+#if ROM_CACHE_PRG < 6 || ROM_CACHE_CHR < 17
+#error "ROM_CACHE_PRG needs at least 6 slots, ROM_CACHE_CHR at least 17"
+#endif
+
+/*-------------------------------------------------------------------*/
+/*  Function prototypes                                              */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  An image packed by tools/convert_roms.py --lz4 ( src/rom_pack.h ):
+ *  the iNES header and trainer, a table of bank offsets, then every
+ *  8 KB PRG and 1 KB CHR bank as an LZ4 block of its own. Banks are
+ *  decoded into RAM slots as the mapper asks for them, through
+ *  ROMPAGE() / VROMPAGE(), and the least recently mapped slot that no
+ *  bank pointer refers to is refilled on a miss.
+ *
+ *  Return values
+ *     0 : Normally
+ *    -1 : The bank table does not fit the image
+ */
+int InfoNES_RomCacheOpen(const BYTE *pbyImage, DWORD dwSize);
+
+/* Back to the flat ROM / VROM arrays */
+void InfoNES_RomCacheClose();
+
+/* An 8 KB PRG bank and a 1 KB CHR bank, from the cache when one is open */
+BYTE *InfoNES_RomPage(int nPage);
+BYTE *InfoNES_VRomPage(int nPage);
+
+/*
+ *  Where a pointer into a slot is in the image: the byte offset in
+ *  PRG ( nKind 0 ) or CHR ( nKind 1 ), as if the image were flat.
+ *  -1 when the pointer is not in a slot of the open image. Save
+ *  states store this in place of the address.
+ */
+int InfoNES_RomCacheOffset(int nKind, const BYTE *pbyPtr);
+
+/* Banks decoded since the open, PRG and CHR */
+extern DWORD g_dwRomCacheFills[2];
+
+#endif /* !InfoNES_ROMCACHE_H_INCLUDED */
@@ -0,0 +1,645 @@
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_State.cpp : Save states                                  */
+/*                                                                   */
+/*===================================================================*/
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include "InfoNES_State.h"
+#include "InfoNES.h"
+#include "InfoNES_Mapper.h"
+#include "InfoNES_System.h"
+#include "InfoNES_pAPU.h"
+#include "K6502.h"
+#ifdef ROM_LZ4
+#include "InfoNES_RomCache.h"
+#endif
+#include <stdint.h>
+#include <string.h>
+
+/* CPU registers ( K6502.cpp ) */
+extern BYTE SP, F, A, X, Y;
+extern BYTE IRQ_Wiring, NMI_Wiring;
+extern int g_wPassedClocks, g_wCurrentClocks;
+
+/* PPU state without a declaration in InfoNES.h */
+extern int SpriteJustHit;
+
+/*-------------------------------------------------------------------*/
+/*  Constants                                                        */
+/*-------------------------------------------------------------------*/
+
+#define STATE_TAG(a, b, c, d) ((DWORD)(a) | ((DWORD)(b) << 8) | ((DWORD)(c) << 16) | ((DWORD)(d) << 24))
+
+/* Magic, version, mapper, PRG and CHR size, reserved */
+#define STATE_HEADER_SIZE 12
+/* Tag and length in front of each chunk */
+#define STATE_CHUNK_HEAD 8
+
+/*
+ *  A bank pointer is stored as what it points into, in the top byte,
+ *  and the offset in there. PRG and CHR offsets are the same whether
+ *  the image is flat or cached ( ROM_LZ4 ).
+ */
+#define STATE_REF_PRG 0
+#define STATE_REF_CHR 1
+#define STATE_REF_PPURAM 2
+#define STATE_REF_SRAM 3
+#define STATE_REF_RAM 4
+#define STATE_REF_MAPPER 5 /* + the region the mapper registered */
+#define STATE_REF_NULL 0xffffffff
+
+#define STATE_REGIONS 2
+
+/* ROMBANK0-3, SRAMBANK and PPUBANK */
+#define STATE_BANKS (4 + 1 + 16)
+
+/*-------------------------------------------------------------------*/
+/*  State resources                                                  */
+/*-------------------------------------------------------------------*/
+
+/* Mapper RAM the bank pointers may point into, registered by MAPR */
+static struct
+{
+  BYTE *pbyMem;
+  DWORD dwSize;
+} s_Regions[STATE_REGIONS];
+static int s_nRegions;
+
+/*===================================================================*/
+/*                                                                   */
+/*                 Serializer : Fields in either direction           */
+/*                                                                   */
+/*===================================================================*/
+
+void InfoNES_StateBytes(struct InfoNES_State_tag *pState, void *pData, DWORD dwSize)
+{
+  if (pState->pbyPos != NULL)
+  {
+    if ((DWORD)(pState->pbyEnd - pState->pbyPos) < dwSize)
+    {
+      pState->byError = 1;
+      return;
+    }
+
+    if (pState->byLoad)
+      memcpy(pData, pState->pbyPos, dwSize);
+    else
+      memcpy(pState->pbyPos, pData, dwSize);
+    pState->pbyPos += dwSize;
+  }
+  pState->dwSize += dwSize;
+}
+
+/* nBytes of dwData, little-endian */
+static void InfoNES_StateInt(struct InfoNES_State_tag *pState, DWORD &dwData, int nBytes)
+{
+  BYTE byData[4];
+
+  for (int nIdx = 0; nIdx < nBytes; ++nIdx)
+    byData[nIdx] = (BYTE)(dwData >> (nIdx * 8));
+
+  InfoNES_StateBytes(pState, byData, nBytes);
+
+  if (pState->byLoad && !pState->byError)
+  {
+    dwData = 0;
+    for (int nIdx = 0; nIdx < nBytes; ++nIdx)
+      dwData |= (DWORD)byData[nIdx] << (nIdx * 8);
+  }
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, BYTE &byData)
+{
+  InfoNES_StateBytes(pState, &byData, 1);
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, bool &bData)
+{
+  DWORD dwData = bData;
+  InfoNES_StateInt(pState, dwData, 1);
+  bData = dwData != 0;
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, WORD &wData)
+{
+  DWORD dwData = wData;
+  InfoNES_StateInt(pState, dwData, 2);
+  wData = (WORD)dwData;
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, short &sData)
+{
+  DWORD dwData = (WORD)sData;
+  InfoNES_StateInt(pState, dwData, 2);
+  sData = (short)(int16_t)dwData;
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, unsigned int &nData)
+{
+  DWORD dwData = nData;
+  InfoNES_StateInt(pState, dwData, 4);
+  nData = (unsigned int)dwData;
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, int &nData)
+{
+  DWORD dwData = (uint32_t)nData;
+  InfoNES_StateInt(pState, dwData, 4);
+  nData = (int)(int32_t)dwData;
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, unsigned long &dwData)
+{
+  DWORD dwValue = (uint32_t)dwData;
+  InfoNES_StateInt(pState, dwValue, 4);
+  dwData = dwValue;
+}
+
+void InfoNES_StateField(struct InfoNES_State_tag *pState, long &lData)
+{
+  DWORD dwData = (uint32_t)lData;
+  InfoNES_StateInt(pState, dwData, 4);
+  lData = (long)(int32_t)dwData;
+}
+
+static void InfoNES_StateAddRegion(struct InfoNES_State_tag *pState, BYTE *pbyMem, DWORD dwSize)
+{
+  if (s_nRegions == STATE_REGIONS)
+  {
+    pState->byError = 1;
+    return;
+  }
+  s_Regions[s_nRegions].pbyMem = pbyMem;
+  s_Regions[s_nRegions].dwSize = dwSize;
+  ++s_nRegions;
+}
+
+void InfoNES_StateMemory(struct InfoNES_State_tag *pState, BYTE *pbyMem, DWORD dwSize)
+{
+  InfoNES_StateAddRegion(pState, pbyMem, dwSize);
+  InfoNES_StateBytes(pState, pbyMem, dwSize);
+}
+
+void InfoNES_StateRegion(struct InfoNES_State_tag *pState, BYTE *pbyMem, DWORD dwSize)
+{
+  InfoNES_StateAddRegion(pState, pbyMem, dwSize);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_StateArea() : What a bank reference points into  */
+/*                                                                   */
+/*===================================================================*/
+static BYTE *InfoNES_StateArea(int nKind, DWORD *pdwSize)
+{
+  switch (nKind)
+  {
+  case STATE_REF_PRG:
+    *pdwSize = NesHeader.byRomSize * 0x4000;
+    return ROM;
+
+  case STATE_REF_CHR:
+    *pdwSize = NesHeader.byVRomSize * 0x2000;
+    return VROM;
+
+  case STATE_REF_PPURAM:
+    *pdwSize = PPURAM_SIZE;
+    return PPURAM;
+
+  case STATE_REF_SRAM:
+    *pdwSize = SRAM_SIZE;
+    return SRAM;
+
+  case STATE_REF_RAM:
+    *pdwSize = RAM_SIZE;
+    return RAM;
+  }
+
+  nKind -= STATE_REF_MAPPER;
+  if (nKind >= s_nRegions)
+  {
+    *pdwSize = 0;
+    return NULL;
+  }
+  *pdwSize = s_Regions[nKind].dwSize;
+  return s_Regions[nKind].pbyMem;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_StateRefOf() : A bank pointer as a reference     */
+/*                                                                   */
+/*===================================================================*/
+static DWORD InfoNES_StateRefOf(const BYTE *pbyPtr)
+{
+  if (pbyPtr == NULL)
+    return STATE_REF_NULL;
+
+#ifdef ROM_LZ4
+  for (int nKind = STATE_REF_PRG; nKind <= STATE_REF_CHR; ++nKind)
+  {
+    int nOffset = InfoNES_RomCacheOffset(nKind, pbyPtr);
+    if (nOffset >= 0)
+      return ((DWORD)nKind << 24) | (DWORD)nOffset;
+  }
+#endif
+
+  for (int nKind = STATE_REF_PRG; nKind < STATE_REF_MAPPER + s_nRegions; ++nKind)
+  {
+    DWORD dwSize;
+    const BYTE *pbyBase = InfoNES_StateArea(nKind, &dwSize);
+    if (pbyBase != NULL && pbyPtr >= pbyBase && pbyPtr < pbyBase + dwSize)
+      return ((DWORD)nKind << 24) | (DWORD)(pbyPtr - pbyBase);
+  }
+
+  // Points somewhere a state cannot follow
+  return STATE_REF_NULL - 1;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_StateRefValid() : The reference can be followed  */
+/*                                                                   */
+/*===================================================================*/
+static bool InfoNES_StateRefValid(DWORD dwRef)
+{
+  if (dwRef == STATE_REF_NULL)
+    return true;
+
+  DWORD dwSize;
+  const BYTE *pbyBase = InfoNES_StateArea(dwRef >> 24, &dwSize);
+#ifdef ROM_LZ4
+  if ((dwRef >> 24) <= STATE_REF_CHR)
+    return (dwRef & 0xffffff) < dwSize;
+#endif
+  return pbyBase != NULL && (dwRef & 0xffffff) < dwSize;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_StatePtrOf() : A valid reference as a pointer    */
+/*                                                                   */
+/*===================================================================*/
+static BYTE *InfoNES_StatePtrOf(DWORD dwRef)
+{
+  if (dwRef == STATE_REF_NULL)
+    return NULL;
+
+  const DWORD dwOffset = dwRef & 0xffffff;
+  switch (dwRef >> 24)
+  {
+  case STATE_REF_PRG:
+    // Through the bank cache when the image is packed
+    return ROMPAGE(dwOffset >> 13) + (dwOffset & 0x1fff);
+
+  case STATE_REF_CHR:
+    return VROMPAGE(dwOffset >> 10) + (dwOffset & 0x3ff);
+  }
+
+  DWORD dwSize;
+  return InfoNES_StateArea(dwRef >> 24, &dwSize) + dwOffset;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*                     Chunks : One per part of the NES              */
+/*                                                                   */
+/*===================================================================*/
+
+static void InfoNES_StateCpu(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateField(pState, PC);
+  InfoNES_StateField(pState, SP);
+  InfoNES_StateField(pState, F);
+  InfoNES_StateField(pState, A);
+  InfoNES_StateField(pState, X);
+  InfoNES_StateField(pState, Y);
+  InfoNES_StateField(pState, IRQ_State);
+  InfoNES_StateField(pState, IRQ_Wiring);
+  InfoNES_StateField(pState, NMI_State);
+  InfoNES_StateField(pState, NMI_Wiring);
+  InfoNES_StateField(pState, g_wPassedClocks);
+  InfoNES_StateField(pState, g_wCurrentClocks);
+}
+
+static void InfoNES_StatePad(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateField(pState, PAD1_Latch);
+  InfoNES_StateField(pState, PAD2_Latch);
+  InfoNES_StateField(pState, PAD_System);
+  InfoNES_StateField(pState, PAD1_Bit);
+  InfoNES_StateField(pState, PAD2_Bit);
+}
+
+static void InfoNES_StateRam(struct InfoNES_State_tag *pState)
+{
+  // 0x0800 - 0x1fff mirror the first 2 KB
+  InfoNES_StateBytes(pState, RAM, 0x800);
+}
+
+static void InfoNES_StateSram(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateBytes(pState, SRAM, SRAM_SIZE);
+}
+
+static void InfoNES_StatePpu(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateField(pState, PPU_R0);
+  InfoNES_StateField(pState, PPU_R1);
+  InfoNES_StateField(pState, PPU_R2);
+  InfoNES_StateField(pState, PPU_R3);
+  InfoNES_StateField(pState, PPU_R7);
+  InfoNES_StateField(pState, PPU_Addr);
+  InfoNES_StateField(pState, PPU_Temp);
+  InfoNES_StateField(pState, PPU_Latch_Flag);
+  InfoNES_StateField(pState, PPU_Scr_H_Byte);
+  InfoNES_StateField(pState, PPU_Scr_H_Bit);
+  InfoNES_StateField(pState, PPU_NameTableBank);
+  InfoNES_StateField(pState, PPU_Scanline);
+  InfoNES_StateField(pState, PPU_UpDown_Clip);
+  InfoNES_StateField(pState, SpriteJustHit);
+  InfoNES_StateField(pState, byVramWriteEnable);
+  InfoNES_StateField(pState, FrameCnt);
+}
+
+static void InfoNES_StateCram(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateBytes(pState, PPURAM, 0x2000);
+}
+
+static void InfoNES_StateVram(struct InfoNES_State_tag *pState)
+{
+  // 0x3000 - 0x3eff are copies, rebuilt after a load
+  InfoNES_StateBytes(pState, &PPURAM[0x2000], 0x1000);
+}
+
+static void InfoNES_StatePalette(struct InfoNES_State_tag *pState)
+{
+  /*
+   *  PalTable follows the last write to each entry, through any of
+   *  the mirrors at 0x3f20 - 0x3fff, so it is not rebuilt from one
+   *  place in PPURAM. Its values are NesPalette[] indexes.
+   */
+  InfoNES_StateBytes(pState, &PPURAM[0x3f00], 0x100);
+  for (int nIdx = 0; nIdx < 32; ++nIdx)
+    InfoNES_StateField(pState, PalTable[nIdx]);
+}
+
+static void InfoNES_StateOam(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateBytes(pState, SPRRAM, SPRRAM_SIZE);
+}
+
+static void InfoNES_StateApu(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateBytes(pState, APU_Reg, 0x18);
+  InfoNES_StateField(pState, FrameIRQ_Enable);
+  InfoNES_StateField(pState, FrameStep);
+}
+
+static void InfoNES_StateMapper(struct InfoNES_State_tag *pState)
+{
+  const struct MapperDesc_tag *pMapper = InfoNES_GetMapper(MapperNo);
+
+  s_nRegions = 0;
+  if (pMapper->pMapperState != NULL)
+    pMapper->pMapperState(pState);
+}
+
+static void InfoNES_StateBanks(struct InfoNES_State_tag *pState)
+{
+  /*
+   *  Loading checks every reference before it changes a pointer, and
+   *  is the first chunk loaded, so a state that does not fit the ROM
+   *  leaves the game as it was.
+   */
+  BYTE **ppbyBank[STATE_BANKS];
+  DWORD dwRef[STATE_BANKS];
+
+  for (int nIdx = 0; nIdx < 4; ++nIdx)
+    ppbyBank[nIdx] = &ROMBANK[nIdx];
+  ppbyBank[4] = &SRAMBANK;
+  for (int nIdx = 0; nIdx < 16; ++nIdx)
+    ppbyBank[5 + nIdx] = &PPUBANK[nIdx];
+
+  for (int nIdx = 0; nIdx < STATE_BANKS; ++nIdx)
+  {
+    dwRef[nIdx] = InfoNES_StateRefOf(*ppbyBank[nIdx]);
+    InfoNES_StateField(pState, dwRef[nIdx]);
+    if (!InfoNES_StateRefValid(dwRef[nIdx]))
+      pState->byError = 1;
+  }
+
+  if (pState->byLoad && !pState->byError)
+  {
+    // One at a time: the bank cache keeps every slot still pointed at
+    for (int nIdx = 0; nIdx < STATE_BANKS; ++nIdx)
+      *ppbyBank[nIdx] = InfoNES_StatePtrOf(dwRef[nIdx]);
+  }
+}
+
+/* In the order they are saved; MAPR registers the regions BANK refers to */
+static const struct
+{
+  DWORD dwTag;
+  void (*pChunk)(struct InfoNES_State_tag *pState);
+} s_Chunks[] = {
+    {STATE_TAG('C', 'P', 'U', ' '), InfoNES_StateCpu},
+    {STATE_TAG('P', 'A', 'D', ' '), InfoNES_StatePad},
+    {STATE_TAG('R', 'A', 'M', ' '), InfoNES_StateRam},
+    {STATE_TAG('S', 'R', 'A', 'M'), InfoNES_StateSram},
+    {STATE_TAG('P', 'P', 'U', ' '), InfoNES_StatePpu},
+    {STATE_TAG('C', 'R', 'A', 'M'), InfoNES_StateCram},
+    {STATE_TAG('V', 'R', 'A', 'M'), InfoNES_StateVram},
+    {STATE_TAG('P', 'A', 'L', ' '), InfoNES_StatePalette},
+    {STATE_TAG('O', 'A', 'M', ' '), InfoNES_StateOam},
+    {STATE_TAG('A', 'P', 'U', ' '), InfoNES_StateApu},
+    {STATE_TAG('M', 'A', 'P', 'R'), InfoNES_StateMapper},
+    {STATE_TAG('B', 'A', 'N', 'K'), InfoNES_StateBanks},
+};
+
+#define STATE_CHUNKS (int)(sizeof s_Chunks / sizeof s_Chunks[0])
+#define STATE_CHUNK_MAPR (STATE_CHUNKS - 2)
+#define STATE_CHUNK_BANK (STATE_CHUNKS - 1)
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_StateHeader() : What game the state is of        */
+/*                                                                   */
+/*===================================================================*/
+static void InfoNES_StateHeader(struct InfoNES_State_tag *pState, DWORD *pdwMagic, WORD *pwVersion, BYTE *pbyGame)
+{
+  DWORD dwReserved = 0;
+
+  InfoNES_StateField(pState, *pdwMagic);
+  InfoNES_StateField(pState, *pwVersion);
+  InfoNES_StateField(pState, pbyGame[0]);
+  InfoNES_StateField(pState, pbyGame[1]);
+  InfoNES_StateField(pState, pbyGame[2]);
+  InfoNES_StateInt(pState, dwReserved, 3);
+}
+
+/* The chunk size InfoNES saves, counted without touching anything */
+static DWORD InfoNES_StateChunkSize(int nChunk)
+{
+  struct InfoNES_State_tag State = {};
+  s_Chunks[nChunk].pChunk(&State);
+  return State.dwSize;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*              InfoNES_StateSize() : Bytes a state takes            */
+/*                                                                   */
+/*===================================================================*/
+DWORD InfoNES_StateSize()
+{
+  DWORD dwSize = STATE_HEADER_SIZE;
+  for (int nChunk = 0; nChunk < STATE_CHUNKS; ++nChunk)
+    dwSize += STATE_CHUNK_HEAD + InfoNES_StateChunkSize(nChunk);
+  return dwSize;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*              InfoNES_SaveState() : Save the running game          */
+/*                                                                   */
+/*===================================================================*/
+DWORD InfoNES_SaveState(BYTE *pbyBuf, DWORD dwSize)
+{
+  struct InfoNES_State_tag State = {pbyBuf, pbyBuf + dwSize, 0, 0, 0};
+  DWORD dwMagic = STATE_MAGIC;
+  WORD wVersion = STATE_VERSION;
+  BYTE byGame[3] = {MapperNo, NesHeader.byRomSize, NesHeader.byVRomSize};
+
+  InfoNES_StateHeader(&State, &dwMagic, &wVersion, byGame);
+
+  for (int nChunk = 0; nChunk < STATE_CHUNKS; ++nChunk)
+  {
+    DWORD dwTag = s_Chunks[nChunk].dwTag;
+    DWORD dwLength = 0;
+    BYTE *pbyLength;
+
+    InfoNES_StateField(&State, dwTag);
+    pbyLength = State.pbyPos;
+    InfoNES_StateField(&State, dwLength);
+
+    const DWORD dwStart = State.dwSize;
+    s_Chunks[nChunk].pChunk(&State);
+    if (State.byError)
+      return 0;
+
+    // The length is known once the chunk is written
+    struct InfoNES_State_tag Length = {pbyLength, pbyLength + 4, 0, 0, 0};
+    dwLength = State.dwSize - dwStart;
+    InfoNES_StateField(&Length, dwLength);
+  }
+
+  return State.dwSize;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          InfoNES_StateFind() : A chunk of the blob, by its tag    */
+/*                                                                   */
+/*===================================================================*/
+static const BYTE *InfoNES_StateFind(const BYTE *pbyBuf, DWORD dwSize, DWORD dwTag, DWORD *pdwLength)
+{
+  DWORD dwPos = STATE_HEADER_SIZE;
+
+  while (dwPos <= dwSize && dwSize - dwPos >= STATE_CHUNK_HEAD)
+  {
+    struct InfoNES_State_tag Head = {const_cast<BYTE *>(pbyBuf + dwPos), const_cast<BYTE *>(pbyBuf + dwSize), 0, 1, 0};
+    DWORD dwChunkTag = 0, dwLength = 0;
+
+    InfoNES_StateField(&Head, dwChunkTag);
+    InfoNES_StateField(&Head, dwLength);
+    if (Head.byError)
+      return NULL;
+    dwPos += STATE_CHUNK_HEAD;
+    if (dwLength > dwSize - dwPos)
+      return NULL;
+
+    if (dwChunkTag == dwTag)
+    {
+      *pdwLength = dwLength;
+      return pbyBuf + dwPos;
+    }
+    // Skip a chunk a later version added
+    dwPos += dwLength;
+  }
+  return NULL;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*              InfoNES_LoadState() : Load a state                   */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_LoadState(const BYTE *pbyBuf, DWORD dwSize)
+{
+  struct InfoNES_State_tag State = {const_cast<BYTE *>(pbyBuf), const_cast<BYTE *>(pbyBuf + dwSize), 0, 1, 0};
+  DWORD dwMagic = 0;
+  WORD wVersion = 0;
+  BYTE byGame[3] = {};
+
+  InfoNES_StateHeader(&State, &dwMagic, &wVersion, byGame);
+  if (State.byError || dwMagic != STATE_MAGIC || wVersion != STATE_VERSION ||
+      byGame[0] != MapperNo || byGame[1] != NesHeader.byRomSize || byGame[2] != NesHeader.byVRomSize)
+    return -1;
+
+  // Every chunk is there at the size this build saves, before anything changes
+  const BYTE *pbyChunk[STATE_CHUNKS];
+  for (int nChunk = 0; nChunk < STATE_CHUNKS; ++nChunk)
+  {
+    DWORD dwLength;
+    pbyChunk[nChunk] = InfoNES_StateFind(pbyBuf, dwSize, s_Chunks[nChunk].dwTag, &dwLength);
+    if (pbyChunk[nChunk] == NULL || dwLength != InfoNES_StateChunkSize(nChunk))
+      return -1;
+  }
+
+  // The regions of MAPR are registered by counting it above; BANK goes first
+  for (int nStep = 0; nStep < STATE_CHUNKS; ++nStep)
+  {
+    const int nChunk = (nStep == 0) ? STATE_CHUNK_BANK : nStep - 1;
+    const DWORD dwLength = InfoNES_StateChunkSize(nChunk);
+    struct InfoNES_State_tag Chunk = {const_cast<BYTE *>(pbyChunk[nChunk]),
+                                      const_cast<BYTE *>(pbyChunk[nChunk] + dwLength), 0, 1, 0};
+    s_Chunks[nChunk].pChunk(&Chunk);
+    if (Chunk.byError)
+      return -1;
+  }
+
+  // What InfoNES derives from the registers
+  PPU_Increment = (PPU_R0 & R0_INC_ADDR) ? 32 : 1;
+  PPU_BG_Base = (PPU_R0 & R0_BG_ADDR) ? ChrBuf + 256 * 64 : ChrBuf;
+  PPU_SP_Base = (PPU_R0 & R0_SP_ADDR) ? ChrBuf + 256 * 64 : ChrBuf;
+  PPU_SP_Height = (PPU_R0 & R0_SP_SIZE) ? 16 : 8;
+
+  // 0x3000 - 0x3eff hold what the name tables hold
+  for (int nAddr = 0; nAddr < 0xf00; ++nAddr)
+    PPURAM[0x3000 + nAddr] = PPUBANK[NAME_TABLE0 + (nAddr >> 10)][nAddr & 0x3ff];
+
+  /*
+   *  The APU starts over from its registers: the channels play on with
+   *  their length counters reloaded, not from where they were.
+   */
+  if (!APU_Mute)
+  {
+    for (int nReg = 0; nReg < 0x14; ++nReg)
+      pAPUSoundRegs[nReg](0x4000 + nReg, APU_Reg[nReg]);
+  }
+  InfoNES_pAPUWriteControl(0x4015, APU_Reg[0x15] & 0x1f);
+
+  // ROMBANK0-3 were restored, rebuild the page table
+  K6502_MapReset();
+
+  // PPURAM and PPUBANK were replaced under the tile-row cache
+  InfoNES_BgCacheFlush();
+
+  return 0;
+}
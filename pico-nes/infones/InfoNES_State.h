@@ -0,0 +1,108 @@
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_State.h : Save states                                    */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef InfoNES_STATE_H_INCLUDED
+#define InfoNES_STATE_H_INCLUDED
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include "InfoNES_Types.h"
+#include <stddef.h>
+
+/*-------------------------------------------------------------------*/
+/*  Constants                                                        */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  A state is one blob: a header, then chunks of a four character
+ *  tag, a 32-bit length and the payload. Every field has a fixed
+ *  width and is little-endian, so a state moves between the device
+ *  and the host. Bank pointers are stored as offsets into the memory
+ *  they point at ( PRG, CHR, PPU RAM, ... ), never as addresses, and
+ *  nothing InfoNES rebuilds from other state ( the PPU RAM mirrors,
+ *  caches ) is stored. A loader skips the chunks it does not know.
+ */
+#define STATE_MAGIC 0x5353454e /* "NESS" */
+#define STATE_VERSION 1
+
+/*-------------------------------------------------------------------*/
+/*  Serializer                                                       */
+/*-------------------------------------------------------------------*/
+
+/* Handed to InfoNES's own chunks and the mapper's state function */
+struct InfoNES_State_tag
+{
+  BYTE *pbyPos;   /* NULL : Only count the bytes */
+  BYTE *pbyEnd;
+  DWORD dwSize;   /* Bytes written or read so far */
+  BYTE byLoad;    /* 1 : Read the fields back from pbyPos */
+  BYTE byError;   /* Ran past pbyEnd */
+};
+
+/* Raw bytes, in either direction */
+void InfoNES_StateBytes(struct InfoNES_State_tag *pState, void *pData, DWORD dwSize);
+
+/*
+ *  A variable, or an array of them, at the fixed width of its type:
+ *  1 byte for BYTE and bool, 2 for WORD and short, 4 for int, long and
+ *  DWORD, on the host too where long is 8. Pointers have no overload
+ *  on purpose.
+ */
+void InfoNES_StateField(struct InfoNES_State_tag *pState, BYTE &byData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, bool &bData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, WORD &wData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, short &sData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, unsigned int &nData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, int &nData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, unsigned long &dwData);
+void InfoNES_StateField(struct InfoNES_State_tag *pState, long &lData);
+
+template <typename T, size_t N>
+inline void InfoNES_StateField(struct InfoNES_State_tag *pState, T (&aData)[N])
+{
+  for (size_t nIdx = 0; nIdx < N; ++nIdx)
+    InfoNES_StateField(pState, aData[nIdx]);
+}
+
+/*
+ *  Mapper RAM that bank pointers may point into. The contents are
+ *  saved, and a pointer into it is stored as an offset like the ones
+ *  into PRG or PPU RAM. InfoNES_StateRegion() only tells where it is,
+ *  for memory the mapper's init function fills the same every time.
+ *  Up to two per mapper.
+ */
+void InfoNES_StateMemory(struct InfoNES_State_tag *pState, BYTE *pbyMem, DWORD dwSize);
+void InfoNES_StateRegion(struct InfoNES_State_tag *pState, BYTE *pbyMem, DWORD dwSize);
+
+/*-------------------------------------------------------------------*/
+/*  Function prototypes                                              */
+/*-------------------------------------------------------------------*/
+
+/* Bytes a state of the running game takes */
+DWORD InfoNES_StateSize();
+
+/*
+ *  Save the running game, between two frames
+ *
+ *  Return values
+ *     n : Bytes written to pbyBuf
+ *     0 : dwSize is less than InfoNES_StateSize()
+ */
+DWORD InfoNES_SaveState(BYTE *pbyBuf, DWORD dwSize);
+
+/*
+ *  Load a state into the running game, which InfoNES_Reset() started
+ *  from the same ROM
+ *
+ *  Return values
+ *     0 : Normally
+ *    -1 : Not a state, another version, or of another game
+ */
+int InfoNES_LoadState(const BYTE *pbyBuf, DWORD dwSize);
+
+#endif /* !InfoNES_STATE_H_INCLUDED */
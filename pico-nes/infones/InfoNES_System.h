@@ -53,6 +53,11 @@ inline void *InfoNES_MemorySet(void *dest, int c, int count)
     return dest;
 }
 
+/* Copy in the background ( DMA ) for the DPCM prefetch; a new copy
+   waits for the last one, InfoNES_PrefetchBusy() until it has landed */
+void InfoNES_PrefetchStart(void *dest, const void *src, int count);
+bool InfoNES_PrefetchBusy();
+
 /* Print debug message */
 void InfoNES_DebugPrint(const char *pszMsg);
 
@@ -68,8 +73,10 @@ int InfoNES_SoundOpen(int samples_per_sync, int sample_rate);
 /* Sound Close */
 void InfoNES_SoundClose(void);
 
-/* Sound Output 5 Waves - 2 Pulse, 1 Triangle, 1 Noise, 1 DPCM */
-void InfoNES_SoundOutput(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3, const BYTE *wave4, const BYTE *wave5);
+/* Sound Output 5 Waves - 2 Pulse, 1 Triangle, 1 Noise, 1 DPCM,
+   and the expansion chip's wave ( NULL when the cartridge has none ) */
+void InfoNES_SoundOutput(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3, const BYTE *wave4, const BYTE *wave5,
+                         const BYTE *wave6);
 int InfoNES_GetSoundBufferSize();
 
 /* Print system message */
@@ -14,27 +14,103 @@
 #include "InfoNES_System.h"
 #include "InfoNES_pAPU.h"
 #include <algorithm>
+#include <math.h>
 #include <string.h>
 
 /*-------------------------------------------------------------------*/
 /*   APU Event resources                                             */
 /*-------------------------------------------------------------------*/
 
+#ifdef APU_THREAD
+/* Free-running, they wrap: only differences and != compare them */
+typedef unsigned int ApuEventIndex_t;
+#else
+typedef int ApuEventIndex_t;
+#endif
+
 struct ApuEvent_t ApuEventQueue[APU_EVENT_MAX];
-int cur_event;
+ApuEventIndex_t cur_event; /* Events written, index & APU_EVENT_MASK */
 WORD entertime;
 
+#ifdef APU_FRAME
+/*
+ *  The whole frame is rendered at Vsync. InfoNES_pAPUHsync() only
+ *  closes each scanline with an APUET_SYNC event carrying its sample
+ *  count; the events from ApuEventTail up to ApuSyncEvent are complete
+ *  scanlines waiting to be rendered.
+ */
+static ApuEventIndex_t ApuEventTail; /* First event not rendered yet */
+static ApuEventIndex_t ApuSyncEvent; /* One past the last APUET_SYNC */
+static WORD ApuSyncTime;   /* Clock of the last APUET_SYNC */
+static int ApuSyncSamples; /* Samples of the scanlines up to ApuSyncEvent */
+static int ApuSyncLines;   /* Scanlines up to ApuSyncEvent */
+static bool ApuSyncEnabled;
+
+static void ApuRenderingFrame();
+#endif
+
+#ifdef APU_THREAD
+/*
+ *  The ring is a single-producer, single-consumer queue: core0 appends
+ *  and moves cur_event, InfoNES_pAPUProcess() renders and moves
+ *  ApuEventTail. Scanlines and frames are closed by APUET_SYNC and
+ *  APUET_VSYNC events, so the consumer needs nothing else from core0.
+ */
+static ApuEventIndex_t ApuScanEvent; /* First event the consumer has not seen */
+static ApuEventIndex_t ApuScanDone;  /* ApuScanEvent, published when it returns */
+
+/* InfoNES_pAPUInit() and InfoNES_pAPUSetExt() stop the consumer first */
+static bool ApuHold;
+static bool ApuBusy;
+
+static void ApuThreadPause()
+{
+  __atomic_store_n(&ApuHold, true, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&ApuBusy, __ATOMIC_SEQ_CST))
+    ;
+}
+
+static void ApuThreadResume()
+{
+  __atomic_store_n(&ApuHold, false, __ATOMIC_SEQ_CST);
+}
+
+static void ApuStatusWrite(BYTE type, BYTE data);
+#endif
+
 /*-------------------------------------------------------------------*/
 /*   APU Register Write Functions                                    */
 /*-------------------------------------------------------------------*/
 
-#define APU_WRITEFUNC(name, evtype)                                \
-  void ApuWrite##name(WORD addr, BYTE value)                       \
-  {                                                                \
-    ApuEventQueue[cur_event].time = getPassedClocks() - entertime; \
-    ApuEventQueue[cur_event].type = APUET_W_##evtype;              \
-    ApuEventQueue[cur_event].data = value;                         \
-    cur_event++;                                                   \
+static inline void __not_in_flash_func(ApuEventPush)(BYTE type, BYTE data)
+{
+#ifdef APU_THREAD
+  ApuStatusWrite(type, data);
+
+  /* A full ring waits for the consumer, which renders long before that */
+  while (cur_event - __atomic_load_n(&ApuEventTail, __ATOMIC_ACQUIRE) == APU_EVENT_MAX)
+    ;
+#elif defined(APU_FRAME)
+  /* A full ring renders the finished scanlines early instead of overflowing */
+  if (cur_event - ApuEventTail == APU_EVENT_MAX)
+    ApuRenderingFrame();
+#endif
+  /* Per scanline, the ring is emptied long before 114 clocks of writes fill it */
+  ApuEvent_t &ev = ApuEventQueue[cur_event & APU_EVENT_MASK];
+  ev.time = getPassedClocks() - entertime;
+  ev.type = type;
+  ev.data = data;
+#ifdef APU_THREAD
+  __atomic_store_n(&cur_event, cur_event + 1, __ATOMIC_RELEASE);
+#else
+  cur_event++;
+#endif
+}
+
+#define APU_WRITEFUNC(name, evtype)                \
+  void ApuWrite##name(WORD addr, BYTE value)       \
+  {                                                \
+    ApuEventPush(APUET_W_##evtype, value);         \
   }
 
 // 普通にバグってる
@@ -61,10 +137,158 @@ APU_WRITEFUNC(C4d, C4D);
 
 APU_WRITEFUNC(C5a, C5A);
 APU_WRITEFUNC(C5b, C5B);
-APU_WRITEFUNC(C5c, C5C);
-APU_WRITEFUNC(C5d, C5D);
 
-APU_WRITEFUNC(Control, CTRL);
+/*-------------------------------------------------------------------*/
+/*   DPCM prefetch                                                   */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  On the device the PRG ROM is XIP flash, and the DMC reading its
+ *  sample a byte at a time from the render loop can miss the cache on
+ *  every byte. So once $4012 / $4013 have been written, the sample they
+ *  point at is copied into an SRAM slot in the background
+ *  ( InfoNES_PrefetchStart() ), and an APUET_DPCM event names the slot;
+ *  the channel plays from the slot once the copy has landed, and
+ *  through the CPU map until then. The copy starts at the next $4015
+ *  write, which is what starts a sample, or at the end of the scanline,
+ *  so the usual $4012, $4013 pair costs one copy. Slots are tagged by
+ *  the ROM they were copied from, so a drum kit is copied once and
+ *  stays. The banks are those of the write, not of the playback; the
+ *  games keep their samples in a fixed bank.
+ */
+#define APU_DPCM_SLOTS 4 /* Two bits of the APUET_DPCM data */
+#define APU_DPCM_BYTES ((0xff << 4) + 1)
+#define APU_DPCM_GEN_MASK 0x3f
+
+struct ApuDpcmSlot_t
+{
+  const BYTE *src[3]; /* The sample in each 8 KB bank it touches */
+  int len;
+  BYTE state; /* gen << 1 | landed */
+  DWORD used; /* LRU stamp */
+  BYTE buf[APU_DPCM_BYTES];
+};
+
+static ApuDpcmSlot_t ApuDpcmSlot[APU_DPCM_SLOTS];
+static BYTE ApuDpcmReg[2]; /* $4012, $4013 as written */
+static bool ApuDpcmDirty;  /* Written since the last prefetch */
+static int ApuDpcmPending = -1; /* Slot whose copy is in flight */
+static DWORD ApuDpcmStamp;
+
+static void ApuDpcmLanded()
+{
+  if (ApuDpcmPending >= 0 && !InfoNES_PrefetchBusy())
+  {
+    ApuDpcmSlot_t &slot = ApuDpcmSlot[ApuDpcmPending];
+    __atomic_store_n(&slot.state, slot.state | 1, __ATOMIC_RELEASE);
+    ApuDpcmPending = -1;
+  }
+}
+
+static void ApuDpcmPrefetch()
+{
+  /* The sample by 8 KB bank; past $FFFF it wraps to $8000 */
+  const BYTE *src[3] = {};
+  int count[3] = {};
+  const int len = (ApuDpcmReg[1] << 4) + 1;
+  WORD addr = 0xC000 + (WORD)(ApuDpcmReg[0] << 6);
+  for (int i = 0, left = len; left; i++)
+  {
+    const int offset = addr & 0x1fff;
+    count[i] = std::min(left, 0x2000 - offset);
+    src[i] = ROMBANK[(addr >> 13) & 3] + offset;
+    left -= count[i];
+    addr += count[i];
+    if (addr < 0x8000)
+      addr += 0x8000;
+  }
+
+  int index = 0;
+  for (int i = 0; i < APU_DPCM_SLOTS; i++)
+  {
+    const ApuDpcmSlot_t &slot = ApuDpcmSlot[i];
+    if (slot.len == len && slot.src[0] == src[0] && slot.src[1] == src[1] && slot.src[2] == src[2])
+    {
+      index = i;
+      goto found;
+    }
+    if (slot.used < ApuDpcmSlot[index].used)
+      index = i;
+  }
+
+  /* Refill the least recently used slot */
+  {
+    while (ApuDpcmPending >= 0)
+      ApuDpcmLanded();
+
+    ApuDpcmSlot_t &slot = ApuDpcmSlot[index];
+    const BYTE gen = ((slot.state >> 1) + 1) & APU_DPCM_GEN_MASK;
+    __atomic_store_n(&slot.state, gen << 1, __ATOMIC_RELEASE);
+    slot.len = len;
+    BYTE *dest = slot.buf;
+    for (int i = 0; i < 3; i++)
+    {
+      slot.src[i] = src[i];
+      if (count[i])
+        InfoNES_PrefetchStart(dest, src[i], count[i]);
+      dest += count[i];
+    }
+    ApuDpcmPending = index;
+    ApuDpcmLanded();
+  }
+
+found:
+  ApuDpcmDirty = false;
+  ApuDpcmSlot[index].used = ++ApuDpcmStamp;
+  ApuEventPush(APUET_DPCM, index | (ApuDpcmSlot[index].state >> 1) << 2);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_pAPUForgetBank() : A PRG bank's memory now holds another */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_pAPUForgetBank(const BYTE *pbyBank)
+{
+  /*
+   *  Slots copied from it are tagged by its address and would match
+   *  the next sample there ( ROM_LZ4 bank cache refilling a slot ).
+   *  The copies already made stay good for the sample playing.
+   */
+  while (ApuDpcmPending >= 0)
+    ApuDpcmLanded();
+  for (int i = 0; i < APU_DPCM_SLOTS; i++)
+  {
+    ApuDpcmSlot_t &slot = ApuDpcmSlot[i];
+    for (int j = 0; j < 3; j++)
+    {
+      if (slot.src[j] >= pbyBank && slot.src[j] < pbyBank + 0x2000)
+        slot.len = 0;
+    }
+  }
+}
+
+void ApuWriteC5c(WORD addr, BYTE value)
+{
+  ApuEventPush(APUET_W_C5C, value);
+  ApuDpcmReg[0] = value;
+  ApuDpcmDirty = true;
+}
+
+void ApuWriteC5d(WORD addr, BYTE value)
+{
+  ApuEventPush(APUET_W_C5D, value);
+  ApuDpcmReg[1] = value;
+  ApuDpcmDirty = true;
+}
+
+void ApuWriteControl(WORD addr, BYTE value)
+{
+  if (ApuDpcmDirty)
+    ApuDpcmPrefetch();
+  ApuEventPush(APUET_W_CTRL, value);
+}
+
 
 ApuWritefunc pAPUSoundRegs[20] =
     {
@@ -90,11 +314,23 @@ ApuWritefunc pAPUSoundRegs[20] =
         ApuWriteC5d,
 };
 
+void InfoNES_pAPUWriteExt(BYTE reg, BYTE data)
+{
+  ApuEventPush(APUET_EXT | reg, data);
+}
+
 /*-------------------------------------------------------------------*/
 /*   APU resources                                                   */
 /*-------------------------------------------------------------------*/
 
-BYTE wave_buffers[5][735]; /* 44100 / 60 = 735 samples per sync */
+/* 114 * 262 / 40 = 746.7 samples per frame ( see ApuQual ), with room */
+#define APU_WAVE_SAMPLES 760
+
+BYTE wave_buffers[5][APU_WAVE_SAMPLES];
+
+/* Expansion chip of the cartridge, if any, and its wave */
+static const ApuExt_t *ApuExt;
+static BYTE ApuExtWave[APU_WAVE_SAMPLES];
 
 BYTE ApuCtrl;
 BYTE ApuCtrlNew;
@@ -123,20 +359,16 @@ struct ApuQualityData_t
   unsigned int sample_rate;
   DWORD cycle_rate;
 } ApuQual[] = {
-    // {0xa2567000, 0xa2567000, 0xa2567000, 183, 164, 11025, 1062658},
-    // {0x512b3800, 0x512b3800, 0x512b3800, 367, 82, 22050, 531329},
-    // {0x289d9c00, 0x289d9c00, 0x289d9c00, 735, 41, 44100, 265664},
-    {0xa2567000, 0xa2567000, 0xa2567000, 45963, 164, 11025, 664935},
-    {0x512b3800, 0x512b3800, 0x512b3800, 91926, 82, 22050, 1329870},
-    {0x289d9c00, 0x289d9c00, 0x289d9c00, 184402, 41, 44100, 2659741},
+    {0xa0000000, 0xa0000000, 0xa0000000, 46694, 160, 11186, 10485760},
+    {0x50000000, 0x50000000, 0x50000000, 93389, 80, 22372, 5242880},
+    {0x28000000, 0x28000000, 0x28000000, 186778, 40, 44744, 2621440},
 };
 
-// 44100/60/262*65536 = 183850.99236641222
-// (44100*1.001)/60/262*65536 = 184034.84335877863
-// (44100*1.003)/60/262*65536 = 184402.54534351142
-
-// cycle_rate
-// 1789773 / 44100 * 65536 = 2659740.665034014
+// A whole number of CPU clocks per sample, so every rate and pitch is
+// exact; the platform resamples to its output rate
+// magic: clocks << 24, cycle_rate: clocks << 16
+// samples_per_sync_16: STEP_PER_SCANLINE / clocks * 65536
+// sample_rate: 1789773 / clocks
 
 /*-------------------------------------------------------------------*/
 /*  Rectangle Wave #1 resources                                      */
@@ -207,6 +439,8 @@ int ApuC5Phaseacc;
 
 WORD ApuC5Address, ApuC5CacheAddr;
 int ApuC5DmaLength, ApuC5CacheDmaLength;
+int ApuC5Slot, ApuC5CacheSlot; /* APUET_DPCM data, -1 before any */
+int ApuC5Offset;               /* Bytes of the sample fetched */
 
 /*-------------------------------------------------------------------*/
 /*  Wave Data                                                        */
@@ -465,66 +699,71 @@ DWORD __not_in_flash_func(ApuDpcmCycles)[16] =
 /* Write registers of rectangular wave #1                            */
 /*-------------------------------------------------------------------*/
 
-int __not_in_flash_func(ApuWriteWave1)(int cycles, int event)
+static inline void __not_in_flash_func(ApuWriteEvent1)(const ApuEvent_t &ev)
 {
-  /* APU Reg Write Event */
-  while ((event < cur_event) && (ApuEventQueue[event].time < cycles))
+  if ((ev.type & APUET_MASK) == APUET_C1)
   {
-    if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C1)
+    switch (ev.type & 0x03)
     {
-      switch (ApuEventQueue[event].type & 0x03)
-      {
-      case 0:
-        ApuC1a = ApuEventQueue[event].data;
-        ApuC1Wave = pulse_waves[ApuC1DutyCycle >> 6];
-        break;
-
-      case 1:
-        ApuC1b = ApuEventQueue[event].data;
-        break;
+    case 0:
+      ApuC1a = ev.data;
+      ApuC1Wave = pulse_waves[ApuC1DutyCycle >> 6];
+      break;
 
-      case 2:
-        ApuC1c = ApuEventQueue[event].data;
-        ApuC1Freq = ((((WORD)ApuC1d & 0x07) << 8) + ApuC1c);
-        ApuC1Atl = ApuAtl[(ApuC1d & 0xf8) >> 3];
+    case 1:
+      ApuC1b = ev.data;
+      break;
 
-        if (ApuC1Freq)
-        {
-          ApuC1Skip = ApuPulseMagic / (ApuC1Freq / 2);
-        }
-        else
-        {
-          ApuC1Skip = 0;
-        }
-        break;
+    case 2:
+      ApuC1c = ev.data;
+      ApuC1Freq = ((((WORD)ApuC1d & 0x07) << 8) + ApuC1c);
+      ApuC1Atl = ApuAtl[(ApuC1d & 0xf8) >> 3];
 
-      case 3:
-        ApuC1d = ApuEventQueue[event].data;
-        ApuC1Freq = ((((WORD)ApuC1d & 0x07) << 8) + ApuC1c);
-        ApuC1Atl = ApuAtl[(ApuC1d & 0xf8) >> 3];
+      if (ApuC1Freq)
+      {
+        ApuC1Skip = ApuPulseMagic / (ApuC1Freq / 2);
+      }
+      else
+      {
+        ApuC1Skip = 0;
+      }
+      break;
 
-        if (ApuC1Freq)
-        {
-          ApuC1Skip = ApuPulseMagic / (ApuC1Freq / 2);
-        }
-        else
-        {
-          ApuC1Skip = 0;
-        }
+    case 3:
+      ApuC1d = ev.data;
+      ApuC1Freq = ((((WORD)ApuC1d & 0x07) << 8) + ApuC1c);
+      ApuC1Atl = ApuAtl[(ApuC1d & 0xf8) >> 3];
 
-        ApuC1EnvVol = 15;
-        break;
+      if (ApuC1Freq)
+      {
+        ApuC1Skip = ApuPulseMagic / (ApuC1Freq / 2);
       }
-    }
-    else if (ApuEventQueue[event].type == APUET_W_CTRL)
-    {
-      ApuCtrlNew = ApuEventQueue[event].data;
-
-      if (!(ApuEventQueue[event].data & (1 << 0)))
+      else
       {
-        ApuC1Atl = 0;
+        ApuC1Skip = 0;
       }
+
+      ApuC1EnvVol = 15;
+      break;
     }
+  }
+  else if (ev.type == APUET_W_CTRL)
+  {
+    ApuCtrlNew = ev.data;
+
+    if (!(ev.data & (1 << 0)))
+    {
+      ApuC1Atl = 0;
+    }
+  }
+}
+
+ApuEventIndex_t __not_in_flash_func(ApuWriteWave1)(int cycles, ApuEventIndex_t event)
+{
+  /* APU Reg Write Event */
+  while ((event < cur_event) && (ApuEventQueue[event & APU_EVENT_MASK].time < cycles))
+  {
+    ApuWriteEvent1(ApuEventQueue[event & APU_EVENT_MASK]);
     event++;
   }
   return event;
@@ -534,11 +773,8 @@ int __not_in_flash_func(ApuWriteWave1)(int cycles, int event)
 /* Rendering rectangular wave #1                                     */
 /*-------------------------------------------------------------------*/
 
-void __not_in_flash_func(ApuRenderingWave1)(int n)
+static void __not_in_flash_func(ApuRenderWave1)(BYTE *wave, int n)
 {
-  ApuCtrlNew = ApuCtrl;
-  ApuWriteWave1(ApuCyclesPerSample * (n + 1), 0);
-
   if ((ApuCtrlNew & 0x01) && (ApuC1Atl || ApuC1Hold) &&
       !(ApuC1Freq < 8 || (!ApuC1SweepIncDec && ApuC1Freq > ApuC1FreqLimit)))
   {
@@ -548,15 +784,22 @@ void __not_in_flash_func(ApuRenderingWave1)(int n)
       /* Wave Rendering */
       ApuC1Index += ApuC1Skip;
       ApuC1Index &= 0x1fffffff;
-      wave_buffers[0][i] = ApuC1Wave[ApuC1Index >> 24] * vol;
+      wave[i] = ApuC1Wave[ApuC1Index >> 24] * vol;
     }
   }
   else
   {
-    memset(wave_buffers[0], 0, 2 * n);
+    memset(wave, 0, n);
   }
 }
 
+void __not_in_flash_func(ApuRenderingWave1)(int n)
+{
+  ApuCtrlNew = ApuCtrl;
+  ApuWriteWave1(ApuCyclesPerSample * (n + 1), 0);
+  ApuRenderWave1(wave_buffers[0], n);
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*      ApuRenderingWave2() : Rendering Rectangular Wave #2          */
@@ -567,65 +810,70 @@ void __not_in_flash_func(ApuRenderingWave1)(int n)
 /* Write registers of rectangular wave #2                           */
 /*-------------------------------------------------------------------*/
 
-int __not_in_flash_func(ApuWriteWave2)(int cycles, int event)
+static inline void __not_in_flash_func(ApuWriteEvent2)(const ApuEvent_t &ev)
 {
-  /* APU Reg Write Event */
-  while ((event < cur_event) && (ApuEventQueue[event].time < cycles))
+  if ((ev.type & APUET_MASK) == APUET_C2)
   {
-    if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C2)
+    switch (ev.type & 0x03)
     {
-      switch (ApuEventQueue[event].type & 0x03)
-      {
-      case 0:
-        ApuC2a = ApuEventQueue[event].data;
-        ApuC2Wave = pulse_waves[ApuC2DutyCycle >> 6];
-        break;
+    case 0:
+      ApuC2a = ev.data;
+      ApuC2Wave = pulse_waves[ApuC2DutyCycle >> 6];
+      break;
 
-      case 1:
-        ApuC2b = ApuEventQueue[event].data;
-        break;
+    case 1:
+      ApuC2b = ev.data;
+      break;
 
-      case 2:
-        ApuC2c = ApuEventQueue[event].data;
-        ApuC2Freq = ((((WORD)ApuC2d & 0x07) << 8) + ApuC2c);
-        ApuC2Atl = ApuAtl[(ApuC2d & 0xf8) >> 3];
+    case 2:
+      ApuC2c = ev.data;
+      ApuC2Freq = ((((WORD)ApuC2d & 0x07) << 8) + ApuC2c);
+      ApuC2Atl = ApuAtl[(ApuC2d & 0xf8) >> 3];
 
-        if (ApuC2Freq)
-        {
-          ApuC2Skip = ApuPulseMagic / (ApuC2Freq / 2);
-        }
-        else
-        {
-          ApuC2Skip = 0;
-        }
-        break;
+      if (ApuC2Freq)
+      {
+        ApuC2Skip = ApuPulseMagic / (ApuC2Freq / 2);
+      }
+      else
+      {
+        ApuC2Skip = 0;
+      }
+      break;
 
-      case 3:
-        ApuC2d = ApuEventQueue[event].data;
-        ApuC2Freq = ((((WORD)ApuC2d & 0x07) << 8) + ApuC2c);
-        ApuC2Atl = ApuAtl[(ApuC2d & 0xf8) >> 3];
+    case 3:
+      ApuC2d = ev.data;
+      ApuC2Freq = ((((WORD)ApuC2d & 0x07) << 8) + ApuC2c);
+      ApuC2Atl = ApuAtl[(ApuC2d & 0xf8) >> 3];
 
-        if (ApuC2Freq)
-        {
-          ApuC2Skip = ApuPulseMagic / (ApuC2Freq / 2);
-        }
-        else
-        {
-          ApuC2Skip = 0;
-        }
-        ApuC2EnvVol = 15;
-        break;
+      if (ApuC2Freq)
+      {
+        ApuC2Skip = ApuPulseMagic / (ApuC2Freq / 2);
       }
-    }
-    else if (ApuEventQueue[event].type == APUET_W_CTRL)
-    {
-      ApuCtrlNew = ApuEventQueue[event].data;
-
-      if (!(ApuEventQueue[event].data & (1 << 1)))
+      else
       {
-        ApuC2Atl = 0;
+        ApuC2Skip = 0;
       }
+      ApuC2EnvVol = 15;
+      break;
+    }
+  }
+  else if (ev.type == APUET_W_CTRL)
+  {
+    ApuCtrlNew = ev.data;
+
+    if (!(ev.data & (1 << 1)))
+    {
+      ApuC2Atl = 0;
     }
+  }
+}
+
+ApuEventIndex_t __not_in_flash_func(ApuWriteWave2)(int cycles, ApuEventIndex_t event)
+{
+  /* APU Reg Write Event */
+  while ((event < cur_event) && (ApuEventQueue[event & APU_EVENT_MASK].time < cycles))
+  {
+    ApuWriteEvent2(ApuEventQueue[event & APU_EVENT_MASK]);
     event++;
   }
   return event;
@@ -635,11 +883,8 @@ int __not_in_flash_func(ApuWriteWave2)(int cycles, int event)
 /* Rendering rectangular wave #2                                     */
 /*-------------------------------------------------------------------*/
 
-void __not_in_flash_func(ApuRenderingWave2)(int n)
+static void __not_in_flash_func(ApuRenderWave2)(BYTE *wave, int n)
 {
-  ApuCtrlNew = ApuCtrl;
-  ApuWriteWave2(ApuCyclesPerSample * (n + 1), 0);
-
   if ((ApuCtrlNew & 0x02) && (ApuC2Atl || ApuC2Hold) &&
       !(ApuC2Freq < 8 || (!ApuC2SweepIncDec && ApuC2Freq > ApuC2FreqLimit)))
   {
@@ -649,15 +894,22 @@ void __not_in_flash_func(ApuRenderingWave2)(int n)
       /* Wave Rendering */
       ApuC2Index += ApuC2Skip;
       ApuC2Index &= 0x1fffffff;
-      wave_buffers[1][i] = ApuC2Wave[ApuC2Index >> 24] * vol;
+      wave[i] = ApuC2Wave[ApuC2Index >> 24] * vol;
     }
   }
   else
   {
-    memset(wave_buffers[1], 0, 2 * n);
+    memset(wave, 0, n);
   }
 }
 
+void __not_in_flash_func(ApuRenderingWave2)(int n)
+{
+  ApuCtrlNew = ApuCtrl;
+  ApuWriteWave2(ApuCyclesPerSample * (n + 1), 0);
+  ApuRenderWave2(wave_buffers[1], n);
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*      ApuRenderingWave3() : Rendering Triangle Wave                */
@@ -668,59 +920,64 @@ void __not_in_flash_func(ApuRenderingWave2)(int n)
 /* Write registers of triangle wave #3                              */
 /*-------------------------------------------------------------------*/
 
-int __not_in_flash_func(ApuWriteWave3)(int cycles, int event)
+static inline void __not_in_flash_func(ApuWriteEvent3)(const ApuEvent_t &ev)
 {
-  /* APU Reg Write Event */
-  while ((event < cur_event) && (ApuEventQueue[event].time < cycles))
+  if ((ev.type & APUET_MASK) == APUET_C3)
   {
-    if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C3)
+    switch (ev.type & 3)
     {
-      switch (ApuEventQueue[event].type & 3)
-      {
-      case 0:
-        ApuC3a = ApuEventQueue[event].data;
-        break;
-
-      case 1:
-        ApuC3b = ApuEventQueue[event].data;
-        break;
+    case 0:
+      ApuC3a = ev.data;
+      break;
 
-      case 2:
-        ApuC3c = ApuEventQueue[event].data;
-        if (ApuC3Freq)
-        {
-          ApuC3Skip = ApuTriangleMagic / ApuC3Freq;
-        }
-        else
-        {
-          ApuC3Skip = 0;
-        }
-        break;
+    case 1:
+      ApuC3b = ev.data;
+      break;
 
-      case 3:
-        ApuC3d = ApuEventQueue[event].data;
-        ApuC3Atl = ApuC3LengthCounter;
-        ApuC3ReloadFlag = true;
-        if (ApuC3Freq)
-        {
-          ApuC3Skip = ApuTriangleMagic / ApuC3Freq;
-        }
-        else
-        {
-          ApuC3Skip = 0;
-        }
+    case 2:
+      ApuC3c = ev.data;
+      if (ApuC3Freq)
+      {
+        ApuC3Skip = ApuTriangleMagic / ApuC3Freq;
       }
-    }
-    else if (ApuEventQueue[event].type == APUET_W_CTRL)
-    {
-      ApuCtrlNew = ApuEventQueue[event].data;
+      else
+      {
+        ApuC3Skip = 0;
+      }
+      break;
 
-      if (!(ApuEventQueue[event].data & (1 << 2)))
+    case 3:
+      ApuC3d = ev.data;
+      ApuC3Atl = ApuC3LengthCounter;
+      ApuC3ReloadFlag = true;
+      if (ApuC3Freq)
+      {
+        ApuC3Skip = ApuTriangleMagic / ApuC3Freq;
+      }
+      else
       {
-        ApuC3Atl = 0;
-        ApuC3Llc = 0;
+        ApuC3Skip = 0;
       }
     }
+  }
+  else if (ev.type == APUET_W_CTRL)
+  {
+    ApuCtrlNew = ev.data;
+
+    if (!(ev.data & (1 << 2)))
+    {
+      ApuC3Atl = 0;
+      ApuC3Llc = 0;
+    }
+  }
+}
+
+ApuEventIndex_t __not_in_flash_func(ApuWriteWave3)(int cycles, ApuEventIndex_t event)
+{
+  /* APU Reg Write Event */
+  while ((event < cur_event) && (ApuEventQueue[event & APU_EVENT_MASK].time < cycles))
+  {
+    ApuWriteEvent3(ApuEventQueue[event & APU_EVENT_MASK]);
     event++;
   }
   return event;
@@ -730,11 +987,8 @@ int __not_in_flash_func(ApuWriteWave3)(int cycles, int event)
 /* Rendering triangle wave #3                                        */
 /*-------------------------------------------------------------------*/
 
-void __not_in_flash_func(ApuRenderingWave3)(int n)
+static void __not_in_flash_func(ApuRenderWave3)(BYTE *wave, int n)
 {
-  ApuCtrlNew = ApuCtrl;
-  ApuWriteWave3(ApuCyclesPerSample * (n + 1), 0);
-
   if ((ApuCtrlNew & 0x04) && ApuC3Atl > 0 && ApuC3Llc > 0 && ApuC3Freq >= 8)
   {
     for (unsigned int i = 0; i < n; i++)
@@ -742,15 +996,22 @@ void __not_in_flash_func(ApuRenderingWave3)(int n)
       /* Wave Rendering */
       ApuC3Index += ApuC3Skip;
       ApuC3Index &= 0x1fffffff;
-      wave_buffers[2][i] = triangle_50[ApuC3Index >> 24];
+      wave[i] = triangle_50[ApuC3Index >> 24];
     }
   }
   else
   {
-    memset(wave_buffers[2], 0, 2 * n);
+    memset(wave, 0, n);
   }
 }
 
+void __not_in_flash_func(ApuRenderingWave3)(int n)
+{
+  ApuCtrlNew = ApuCtrl;
+  ApuWriteWave3(ApuCyclesPerSample * (n + 1), 0);
+  ApuRenderWave3(wave_buffers[2], n);
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*      ApuRenderingWave4() : Rendering Noise                        */
@@ -761,72 +1022,77 @@ void __not_in_flash_func(ApuRenderingWave3)(int n)
 /* Write registers of noise channel #4                              */
 /*-------------------------------------------------------------------*/
 
-int __not_in_flash_func(ApuWriteWave4)(int cycles, int event)
+static inline void __not_in_flash_func(ApuWriteEvent4)(const ApuEvent_t &ev)
 {
-  /* APU Reg Write Event */
-  while ((event < cur_event) && (ApuEventQueue[event].time < cycles))
+  if ((ev.type & APUET_MASK) == APUET_C4)
   {
-    if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C4)
+    switch (ev.type & 3)
     {
-      switch (ApuEventQueue[event].type & 3)
+    case 0:
+      ApuC4a = ev.data;
+      break;
+
+    case 1:
+      ApuC4b = ev.data;
+      break;
+
+    case 2:
+      ApuC4c = ev.data;
+
+      // if (ApuC4Small)
+      // {
+      //   ApuC4Sr = 0x001f;
+      // }
+      // else
+      // {
+      //   ApuC4Sr = 0x01ff;
+      // }
+
+      /* Frequency */
+      if (ApuC4Freq)
       {
-      case 0:
-        ApuC4a = ApuEventQueue[event].data;
-        break;
-
-      case 1:
-        ApuC4b = ApuEventQueue[event].data;
-        break;
-
-      case 2:
-        ApuC4c = ApuEventQueue[event].data;
-
-        // if (ApuC4Small)
-        // {
-        //   ApuC4Sr = 0x001f;
-        // }
-        // else
-        // {
-        //   ApuC4Sr = 0x01ff;
-        // }
-
-        /* Frequency */
-        if (ApuC4Freq)
-        {
-          ApuC4Skip = ApuNoiseMagic / ApuC4Freq;
-        }
-        else
-        {
-          ApuC4Skip = 0;
-        }
-        ApuC4Atl = ApuC4LengthCounter;
-        break;
+        ApuC4Skip = ApuNoiseMagic / ApuC4Freq;
+      }
+      else
+      {
+        ApuC4Skip = 0;
+      }
+      ApuC4Atl = ApuC4LengthCounter;
+      break;
 
-      case 3:
-        ApuC4d = ApuEventQueue[event].data;
+    case 3:
+      ApuC4d = ev.data;
 
-        /* Frequency */
-        if (ApuC4Freq)
-        {
-          ApuC4Skip = ApuNoiseMagic / ApuC4Freq;
-        }
-        else
-        {
-          ApuC4Skip = 0;
-        }
-        ApuC4Atl = ApuC4LengthCounter;
-        ApuC4EnvVol = 15;
+      /* Frequency */
+      if (ApuC4Freq)
+      {
+        ApuC4Skip = ApuNoiseMagic / ApuC4Freq;
       }
-    }
-    else if (ApuEventQueue[event].type == APUET_W_CTRL)
-    {
-      ApuCtrlNew = ApuEventQueue[event].data;
-
-      if (!(ApuEventQueue[event].data & (1 << 3)))
+      else
       {
-        ApuC4Atl = 0;
+        ApuC4Skip = 0;
       }
+      ApuC4Atl = ApuC4LengthCounter;
+      ApuC4EnvVol = 15;
+    }
+  }
+  else if (ev.type == APUET_W_CTRL)
+  {
+    ApuCtrlNew = ev.data;
+
+    if (!(ev.data & (1 << 3)))
+    {
+      ApuC4Atl = 0;
     }
+  }
+}
+
+ApuEventIndex_t __not_in_flash_func(ApuWriteWave4)(int cycles, ApuEventIndex_t event)
+{
+  /* APU Reg Write Event */
+  while ((event < cur_event) && (ApuEventQueue[event & APU_EVENT_MASK].time < cycles))
+  {
+    ApuWriteEvent4(ApuEventQueue[event & APU_EVENT_MASK]);
     event++;
   }
   return event;
@@ -836,11 +1102,8 @@ int __not_in_flash_func(ApuWriteWave4)(int cycles, int event)
 /* Rendering noise channel #4                                        */
 /*-------------------------------------------------------------------*/
 
-void __not_in_flash_func(ApuRenderingWave4)(int n)
+static void __not_in_flash_func(ApuRenderWave4)(BYTE *wave, int n)
 {
-  ApuCtrlNew = ApuCtrl;
-  ApuWriteWave4(ApuCyclesPerSample * (n + 1), 0);
-
   if ((ApuCtrlNew & 0x08) && ApuC4Atl)
   {
     int shift = ApuC4Small ? 6 : 1;
@@ -860,25 +1123,32 @@ void __not_in_flash_func(ApuRenderingWave4)(int n)
       {
         if (ApuC4Env)
         {
-          wave_buffers[3][i] = ApuC4Vol;
+          wave[i] = ApuC4Vol;
         }
         else
         {
-          wave_buffers[3][i] = ApuC4EnvVol;
+          wave[i] = ApuC4EnvVol;
         }
       }
       else
       {
-        wave_buffers[3][i] = 0;
+        wave[i] = 0;
       }
     }
   }
   else
   {
-    memset(wave_buffers[3], 0, n << 1);
+    memset(wave, 0, n);
   }
 }
 
+void __not_in_flash_func(ApuRenderingWave4)(int n)
+{
+  ApuCtrlNew = ApuCtrl;
+  ApuWriteWave4(ApuCyclesPerSample * (n + 1), 0);
+  ApuRenderWave4(wave_buffers[3], n);
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*      ApuRenderingWave5() : Rendering DPCM channel #5              */
@@ -889,65 +1159,143 @@ void __not_in_flash_func(ApuRenderingWave4)(int n)
 /* Write registers of DPCM channel #5                               */
 /*-------------------------------------------------------------------*/
 
-int __not_in_flash_func(ApuWriteWave5)(int cycles, int event)
+static inline void __not_in_flash_func(ApuWriteEvent5)(const ApuEvent_t &ev)
 {
-  /* APU Reg Write Event */
-  while ((event < cur_event) && (ApuEventQueue[event].time < cycles))
+  if ((ev.type & APUET_MASK) == APUET_C5)
   {
-    if ((ApuEventQueue[event].type & APUET_MASK) == APUET_C5)
+    ApuC5Reg[ev.type & 3] = ev.data;
+
+    switch (ev.type & 3)
     {
-      ApuC5Reg[ApuEventQueue[event].type & 3] = ApuEventQueue[event].data;
+    case 0:
+      ApuC5Freq = ApuDpcmCycles[(ev.data & 0x0F)] << 16;
+      ApuC5Looping = ev.data & 0x40;
+      break;
+    case 1:
+      ApuC5DpcmValue = (ev.data & 0x7F) >> 1;
+      break;
+    case 2:
+      ApuC5CacheAddr = 0xC000 + (WORD)(ev.data << 6);
+      ApuC5CacheSlot = -1; /* Until its APUET_DPCM */
+      break;
+    case 3:
+      ApuC5CacheDmaLength = ((ev.data << 4) + 1) << 3;
+      ApuC5CacheSlot = -1;
+      break;
+    }
+  }
+  else if (ev.type == APUET_DPCM)
+  {
+    ApuC5CacheSlot = ev.data;
+  }
+  else if (ev.type == APUET_W_CTRL)
+  {
+    ApuCtrlNew = ev.data;
 
-      switch (ApuEventQueue[event].type & 3)
-      {
-      case 0:
-        ApuC5Freq = ApuDpcmCycles[(ApuEventQueue[event].data & 0x0F)] << 16;
-        ApuC5Looping = ApuEventQueue[event].data & 0x40;
-        break;
-      case 1:
-        ApuC5DpcmValue = (ApuEventQueue[event].data & 0x7F) >> 1;
-        break;
-      case 2:
-        ApuC5CacheAddr = 0xC000 + (WORD)(ApuEventQueue[event].data << 6);
-        break;
-      case 3:
-        ApuC5CacheDmaLength = ((ApuEventQueue[event].data << 4) + 1) << 3;
-        break;
-      }
+    if (!(ev.data & (1 << 4)))
+    {
+      ApuC5Enable = 0;
+      ApuC5DmaLength = 0;
     }
-    else if (ApuEventQueue[event].type == APUET_W_CTRL)
+    else
     {
-      ApuCtrlNew = ApuEventQueue[event].data;
-
-      if (!(ApuEventQueue[event].data & (1 << 4)))
+      ApuC5Enable = 0xFF;
+      if (!ApuC5DmaLength)
       {
-        ApuC5Enable = 0;
-        ApuC5DmaLength = 0;
-      }
-      else
-      {
-        ApuC5Enable = 0xFF;
-        if (!ApuC5DmaLength)
-        {
-          ApuC5Address = ApuC5CacheAddr;
-          ApuC5DmaLength = ApuC5CacheDmaLength;
-        }
+        ApuC5Address = ApuC5CacheAddr;
+        ApuC5DmaLength = ApuC5CacheDmaLength;
+        ApuC5Slot = ApuC5CacheSlot;
+        ApuC5Offset = 0;
       }
     }
+  }
+}
+
+ApuEventIndex_t __not_in_flash_func(ApuWriteWave5)(int cycles, ApuEventIndex_t event)
+{
+  /* APU Reg Write Event */
+  while ((event < cur_event) && (ApuEventQueue[event & APU_EVENT_MASK].time < cycles))
+  {
+    ApuWriteEvent5(ApuEventQueue[event & APU_EVENT_MASK]);
     event++;
   }
   return event;
 }
 
 /*-------------------------------------------------------------------*/
-/* Rendering DPCM channel #5                                         */
+/* Next sample byte: from its prefetch slot once the copy has landed */
 /*-------------------------------------------------------------------*/
 
-void __not_in_flash_func(ApuRenderingWave5)(int n)
+static inline BYTE __not_in_flash_func(ApuDpcmFetch)()
 {
-  ApuCtrlNew = ApuCtrl;
-  ApuWriteWave5(ApuCyclesPerSample * (n + 1), 0);
+  const int offset = ApuC5Offset++;
+  if (ApuC5Slot >= 0)
+  {
+    const ApuDpcmSlot_t &slot = ApuDpcmSlot[ApuC5Slot & (APU_DPCM_SLOTS - 1)];
+    const BYTE state = (ApuC5Slot >> 2) << 1 | 1;
+    if (__atomic_load_n(&slot.state, __ATOMIC_ACQUIRE) == state)
+    {
+      const BYTE data = __atomic_load_n(&slot.buf[offset], __ATOMIC_RELAXED);
+      /* APU_THREAD: the slot may have been refilled under the read */
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&slot.state, __ATOMIC_RELAXED) == state)
+        return data;
+    }
+  }
+  return K6502_Read(ApuC5Address);
+}
+
+/*-------------------------------------------------------------------*/
+/* Play one DMC bit; false once a non-looping sample has ended       */
+/*-------------------------------------------------------------------*/
+
+static inline bool __not_in_flash_func(ApuDpcmClock)()
+{
+  if (!(ApuC5DmaLength & 7))
+  {
+    ApuC5CurByte = ApuDpcmFetch();
+    if (0xFFFF == ApuC5Address)
+      ApuC5Address = 0x8000;
+    else
+      ApuC5Address++;
+  }
+  if (!(--ApuC5DmaLength))
+  {
+    if (ApuC5Looping)
+    {
+      ApuC5Address = ApuC5CacheAddr;
+      ApuC5DmaLength = ApuC5CacheDmaLength;
+      ApuC5Slot = ApuC5CacheSlot;
+      ApuC5Offset = 0;
+    }
+    else
+    {
+      ApuC5Enable = 0;
+      return false;
+    }
+  }
+
+  // positive delta
+  if (ApuC5CurByte & (1 << ((ApuC5DmaLength & 7) ^ 7)))
+  {
+    if (ApuC5DpcmValue < 0x3F)
+      ApuC5DpcmValue += 1;
+  }
+  else
+  {
+    // negative delta
+    if (ApuC5DpcmValue > 1)
+      ApuC5DpcmValue -= 1;
+  }
+  return true;
+}
+
+/*-------------------------------------------------------------------*/
+/* Rendering DPCM channel #5                                         */
+/*-------------------------------------------------------------------*/
 
+static void __not_in_flash_func(ApuRenderWave5)(BYTE *wave, int n)
+{
   if (ApuCtrlNew & 0x10)
   {
     for (unsigned int i = 0; i < n; i++)
@@ -959,52 +1307,507 @@ void __not_in_flash_func(ApuRenderingWave5)(int n)
         while (ApuC5Phaseacc < 0)
         {
           ApuC5Phaseacc += ApuC5Freq;
-          if (!(ApuC5DmaLength & 7))
-          {
-            ApuC5CurByte = K6502_Read(ApuC5Address);
-            if (0xFFFF == ApuC5Address)
-              ApuC5Address = 0x8000;
-            else
-              ApuC5Address++;
-          }
-          if (!(--ApuC5DmaLength))
-          {
-            if (ApuC5Looping)
-            {
-              ApuC5Address = ApuC5CacheAddr;
-              ApuC5DmaLength = ApuC5CacheDmaLength;
-            }
-            else
-            {
-              ApuC5Enable = 0;
-              break;
-            }
-          }
-
-          // positive delta
-          if (ApuC5CurByte & (1 << ((ApuC5DmaLength & 7) ^ 7)))
-          {
-            if (ApuC5DpcmValue < 0x3F)
-              ApuC5DpcmValue += 1;
-          }
-          else
-          {
-            // negative delta
-            if (ApuC5DpcmValue > 1)
-              ApuC5DpcmValue -= 1;
-          }
+          if (!ApuDpcmClock())
+            break;
         }
       }
 
       /* Wave Rendering */
-      wave_buffers[4][i] = ApuC5DpcmValue;
+      wave[i] = ApuC5DpcmValue;
+    }
+  }
+  else
+  {
+    memset(wave, 0, n);
+  }
+}
+
+void __not_in_flash_func(ApuRenderingWave5)(int n)
+{
+  ApuCtrlNew = ApuCtrl;
+  ApuWriteWave5(ApuCyclesPerSample * (n + 1), 0);
+  ApuRenderWave5(wave_buffers[4], n);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*      ApuRenderingExt() : Rendering the expansion chip             */
+/*                                                                   */
+/*===================================================================*/
+
+/* The chips render on the sample grid, with or without APU_BLIP */
+
+static inline void __not_in_flash_func(ApuWriteEventExt)(const ApuEvent_t &ev)
+{
+  if (ev.type & APUET_EXT)
+  {
+    ApuExt->write(ev.type & ~APUET_EXT, ev.data);
+  }
+}
+
+static void __not_in_flash_func(ApuRenderWaveExt)(BYTE *wave, int n)
+{
+  ApuExt->render(wave, n);
+}
+
+void __not_in_flash_func(ApuRenderingExt)(int n, bool enabled)
+{
+  /* Writes are kept while the sound is off: N163 wave RAM lives there */
+  for (ApuEventIndex_t event = 0; event < cur_event; event++)
+  {
+    ApuWriteEventExt(ApuEventQueue[event & APU_EVENT_MASK]);
+  }
+  if (enabled)
+    ApuRenderWaveExt(ApuExtWave, n);
+  else
+    memset(ApuExtWave, 0, n);
+}
+
+void InfoNES_pAPUSetExt(const ApuExt_t *ext)
+{
+#ifdef APU_THREAD
+  ApuThreadPause();
+#endif
+  ApuExt = ext;
+  if (ApuExt)
+  {
+    ApuExt->reset();
+    InfoNES_MemorySet((void *)ApuExtWave, 0, APU_WAVE_SAMPLES);
+  }
+#ifdef APU_THREAD
+  ApuThreadResume();
+#endif
+}
+
+#ifdef APU_BLIP
+/*===================================================================*/
+/*                                                                   */
+/*      ApuSynthWave1-5() : Band-limited step synthesis              */
+/*                                                                   */
+/*===================================================================*/
+
+/*
+ *  The ApuRenderingWave loops above advance a phase accumulator once
+ *  per output sample. Level changes snap to the sample grid, which
+ *  aliases, and every register write of the scanline is applied before
+ *  its first sample.
+ *
+ *  This engine runs each channel on the CPU clock instead. When a
+ *  channel's level changes, the difference is added to that channel's
+ *  ApuBlip buffer as a band-limited step: a windowed sinc
+ *  APU_BLIP_TAPS samples wide, at the clock where the change happened.
+ *  Register writes take effect at their own clock. ApuBlipRead() then
+ *  integrates the differences into a block of samples in one pass.
+ */
+
+#define APU_BLIP_PHASE_BITS 5
+#define APU_BLIP_PHASES (1 << APU_BLIP_PHASE_BITS)
+#define APU_BLIP_TAPS 16
+/* Most samples read at once */
+#ifdef APU_FRAME
+#define APU_BLIP_BLOCK APU_WAVE_SAMPLES
+#else
+#define APU_BLIP_BLOCK 8 /* 114 / 40 rounded up, with room */
+#endif
+#define APU_BLIP_SIZE (APU_BLIP_BLOCK + APU_BLIP_TAPS + 1)
+
+/* Band-limited step per sub-sample phase, Q15; each phase sums to 1 << 15 */
+static int16_t ApuBlipKernel[APU_BLIP_PHASES][APU_BLIP_TAPS];
+
+struct ApuBlip_t
+{
+  int32_t buf[APU_BLIP_SIZE]; /* Level differences, Q15 */
+  int32_t sum;                /* Integrated level, Q15 */
+  int amp;                    /* Level of the last step added */
+};
+
+static ApuBlip_t ApuBlip[5];
+
+/* Samples per CPU clock, 16.32 fixed point */
+static DWORD ApuBlipRate;
+
+/* Position of clock 0 of this span in the ApuBlip buffers, 16.16 */
+static DWORD ApuBlipStart16;
+
+/* Clocks in this span: a scanline, or the scanlines up to ApuSyncEvent */
+static int ApuBlipClocks;
+
+/* Clocks left until the next sequencer step */
+static int ApuC1Timer;
+static int ApuC2Timer;
+static int ApuC3Timer;
+static int ApuC4Timer;
+
+/*-------------------------------------------------------------------*/
+/*  Build the step kernel                                            */
+/*-------------------------------------------------------------------*/
+
+static void ApuBlipInit()
+{
+  const float cutoff = 0.9f; /* Of the Nyquist frequency */
+  const float half = APU_BLIP_TAPS / 2;
+
+  for (int p = 0; p < APU_BLIP_PHASES; p++)
+  {
+    float taps[APU_BLIP_TAPS];
+    float total = 0;
+    for (int i = 0; i < APU_BLIP_TAPS; i++)
+    {
+      /* Distance from the step, in samples */
+      const float x = i - (half - 1) - (p + 0.5f) / APU_BLIP_PHASES;
+      const float sinc = x == 0 ? cutoff : sinf(M_PI * cutoff * x) / (M_PI * x);
+      const float window = 0.42f + 0.5f * cosf(M_PI * x / half) + 0.08f * cosf(2 * M_PI * x / half);
+      taps[i] = sinc * window;
+      total += taps[i];
+    }
+
+    int sum = 0;
+    for (int i = 0; i < APU_BLIP_TAPS; i++)
+    {
+      ApuBlipKernel[p][i] = (int16_t)lrintf(taps[i] * (1 << 15) / total);
+      sum += ApuBlipKernel[p][i];
+    }
+    /* A step must settle on exactly its level, or the integrator drifts */
+    ApuBlipKernel[p][APU_BLIP_TAPS / 2 - 1] += (1 << 15) - sum;
+  }
+
+  memset(ApuBlip, 0, sizeof ApuBlip);
+  ApuBlipRate = (DWORD)(((uint64_t)ApuSamplesPerSync16 << 16) / STEP_PER_SCANLINE);
+  ApuBlipStart16 = 0;
+  ApuBlipClocks = STEP_PER_SCANLINE;
+  ApuC1Timer = ApuC2Timer = ApuC3Timer = ApuC4Timer = 0;
+  ApuC5Phaseacc = 0;
+}
+
+/*-------------------------------------------------------------------*/
+/*  Move a channel to level amp at CPU clock t of this span          */
+/*-------------------------------------------------------------------*/
+
+static inline void __not_in_flash_func(ApuBlipAdd)(ApuBlip_t &blip, int t, int amp)
+{
+  const int delta = amp - blip.amp;
+  if (!delta)
+    return;
+  blip.amp = amp;
+
+  const DWORD pos = ApuBlipStart16 + (DWORD)(((uint64_t)t * ApuBlipRate) >> 16);
+  int32_t *out = &blip.buf[pos >> 16];
+  const int16_t *kernel = ApuBlipKernel[(pos >> (16 - APU_BLIP_PHASE_BITS)) & (APU_BLIP_PHASES - 1)];
+  for (int i = 0; i < APU_BLIP_TAPS; i++)
+    out[i] += delta * kernel[i];
+}
+
+/*-------------------------------------------------------------------*/
+/*  Integrate n samples of a channel into its wave buffer            */
+/*-------------------------------------------------------------------*/
+
+static void __not_in_flash_func(ApuBlipRead)(ApuBlip_t &blip, int n, BYTE *wave, int max)
+{
+  int32_t sum = blip.sum;
+  for (int i = 0; i < n; i++)
+  {
+    sum += blip.buf[i];
+    /*
+     *  Ringing of a full-scale step is clipped to the channel's range,
+     *  max: the mixer's DAC tables end there ( noise 15, DPCM 63 )
+     */
+    const int level = sum >> 15;
+    wave[i] = level < 0 ? 0 : level > max ? max : level;
+  }
+  blip.sum = sum;
+
+  memmove(blip.buf, blip.buf + n, (APU_BLIP_SIZE - n) * sizeof blip.buf[0]);
+  memset(blip.buf + APU_BLIP_SIZE - n, 0, n * sizeof blip.buf[0]);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Run a channel through the span, one register write at a time     */
+/*-------------------------------------------------------------------*/
+
+template <typename Run>
+static inline void __not_in_flash_func(ApuBlipSpan)(void (*write)(const ApuEvent_t &), Run run,
+                                                    int event, int end)
+{
+  ApuCtrlNew = ApuCtrl;
+
+  int now = 0;
+  for (; event < end; event++)
+  {
+    const ApuEvent_t &ev = ApuEventQueue[event & APU_EVENT_MASK];
+    const int until = std::min<int>(std::max<int>(ev.time, now), ApuBlipClocks);
+    run(now, until);
+    now = until;
+    write(ev);
+  }
+  run(now, ApuBlipClocks);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Step a 32-entry wave table every period clocks                   */
+/*-------------------------------------------------------------------*/
+
+static inline void __not_in_flash_func(ApuBlipSequence)(ApuBlip_t &blip, int &timer, DWORD &step,
+                                                        const BYTE *wave, int stride, int period,
+                                                        int vol, int from, int to)
+{
+  ApuBlipAdd(blip, from, wave[step] * vol);
+
+  int t = from + timer;
+  while (t < to)
+  {
+    step = (step + stride) & 0x1f;
+    ApuBlipAdd(blip, t, wave[step] * vol);
+    t += period;
+  }
+  timer = t - to;
+}
+
+/*-------------------------------------------------------------------*/
+/* Rectangular waves #1, #2                                          */
+/*-------------------------------------------------------------------*/
+
+/* ApuC1Index and ApuC2Index hold the wave table position here */
+
+void __not_in_flash_func(ApuSynthWave1)(int n, int event, int end)
+{
+  auto run = [](int from, int to)
+  {
+    if ((ApuCtrlNew & 0x01) && (ApuC1Atl || ApuC1Hold) &&
+        !(ApuC1Freq < 8 || (!ApuC1SweepIncDec && ApuC1Freq > ApuC1FreqLimit)))
+    {
+      /* 8 duty steps of 2 * ( Freq + 1 ) clocks */
+      ApuBlipSequence(ApuBlip[0], ApuC1Timer, ApuC1Index, ApuC1Wave, 4, 2 * (ApuC1Freq + 1),
+                      ApuC1Env ? ApuC1Vol : ApuC1EnvVol, from, to);
+    }
+    else
+    {
+      ApuBlipAdd(ApuBlip[0], from, 0);
+    }
+  };
+  ApuBlipSpan(ApuWriteEvent1, run, event, end);
+  ApuBlipRead(ApuBlip[0], n, wave_buffers[0], 0xff);
+}
+
+void __not_in_flash_func(ApuSynthWave2)(int n, int event, int end)
+{
+  auto run = [](int from, int to)
+  {
+    if ((ApuCtrlNew & 0x02) && (ApuC2Atl || ApuC2Hold) &&
+        !(ApuC2Freq < 8 || (!ApuC2SweepIncDec && ApuC2Freq > ApuC2FreqLimit)))
+    {
+      ApuBlipSequence(ApuBlip[1], ApuC2Timer, ApuC2Index, ApuC2Wave, 4, 2 * (ApuC2Freq + 1),
+                      ApuC2Env ? ApuC2Vol : ApuC2EnvVol, from, to);
+    }
+    else
+    {
+      ApuBlipAdd(ApuBlip[1], from, 0);
+    }
+  };
+  ApuBlipSpan(ApuWriteEvent2, run, event, end);
+  ApuBlipRead(ApuBlip[1], n, wave_buffers[1], 0xff);
+}
+
+/*-------------------------------------------------------------------*/
+/* Triangle wave #3                                                  */
+/*-------------------------------------------------------------------*/
+
+void __not_in_flash_func(ApuSynthWave3)(int n, int event, int end)
+{
+  auto run = [](int from, int to)
+  {
+    /* A halted triangle holds its level instead of clicking to 0 */
+    if ((ApuCtrlNew & 0x04) && ApuC3Atl > 0 && ApuC3Llc > 0 && ApuC3Freq >= 8)
+    {
+      /* 32 steps of Freq + 1 clocks */
+      ApuBlipSequence(ApuBlip[2], ApuC3Timer, ApuC3Index, triangle_50, 1, ApuC3Freq + 1,
+                      1, from, to);
+    }
+  };
+  ApuBlipSpan(ApuWriteEvent3, run, event, end);
+  ApuBlipRead(ApuBlip[2], n, wave_buffers[2], 0xff);
+}
+
+/*-------------------------------------------------------------------*/
+/* Noise channel #4                                                  */
+/*-------------------------------------------------------------------*/
+
+void __not_in_flash_func(ApuSynthWave4)(int n, int event, int end)
+{
+  auto run = [](int from, int to)
+  {
+    if (!((ApuCtrlNew & 0x08) && ApuC4Atl))
+    {
+      ApuBlipAdd(ApuBlip[3], from, 0);
+      return;
+    }
+
+    const int vol = ApuC4Env ? ApuC4Vol : ApuC4EnvVol;
+    const int shift = ApuC4Small ? 6 : 1;
+    ApuBlipAdd(ApuBlip[3], from, (ApuC4Sr & 1) ? 0 : vol);
+
+    int t = from + ApuC4Timer;
+    while (t < to)
+    {
+      int f = (ApuC4Sr ^ (ApuC4Sr >> shift)) & 1;
+      ApuC4Sr = (ApuC4Sr >> 1) | (f << 14);
+      ApuBlipAdd(ApuBlip[3], t, (ApuC4Sr & 1) ? 0 : vol);
+      t += ApuC4Freq;
     }
+    ApuC4Timer = t - to;
+  };
+  ApuBlipSpan(ApuWriteEvent4, run, event, end);
+  ApuBlipRead(ApuBlip[3], n, wave_buffers[3], 0x0f);
+}
+
+/*-------------------------------------------------------------------*/
+/* DPCM channel #5                                                   */
+/*-------------------------------------------------------------------*/
+
+/* ApuC5Phaseacc counts clocks to the next DMC bit here */
+
+void __not_in_flash_func(ApuSynthWave5)(int n, int event, int end)
+{
+  auto run = [](int from, int to)
+  {
+    /* $4011 loads land here; the DAC keeps its level while disabled */
+    ApuBlipAdd(ApuBlip[4], from, ApuC5DpcmValue);
+    if (!(ApuCtrlNew & 0x10) || !ApuC5DmaLength)
+      return;
+
+    int t = from + ApuC5Phaseacc;
+    while (t < to)
+    {
+      if (!ApuDpcmClock())
+      {
+        t = to;
+        break;
+      }
+      ApuBlipAdd(ApuBlip[4], t, ApuC5DpcmValue);
+      t += ApuDpcmCycles[ApuC5Reg[0] & 0x0F];
+    }
+    ApuC5Phaseacc = t - to;
+  };
+  ApuBlipSpan(ApuWriteEvent5, run, event, end);
+  ApuBlipRead(ApuBlip[4], n, wave_buffers[4], 0x3f);
+}
+#endif /* APU_BLIP */
+
+/*===================================================================*/
+/*                                                                   */
+/*     InfoNES_pAPUStatus() : Length counter bits of $4015           */
+/*                                                                   */
+/*===================================================================*/
+
+#ifdef APU_THREAD
+/*
+ *  The channels live on the other core, so core0 keeps its own length
+ *  counters for $4015: loaded and cleared by the writes as it queues
+ *  them, counted down at Vsync by the rules of ApuSequencer().
+ */
+static BYTE ApuStatReg[APUET_W_C5A]; /* Last write to $4000-$400f */
+static BYTE ApuStatAtl[4];
+static DWORD ApuStatC3Llc;
+static bool ApuStatC3Reload;
+
+static void __not_in_flash_func(ApuStatusWrite)(BYTE type, BYTE data)
+{
+  if (type == APUET_W_CTRL)
+  {
+    for (int ch = 0; ch < 4; ch++)
+    {
+      if (!(data & (1 << ch)))
+        ApuStatAtl[ch] = 0;
+    }
+    if (!(data & (1 << 2)))
+      ApuStatC3Llc = 0;
+    return;
+  }
+  if (type >= APUET_W_C5A)
+    return;
+
+  ApuStatReg[type] = data;
+  switch (type)
+  {
+  case APUET_W_C1C:
+  case APUET_W_C1D:
+    ApuStatAtl[0] = ApuAtl[(ApuStatReg[APUET_W_C1D] & 0xf8) >> 3];
+    break;
+
+  case APUET_W_C2C:
+  case APUET_W_C2D:
+    ApuStatAtl[1] = ApuAtl[(ApuStatReg[APUET_W_C2D] & 0xf8) >> 3];
+    break;
+
+  case APUET_W_C3D:
+    ApuStatAtl[2] = ApuAtl[(data & 0xf8) >> 3];
+    ApuStatC3Reload = true;
+    break;
+
+  case APUET_W_C4C:
+  case APUET_W_C4D:
+    ApuStatAtl[3] = ApuAtl[ApuStatReg[APUET_W_C4D] >> 3] << 1;
+    break;
+  }
+}
+
+static void __not_in_flash_func(ApuStatusVsync)()
+{
+  const BYTE c3a = ApuStatReg[APUET_W_C3A];
+
+  if (ApuStatAtl[0])
+    ApuStatAtl[0]--;
+  if (ApuStatAtl[1])
+    ApuStatAtl[1]--;
+
+  if (ApuStatC3Reload)
+    ApuStatC3Llc = ((WORD)c3a & 0x7f) << 6;
+  else if (ApuStatC3Llc > 0)
+    ApuStatC3Llc = std::max<int>(0, (int)ApuStatC3Llc - 4 * 64);
+  if (!(c3a & 0x80))
+    ApuStatC3Reload = false;
+  if (ApuStatAtl[2] && !(c3a & 0x80))
+    ApuStatAtl[2]--;
+
+  if (ApuStatAtl[3] && !(ApuStatReg[APUET_W_C4A] & 0x20))
+    ApuStatAtl[3]--;
+}
+
+BYTE __not_in_flash_func(InfoNES_pAPUStatus)()
+{
+  BYTE byRet = 0;
+  if (ApuStatAtl[0] > 0)
+    byRet |= (1 << 0);
+  if (ApuStatAtl[1] > 0)
+    byRet |= (1 << 1);
+  if (!(ApuStatReg[APUET_W_C3A] & 0x80) ? ApuStatAtl[2] > 0 : ApuStatC3Llc > 0)
+    byRet |= (1 << 2);
+  if (ApuStatAtl[3] > 0)
+    byRet |= (1 << 3);
+  return byRet;
+}
+#else
+BYTE __not_in_flash_func(InfoNES_pAPUStatus)()
+{
+  BYTE byRet = 0;
+  if (ApuC1Atl > 0)
+    byRet |= (1 << 0);
+  if (ApuC2Atl > 0)
+    byRet |= (1 << 1);
+  if (!ApuC3Holdnote)
+  {
+    if (ApuC3Atl > 0)
+      byRet |= (1 << 2);
   }
   else
   {
-    memset(wave_buffers[4], 0, n << 1);
+    if (ApuC3Llc > 0)
+      byRet |= (1 << 2);
   }
+  if (ApuC4Atl > 0)
+    byRet |= (1 << 3);
+  return byRet;
 }
+#endif /* APU_THREAD */
 
 /*===================================================================*/
 /*                                                                   */
@@ -1012,7 +1815,8 @@ void __not_in_flash_func(ApuRenderingWave5)(int n)
 /*                                                                   */
 /*===================================================================*/
 
-void InfoNES_pAPUVsync()
+/* Envelopes, sweeps and length counters, once per frame */
+static void __not_in_flash_func(ApuSequencer)()
 {
   if (ApuC1Atl)
   {
@@ -1151,6 +1955,21 @@ void InfoNES_pAPUVsync()
   //        ApuC5Looping, ApuC5DpcmValue, ApuC5Address, ApuC5DmaLength);
 }
 
+void InfoNES_pAPUVsync()
+{
+#ifdef APU_THREAD
+  /* The consumer runs the sequencer when it gets to the end of the frame */
+  ApuStatusVsync();
+  ApuEventPush(APUET_VSYNC, 0);
+#else
+#ifdef APU_FRAME
+  /* The frame's audio, with the envelopes and counters it was played with */
+  ApuRenderingFrame();
+#endif
+  ApuSequencer();
+#endif
+}
+
 /*===================================================================*/
 /*                                                                   */
 /*     InfoNES_pApuHsync() : Callback Function per Hsync             */
@@ -1159,8 +1978,129 @@ void InfoNES_pAPUVsync()
 
 uint32_t leftSamples16 = 0;
 
+#ifdef APU_FRAME
+static DWORD ApuSyncStart16; /* leftSamples16 at ApuEventTail */
+
+/*-------------------------------------------------------------------*/
+/*  Render a channel through the scanlines up to end                 */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  Gives the same samples as rendering every scanline on its own: the
+ *  writes of a scanline still land before its first sample, but the
+ *  samples between two writes go out in one call.
+ */
+static void __not_in_flash_func(ApuRenderingBatch)(void (*write)(const ApuEvent_t &),
+                                                   void (*render)(BYTE *, int), BYTE *wave,
+                                                   ApuEventIndex_t end)
+{
+  ApuCtrlNew = ApuCtrl;
+
+  int done = 0;
+  int pending = 0;
+  for (ApuEventIndex_t event = ApuEventTail; event != end; event++)
+  {
+    const ApuEvent_t &ev = ApuEventQueue[event & APU_EVENT_MASK];
+    if (ev.type == APUET_SYNC)
+    {
+      pending += ev.data & APU_SYNC_SAMPLES;
+      continue;
+    }
+    if (pending)
+    {
+      render(wave + done, pending);
+      done += pending;
+      pending = 0;
+    }
+    write(ev);
+  }
+  render(wave + done, pending);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Render and output the finished scanlines                         */
+/*-------------------------------------------------------------------*/
+
+static void __not_in_flash_func(ApuRenderingFrame)()
+{
+  const ApuEventIndex_t end = ApuSyncEvent;
+  const int n = ApuSyncSamples;
+
+  if (ApuSyncEnabled)
+  {
+#ifdef APU_BLIP
+    ApuBlipStart16 = ApuSyncStart16;
+    ApuBlipClocks = ApuSyncTime;
+    if (ApuSyncTime)
+      ApuBlipRate = (DWORD)((((uint64_t)ApuSyncLines * ApuSamplesPerSync16) << 16) / ApuSyncTime);
+    ApuSynthWave1(n, ApuEventTail, end);
+    ApuSynthWave2(n, ApuEventTail, end);
+    ApuSynthWave3(n, ApuEventTail, end);
+    ApuSynthWave4(n, ApuEventTail, end);
+    ApuSynthWave5(n, ApuEventTail, end);
+#else
+    ApuRenderingBatch(ApuWriteEvent1, ApuRenderWave1, wave_buffers[0], end);
+    ApuRenderingBatch(ApuWriteEvent2, ApuRenderWave2, wave_buffers[1], end);
+    ApuRenderingBatch(ApuWriteEvent3, ApuRenderWave3, wave_buffers[2], end);
+    ApuRenderingBatch(ApuWriteEvent4, ApuRenderWave4, wave_buffers[3], end);
+    ApuRenderingBatch(ApuWriteEvent5, ApuRenderWave5, wave_buffers[4], end);
+#endif
+    ApuCtrl = ApuCtrlNew;
+  }
+  else
+  {
+    memset(&wave_buffers[0][0], 0, n);
+    memset(&wave_buffers[1][0], 0, n);
+    memset(&wave_buffers[2][0], 0, n);
+    memset(&wave_buffers[3][0], 0, n);
+    memset(&wave_buffers[4][0], 0, n);
+  }
+
+  if (ApuExt)
+  {
+    /* Its writes apply with the sound off too, see ApuRenderingExt() */
+    ApuRenderingBatch(ApuWriteEventExt, ApuRenderWaveExt, ApuExtWave, end);
+    if (!ApuSyncEnabled)
+      memset(ApuExtWave, 0, n);
+  }
+
+  InfoNES_SoundOutput(n,
+                      wave_buffers[0], wave_buffers[1], wave_buffers[2],
+                      wave_buffers[3], wave_buffers[4], ApuExt ? ApuExtWave : NULL);
+
+#ifdef APU_THREAD
+  /* The slots up to end are core0's again; the events are line-timed */
+  __atomic_store_n(&ApuEventTail, end, __ATOMIC_RELEASE);
+#else
+  /* Writes of the unfinished scanline stay, timed from its start */
+  for (int event = end; event < cur_event; event++)
+  {
+    ApuEventQueue[event & APU_EVENT_MASK].time -= ApuSyncTime;
+  }
+  entertime += ApuSyncTime;
+
+  const int base = end & ~APU_EVENT_MASK;
+  ApuEventTail = ApuSyncEvent = end - base;
+  cur_event -= base;
+  ApuSyncStart16 = leftSamples16;
+#endif
+
+  ApuSyncTime = 0;
+  ApuSyncSamples = 0;
+  ApuSyncLines = 0;
+}
+#endif /* APU_FRAME */
+
 void __not_in_flash_func(InfoNES_pAPUHsync)(bool enabled)
 {
+  /* Copies started during the scanline are done by now, usually */
+  ApuDpcmLanded();
+  if (ApuDpcmDirty)
+    ApuDpcmPrefetch();
+
+#ifdef APU_BLIP
+  ApuBlipStart16 = leftSamples16;
+#endif
   auto n16 = ApuSamplesPerSync16 + leftSamples16;
   auto n = n16 >> 16;
   leftSamples16 = n16 - (n << 16);
@@ -1168,13 +2108,39 @@ void __not_in_flash_func(InfoNES_pAPUHsync)(bool enabled)
   int bufferLeft = InfoNES_GetSoundBufferSize();
   n = std::min<int>(bufferLeft, n);
 
+#ifdef APU_THREAD
+  /* Only mark the end of the scanline; InfoNES_pAPUProcess() renders */
+  ApuEventPush(APUET_SYNC, n | (enabled ? APU_SYNC_ON : 0));
+  entertime = getPassedClocks();
+#elif defined(APU_FRAME)
+  /* Only mark the end of the scanline; InfoNES_pAPUVsync() renders */
+  ApuEventPush(APUET_SYNC, n);
+  ApuSyncEvent = cur_event;
+  ApuSyncTime = ApuEventQueue[(cur_event - 1) & APU_EVENT_MASK].time;
+  ApuSyncSamples += n;
+  ApuSyncLines++;
+  ApuSyncEnabled = enabled;
+
+  if (ApuSyncSamples > APU_WAVE_SAMPLES - 4)
+  {
+    ApuRenderingFrame();
+  }
+#else
   if (enabled)
   {
+#ifdef APU_BLIP
+    ApuSynthWave1(n, 0, cur_event);
+    ApuSynthWave2(n, 0, cur_event);
+    ApuSynthWave3(n, 0, cur_event);
+    ApuSynthWave4(n, 0, cur_event);
+    ApuSynthWave5(n, 0, cur_event);
+#else
     ApuRenderingWave1(n);
     ApuRenderingWave2(n);
     ApuRenderingWave3(n);
     ApuRenderingWave4(n);
     ApuRenderingWave5(n);
+#endif
     ApuCtrl = ApuCtrlNew;
   }
   else
@@ -1186,14 +2152,70 @@ void __not_in_flash_func(InfoNES_pAPUHsync)(bool enabled)
     memset(&wave_buffers[4][0], 0, n);
   }
 
+  if (ApuExt)
+    ApuRenderingExt(n, enabled);
+
   InfoNES_SoundOutput(n,
                       wave_buffers[0], wave_buffers[1], wave_buffers[2],
-                      wave_buffers[3], wave_buffers[4]);
+                      wave_buffers[3], wave_buffers[4], ApuExt ? ApuExtWave : NULL);
 
   entertime = getPassedClocks();
   cur_event = 0;
+#endif
+}
+
+#ifdef APU_THREAD
+/*===================================================================*/
+/*                                                                   */
+/*    InfoNES_pAPUProcess() : Render the queued frames ( consumer )  */
+/*                                                                   */
+/*===================================================================*/
+
+void __not_in_flash_func(InfoNES_pAPUProcess)()
+{
+  __atomic_store_n(&ApuBusy, true, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ApuHold, __ATOMIC_SEQ_CST))
+  {
+    __atomic_store_n(&ApuBusy, false, __ATOMIC_SEQ_CST);
+    return;
+  }
+
+  const ApuEventIndex_t head = __atomic_load_n(&cur_event, __ATOMIC_ACQUIRE);
+  while (ApuScanEvent != head)
+  {
+    const ApuEvent_t &ev = ApuEventQueue[ApuScanEvent++ & APU_EVENT_MASK];
+    if (ev.type == APUET_SYNC)
+    {
+      ApuSyncEvent = ApuScanEvent;
+      ApuSyncSamples += ev.data & APU_SYNC_SAMPLES;
+      ApuSyncLines++;
+      ApuSyncEnabled = ev.data & APU_SYNC_ON;
+
+      /* The wave buffers are full, or core0 is about to wait for room */
+      if (ApuSyncSamples > APU_WAVE_SAMPLES - 4 || ApuSyncEvent - ApuEventTail >= APU_EVENT_MAX / 2)
+      {
+        ApuRenderingFrame();
+      }
+    }
+    else if (ev.type == APUET_VSYNC)
+    {
+      /* The frame's audio, with the envelopes and counters it was played with */
+      ApuSyncEvent = ApuScanEvent;
+      ApuRenderingFrame();
+      ApuSequencer();
+    }
+  }
+
+  __atomic_store_n(&ApuScanDone, ApuScanEvent, __ATOMIC_RELEASE);
+  __atomic_store_n(&ApuBusy, false, __ATOMIC_SEQ_CST);
 }
 
+bool InfoNES_pAPUIdle()
+{
+  return __atomic_load_n(&ApuScanDone, __ATOMIC_ACQUIRE) == cur_event;
+}
+#endif /* APU_THREAD */
+
 /*===================================================================*/
 /*                                                                   */
 /*            InfoNES_pApuInit() : Initialize pApu                   */
@@ -1202,10 +2224,15 @@ void __not_in_flash_func(InfoNES_pAPUHsync)(bool enabled)
 
 void InfoNES_pAPUInit(void)
 {
+#ifdef APU_THREAD
+  /* Nothing queued for the old state may be rendered into the new one */
+  ApuThreadPause();
+#endif
+
   /* Sound Hardware Init */
   InfoNES_SoundInit();
 
-  ApuQuality = pAPU_QUALITY - 1; // 1: 22050, 2: 44100 [samples/sec]
+  ApuQuality = pAPU_QUALITY - 1; // 1: 22372, 2: 44744 [samples/sec]
 
   ApuPulseMagic = ApuQual[ApuQuality].pulse_magic;
   ApuTriangleMagic = ApuQual[ApuQuality].triangle_magic;
@@ -1234,7 +2261,7 @@ void InfoNES_pAPUInit(void)
   ApuC1EnvVol = ApuC2EnvVol = ApuC4EnvVol = 0;
   ApuC1Atl = ApuC2Atl = ApuC4Atl = 0;
   ApuC1SweepPhase = ApuC2SweepPhase = 0;
-  ApuC1Freq = ApuC2Freq = ApuC4Freq = 0;
+  ApuC1Freq = ApuC2Freq = 0;
   ApuC4Sr = 1;
   ApuC4Fdc = 0;
 
@@ -1255,18 +2282,53 @@ void InfoNES_pAPUInit(void)
   ApuC5Freq = ApuC5Phaseacc;
   ApuC5Address = ApuC5CacheAddr = 0;
   ApuC5DmaLength = ApuC5CacheDmaLength = 0;
+  ApuC5Slot = ApuC5CacheSlot = -1;
+  ApuC5Offset = 0;
+
+  /* A new cassette may sit where the old one was: drop every slot */
+  while (ApuDpcmPending >= 0)
+    ApuDpcmLanded();
+  for (int i = 0; i < APU_DPCM_SLOTS; i++)
+  {
+    ApuDpcmSlot[i].len = 0;
+    ApuDpcmSlot[i].used = 0;
+  }
+  ApuDpcmReg[0] = ApuDpcmReg[1] = 0;
+  ApuDpcmDirty = false;
+  ApuDpcmStamp = 0;
 
   /*-------------------------------------------------------------------*/
   /*   Initialize Wave Buffers                                         */
   /*-------------------------------------------------------------------*/
-  InfoNES_MemorySet((void *)wave_buffers[0], 0, 735);
-  InfoNES_MemorySet((void *)wave_buffers[1], 0, 735);
-  InfoNES_MemorySet((void *)wave_buffers[2], 0, 735);
-  InfoNES_MemorySet((void *)wave_buffers[3], 0, 735);
-  InfoNES_MemorySet((void *)wave_buffers[4], 0, 735);
+  InfoNES_MemorySet((void *)wave_buffers[0], 0, APU_WAVE_SAMPLES);
+  InfoNES_MemorySet((void *)wave_buffers[1], 0, APU_WAVE_SAMPLES);
+  InfoNES_MemorySet((void *)wave_buffers[2], 0, APU_WAVE_SAMPLES);
+  InfoNES_MemorySet((void *)wave_buffers[3], 0, APU_WAVE_SAMPLES);
+  InfoNES_MemorySet((void *)wave_buffers[4], 0, APU_WAVE_SAMPLES);
+
+#ifdef APU_BLIP
+  ApuBlipInit();
+#endif
+
+  /* The mapper's init function registers its chip again */
+  ApuExt = NULL;
 
   entertime = getPassedClocks();
   cur_event = 0;
+#ifdef APU_FRAME
+  ApuEventTail = ApuSyncEvent = 0;
+  ApuSyncTime = 0;
+  ApuSyncSamples = ApuSyncLines = 0;
+  ApuSyncStart16 = leftSamples16;
+#endif
+#ifdef APU_THREAD
+  ApuScanEvent = ApuScanDone = 0;
+  InfoNES_MemorySet((void *)ApuStatReg, 0, sizeof ApuStatReg);
+  InfoNES_MemorySet((void *)ApuStatAtl, 0, sizeof ApuStatAtl);
+  ApuStatC3Llc = 0;
+  ApuStatC3Reload = false;
+  ApuThreadResume();
+#endif
 }
 
 /*===================================================================*/
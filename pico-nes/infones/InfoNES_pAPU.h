@@ -100,12 +100,23 @@
 /*  pAPU Event resources                                             */
 /*-------------------------------------------------------------------*/
 
+#if defined(APU_THREAD) && (!defined(APU_FRAME) || defined(APU_BLIP))
+#error "APU_THREAD builds on APU_FRAME without APU_BLIP"
+#endif
+
 //#define APU_EVENT_MAX 15000
-#define APU_EVENT_MAX 100
+/* Ring of register writes; a power of two, and far more than one scanline writes */
+#ifdef APU_THREAD
+/* Several frames, so core0 does not wait while core1 refreshes the LCD */
+#define APU_EVENT_MAX 4096
+#else
+#define APU_EVENT_MAX 256
+#endif
+#define APU_EVENT_MASK (APU_EVENT_MAX - 1)
 
 struct ApuEvent_t
 {
-  short time;
+  WORD time; /* Clocks since entertime */
   BYTE type;
   BYTE data;
 };
@@ -137,7 +148,14 @@ struct ApuEvent_t
 #define APUET_W_C5C 0x12
 #define APUET_W_C5D 0x13
 #define APUET_W_CTRL 0x20
-#define APUET_SYNC 0x40
+#define APUET_SYNC 0x40 /* End of a scanline, data = its samples ( APU_FRAME ) */
+#define APUET_VSYNC 0x44 /* End of a frame ( APU_THREAD ); the write handlers ignore it */
+#define APUET_DPCM 0x48  /* Prefetch slot of the last $4012 / $4013 write, data = slot | gen << 2 */
+#define APUET_EXT 0x80  /* Expansion chip write, type & 0x7f = its register */
+
+/* APUET_SYNC data: samples, and whether the sound was on ( APU_THREAD ) */
+#define APU_SYNC_SAMPLES 0x7f
+#define APU_SYNC_ON 0x80
 
 /*-------------------------------------------------------------------*/
 /*  Function prototypes                                              */
@@ -156,45 +174,72 @@ void InfoNES_pAPUDone(void);
 void InfoNES_pAPUVsync(void);
 void InfoNES_pAPUHsync(bool enabled);
 
-/*-------------------------------------------------------------------*/
-/*  pAPU Quality resources                                           */
-/*-------------------------------------------------------------------*/
+/* Length counter bits of $4015 */
+BYTE InfoNES_pAPUStatus(void);
 
-/*-------------------------------------------------------------------*/
-/* ApuQuality is used to control the sound playback rate.            */
-/* 1 is 11015 Hz.                                                    */
-/* 2 is 22050 Hz.                                                    */
-/* 3 is 44100 Hz.                                                    */
-/* these values subject to change without notice.                    */
-/*-------------------------------------------------------------------*/
-extern int ApuQuality;
-#define pAPU_QUALITY 3
+/* The DPCM prefetch slots copied from a PRG bank are stale */
+void InfoNES_pAPUForgetBank(const BYTE *pbyBank);
 
-/*-------------------------------------------------------------------*/
-/*  Rectangle Wave #1 resources                                      */
-/*-------------------------------------------------------------------*/
+#ifdef APU_THREAD
+/*
+ *  Synthesis on the other core ( a thread on the host ). The emulation
+ *  only queues the writes; InfoNES_pAPUProcess() renders the scanlines
+ *  queued so far, runs the Vsync sequencer and hands each frame to
+ *  InfoNES_SoundOutput() from the calling core. It returns at once when
+ *  there is nothing to do, so call it from the other core's loop.
+ */
+void InfoNES_pAPUProcess(void);
 
-extern BYTE ApuC1Atl;
+/* Every queued event has been through InfoNES_pAPUProcess() */
+bool InfoNES_pAPUIdle(void);
+#endif
 
 /*-------------------------------------------------------------------*/
-/*  Rectangle Wave #2 resources                                      */
+/*  Expansion audio                                                  */
 /*-------------------------------------------------------------------*/
 
-extern BYTE ApuC2Atl;
+/*
+ *  A cartridge sound chip ( VRC6, N163, 5B ). The mapper registers it
+ *  from its init function and queues the chip's register writes with
+ *  InfoNES_pAPUWriteExt(); they go through the event queue with the APU
+ *  writes and the chip is rendered in the same pass. Per scanline, a
+ *  line's writes all apply before its samples are rendered; with
+ *  APU_FRAME the chip is rendered a block of samples between two writes
+ *  at a time. Its wave is the sixth one handed to InfoNES_SoundOutput():
+ *  0..255, mixed linearly.
+ */
+struct ApuExt_t
+{
+  void (*reset)(void);                /* Power-on state */
+  void (*write)(BYTE reg, BYTE data); /* reg is 0..0x7f, numbered by the chip */
+  void (*render)(BYTE *wave, int n);  /* Next n samples */
+};
 
-/*-------------------------------------------------------------------*/
-/*  Triangle Wave resources                                          */
-/*-------------------------------------------------------------------*/
+/* NULL removes the chip; InfoNES_pAPUInit() does so on every reset */
+void InfoNES_pAPUSetExt(const ApuExt_t *ext);
+void InfoNES_pAPUWriteExt(BYTE reg, BYTE data);
 
-extern BYTE ApuC3a;
-extern BYTE ApuC3Atl;
-extern DWORD ApuC3Llc; /* Linear Length Counter */
+/* CPU clocks per sample, 16.16 */
+extern DWORD ApuCycleRate;
+
+/* Samples per scanline, 16.16; SCAN_VBLANK_END + 1 of them make a frame */
+extern unsigned int ApuSamplesPerSync16;
 
 /*-------------------------------------------------------------------*/
-/*  Noise resources                                                  */
+/*  pAPU Quality resources                                           */
 /*-------------------------------------------------------------------*/
 
-extern BYTE ApuC4Atl;
+/*-------------------------------------------------------------------*/
+/* ApuQuality is used to control the synthesis rate.                 */
+/* 1 is 1789773 / 160 = 11186 Hz.                                    */
+/* 2 is 1789773 / 80 = 22372 Hz.                                     */
+/* 3 is 1789773 / 40 = 44744 Hz.                                     */
+/* The platform resamples to its output rate.                        */
+/*-------------------------------------------------------------------*/
+extern int ApuQuality;
+#ifndef pAPU_QUALITY
+#define pAPU_QUALITY 3
+#endif
 
 #endif /* InfoNES_PAPU_H_INCLUDED */
 
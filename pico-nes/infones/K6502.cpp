@@ -11,6 +11,7 @@
 /*-------------------------------------------------------------------*/
 
 #include "K6502.h"
+#include "InfoNES.h"
 #include "InfoNES_System.h"
 
 #include <stdio.h>
@@ -26,17 +27,17 @@
 // Addressing Op.
 // Address
 // (Indirect,X)
-#define AA_IX K6502_ReadZpW(K6502_Read(PC++) + X)
+#define AA_IX K6502_ReadZpW(K6502_Fetch() + X)
 // (Indirect),Y
-#define AA_IY K6502_ReadZpW(K6502_Read(PC++)) + Y
+#define AA_IY K6502_ReadZpW(K6502_Fetch()) + Y
 // Zero Page
-#define AA_ZP K6502_Read(PC++)
+#define AA_ZP K6502_Fetch()
 // Zero Page,X
-#define AA_ZPX (BYTE)(K6502_Read(PC++) + X)
+#define AA_ZPX (BYTE)(K6502_Fetch() + X)
 // Zero Page,Y
-#define AA_ZPY (BYTE)(K6502_Read(PC++) + Y)
+#define AA_ZPY (BYTE)(K6502_Fetch() + Y)
 // Absolute
-#define AA_ABS (K6502_Read(PC++) | (WORD)K6502_Read(PC++) << 8)
+#define AA_ABS K6502_FetchW()
 // Absolute2 ( PC-- )
 #define AA_ABS2 (K6502_Read(PC++) | (WORD)K6502_Read(PC) << 8)
 // Absolute,X
@@ -62,19 +63,27 @@
 // Absolute,Y
 #define A_ABSY K6502_ReadAbsY()
 // Immediate
-#define A_IMM K6502_Read(PC++)
+#define A_IMM K6502_Fetch()
 
 // Flag Op.
 #define SETF(a) F |= (a)
 #define RSTF(a) F &= ~(a)
-#define TEST(a)          \
-  RSTF(FLAG_N | FLAG_Z); \
-  SETF(g_byTestTable[a])
+// N and Z are evaluated lazily inside step() : N is bit 7 of byFlagN
+// and Z is set when byFlagZ is 0. The other flags live in F.
+#define TEST(a) byFlagN = byFlagZ = (a)
+#define GETF() ((F & ~(FLAG_N | FLAG_Z)) | (byFlagN & FLAG_N) | (byFlagZ ? 0 : FLAG_Z))
+#define PUTF(a)  \
+  F = (a);       \
+  byFlagN = F;   \
+  byFlagZ = ~F & FLAG_Z
 
 // Load & Store Op.
 #define STA(a) K6502_Write((a), A);
 #define STX(a) K6502_Write((a), X);
 #define STY(a) K6502_Write((a), Y);
+#define STA_ZP(a) K6502_WriteZp((a), A);
+#define STX_ZP(a) K6502_WriteZp((a), X);
+#define STY_ZP(a) K6502_WriteZp((a), Y);
 #define LDA(a) \
   A = (a);     \
   TEST(A);
@@ -105,98 +114,127 @@
 #define EOR(a) \
   A ^= (a);    \
   TEST(A)
-#define BIT(a)                    \
-  byD0 = (a);                     \
-  RSTF(FLAG_N | FLAG_V | FLAG_Z); \
-  SETF((byD0 & (FLAG_N | FLAG_V)) | ((byD0 & A) ? 0 : FLAG_Z));
-#define CMP(a)                    \
-  wD0 = (WORD)A - (a);            \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  SETF(g_byTestTable[wD0 & 0xff] | (wD0 < 0x100 ? FLAG_C : 0));
-#define CPX(a)                    \
-  wD0 = (WORD)X - (a);            \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  SETF(g_byTestTable[wD0 & 0xff] | (wD0 < 0x100 ? FLAG_C : 0));
-#define CPY(a)                    \
-  wD0 = (WORD)Y - (a);            \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  SETF(g_byTestTable[wD0 & 0xff] | (wD0 < 0x100 ? FLAG_C : 0));
+#define BIT(a)         \
+  byD0 = (a);          \
+  RSTF(FLAG_V);        \
+  SETF(byD0 & FLAG_V); \
+  byFlagN = byD0;      \
+  byFlagZ = byD0 & A;
+#define CMP(a)         \
+  wD0 = (WORD)A - (a); \
+  RSTF(FLAG_C);        \
+  SETF(wD0 < 0x100);   \
+  TEST((BYTE)wD0);
+#define CPX(a)         \
+  wD0 = (WORD)X - (a); \
+  RSTF(FLAG_C);        \
+  SETF(wD0 < 0x100);   \
+  TEST((BYTE)wD0);
+#define CPY(a)         \
+  wD0 = (WORD)Y - (a); \
+  RSTF(FLAG_C);        \
+  SETF(wD0 < 0x100);   \
+  TEST((BYTE)wD0);
 
 // Math Op. (A D flag isn't being supported.)
 #define ADC(a)                                                                                 \
   byD0 = (a);                                                                                  \
   wD0 = A + byD0 + (F & FLAG_C);                                                               \
   byD1 = (BYTE)wD0;                                                                            \
-  RSTF(FLAG_N | FLAG_V | FLAG_Z | FLAG_C);                                                     \
-  SETF(g_byTestTable[byD1] | ((~(A ^ byD0) & (A ^ byD1) & 0x80) ? FLAG_V : 0) | (wD0 > 0xff)); \
-  A = byD1;
+  RSTF(FLAG_V | FLAG_C);                                                                       \
+  SETF(((~(A ^ byD0) & (A ^ byD1) & 0x80) ? FLAG_V : 0) | (wD0 > 0xff));                      \
+  A = byD1;                                                                                    \
+  TEST(A);
 
 #define SBC(a)                                                                                 \
   byD0 = (a);                                                                                  \
   wD0 = A - byD0 - (~F & FLAG_C);                                                              \
   byD1 = (BYTE)wD0;                                                                            \
-  RSTF(FLAG_N | FLAG_V | FLAG_Z | FLAG_C);                                                     \
-  SETF(g_byTestTable[byD1] | (((A ^ byD0) & (A ^ byD1) & 0x80) ? FLAG_V : 0) | (wD0 < 0x100)); \
-  A = byD1;
+  RSTF(FLAG_V | FLAG_C);                                                                       \
+  SETF((((A ^ byD0) & (A ^ byD1) & 0x80) ? FLAG_V : 0) | (wD0 < 0x100));                      \
+  A = byD1;                                                                                    \
+  TEST(A);
 
-#define DEC(a)            \
+#define DEC_M(a, RD, WR) \
   wA0 = a;                \
-  byD0 = K6502_Read(wA0); \
+  byD0 = RD(wA0);         \
   --byD0;                 \
-  K6502_Write(wA0, byD0); \
+  WR(wA0, byD0);          \
   TEST(byD0)
-#define INC(a)            \
+#define INC_M(a, RD, WR) \
   wA0 = a;                \
-  byD0 = K6502_Read(wA0); \
+  byD0 = RD(wA0);         \
   ++byD0;                 \
-  K6502_Write(wA0, byD0); \
+  WR(wA0, byD0);          \
   TEST(byD0)
+#define DEC(a) DEC_M(a, K6502_Read, K6502_Write)
+#define INC(a) INC_M(a, K6502_Read, K6502_Write)
+#define DEC_ZP(a) DEC_M(a, K6502_ReadZp, K6502_WriteZp)
+#define INC_ZP(a) INC_M(a, K6502_ReadZp, K6502_WriteZp)
 
 // Shift Op.
-#define ASLA                      \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  SETF(g_ASLTable[A].byFlag);     \
-  A = g_ASLTable[A].byValue
-#define ASL(a)                    \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  wA0 = a;                        \
-  byD0 = K6502_Read(wA0);         \
-  SETF(g_ASLTable[byD0].byFlag);  \
-  K6502_Write(wA0, g_ASLTable[byD0].byValue)
-#define LSRA                      \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  SETF(g_LSRTable[A].byFlag);     \
-  A = g_LSRTable[A].byValue
-#define LSR(a)                    \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C); \
-  wA0 = a;                        \
-  byD0 = K6502_Read(wA0);         \
-  SETF(g_LSRTable[byD0].byFlag);  \
-  K6502_Write(wA0, g_LSRTable[byD0].byValue)
+#define ASLA        \
+  RSTF(FLAG_C);     \
+  SETF(A >> 7);     \
+  A <<= 1;          \
+  TEST(A)
+#define ASL_M(a, RD, WR) \
+  wA0 = a;               \
+  byD0 = RD(wA0);        \
+  RSTF(FLAG_C);          \
+  SETF(byD0 >> 7);       \
+  byD0 <<= 1;            \
+  WR(wA0, byD0);         \
+  TEST(byD0)
+#define LSRA          \
+  RSTF(FLAG_C);       \
+  SETF(A & FLAG_C);   \
+  A >>= 1;            \
+  TEST(A)
+#define LSR_M(a, RD, WR) \
+  wA0 = a;               \
+  byD0 = RD(wA0);        \
+  RSTF(FLAG_C);          \
+  SETF(byD0 & FLAG_C);   \
+  byD0 >>= 1;            \
+  WR(wA0, byD0);         \
+  TEST(byD0)
 #define ROLA                        \
-  byD0 = F & FLAG_C;                \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C);   \
-  SETF(g_ROLTable[byD0][A].byFlag); \
-  A = g_ROLTable[byD0][A].byValue
-#define ROL(a)                         \
-  byD1 = F & FLAG_C;                   \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C);      \
-  wA0 = a;                             \
-  byD0 = K6502_Read(wA0);              \
-  SETF(g_ROLTable[byD1][byD0].byFlag); \
-  K6502_Write(wA0, g_ROLTable[byD1][byD0].byValue)
-#define RORA                        \
-  byD0 = F & FLAG_C;                \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C);   \
-  SETF(g_RORTable[byD0][A].byFlag); \
-  A = g_RORTable[byD0][A].byValue
-#define ROR(a)                         \
-  byD1 = F & FLAG_C;                   \
-  RSTF(FLAG_N | FLAG_Z | FLAG_C);      \
-  wA0 = a;                             \
-  byD0 = K6502_Read(wA0);              \
-  SETF(g_RORTable[byD1][byD0].byFlag); \
-  K6502_Write(wA0, g_RORTable[byD1][byD0].byValue)
+  byD0 = (A << 1) | (F & FLAG_C);   \
+  RSTF(FLAG_C);                     \
+  SETF(A >> 7);                     \
+  A = byD0;                         \
+  TEST(A)
+#define ROL_M(a, RD, WR)                \
+  wA0 = a;                              \
+  byD0 = RD(wA0);                       \
+  byD1 = (byD0 << 1) | (F & FLAG_C);    \
+  RSTF(FLAG_C);                         \
+  SETF(byD0 >> 7);                      \
+  WR(wA0, byD1);                        \
+  TEST(byD1)
+#define RORA                            \
+  byD0 = (A >> 1) | ((F & FLAG_C) << 7); \
+  RSTF(FLAG_C);                         \
+  SETF(A & FLAG_C);                     \
+  A = byD0;                             \
+  TEST(A)
+#define ROR_M(a, RD, WR)                    \
+  wA0 = a;                                  \
+  byD0 = RD(wA0);                           \
+  byD1 = (byD0 >> 1) | ((F & FLAG_C) << 7); \
+  RSTF(FLAG_C);                             \
+  SETF(byD0 & FLAG_C);                      \
+  WR(wA0, byD1);                            \
+  TEST(byD1)
+#define ASL(a) ASL_M(a, K6502_Read, K6502_Write)
+#define LSR(a) LSR_M(a, K6502_Read, K6502_Write)
+#define ROL(a) ROL_M(a, K6502_Read, K6502_Write)
+#define ROR(a) ROR_M(a, K6502_Read, K6502_Write)
+#define ASL_ZP(a) ASL_M(a, K6502_ReadZp, K6502_WriteZp)
+#define LSR_ZP(a) LSR_M(a, K6502_ReadZp, K6502_WriteZp)
+#define ROL_ZP(a) ROL_M(a, K6502_ReadZp, K6502_WriteZp)
+#define ROR_ZP(a) ROR_M(a, K6502_ReadZp, K6502_WriteZp)
 
 // Jump Op.
 #define JSR      \
@@ -210,14 +248,40 @@
     PC += (int8_t)K6502_Read(PC);               \
     CLK(3 + ((wA0 & 0x0100) != (PC & 0x0100))); \
     ++PC;                                       \
+    if (PC < wA0)                               \
+    {                                           \
+      IDLE_LOOP(wA0 - 1);                       \
+    }                                           \
   }                                             \
   else                                          \
   {                                             \
     ++PC;                                       \
     CLK(2);                                     \
+    wIdleHead = 0;                              \
   }
 #define JMP(a) PC = a;
 
+// Idle loop Op.
+// Called when the instruction at wTail has just jumped back to PC. After
+// one whole iteration from PC, the loop is skipped ahead by whole
+// iterations up to the end of the clock budget ( see K6502_IdleBlock() ).
+#define IDLE_LOOP(wTail)                                           \
+  if (K6502_IdleBlock(PC, (wTail)))                                \
+  {                                                                \
+    if (wIdleHead == PC)                                           \
+    {                                                              \
+      int nIter = g_wPassedClocks - nIdleClocks;                   \
+      int nSkip = (wClocks - g_wPassedClocks - 1) / nIter;         \
+      if (nSkip > 0)                                               \
+      {                                                            \
+        g_wPassedClocks += nSkip * nIter;                          \
+        K6502_COUNT_IDLE(nSkip, nIter);                            \
+      }                                                            \
+    }                                                              \
+    wIdleHead = PC;                                                \
+    nIdleClocks = g_wPassedClocks;                                 \
+  }
+
 /*-------------------------------------------------------------------*/
 /*  Global valiables                                                 */
 /*-------------------------------------------------------------------*/
@@ -251,27 +315,51 @@ WORD getPassedClocks()
   return g_wCurrentClocks;
 }
 
-// A table for the test
-BYTE g_byTestTable[256];
+// Page table
+BYTE *K6502_ReadMap[0x100];
+BYTE *K6502_WriteMap[0x100];
+
+// The banks K6502_ReadMap was last built from ( ROMBANK0-3, SRAM )
+static BYTE *s_pbyMappedBank[5];
+
+#ifdef K6502_PROFILE
+// The number of the executed instructions ( host benchmark )
+DWORD g_dwInstructions;
+// The number of the clocks skipped in idle loops ( host benchmark )
+DWORD g_dwIdleClocks;
+#define K6502_COUNT_INSTRUCTION ++g_dwInstructions
+#define K6502_COUNT_IDLE(nSkip, nIter)                                  \
+  g_dwInstructions += (nSkip) * s_IdleCache[s_nIdleIdx].byInstructions; \
+  g_dwIdleClocks += (nSkip) * (nIter)
+#else
+#define K6502_COUNT_INSTRUCTION
+#define K6502_COUNT_IDLE(nSkip, nIter)
+#endif
+
+/*-------------------------------------------------------------------*/
+/*  Idle loop cache                                                  */
+/*-------------------------------------------------------------------*/
 
-// Value and Flag Data
-struct value_table_tag
+// A basic block that jumps back to its own head, checked once by
+// K6502_CheckIdle() and remembered with the ROM bank it came from
+struct idle_block_tag
 {
-  BYTE byValue;
-  BYTE byFlag;
+  BYTE *pbyBank;        // ROM bank of the block ( NULL : empty entry )
+  WORD wHead;           // First instruction
+  WORD wTail;           // The branch or JMP back to wHead
+  BYTE byIdle;          // Whole iterations can be skipped
+  BYTE byInstructions;  // Instructions per iteration
 };
 
-// A table for ASL
-struct value_table_tag g_ASLTable[256];
+#define IDLE_CACHE_SIZE 64
+#define IDLE_BLOCK_MAX 32
 
-// A table for LSR
-struct value_table_tag g_LSRTable[256];
+static struct idle_block_tag s_IdleCache[IDLE_CACHE_SIZE];
 
-// A table for ROL
-struct value_table_tag g_ROLTable[2][256];
+// The entry last returned by K6502_IdleBlock()
+static int s_nIdleIdx;
 
-// A table for ROR
-struct value_table_tag g_RORTable[2][256];
+BYTE K6502_IdleSkip = 1;
 
 /*===================================================================*/
 /*                                                                   */
@@ -286,102 +374,9 @@ void K6502_Init()
  *  You must call this function only once at first.
  */
 
-  BYTE idx;
-  BYTE idx2;
-
   // The establishment of the IRQ pin
   NMI_Wiring = NMI_State = 1;
   IRQ_Wiring = IRQ_State = 1;
-
-  // Make a table for the test
-  idx = 0;
-  do
-  {
-    if (idx == 0)
-      g_byTestTable[0] = FLAG_Z;
-    else if (idx > 127)
-      g_byTestTable[idx] = FLAG_N;
-    else
-      g_byTestTable[idx] = 0;
-
-    ++idx;
-  } while (idx != 0);
-
-  // Make a table ASL
-  idx = 0;
-  do
-  {
-    g_ASLTable[idx].byValue = idx << 1;
-    g_ASLTable[idx].byFlag = 0;
-
-    if (idx > 127)
-      g_ASLTable[idx].byFlag = FLAG_C;
-
-    if (g_ASLTable[idx].byValue == 0)
-      g_ASLTable[idx].byFlag |= FLAG_Z;
-    else if (g_ASLTable[idx].byValue & 0x80)
-      g_ASLTable[idx].byFlag |= FLAG_N;
-
-    ++idx;
-  } while (idx != 0);
-
-  // Make a table LSR
-  idx = 0;
-  do
-  {
-    g_LSRTable[idx].byValue = idx >> 1;
-    g_LSRTable[idx].byFlag = 0;
-
-    if (idx & 1)
-      g_LSRTable[idx].byFlag = FLAG_C;
-
-    if (g_LSRTable[idx].byValue == 0)
-      g_LSRTable[idx].byFlag |= FLAG_Z;
-
-    ++idx;
-  } while (idx != 0);
-
-  // Make a table ROL
-  for (idx2 = 0; idx2 < 2; ++idx2)
-  {
-    idx = 0;
-    do
-    {
-      g_ROLTable[idx2][idx].byValue = (idx << 1) | idx2;
-      g_ROLTable[idx2][idx].byFlag = 0;
-
-      if (idx > 127)
-        g_ROLTable[idx2][idx].byFlag = FLAG_C;
-
-      if (g_ROLTable[idx2][idx].byValue == 0)
-        g_ROLTable[idx2][idx].byFlag |= FLAG_Z;
-      else if (g_ROLTable[idx2][idx].byValue & 0x80)
-        g_ROLTable[idx2][idx].byFlag |= FLAG_N;
-
-      ++idx;
-    } while (idx != 0);
-  }
-
-  // Make a table ROR
-  for (idx2 = 0; idx2 < 2; ++idx2)
-  {
-    idx = 0;
-    do
-    {
-      g_RORTable[idx2][idx].byValue = (idx >> 1) | (idx2 << 7);
-      g_RORTable[idx2][idx].byFlag = 0;
-
-      if (idx & 1)
-        g_RORTable[idx2][idx].byFlag = FLAG_C;
-
-      if (g_RORTable[idx2][idx].byValue == 0)
-        g_RORTable[idx2][idx].byFlag |= FLAG_Z;
-      else if (g_RORTable[idx2][idx].byValue & 0x80)
-        g_RORTable[idx2][idx].byFlag |= FLAG_N;
-
-      ++idx;
-    } while (idx != 0);
-  }
 }
 
 /*===================================================================*/
@@ -396,6 +391,9 @@ void K6502_Reset()
  *
  */
 
+  // Map the banks the mapper has just set up
+  K6502_MapReset();
+
   // Reset Registers
   PC = K6502_ReadW(VECTOR_RESET);
   SP = 0xFF;
@@ -413,958 +411,542 @@ void K6502_Reset()
 
 /*===================================================================*/
 /*                                                                   */
-/*    K6502_Set_Int_Wiring() : Set up wiring of the interrupt pin    */
+/*              K6502_MapReset() : Build the page table              */
 /*                                                                   */
 /*===================================================================*/
-void K6502_Set_Int_Wiring(BYTE byNMI_Wiring, BYTE byIRQ_Wiring)
+void K6502_MapReset()
 {
   /*
- * Set up wiring of the interrupt pin
+ *  Build the page table
+ *
+ *  Remarks
+ *    0x0000 - 0x1fff  RAM, read and write ( 0x800 mirrors )
+ *    0x2000 - 0x5fff  No map, PPU / Sound / Mapper registers
+ *    0x6000 - 0x7fff  SRAM or SRAMBANK, read only
+ *    0x8000 - 0xffff  ROMBANK0 - ROMBANK3, read only
  *
+ *    SRAM writes keep going through K6502_WriteIo() to flag
+ *    SRAMwritten and to reach the mapper.
  */
-
-  NMI_Wiring = byNMI_Wiring;
-  IRQ_Wiring = byIRQ_Wiring;
-}
-
-static void __not_in_flash_func(procNMI)()
-{
-  // Dispose of it if there is an interrupt requirement
-  if (NMI_State != NMI_Wiring)
+  for (int nPage = 0; nPage < 0x100; ++nPage)
   {
-    // NMI Interrupt
-    NMI_State = NMI_Wiring;
-    CLK(7);
-
-    PUSHW(PC);
-    PUSH(F & ~FLAG_B);
-
-    RSTF(FLAG_D);
-    SETF(FLAG_I);
-
-    PC = K6502_ReadW(VECTOR_NMI);
+    K6502_ReadMap[nPage] = K6502_WriteMap[nPage] = NULL;
   }
-  else if (IRQ_State != IRQ_Wiring)
-  {
-    // IRQ Interrupt
-    // Execute IRQ if an I flag isn't being set
-    if (!(F & FLAG_I))
-    {
-      IRQ_State = IRQ_Wiring;
-      CLK(7);
 
-      PUSHW(PC);
-      PUSH(F & ~FLAG_B);
+  for (int nPage = 0; nPage < 0x20; ++nPage)
+  {
+    K6502_ReadMap[nPage] = K6502_WriteMap[nPage] = &RAM[(nPage & 0x07) << 8];
+  }
 
-      RSTF(FLAG_D);
-      SETF(FLAG_I);
+  for (int nBank = 0; nBank < 5; ++nBank)
+  {
+    s_pbyMappedBank[nBank] = NULL;
+  }
+  K6502_MapPrg();
 
-      PC = K6502_ReadW(VECTOR_IRQ);
-    }
+  // Forget the idle loops of the previous image
+  for (int nIdx = 0; nIdx < IDLE_CACHE_SIZE; ++nIdx)
+  {
+    s_IdleCache[nIdx].pbyBank = NULL;
   }
 }
 
-static void __not_in_flash_func(step)(int wClocks)
+/*===================================================================*/
+/*                                                                   */
+/*         K6502_MapPrg() : Follow PRG bank switching in the map     */
+/*                                                                   */
+/*===================================================================*/
+void __not_in_flash_func(K6502_MapPrg)()
 {
   /*
- *  Only the specified number of the clocks execute Op.
+ *  Follow PRG bank switching in the map
  *
- *  Parameters
- *    WORD wClocks              (Read)
- *      The number of the clocks
+ *  Remarks
+ *    Mappers switch banks by storing into ROMBANK0-3 / SRAMBANK.
+ *    This is called after every mapper callback and remaps the
+ *    32 pages of each 8KB bank whose pointer changed.
  */
+  BYTE *pbyBank[5] = {ROMBANK0, ROMBANK1, ROMBANK2, ROMBANK3,
+                      ROM_SRAM ? SRAM : SRAMBANK};
+  static const BYTE byFirstPage[5] = {0x80, 0xa0, 0xc0, 0xe0, 0x60};
 
-  BYTE byCode;
-
-  WORD wA0;
-  BYTE byD0;
-  BYTE byD1;
-  WORD wD0;
-
-  auto prePassedClocks = g_wPassedClocks;
-
-  // It has a loop until a constant clock passes
-  while (g_wPassedClocks < wClocks)
+  for (int nBank = 0; nBank < 5; ++nBank)
   {
-    // if (PC == 0xc449 || PC == 0xc955)
-    // {
-    //   printf("%04x:%02x\n", PC, A);
-    // }
-
-    // if (PC == 0xc44a)
-    // {
-    //   printf("A:%02X X:%02X Y:%02X SP:%02X F:%02X  %04X\n", A, X, Y, SP, F, PC);
-    // }
-
-    // Read an instruction
-    byCode = K6502_Read(PC++);
+    if (pbyBank[nBank] == s_pbyMappedBank[nBank])
+      continue;
 
-    //    printf("PC %04x %02x\n", PC - 1, byCode);
-
-    // Execute an instruction.
-    switch (byCode)
+    s_pbyMappedBank[nBank] = pbyBank[nBank];
+    for (int nPage = 0; nPage < 0x20; ++nPage)
     {
-    case 0x00: // BRK
-      ++PC;
-      PUSHW(PC);
-      SETF(FLAG_B);
-      PUSH(F);
-      SETF(FLAG_I);
-      RSTF(FLAG_D);
-      PC = K6502_ReadW(VECTOR_IRQ);
-      CLK(7);
-      break;
-
-    case 0x01: // ORA (Zpg,X)
-      ORA(A_IX);
-      CLK(6);
-      break;
-
-    case 0x05: // ORA Zpg
-      ORA(A_ZP);
-      CLK(3);
-      break;
-
-    case 0x06: // ASL Zpg
-      ASL(AA_ZP);
-      CLK(5);
-      break;
-
-    case 0x08: // PHP
-      SETF(FLAG_B);
-      PUSH(F);
-      CLK(3);
-      break;
-
-    case 0x09: // ORA #Oper
-      ORA(A_IMM);
-      CLK(2);
-      break;
-
-    case 0x0A: // ASL A
-      ASLA;
-      CLK(2);
-      break;
-
-    case 0x0D: // ORA Abs
-      ORA(A_ABS);
-      CLK(4);
-      break;
-
-    case 0x0e: // ASL Abs
-      ASL(AA_ABS);
-      CLK(6);
-      break;
-
-    case 0x10: // BPL Oper
-      BRA(!(F & FLAG_N));
-      break;
-
-    case 0x11: // ORA (Zpg),Y
-      ORA(A_IY);
-      CLK(5);
-      break;
-
-    case 0x15: // ORA Zpg,X
-      ORA(A_ZPX);
-      CLK(4);
-      break;
-
-    case 0x16: // ASL Zpg,X
-      ASL(AA_ZPX);
-      CLK(6);
-      break;
-
-    case 0x18: // CLC
-      RSTF(FLAG_C);
-      CLK(2);
-      break;
-
-    case 0x19: // ORA Abs,Y
-      ORA(A_ABSY);
-      CLK(4);
-      break;
-
-    case 0x1D: // ORA Abs,X
-      ORA(A_ABSX);
-      CLK(4);
-      break;
-
-    case 0x1E: // ASL Abs,X
-      ASL(AA_ABSX);
-      CLK(7);
-      break;
-
-    case 0x20: // JSR Abs
-      JSR;
-      CLK(6);
-      break;
-
-    case 0x21: // AND (Zpg,X)
-      AND(A_IX);
-      CLK(6);
-      break;
-
-    case 0x24: // BIT Zpg
-      BIT(A_ZP);
-      CLK(3);
-      break;
-
-    case 0x25: // AND Zpg
-      AND(A_ZP);
-      CLK(3);
-      break;
-
-    case 0x26: // ROL Zpg
-      ROL(AA_ZP);
-      CLK(5);
-      break;
-
-    case 0x28: // PLP
-      POP(F);
-      SETF(FLAG_R);
-      CLK(4);
-      break;
-
-    case 0x29: // AND #Oper
-      AND(A_IMM);
-      CLK(2);
-      break;
-
-    case 0x2A: // ROL A
-      ROLA;
-      CLK(2);
-      break;
-
-    case 0x2C: // BIT Abs
-      BIT(A_ABS);
-      CLK(4);
-      break;
-
-    case 0x2D: // AND Abs
-      AND(A_ABS);
-      CLK(4);
-      break;
-
-    case 0x2E: // ROL Abs
-      ROL(AA_ABS);
-      CLK(6);
-      break;
-
-    case 0x30: // BMI Oper
-      BRA(F & FLAG_N);
-      break;
-
-    case 0x31: // AND (Zpg),Y
-      AND(A_IY);
-      CLK(5);
-      break;
-
-    case 0x35: // AND Zpg,X
-      AND(A_ZPX);
-      CLK(4);
-      break;
-
-    case 0x36: // ROL Zpg,X
-      ROL(AA_ZPX);
-      CLK(6);
-      break;
+      K6502_ReadMap[byFirstPage[nBank] + nPage] =
+          pbyBank[nBank] ? pbyBank[nBank] + (nPage << 8) : NULL;
+    }
+  }
+}
 
-    case 0x38: // SEC
-      SETF(FLAG_C);
-      CLK(2);
-      break;
+/*===================================================================*/
+/*                                                                   */
+/*     K6502_ForgetBank() : A ROM bank's memory now holds another    */
+/*                                                                   */
+/*===================================================================*/
+void K6502_ForgetBank(BYTE *pbyBank)
+{
+  /*
+ *  A ROM bank's memory now holds another
+ *
+ *  Remarks
+ *    The idle loops found in it are keyed by its address and would
+ *    match code they were never checked against ( ROM_LZ4 bank
+ *    cache refilling a slot ).
+ */
+  for (int nIdx = 0; nIdx < IDLE_CACHE_SIZE; ++nIdx)
+  {
+    if (s_IdleCache[nIdx].pbyBank == pbyBank)
+      s_IdleCache[nIdx].pbyBank = NULL;
+  }
+}
 
-    case 0x39: // AND Abs,Y
-      AND(A_ABSY);
-      CLK(4);
-      break;
+/*===================================================================*/
+/*                                                                   */
+/*    K6502_Set_Int_Wiring() : Set up wiring of the interrupt pin    */
+/*                                                                   */
+/*===================================================================*/
+void K6502_Set_Int_Wiring(BYTE byNMI_Wiring, BYTE byIRQ_Wiring)
+{
+  /*
+ * Set up wiring of the interrupt pin
+ *
+ */
 
-    case 0x3D: // AND Abs,X
-      AND(A_ABSX);
-      CLK(4);
-      break;
+  NMI_Wiring = byNMI_Wiring;
+  IRQ_Wiring = byIRQ_Wiring;
+}
 
-    case 0x3E: // ROL Abs,X
-      ROL(AA_ABSX);
-      CLK(7);
-      break;
+/*===================================================================*/
+/*                                                                   */
+/*        K6502_CheckIdle() : Check a loop for idle skipping         */
+/*                                                                   */
+/*===================================================================*/
 
-    case 0x40: // RTI
-      POP(F);
-      SETF(FLAG_R);
-      POPW(PC);
-      CLK(6);
-      break;
+// Resources read or written by an instruction
+#define IR_A 0x01
+#define IR_X 0x02
+#define IR_Y 0x04
+#define IR_C 0x08
+#define IR_V 0x10
+#define IR_NZ 0x20
 
-    case 0x41: // EOR (Zpg,X)
-      EOR(A_IX);
-      CLK(6);
-      break;
+// Addressing modes
+enum
+{
+  IM_IMP,
+  IM_IMM,
+  IM_ZP,
+  IM_ZPX,
+  IM_ZPY,
+  IM_ABS,
+  IM_ABSX,
+  IM_ABSY,
+  IM_REL,
+  IM_JMP
+};
 
-    case 0x45: // EOR Zpg
-      EOR(A_ZP);
-      CLK(3);
-      break;
+// Instructions that may appear in an idle loop
+static const struct
+{
+  BYTE byCode;
+  BYTE byMode;
+  BYTE byRead;
+  BYTE byWrite;
+} s_IdleOps[] = {
+    // LDA / LDX / LDY
+    {0xA9, IM_IMM, 0, IR_A | IR_NZ},
+    {0xA5, IM_ZP, 0, IR_A | IR_NZ},
+    {0xB5, IM_ZPX, 0, IR_A | IR_NZ},
+    {0xAD, IM_ABS, 0, IR_A | IR_NZ},
+    {0xBD, IM_ABSX, 0, IR_A | IR_NZ},
+    {0xB9, IM_ABSY, 0, IR_A | IR_NZ},
+    {0xA2, IM_IMM, 0, IR_X | IR_NZ},
+    {0xA6, IM_ZP, 0, IR_X | IR_NZ},
+    {0xB6, IM_ZPY, 0, IR_X | IR_NZ},
+    {0xAE, IM_ABS, 0, IR_X | IR_NZ},
+    {0xBE, IM_ABSY, 0, IR_X | IR_NZ},
+    {0xA0, IM_IMM, 0, IR_Y | IR_NZ},
+    {0xA4, IM_ZP, 0, IR_Y | IR_NZ},
+    {0xB4, IM_ZPX, 0, IR_Y | IR_NZ},
+    {0xAC, IM_ABS, 0, IR_Y | IR_NZ},
+    {0xBC, IM_ABSX, 0, IR_Y | IR_NZ},
+    // AND / ORA / EOR
+    {0x29, IM_IMM, IR_A, IR_A | IR_NZ},
+    {0x25, IM_ZP, IR_A, IR_A | IR_NZ},
+    {0x35, IM_ZPX, IR_A, IR_A | IR_NZ},
+    {0x2D, IM_ABS, IR_A, IR_A | IR_NZ},
+    {0x3D, IM_ABSX, IR_A, IR_A | IR_NZ},
+    {0x39, IM_ABSY, IR_A, IR_A | IR_NZ},
+    {0x09, IM_IMM, IR_A, IR_A | IR_NZ},
+    {0x05, IM_ZP, IR_A, IR_A | IR_NZ},
+    {0x15, IM_ZPX, IR_A, IR_A | IR_NZ},
+    {0x0D, IM_ABS, IR_A, IR_A | IR_NZ},
+    {0x1D, IM_ABSX, IR_A, IR_A | IR_NZ},
+    {0x19, IM_ABSY, IR_A, IR_A | IR_NZ},
+    {0x49, IM_IMM, IR_A, IR_A | IR_NZ},
+    {0x45, IM_ZP, IR_A, IR_A | IR_NZ},
+    {0x55, IM_ZPX, IR_A, IR_A | IR_NZ},
+    {0x4D, IM_ABS, IR_A, IR_A | IR_NZ},
+    {0x5D, IM_ABSX, IR_A, IR_A | IR_NZ},
+    {0x59, IM_ABSY, IR_A, IR_A | IR_NZ},
+    // CMP / CPX / CPY / BIT
+    {0xC9, IM_IMM, IR_A, IR_C | IR_NZ},
+    {0xC5, IM_ZP, IR_A, IR_C | IR_NZ},
+    {0xD5, IM_ZPX, IR_A, IR_C | IR_NZ},
+    {0xCD, IM_ABS, IR_A, IR_C | IR_NZ},
+    {0xDD, IM_ABSX, IR_A, IR_C | IR_NZ},
+    {0xD9, IM_ABSY, IR_A, IR_C | IR_NZ},
+    {0xE0, IM_IMM, IR_X, IR_C | IR_NZ},
+    {0xE4, IM_ZP, IR_X, IR_C | IR_NZ},
+    {0xEC, IM_ABS, IR_X, IR_C | IR_NZ},
+    {0xC0, IM_IMM, IR_Y, IR_C | IR_NZ},
+    {0xC4, IM_ZP, IR_Y, IR_C | IR_NZ},
+    {0xCC, IM_ABS, IR_Y, IR_C | IR_NZ},
+    {0x24, IM_ZP, IR_A, IR_V | IR_NZ},
+    {0x2C, IM_ABS, IR_A, IR_V | IR_NZ},
+    // Transfer / Flag / Shift A
+    {0xAA, IM_IMP, IR_A, IR_X | IR_NZ},
+    {0xA8, IM_IMP, IR_A, IR_Y | IR_NZ},
+    {0x8A, IM_IMP, IR_X, IR_A | IR_NZ},
+    {0x98, IM_IMP, IR_Y, IR_A | IR_NZ},
+    {0x18, IM_IMP, 0, IR_C},
+    {0x38, IM_IMP, 0, IR_C},
+    {0xB8, IM_IMP, 0, IR_V},
+    {0xEA, IM_IMP, 0, 0},
+    {0x0A, IM_IMP, IR_A, IR_A | IR_C | IR_NZ},
+    {0x4A, IM_IMP, IR_A, IR_A | IR_C | IR_NZ},
+    {0x2A, IM_IMP, IR_A | IR_C, IR_A | IR_C | IR_NZ},
+    {0x6A, IM_IMP, IR_A | IR_C, IR_A | IR_C | IR_NZ},
+    // The jump back ( only as the last instruction )
+    {0x10, IM_REL, IR_NZ, 0},
+    {0x30, IM_REL, IR_NZ, 0},
+    {0x50, IM_REL, IR_V, 0},
+    {0x70, IM_REL, IR_V, 0},
+    {0x90, IM_REL, IR_C, 0},
+    {0xB0, IM_REL, IR_C, 0},
+    {0xD0, IM_REL, IR_NZ, 0},
+    {0xF0, IM_REL, IR_NZ, 0},
+    {0x4C, IM_JMP, 0, 0},
+};
 
-    case 0x46: // LSR Zpg
-      LSR(AA_ZP);
-      CLK(5);
-      break;
+static BYTE K6502_CodeByte(WORD wAddr)
+{
+  BYTE *pbyPage = K6502_ReadMap[wAddr >> 8];
+  return pbyPage ? pbyPage[wAddr & 0xff] : 0;
+}
 
-    case 0x48: // PHA
-      PUSH(A);
-      CLK(3);
-      break;
+static BYTE K6502_CheckIdle(WORD wHead, WORD wTail, BYTE *pbyInstructions)
+{
+  /*
+ *  Check a loop for idle skipping
+ *
+ *  Parameters
+ *    WORD wHead                (Read)
+ *      First instruction of the loop
+ *
+ *    WORD wTail                (Read)
+ *      The branch or JMP that goes back to wHead
+ *
+ *    BYTE *pbyInstructions     (Write)
+ *      Instructions per iteration
+ *
+ *  Return values
+ *    1 : Whole iterations can be skipped
+ *    0 : The loop has to be interpreted
+ *
+ *  Remarks
+ *    The loop has to be straight-line code inside one ROM bank that
+ *    reads RAM, SRAM, ROM or the PPU status and writes no memory, and
+ *    every register or flag it changes has to be set before it is used.
+ *    Then an iteration leaves the CPU exactly as it found it for as
+ *    long as memory does not change, and memory only changes between
+ *    two step() calls ( H-Sync, NMI ), e.g.
+ *
+ *      wait: LDA $2002      wait: LDA nmi_flag     wait: BIT $2002
+ *            BPL wait             BEQ wait               BVC wait
+ */
+  BYTE byUsed = 0;
+  BYTE byWritten = 0;
+  BYTE byCount = 0;
+  WORD wAddr = wHead;
 
-    case 0x49: // EOR #Oper
-      EOR(A_IMM);
-      CLK(2);
-      break;
+  if (wHead < 0x8000 || wTail < wHead || wTail - wHead > IDLE_BLOCK_MAX ||
+      ((wHead ^ wTail) & 0xe000))
+    return 0;
 
-    case 0x4A: // LSR A
-      LSRA;
-      CLK(2);
-      break;
+  for (;;)
+  {
+    BYTE byCode = K6502_CodeByte(wAddr);
+    WORD wOper = K6502_CodeByte(wAddr + 1) | (WORD)K6502_CodeByte(wAddr + 2) << 8;
+    int nIdx;
 
-    case 0x4C: // JMP Abs
-#if 0
-      JMP(AA_ABS);
-      CLK(3);
-#else
+    for (nIdx = 0; nIdx < (int)(sizeof s_IdleOps / sizeof s_IdleOps[0]); ++nIdx)
     {
-      auto addr = AA_ABS;
-      if (addr == PC - 3)
-      {
-        JMP(addr);
-        do
-        {
-          CLK(3);
-        } while (g_wPassedClocks < wClocks);
+      if (s_IdleOps[nIdx].byCode == byCode)
         break;
-      }
-      else
-      {
-        JMP(addr);
-        CLK(3);
-      }
     }
-#endif
-      break;
-
-    case 0x4D: // EOR Abs
-      EOR(A_ABS);
-      CLK(4);
-      break;
-
-    case 0x4E: // LSR Abs
-      LSR(AA_ABS);
-      CLK(6);
-      break;
-
-    case 0x50: // BVC
-      BRA(!(F & FLAG_V));
-      break;
-
-    case 0x51: // EOR (Zpg),Y
-      EOR(A_IY);
-      CLK(5);
-      break;
-
-    case 0x55: // EOR Zpg,X
-      EOR(A_ZPX);
-      CLK(4);
-      break;
-
-    case 0x56: // LSR Zpg,X
-      LSR(AA_ZPX);
-      CLK(6);
-      break;
-
-    case 0x58: // CLI
-      byD0 = F;
-      RSTF(FLAG_I);
-      CLK(2);
-      if ((byD0 & FLAG_I) && IRQ_State != IRQ_Wiring)
-      {
-        IRQ_State = IRQ_Wiring;
-        CLK(7);
-
-        PUSHW(PC);
-        PUSH(F & ~FLAG_B);
-
-        RSTF(FLAG_D);
-        SETF(FLAG_I);
-
-        PC = K6502_ReadW(VECTOR_IRQ);
-      }
-      break;
+    if (nIdx == (int)(sizeof s_IdleOps / sizeof s_IdleOps[0]))
+      return 0;
 
-    case 0x59: // EOR Abs,Y
-      EOR(A_ABSY);
-      CLK(4);
-      break;
+    BYTE byMode = s_IdleOps[nIdx].byMode;
+    BYTE byRead = s_IdleOps[nIdx].byRead;
+    int nLen;
 
-    case 0x5D: // EOR Abs,X
-      EOR(A_ABSX);
-      CLK(4);
+    switch (byMode)
+    {
+    case IM_IMP:
+      nLen = 1;
       break;
 
-    case 0x5E: // LSR Abs,X
-      LSR(AA_ABSX);
-      CLK(7);
+    case IM_ZPX:
+      byRead |= IR_X;
+      nLen = 2;
       break;
 
-    case 0x60: // RTS
-      POPW(PC);
-      ++PC;
-      CLK(6);
+    case IM_ZPY:
+      byRead |= IR_Y;
+      nLen = 2;
       break;
 
-    case 0x61: // ADC (Zpg,X)
-      ADC(A_IX);
-      CLK(6);
-      break;
+    case IM_ABS:
+    case IM_ABSX:
+    case IM_ABSY:
+      byRead |= (byMode == IM_ABSX) ? IR_X : (byMode == IM_ABSY) ? IR_Y : 0;
+      nLen = 3;
 
-    case 0x65: // ADC Zpg
-      ADC(A_ZP);
-      CLK(3);
+      // Reading has to be free of side effects
+      if (byMode == IM_ABS && (wOper & 0xe007) == 0x2002)
+        break; /* PPU Status ( repeating it changes nothing ) */
+      if (byMode != IM_ABS && wOper > 0xff00)
+        return 0;
+      if (!(wOper + (byMode == IM_ABS ? 0 : 0xff) < 0x2000 || wOper >= 0x6000))
+        return 0;
       break;
 
-    case 0x66: // ROR Zpg
-      ROR(AA_ZP);
-      CLK(5);
+    case IM_JMP:
+      nLen = 3;
       break;
 
-    case 0x68: // PLA
-      POP(A);
-      TEST(A);
-      CLK(4);
+    default: /* IM_IMM, IM_ZP, IM_REL */
+      nLen = 2;
       break;
+    }
 
-    case 0x69: // ADC #Oper
-      ADC(A_IMM);
-      CLK(2);
-      break;
+    // A resource the loop sets must not be used before it is set
+    byUsed |= byRead & ~byWritten;
+    byWritten |= s_IdleOps[nIdx].byWrite;
+    ++byCount;
 
-    case 0x6A: // ROR A
-      RORA;
-      CLK(2);
+    if (byMode == IM_REL || byMode == IM_JMP)
+    {
+      // Only the last instruction may jump
+      if (wAddr != wTail)
+        return 0;
       break;
+    }
 
-    case 0x6C: // JMP (Abs)
-      JMP(K6502_ReadW2(AA_ABS));
-      CLK(5);
-      break;
+    wAddr += nLen;
+    if (wAddr > wTail)
+      return 0;
+  }
 
-    case 0x6D: // ADC Abs
-      ADC(A_ABS);
-      CLK(4);
-      break;
+  if (byUsed & byWritten)
+    return 0;
 
-    case 0x6E: // ROR Abs
-      ROR(AA_ABS);
-      CLK(6);
-      break;
+  *pbyInstructions = byCount;
+  return 1;
+}
 
-    case 0x70: // BVS
-      BRA(F & FLAG_V);
-      break;
+/*===================================================================*/
+/*                                                                   */
+/*       K6502_IdleBlock() : Look up a loop in the idle cache        */
+/*                                                                   */
+/*===================================================================*/
+static inline int __not_in_flash_func(K6502_IdleBlock)(WORD wHead, WORD wTail)
+{
+  /*
+ *  Look up a loop in the idle cache
+ *
+ *  Return values
+ *    Nonzero when whole iterations of wHead - wTail can be skipped
+ *
+ *  Remarks
+ *    Entries are keyed by the ROM bank as well, so a bank switch
+ *    simply misses and the loop is checked again.
+ */
+  if (wHead < 0x8000 || !K6502_IdleSkip)
+    return 0;
 
-    case 0x71: // ADC (Zpg),Y
-      ADC(A_IY);
-      CLK(5);
-      break;
+  BYTE *pbyBank = ROMBANK[(wHead - 0x8000) >> 13];
+  int nIdx = (wTail ^ (wTail >> 6)) & (IDLE_CACHE_SIZE - 1);
+  struct idle_block_tag *pBlock = &s_IdleCache[nIdx];
 
-    case 0x75: // ADC Zpg,X
-      ADC(A_ZPX);
-      CLK(4);
-      break;
+  if (pBlock->pbyBank != pbyBank || pBlock->wHead != wHead || pBlock->wTail != wTail)
+  {
+    pBlock->pbyBank = pbyBank;
+    pBlock->wHead = wHead;
+    pBlock->wTail = wTail;
+    pBlock->byIdle = K6502_CheckIdle(wHead, wTail, &pBlock->byInstructions);
+  }
 
-    case 0x76: // ROR Zpg,X
-      ROR(AA_ZPX);
-      CLK(6);
-      break;
+  s_nIdleIdx = nIdx;
+  return pBlock->byIdle;
+}
 
-    case 0x78: // SEI
-      SETF(FLAG_I);
-      CLK(2);
-      break;
+static void __not_in_flash_func(procNMI)()
+{
+  // Dispose of it if there is an interrupt requirement
+  if (NMI_State != NMI_Wiring)
+  {
+    // NMI Interrupt
+    NMI_State = NMI_Wiring;
+    CLK(7);
 
-    case 0x79: // ADC Abs,Y
-      ADC(A_ABSY);
-      CLK(4);
-      break;
+    PUSHW(PC);
+    PUSH(F & ~FLAG_B);
 
-    case 0x7D: // ADC Abs,X
-      ADC(A_ABSX);
-      CLK(4);
-      break;
+    RSTF(FLAG_D);
+    SETF(FLAG_I);
 
-    case 0x7E: // ROR Abs,X
-      ROR(AA_ABSX);
+    PC = K6502_ReadW(VECTOR_NMI);
+  }
+  else if (IRQ_State != IRQ_Wiring)
+  {
+    // IRQ Interrupt
+    // Execute IRQ if an I flag isn't being set
+    if (!(F & FLAG_I))
+    {
+      IRQ_State = IRQ_Wiring;
       CLK(7);
-      break;
-
-    case 0x81: // STA (Zpg,X)
-      STA(AA_IX);
-      CLK(6);
-      break;
-
-    case 0x84: // STY Zpg
-      STY(AA_ZP);
-      CLK(3);
-      break;
-
-    case 0x85: // STA Zpg
-      STA(AA_ZP);
-      CLK(3);
-      break;
-
-    case 0x86: // STX Zpg
-      STX(AA_ZP);
-      CLK(3);
-      break;
-
-    case 0x88: // DEY
-      --Y;
-      TEST(Y);
-      CLK(2);
-      break;
-
-    case 0x8A: // TXA
-      A = X;
-      TEST(A);
-      CLK(2);
-      break;
-
-    case 0x8C: // STY Abs
-      STY(AA_ABS);
-      CLK(4);
-      break;
-
-    case 0x8D: // STA Abs
-      STA(AA_ABS);
-      CLK(4);
-      break;
-
-    case 0x8E: // STX Abs
-      STX(AA_ABS);
-      CLK(4);
-      break;
-
-    case 0x90: // BCC
-      BRA(!(F & FLAG_C));
-      break;
-
-    case 0x91: // STA (Zpg),Y
-      STA(AA_IY);
-      CLK(6);
-      break;
-
-    case 0x94: // STY Zpg,X
-      STY(AA_ZPX);
-      CLK(4);
-      break;
-
-    case 0x95: // STA Zpg,X
-      STA(AA_ZPX);
-      CLK(4);
-      break;
-
-    case 0x96: // STX Zpg,Y
-      STX(AA_ZPY);
-      CLK(4);
-      break;
-
-    case 0x98: // TYA
-      A = Y;
-      TEST(A);
-      CLK(2);
-      break;
-
-    case 0x99: // STA Abs,Y
-      STA(AA_ABSY);
-      CLK(5);
-      break;
-
-    case 0x9A: // TXS
-      SP = X;
-      CLK(2);
-      break;
-
-    case 0x9D: // STA Abs,X
-      STA(AA_ABSX);
-      CLK(5);
-      break;
-
-    case 0xA0: // LDY #Oper
-      LDY(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xA1: // LDA (Zpg,X)
-      LDA(A_IX);
-      CLK(6);
-      break;
-
-    case 0xA2: // LDX #Oper
-      LDX(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xA4: // LDY Zpg
-      LDY(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xA5: // LDA Zpg
-      LDA(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xA6: // LDX Zpg
-      LDX(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xA8: // TAY
-      Y = A;
-      TEST(A);
-      CLK(2);
-      break;
-
-    case 0xA9: // LDA #Oper
-      LDA(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xAA: // TAX
-      X = A;
-      TEST(A);
-      CLK(2);
-      break;
-
-    case 0xAC: // LDY Abs
-      LDY(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xAD: // LDA Abs
-      LDA(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xAE: // LDX Abs
-      LDX(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xB0: // BCS
-      BRA(F & FLAG_C);
-      break;
-
-    case 0xB1: // LDA (Zpg),Y
-      LDA(A_IY);
-      CLK(5);
-      break;
 
-    case 0xB4: // LDY Zpg,X
-      LDY(A_ZPX);
-      CLK(4);
-      break;
-
-    case 0xB5: // LDA Zpg,X
-      LDA(A_ZPX);
-      CLK(4);
-      break;
-
-    case 0xB6: // LDX Zpg,Y
-      LDX(A_ZPY);
-      CLK(4);
-      break;
-
-    case 0xB8: // CLV
-      RSTF(FLAG_V);
-      CLK(2);
-      break;
-
-    case 0xB9: // LDA Abs,Y
-      LDA(A_ABSY);
-      CLK(4);
-      break;
-
-    case 0xBA: // TSX
-      X = SP;
-      TEST(X);
-      CLK(2);
-      break;
-
-    case 0xBC: // LDY Abs,X
-      LDY(A_ABSX);
-      CLK(4);
-      break;
-
-    case 0xBD: // LDA Abs,X
-      LDA(A_ABSX);
-      CLK(4);
-      break;
-
-    case 0xBE: // LDX Abs,Y
-      LDX(A_ABSY);
-      CLK(4);
-      break;
-
-    case 0xC0: // CPY #Oper
-      CPY(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xC1: // CMP (Zpg,X)
-      CMP(A_IX);
-      CLK(6);
-      break;
-
-    case 0xC4: // CPY Zpg
-      CPY(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xC5: // CMP Zpg
-      CMP(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xC6: // DEC Zpg
-      DEC(AA_ZP);
-      CLK(5);
-      break;
-
-    case 0xC8: // INY
-      ++Y;
-      TEST(Y);
-      CLK(2);
-      break;
-
-    case 0xC9: // CMP #Oper
-      CMP(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xCA: // DEX
-      --X;
-      TEST(X);
-      CLK(2);
-      break;
-
-    case 0xCC: // CPY Abs
-      CPY(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xCD: // CMP Abs
-      CMP(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xCE: // DEC Abs
-      DEC(AA_ABS);
-      CLK(6);
-      break;
-
-    case 0xD0: // BNE
-      BRA(!(F & FLAG_Z));
-      break;
-
-    case 0xD1: // CMP (Zpg),Y
-      CMP(A_IY);
-      CLK(5);
-      break;
-
-    case 0xD5: // CMP Zpg,X
-      CMP(A_ZPX);
-      CLK(4);
-      break;
-
-    case 0xD6: // DEC Zpg,X
-      DEC(AA_ZPX);
-      CLK(6);
-      break;
+      PUSHW(PC);
+      PUSH(F & ~FLAG_B);
 
-    case 0xD8: // CLD
       RSTF(FLAG_D);
-      CLK(2);
-      break;
-
-    case 0xD9: // CMP Abs,Y
-      CMP(A_ABSY);
-      CLK(4);
-      break;
-
-    case 0xDD: // CMP Abs,X
-      CMP(A_ABSX);
-      CLK(4);
-      break;
-
-    case 0xDE: // DEC Abs,X
-      DEC(AA_ABSX);
-      CLK(7);
-      break;
-
-    case 0xE0: // CPX #Oper
-      CPX(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xE1: // SBC (Zpg,X)
-      SBC(A_IX);
-      CLK(6);
-      break;
-
-    case 0xE4: // CPX Zpg
-      CPX(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xE5: // SBC Zpg
-      SBC(A_ZP);
-      CLK(3);
-      break;
-
-    case 0xE6: // INC Zpg
-      INC(AA_ZP);
-      CLK(5);
-      break;
-
-    case 0xE8: // INX
-      ++X;
-      TEST(X);
-      CLK(2);
-      break;
-
-    case 0xE9: // SBC #Oper
-      SBC(A_IMM);
-      CLK(2);
-      break;
-
-    case 0xEA: // NOP
-      CLK(2);
-      break;
-
-    case 0xEC: // CPX Abs
-      CPX(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xED: // SBC Abs
-      SBC(A_ABS);
-      CLK(4);
-      break;
-
-    case 0xEE: // INC Abs
-      INC(AA_ABS);
-      CLK(6);
-      break;
-
-    case 0xF0: // BEQ
-      BRA(F & FLAG_Z);
-      break;
+      SETF(FLAG_I);
 
-    case 0xF1: // SBC (Zpg),Y
-      SBC(A_IY);
-      CLK(5);
-      break;
+      PC = K6502_ReadW(VECTOR_IRQ);
+    }
+  }
+}
 
-    case 0xF5: // SBC Zpg,X
-      SBC(A_ZPX);
-      CLK(4);
-      break;
+static void __not_in_flash_func(step)(int wClocks)
+{
+  /*
+ *  Only the specified number of the clocks execute Op.
+ *
+ *  Parameters
+ *    WORD wClocks              (Read)
+ *      The number of the clocks
+ */
 
-    case 0xF6: // INC Zpg,X
-      INC(AA_ZPX);
-      CLK(6);
-      break;
+  BYTE byCode;
 
-    case 0xF8: // SED
-      SETF(FLAG_D);
-      CLK(2);
-      break;
+  WORD wA0;
+  BYTE byD0;
+  BYTE byD1;
+  WORD wD0;
 
-    case 0xF9: // SBC Abs,Y
-      SBC(A_ABSY);
-      CLK(4);
-      break;
+  // Lazy N and Z ( folded back into F when step() returns )
+  BYTE byFlagN = F;
+  BYTE byFlagZ = ~F & FLAG_Z;
 
-    case 0xFD: // SBC Abs,X
-      SBC(A_ABSX);
-      CLK(4);
-      break;
+  // Head of the idle loop being iterated and the clocks at its start
+  WORD wIdleHead = 0;
+  int nIdleClocks = 0;
 
-    case 0xFE: // INC Abs,X
-      INC(AA_ABSX);
-      CLK(7);
-      break;
+  auto prePassedClocks = g_wPassedClocks;
 
-      /*-----------------------------------------------------------*/
-      /*  Unlisted Instructions ( thanks to virtualnes )           */
-      /*-----------------------------------------------------------*/
-
-    case 0x1A: // NOP (Unofficial)
-    case 0x3A: // NOP (Unofficial)
-    case 0x5A: // NOP (Unofficial)
-    case 0x7A: // NOP (Unofficial)
-    case 0xDA: // NOP (Unofficial)
-    case 0xFA: // NOP (Unofficial)
-      CLK(2);
-      break;
+#if defined(K6502_THREADED)
+  /*-------------------------------------------------------------------*/
+  /*  Threaded dispatch ( computed goto )                              */
+  /*-------------------------------------------------------------------*/
+
+  // Every instruction jumps straight to the next one's body
+  static const void *const s_OpTable[256] = {
+      &&op_0x00, &&op_0x01, &&op_default, &&op_default, &&op_0x04, &&op_0x05, &&op_0x06, &&op_default,
+      &&op_0x08, &&op_0x09, &&op_0x0A, &&op_default, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_default,
+      &&op_0x10, &&op_0x11, &&op_default, &&op_default, &&op_0x14, &&op_0x15, &&op_0x16, &&op_default,
+      &&op_0x18, &&op_0x19, &&op_0x1A, &&op_default, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_default,
+      &&op_0x20, &&op_0x21, &&op_default, &&op_default, &&op_0x24, &&op_0x25, &&op_0x26, &&op_default,
+      &&op_0x28, &&op_0x29, &&op_0x2A, &&op_default, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_default,
+      &&op_0x30, &&op_0x31, &&op_default, &&op_default, &&op_0x34, &&op_0x35, &&op_0x36, &&op_default,
+      &&op_0x38, &&op_0x39, &&op_0x3A, &&op_default, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_default,
+      &&op_0x40, &&op_0x41, &&op_default, &&op_default, &&op_0x44, &&op_0x45, &&op_0x46, &&op_default,
+      &&op_0x48, &&op_0x49, &&op_0x4A, &&op_default, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_default,
+      &&op_0x50, &&op_0x51, &&op_default, &&op_default, &&op_0x54, &&op_0x55, &&op_0x56, &&op_default,
+      &&op_0x58, &&op_0x59, &&op_0x5A, &&op_default, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_default,
+      &&op_0x60, &&op_0x61, &&op_default, &&op_default, &&op_0x64, &&op_0x65, &&op_0x66, &&op_default,
+      &&op_0x68, &&op_0x69, &&op_0x6A, &&op_default, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_default,
+      &&op_0x70, &&op_0x71, &&op_default, &&op_default, &&op_0x74, &&op_0x75, &&op_0x76, &&op_default,
+      &&op_0x78, &&op_0x79, &&op_0x7A, &&op_default, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_default,
+      &&op_0x80, &&op_0x81, &&op_0x82, &&op_default, &&op_0x84, &&op_0x85, &&op_0x86, &&op_default,
+      &&op_0x88, &&op_0x89, &&op_0x8A, &&op_default, &&op_0x8C, &&op_0x8D, &&op_0x8E, &&op_default,
+      &&op_0x90, &&op_0x91, &&op_default, &&op_default, &&op_0x94, &&op_0x95, &&op_0x96, &&op_default,
+      &&op_0x98, &&op_0x99, &&op_0x9A, &&op_default, &&op_default, &&op_0x9D, &&op_default, &&op_default,
+      &&op_0xA0, &&op_0xA1, &&op_0xA2, &&op_default, &&op_0xA4, &&op_0xA5, &&op_0xA6, &&op_default,
+      &&op_0xA8, &&op_0xA9, &&op_0xAA, &&op_default, &&op_0xAC, &&op_0xAD, &&op_0xAE, &&op_default,
+      &&op_0xB0, &&op_0xB1, &&op_default, &&op_default, &&op_0xB4, &&op_0xB5, &&op_0xB6, &&op_default,
+      &&op_0xB8, &&op_0xB9, &&op_0xBA, &&op_default, &&op_0xBC, &&op_0xBD, &&op_0xBE, &&op_default,
+      &&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_default, &&op_0xC4, &&op_0xC5, &&op_0xC6, &&op_default,
+      &&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_default, &&op_0xCC, &&op_0xCD, &&op_0xCE, &&op_default,
+      &&op_0xD0, &&op_0xD1, &&op_default, &&op_default, &&op_0xD4, &&op_0xD5, &&op_0xD6, &&op_default,
+      &&op_0xD8, &&op_0xD9, &&op_0xDA, &&op_default, &&op_0xDC, &&op_0xDD, &&op_0xDE, &&op_default,
+      &&op_0xE0, &&op_0xE1, &&op_0xE2, &&op_default, &&op_0xE4, &&op_0xE5, &&op_0xE6, &&op_default,
+      &&op_0xE8, &&op_0xE9, &&op_0xEA, &&op_default, &&op_0xEC, &&op_0xED, &&op_0xEE, &&op_default,
+      &&op_0xF0, &&op_0xF1, &&op_default, &&op_default, &&op_0xF4, &&op_0xF5, &&op_0xF6, &&op_default,
+      &&op_0xF8, &&op_0xF9, &&op_0xFA, &&op_default, &&op_0xFC, &&op_0xFD, &&op_0xFE, &&op_default,
+  };
+
+#define OP(code) op_##code:
+#define OP_DEFAULT op_default:
+#define NEXT                         \
+  if (g_wPassedClocks >= wClocks)    \
+    goto done;                       \
+  byCode = K6502_Fetch();            \
+  K6502_COUNT_INSTRUCTION;           \
+  goto *s_OpTable[byCode]
+
+  NEXT;
+#include "K6502_Op.h"
+done:
 
-    case 0x80: // DOP (CYCLES 2)
-    case 0x82: // DOP (CYCLES 2)
-    case 0x89: // DOP (CYCLES 2)
-    case 0xC2: // DOP (CYCLES 2)
-    case 0xE2: // DOP (CYCLES 2)
-      PC++;
-      CLK(2);
-      break;
+#else
+  /*-------------------------------------------------------------------*/
+  /*  Switch dispatch                                                  */
+  /*-------------------------------------------------------------------*/
 
-    case 0x04: // DOP (CYCLES 3)
-    case 0x44: // DOP (CYCLES 3)
-    case 0x64: // DOP (CYCLES 3)
-      PC++;
-      CLK(3);
-      break;
+#define OP(code) case code:
+#define OP_DEFAULT default:
+#define NEXT break
 
-    case 0x14: // DOP (CYCLES 4)
-    case 0x34: // DOP (CYCLES 4)
-    case 0x54: // DOP (CYCLES 4)
-    case 0x74: // DOP (CYCLES 4)
-    case 0xD4: // DOP (CYCLES 4)
-    case 0xF4: // DOP (CYCLES 4)
-      PC++;
-      CLK(4);
-      break;
+  // It has a loop until a constant clock passes
+  while (g_wPassedClocks < wClocks)
+  {
+    // Read an instruction
+    byCode = K6502_Fetch();
+    K6502_COUNT_INSTRUCTION;
 
-    case 0x0C: // TOP
-    case 0x1C: // TOP
-    case 0x3C: // TOP
-    case 0x5C: // TOP
-    case 0x7C: // TOP
-    case 0xDC: // TOP
-    case 0xFC: // TOP
-      PC += 2;
-      CLK(4);
-      break;
+    // Execute an instruction.
+    switch (byCode)
+    {
+#include "K6502_Op.h"
+    } /* end of switch ( byCode ) */
 
-    default: // Unknown Instruction
-      CLK(2);
-#if 0
-        InfoNES_MessageBox( "0x%02x is unknown instruction.\n", byCode ) ;
+  } /* end of while ... */
 #endif
-      break;
 
-    } /* end of switch ( byCode ) */
+#undef OP
+#undef OP_DEFAULT
+#undef NEXT
 
-  } /* end of while ... */
+  F = GETF();
 
   // Correct the number of the clocks
   g_wCurrentClocks += (g_wPassedClocks - prePassedClocks);
@@ -1413,7 +995,7 @@ static __attribute__((always_inline)) inline BYTE __not_in_flash_func(K6502_Read
 static __attribute__((always_inline)) inline BYTE __not_in_flash_func(K6502_ReadIY)()
 {
   WORD wA0, wA1;
-  wA0 = K6502_ReadZpW(K6502_Read(PC++));
+  wA0 = K6502_ReadZpW(K6502_Fetch());
   wA1 = wA0 + Y;
   CLK((wA0 & 0x0100) != (wA1 & 0x0100));
   return K6502_Read(wA1);
@@ -56,8 +56,14 @@ void K6502_Reset();
 void K6502_Set_Int_Wiring(BYTE byNMI_Wiring, BYTE byIRQ_Wiring);
 void K6502_Step(int wClocks);
 
+// Memory map
+void K6502_MapReset();
+void K6502_MapPrg();
+void K6502_ForgetBank(BYTE *pbyBank);
+
 // I/O Operation (User definition)
 static inline BYTE K6502_Read(WORD wAddr);
+static BYTE K6502_ReadIo(WORD wAddr);
 static inline WORD K6502_ReadW(WORD wAddr);
 static inline WORD K6502_ReadW2(WORD wAddr);
 static inline BYTE K6502_ReadZp(BYTE byAddr);
@@ -65,9 +71,13 @@ static inline WORD K6502_ReadZpW(BYTE byAddr);
 static inline BYTE K6502_ReadAbsX();
 static inline BYTE K6502_ReadAbsY();
 static inline BYTE K6502_ReadIY();
+static inline BYTE K6502_Fetch();
+static inline WORD K6502_FetchW();
 
 static inline void K6502_Write(WORD wAddr, BYTE byData);
+static void K6502_WriteIo(WORD wAddr, BYTE byData);
 static inline void K6502_WriteW(WORD wAddr, WORD wData);
+static inline void K6502_WriteZp(BYTE byAddr, BYTE byData);
 
 // The state of the IRQ pin
 extern BYTE IRQ_State;
@@ -77,8 +87,23 @@ extern BYTE NMI_State;
 
 extern WORD PC;
 
+// Page table : the base of every 256 byte page, NULL when the page
+// has to go through K6502_ReadIo() / K6502_WriteIo()
+extern BYTE *K6502_ReadMap[0x100];
+extern BYTE *K6502_WriteMap[0x100];
+
 // The number of the clocks that it passed
 //extern WORD g_wPassedClocks;
 WORD getPassedClocks();
 
+// Skip whole iterations of idle loops ( 0 : a per-game quirk turned it off )
+extern BYTE K6502_IdleSkip;
+
+#ifdef K6502_PROFILE
+// The number of the executed instructions ( host benchmark )
+extern DWORD g_dwInstructions;
+// The number of the clocks skipped in idle loops ( host benchmark )
+extern DWORD g_dwIdleClocks;
+#endif
+
 #endif /* !K6502_H_INCLUDED */
@@ -0,0 +1,873 @@
+/*===================================================================*/
+/*                                                                   */
+/*  K6502_Op.h : 6502 instruction bodies                             */
+/*               This file is included in step() of K6502.cpp       */
+/*                                                                   */
+/*  OP( code ) opens an instruction, NEXT ends it. The including     */
+/*  engine defines them either as switch cases or as labels of the   */
+/*  computed-goto table ( K6502_THREADED ).                          */
+/*                                                                   */
+/*===================================================================*/
+
+OP(0x00) // BRK
+  ++PC;
+  PUSHW(PC);
+  SETF(FLAG_B);
+  PUSH(GETF());
+  SETF(FLAG_I);
+  RSTF(FLAG_D);
+  PC = K6502_ReadW(VECTOR_IRQ);
+  CLK(7);
+  NEXT;
+
+OP(0x01) // ORA (Zpg,X)
+  ORA(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0x05) // ORA Zpg
+  ORA(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x06) // ASL Zpg
+  ASL_ZP(AA_ZP);
+  CLK(5);
+  NEXT;
+
+OP(0x08) // PHP
+  SETF(FLAG_B);
+  PUSH(GETF());
+  CLK(3);
+  NEXT;
+
+OP(0x09) // ORA #Oper
+  ORA(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0x0A) // ASL A
+  ASLA;
+  CLK(2);
+  NEXT;
+
+OP(0x0D) // ORA Abs
+  ORA(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x0E) // ASL Abs
+  ASL(AA_ABS);
+  CLK(6);
+  NEXT;
+
+OP(0x10) // BPL Oper
+  BRA(!(byFlagN & FLAG_N));
+  NEXT;
+
+OP(0x11) // ORA (Zpg),Y
+  ORA(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0x15) // ORA Zpg,X
+  ORA(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0x16) // ASL Zpg,X
+  ASL_ZP(AA_ZPX);
+  CLK(6);
+  NEXT;
+
+OP(0x18) // CLC
+  RSTF(FLAG_C);
+  CLK(2);
+  NEXT;
+
+OP(0x19) // ORA Abs,Y
+  ORA(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0x1D) // ORA Abs,X
+  ORA(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0x1E) // ASL Abs,X
+  ASL(AA_ABSX);
+  CLK(7);
+  NEXT;
+
+OP(0x20) // JSR Abs
+  JSR;
+  CLK(6);
+  NEXT;
+
+OP(0x21) // AND (Zpg,X)
+  AND(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0x24) // BIT Zpg
+  BIT(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x25) // AND Zpg
+  AND(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x26) // ROL Zpg
+  ROL_ZP(AA_ZP);
+  CLK(5);
+  NEXT;
+
+OP(0x28) // PLP
+  POP(byD0);
+  PUTF(byD0 | FLAG_R);
+  CLK(4);
+  NEXT;
+
+OP(0x29) // AND #Oper
+  AND(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0x2A) // ROL A
+  ROLA;
+  CLK(2);
+  NEXT;
+
+OP(0x2C) // BIT Abs
+  BIT(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x2D) // AND Abs
+  AND(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x2E) // ROL Abs
+  ROL(AA_ABS);
+  CLK(6);
+  NEXT;
+
+OP(0x30) // BMI Oper
+  BRA(byFlagN & FLAG_N);
+  NEXT;
+
+OP(0x31) // AND (Zpg),Y
+  AND(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0x35) // AND Zpg,X
+  AND(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0x36) // ROL Zpg,X
+  ROL_ZP(AA_ZPX);
+  CLK(6);
+  NEXT;
+
+OP(0x38) // SEC
+  SETF(FLAG_C);
+  CLK(2);
+  NEXT;
+
+OP(0x39) // AND Abs,Y
+  AND(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0x3D) // AND Abs,X
+  AND(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0x3E) // ROL Abs,X
+  ROL(AA_ABSX);
+  CLK(7);
+  NEXT;
+
+OP(0x40) // RTI
+  POP(byD0);
+  PUTF(byD0 | FLAG_R);
+  POPW(PC);
+  CLK(6);
+  NEXT;
+
+OP(0x41) // EOR (Zpg,X)
+  EOR(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0x45) // EOR Zpg
+  EOR(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x46) // LSR Zpg
+  LSR_ZP(AA_ZP);
+  CLK(5);
+  NEXT;
+
+OP(0x48) // PHA
+  PUSH(A);
+  CLK(3);
+  NEXT;
+
+OP(0x49) // EOR #Oper
+  EOR(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0x4A) // LSR A
+  LSRA;
+  CLK(2);
+  NEXT;
+
+OP(0x4C) // JMP Abs
+#if 0
+  JMP(AA_ABS);
+  CLK(3);
+#else
+{
+  auto addr = AA_ABS;
+  if (addr == PC - 3)
+  {
+    JMP(addr);
+    do
+    {
+      CLK(3);
+    } while (g_wPassedClocks < wClocks);
+    NEXT;
+  }
+  else
+  {
+    wA0 = PC - 3;
+    JMP(addr);
+    CLK(3);
+    if (PC < wA0)
+    {
+      IDLE_LOOP(wA0);
+    }
+  }
+}
+#endif
+  NEXT;
+
+OP(0x4D) // EOR Abs
+  EOR(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x4E) // LSR Abs
+  LSR(AA_ABS);
+  CLK(6);
+  NEXT;
+
+OP(0x50) // BVC
+  BRA(!(F & FLAG_V));
+  NEXT;
+
+OP(0x51) // EOR (Zpg),Y
+  EOR(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0x55) // EOR Zpg,X
+  EOR(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0x56) // LSR Zpg,X
+  LSR_ZP(AA_ZPX);
+  CLK(6);
+  NEXT;
+
+OP(0x58) // CLI
+  byD0 = F;
+  RSTF(FLAG_I);
+  CLK(2);
+  if ((byD0 & FLAG_I) && IRQ_State != IRQ_Wiring)
+  {
+    IRQ_State = IRQ_Wiring;
+    CLK(7);
+
+    PUSHW(PC);
+    PUSH(GETF() & ~FLAG_B);
+
+    RSTF(FLAG_D);
+    SETF(FLAG_I);
+
+    PC = K6502_ReadW(VECTOR_IRQ);
+  }
+  NEXT;
+
+OP(0x59) // EOR Abs,Y
+  EOR(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0x5D) // EOR Abs,X
+  EOR(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0x5E) // LSR Abs,X
+  LSR(AA_ABSX);
+  CLK(7);
+  NEXT;
+
+OP(0x60) // RTS
+  POPW(PC);
+  ++PC;
+  CLK(6);
+  NEXT;
+
+OP(0x61) // ADC (Zpg,X)
+  ADC(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0x65) // ADC Zpg
+  ADC(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x66) // ROR Zpg
+  ROR_ZP(AA_ZP);
+  CLK(5);
+  NEXT;
+
+OP(0x68) // PLA
+  POP(A);
+  TEST(A);
+  CLK(4);
+  NEXT;
+
+OP(0x69) // ADC #Oper
+  ADC(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0x6A) // ROR A
+  RORA;
+  CLK(2);
+  NEXT;
+
+OP(0x6C) // JMP (Abs)
+  JMP(K6502_ReadW2(AA_ABS));
+  CLK(5);
+  NEXT;
+
+OP(0x6D) // ADC Abs
+  ADC(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x6E) // ROR Abs
+  ROR(AA_ABS);
+  CLK(6);
+  NEXT;
+
+OP(0x70) // BVS
+  BRA(F & FLAG_V);
+  NEXT;
+
+OP(0x71) // ADC (Zpg),Y
+  ADC(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0x75) // ADC Zpg,X
+  ADC(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0x76) // ROR Zpg,X
+  ROR_ZP(AA_ZPX);
+  CLK(6);
+  NEXT;
+
+OP(0x78) // SEI
+  SETF(FLAG_I);
+  CLK(2);
+  NEXT;
+
+OP(0x79) // ADC Abs,Y
+  ADC(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0x7D) // ADC Abs,X
+  ADC(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0x7E) // ROR Abs,X
+  ROR(AA_ABSX);
+  CLK(7);
+  NEXT;
+
+OP(0x81) // STA (Zpg,X)
+  STA(AA_IX);
+  CLK(6);
+  NEXT;
+
+OP(0x84) // STY Zpg
+  STY_ZP(AA_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x85) // STA Zpg
+  STA_ZP(AA_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x86) // STX Zpg
+  STX_ZP(AA_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0x88) // DEY
+  --Y;
+  TEST(Y);
+  CLK(2);
+  NEXT;
+
+OP(0x8A) // TXA
+  A = X;
+  TEST(A);
+  CLK(2);
+  NEXT;
+
+OP(0x8C) // STY Abs
+  STY(AA_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x8D) // STA Abs
+  STA(AA_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x8E) // STX Abs
+  STX(AA_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0x90) // BCC
+  BRA(!(F & FLAG_C));
+  NEXT;
+
+OP(0x91) // STA (Zpg),Y
+  STA(AA_IY);
+  CLK(6);
+  NEXT;
+
+OP(0x94) // STY Zpg,X
+  STY_ZP(AA_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0x95) // STA Zpg,X
+  STA_ZP(AA_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0x96) // STX Zpg,Y
+  STX_ZP(AA_ZPY);
+  CLK(4);
+  NEXT;
+
+OP(0x98) // TYA
+  A = Y;
+  TEST(A);
+  CLK(2);
+  NEXT;
+
+OP(0x99) // STA Abs,Y
+  STA(AA_ABSY);
+  CLK(5);
+  NEXT;
+
+OP(0x9A) // TXS
+  SP = X;
+  CLK(2);
+  NEXT;
+
+OP(0x9D) // STA Abs,X
+  STA(AA_ABSX);
+  CLK(5);
+  NEXT;
+
+OP(0xA0) // LDY #Oper
+  LDY(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xA1) // LDA (Zpg,X)
+  LDA(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0xA2) // LDX #Oper
+  LDX(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xA4) // LDY Zpg
+  LDY(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xA5) // LDA Zpg
+  LDA(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xA6) // LDX Zpg
+  LDX(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xA8) // TAY
+  Y = A;
+  TEST(A);
+  CLK(2);
+  NEXT;
+
+OP(0xA9) // LDA #Oper
+  LDA(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xAA) // TAX
+  X = A;
+  TEST(A);
+  CLK(2);
+  NEXT;
+
+OP(0xAC) // LDY Abs
+  LDY(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xAD) // LDA Abs
+  LDA(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xAE) // LDX Abs
+  LDX(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xB0) // BCS
+  BRA(F & FLAG_C);
+  NEXT;
+
+OP(0xB1) // LDA (Zpg),Y
+  LDA(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0xB4) // LDY Zpg,X
+  LDY(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0xB5) // LDA Zpg,X
+  LDA(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0xB6) // LDX Zpg,Y
+  LDX(A_ZPY);
+  CLK(4);
+  NEXT;
+
+OP(0xB8) // CLV
+  RSTF(FLAG_V);
+  CLK(2);
+  NEXT;
+
+OP(0xB9) // LDA Abs,Y
+  LDA(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0xBA) // TSX
+  X = SP;
+  TEST(X);
+  CLK(2);
+  NEXT;
+
+OP(0xBC) // LDY Abs,X
+  LDY(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0xBD) // LDA Abs,X
+  LDA(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0xBE) // LDX Abs,Y
+  LDX(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0xC0) // CPY #Oper
+  CPY(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xC1) // CMP (Zpg,X)
+  CMP(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0xC4) // CPY Zpg
+  CPY(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xC5) // CMP Zpg
+  CMP(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xC6) // DEC Zpg
+  DEC_ZP(AA_ZP);
+  CLK(5);
+  NEXT;
+
+OP(0xC8) // INY
+  ++Y;
+  TEST(Y);
+  CLK(2);
+  NEXT;
+
+OP(0xC9) // CMP #Oper
+  CMP(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xCA) // DEX
+  --X;
+  TEST(X);
+  CLK(2);
+  NEXT;
+
+OP(0xCC) // CPY Abs
+  CPY(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xCD) // CMP Abs
+  CMP(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xCE) // DEC Abs
+  DEC(AA_ABS);
+  CLK(6);
+  NEXT;
+
+OP(0xD0) // BNE
+  BRA(byFlagZ);
+  NEXT;
+
+OP(0xD1) // CMP (Zpg),Y
+  CMP(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0xD5) // CMP Zpg,X
+  CMP(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0xD6) // DEC Zpg,X
+  DEC_ZP(AA_ZPX);
+  CLK(6);
+  NEXT;
+
+OP(0xD8) // CLD
+  RSTF(FLAG_D);
+  CLK(2);
+  NEXT;
+
+OP(0xD9) // CMP Abs,Y
+  CMP(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0xDD) // CMP Abs,X
+  CMP(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0xDE) // DEC Abs,X
+  DEC(AA_ABSX);
+  CLK(7);
+  NEXT;
+
+OP(0xE0) // CPX #Oper
+  CPX(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xE1) // SBC (Zpg,X)
+  SBC(A_IX);
+  CLK(6);
+  NEXT;
+
+OP(0xE4) // CPX Zpg
+  CPX(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xE5) // SBC Zpg
+  SBC(A_ZP);
+  CLK(3);
+  NEXT;
+
+OP(0xE6) // INC Zpg
+  INC_ZP(AA_ZP);
+  CLK(5);
+  NEXT;
+
+OP(0xE8) // INX
+  ++X;
+  TEST(X);
+  CLK(2);
+  NEXT;
+
+OP(0xE9) // SBC #Oper
+  SBC(A_IMM);
+  CLK(2);
+  NEXT;
+
+OP(0xEA) // NOP
+  CLK(2);
+  NEXT;
+
+OP(0xEC) // CPX Abs
+  CPX(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xED) // SBC Abs
+  SBC(A_ABS);
+  CLK(4);
+  NEXT;
+
+OP(0xEE) // INC Abs
+  INC(AA_ABS);
+  CLK(6);
+  NEXT;
+
+OP(0xF0) // BEQ
+  BRA(!byFlagZ);
+  NEXT;
+
+OP(0xF1) // SBC (Zpg),Y
+  SBC(A_IY);
+  CLK(5);
+  NEXT;
+
+OP(0xF5) // SBC Zpg,X
+  SBC(A_ZPX);
+  CLK(4);
+  NEXT;
+
+OP(0xF6) // INC Zpg,X
+  INC_ZP(AA_ZPX);
+  CLK(6);
+  NEXT;
+
+OP(0xF8) // SED
+  SETF(FLAG_D);
+  CLK(2);
+  NEXT;
+
+OP(0xF9) // SBC Abs,Y
+  SBC(A_ABSY);
+  CLK(4);
+  NEXT;
+
+OP(0xFD) // SBC Abs,X
+  SBC(A_ABSX);
+  CLK(4);
+  NEXT;
+
+OP(0xFE) // INC Abs,X
+  INC(AA_ABSX);
+  CLK(7);
+  NEXT;
+
+  /*-----------------------------------------------------------*/
+  /*  Unlisted Instructions ( thanks to virtualnes )           */
+  /*-----------------------------------------------------------*/
+
+OP(0x1A) // NOP (Unofficial)
+OP(0x3A) // NOP (Unofficial)
+OP(0x5A) // NOP (Unofficial)
+OP(0x7A) // NOP (Unofficial)
+OP(0xDA) // NOP (Unofficial)
+OP(0xFA) // NOP (Unofficial)
+  CLK(2);
+  NEXT;
+
+OP(0x80) // DOP (CYCLES 2)
+OP(0x82) // DOP (CYCLES 2)
+OP(0x89) // DOP (CYCLES 2)
+OP(0xC2) // DOP (CYCLES 2)
+OP(0xE2) // DOP (CYCLES 2)
+  PC++;
+  CLK(2);
+  NEXT;
+
+OP(0x04) // DOP (CYCLES 3)
+OP(0x44) // DOP (CYCLES 3)
+OP(0x64) // DOP (CYCLES 3)
+  PC++;
+  CLK(3);
+  NEXT;
+
+OP(0x14) // DOP (CYCLES 4)
+OP(0x34) // DOP (CYCLES 4)
+OP(0x54) // DOP (CYCLES 4)
+OP(0x74) // DOP (CYCLES 4)
+OP(0xD4) // DOP (CYCLES 4)
+OP(0xF4) // DOP (CYCLES 4)
+  PC++;
+  CLK(4);
+  NEXT;
+
+OP(0x0C) // TOP
+OP(0x1C) // TOP
+OP(0x3C) // TOP
+OP(0x5C) // TOP
+OP(0x7C) // TOP
+OP(0xDC) // TOP
+OP(0xFC) // TOP
+  PC += 2;
+  CLK(4);
+  NEXT;
+
+OP_DEFAULT // Unknown Instruction
+  CLK(2);
+#if 0
+    InfoNES_MessageBox( "0x%02x is unknown instruction.\n", byCode ) ;
+#endif
+  NEXT;
@@ -43,13 +43,37 @@ static inline BYTE K6502_ReadZp(BYTE byAddr)
 
 /*===================================================================*/
 /*                                                                   */
-/*               K6502_Read() : Reading operation                    */
+/*            K6502_WriteZp() : Writing to the zero page             */
 /*                                                                   */
 /*===================================================================*/
-static inline BYTE __not_in_flash_func(K6502_Read)(WORD wAddr)
+static inline void K6502_WriteZp(BYTE byAddr, BYTE byData)
 {
   /*
- *  Reading operation
+ *  Writing to the zero page
+ *
+ *  Parameters
+ *    BYTE byAddr              (Read)
+ *      An address inside the zero page
+ *
+ *    BYTE byData              (Read)
+ *      Data to write
+ *
+ *  Remarks
+ *    The zero page is always RAM, so the write dispatcher is skipped.
+ */
+
+  RAM[byAddr] = byData;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        K6502_ReadIo() : Reading from a page with no direct map    */
+/*                                                                   */
+/*===================================================================*/
+static BYTE __no_inline_not_in_flash_func(K6502_ReadIo)(WORD wAddr)
+{
+  /*
+ *  Reading from a page with no direct map
  *
  *  Parameters
  *    WORD wAddr              (Read)
@@ -59,25 +83,16 @@ static inline BYTE __not_in_flash_func(K6502_Read)(WORD wAddr)
  *    Read data
  *
  *  Remarks
- *    0x0000 - 0x1fff  RAM ( 0x800 - 0x1fff is mirror of 0x0 - 0x7ff )
  *    0x2000 - 0x3fff  PPU
  *    0x4000 - 0x5fff  Sound
- *    0x6000 - 0x7fff  SRAM ( Battery Backed )
- *    0x8000 - 0xffff  ROM
  *
+ *    RAM, SRAM and ROM are read through K6502_ReadMap and never
+ *    get here.
  */
   BYTE byRet;
 
-  if (wAddr >= 0x8000)
-  {
-    return ROMBANK[(wAddr - 0x8000) >> 13][wAddr & 0x1fff];
-  }
-
   switch (wAddr & 0xe000)
   {
-  case 0x0000: /* RAM */
-    return RAM[wAddr & 0x7ff];
-
   case 0x2000:                /* PPU */
     if ((wAddr & 0x7) == 0x7) /* PPU Memory */
     {
@@ -125,23 +140,7 @@ static inline BYTE __not_in_flash_func(K6502_Read)(WORD wAddr)
     if (wAddr == 0x4015)
     {
       // APU control
-      byRet = APU_Reg[0x15];
-      if (ApuC1Atl > 0)
-        byRet |= (1 << 0);
-      if (ApuC2Atl > 0)
-        byRet |= (1 << 1);
-      if (!ApuC3Holdnote)
-      {
-        if (ApuC3Atl > 0)
-          byRet |= (1 << 2);
-      }
-      else
-      {
-        if (ApuC3Llc > 0)
-          byRet |= (1 << 2);
-      }
-      if (ApuC4Atl > 0)
-        byRet |= (1 << 3);
+      byRet = APU_Reg[0x15] | InfoNES_pAPUStatus();
 
       // FrameIRQ
       APU_Reg[0x15] &= ~0x40;
@@ -164,32 +163,12 @@ static inline BYTE __not_in_flash_func(K6502_Read)(WORD wAddr)
     else
     {
       /* Return Mapper Register*/
-      return MapperReadApu(wAddr);
+      byRet = MapperReadApu(wAddr);
+      K6502_MapPrg();
+      return byRet;
     }
     break;
     // The other sound registers are not readable.
-
-  case 0x6000: /* SRAM */
-    if (ROM_SRAM)
-    {
-      return SRAM[wAddr & 0x1fff];
-    }
-    else
-    { /* SRAM BANK */
-      return SRAMBANK[wAddr & 0x1fff];
-    }
-
-    // case 0x8000: /* ROM BANK 0 */
-    //   return ROMBANK0[wAddr & 0x1fff];
-
-    // case 0xa000: /* ROM BANK 1 */
-    //   return ROMBANK1[wAddr & 0x1fff];
-
-    // case 0xc000: /* ROM BANK 2 */
-    //   return ROMBANK2[wAddr & 0x1fff];
-
-    // case 0xe000: /* ROM BANK 3 */
-    //   return ROMBANK3[wAddr & 0x1fff];
   }
 
   return (wAddr >> 8); /* when a register is not readable the upper half
@@ -198,13 +177,47 @@ static inline BYTE __not_in_flash_func(K6502_Read)(WORD wAddr)
 
 /*===================================================================*/
 /*                                                                   */
-/*               K6502_Write() : Writing operation                    */
+/*               K6502_Read() : Reading operation                    */
 /*                                                                   */
 /*===================================================================*/
-static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
+static inline BYTE __not_in_flash_func(K6502_Read)(WORD wAddr)
 {
   /*
- *  Writing operation
+ *  Reading operation
+ *
+ *  Parameters
+ *    WORD wAddr              (Read)
+ *      Address to read
+ *
+ *  Return values
+ *    Read data
+ *
+ *  Remarks
+ *    0x0000 - 0x1fff  RAM ( 0x800 - 0x1fff is mirror of 0x0 - 0x7ff )
+ *    0x2000 - 0x3fff  PPU
+ *    0x4000 - 0x5fff  Sound
+ *    0x6000 - 0x7fff  SRAM ( Battery Backed )
+ *    0x8000 - 0xffff  ROM
+ *
+ *    Mapped pages are a single load, the rest goes to K6502_ReadIo().
+ */
+  BYTE *pbyPage = K6502_ReadMap[wAddr >> 8];
+
+  if (pbyPage)
+    return pbyPage[wAddr & 0xff];
+
+  return K6502_ReadIo(wAddr);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        K6502_WriteIo() : Writing to a page with no direct map     */
+/*                                                                   */
+/*===================================================================*/
+static void __no_inline_not_in_flash_func(K6502_WriteIo)(WORD wAddr, BYTE byData)
+{
+  /*
+ *  Writing to a page with no direct map
  *
  *  Parameters
  *    WORD wAddr              (Read)
@@ -214,23 +227,17 @@ static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
  *      Data to write
  *
  *  Remarks
- *    0x0000 - 0x1fff  RAM ( 0x800 - 0x1fff is mirror of 0x0 - 0x7ff )
  *    0x2000 - 0x3fff  PPU
  *    0x4000 - 0x5fff  Sound
  *    0x6000 - 0x7fff  SRAM ( Battery Backed )
- *    0x8000 - 0xffff  ROM
+ *    0x8000 - 0xffff  ROM ( Mapper registers )
  *
+ *    A mapper may switch ROMBANK[] / SRAMBANK here, so the page table
+ *    is brought up to date after every mapper call.
  */
 
   switch (wAddr & 0xe000)
   {
-  case 0x0000: /* RAM */
-  {
-    auto addr = wAddr & 0x7ff;
-    RAM[addr] = byData;
-  }
-  break;
-
   case 0x2000: /* PPU */
     switch (wAddr & 0x7)
     {
@@ -333,12 +340,14 @@ static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
         // Pattern Data
         ChrBufUpdate |= (1 << (addr >> 10));
         PPUBANK[addr >> 10][addr & 0x3ff] = byData;
+        InfoNES_BgCacheWriteChr(PPUBANK[addr >> 10]);
       }
       else if (addr < 0x3f00) /* 0x2000 - 0x3eff */
       {
         // Name Table and mirror
         PPUBANK[addr >> 10][addr & 0x3ff] = byData;
         PPUBANK[(addr ^ 0x1000) >> 10][addr & 0x3ff] = byData;
+        InfoNES_BgCacheWriteNT(addr);
       }
       else if (!(addr & 0xf)) /* 0x3f00 or 0x3f10 */
       {
@@ -460,6 +469,7 @@ static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
     {
       /* Write to APU */
       MapperApu(wAddr, byData);
+      K6502_MapPrg();
     }
     break;
 
@@ -471,6 +481,7 @@ static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
     if (!ROM_SRAM)
     {
       MapperSram(wAddr, byData);
+      K6502_MapPrg();
     }
     break;
 
@@ -480,10 +491,62 @@ static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
   case 0xe000: /* ROM BANK 3 */
     // Write to Mapper
     MapperWrite(wAddr, byData);
+    K6502_MapPrg();
     break;
   }
 }
 
+/*===================================================================*/
+/*                                                                   */
+/*               K6502_Write() : Writing operation                    */
+/*                                                                   */
+/*===================================================================*/
+static inline void __not_in_flash_func(K6502_Write)(WORD wAddr, BYTE byData)
+{
+  /*
+ *  Writing operation
+ *
+ *  Parameters
+ *    WORD wAddr              (Read)
+ *      Address to write
+ *
+ *    BYTE byData             (Read)
+ *      Data to write
+ *
+ *  Remarks
+ *    Only RAM pages are mapped for writing, the rest goes to
+ *    K6502_WriteIo().
+ */
+  BYTE *pbyPage = K6502_WriteMap[wAddr >> 8];
+
+  if (pbyPage)
+  {
+    pbyPage[wAddr & 0xff] = byData;
+    return;
+  }
+
+  K6502_WriteIo(wAddr, byData);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*            K6502_Fetch() : Reading the instruction stream         */
+/*                                                                   */
+/*===================================================================*/
+static inline BYTE __not_in_flash_func(K6502_Fetch)()
+{
+  /*
+ *  Read the byte at PC and advance PC ( opcode, immediate and operands )
+ */
+  return K6502_Read(PC++);
+}
+
+static inline WORD __not_in_flash_func(K6502_FetchW)()
+{
+  WORD wData = K6502_Fetch();
+  return wData | (WORD)K6502_Fetch() << 8;
+}
+
 // Reading/Writing operation (WORD version)
 static inline WORD K6502_ReadW(WORD wAddr) { return K6502_Read(wAddr) | (WORD)K6502_Read(wAddr + 1) << 8; };
 static inline void K6502_WriteW(WORD wAddr, WORD wData)
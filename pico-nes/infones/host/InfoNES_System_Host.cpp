@@ -0,0 +1,656 @@
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_System_Host.cpp : Headless host ( Linux ) system file    */
+/*                                                                   */
+/*  No window and no sound device: the frame is kept in SCREEN, the  */
+/*  sound can be captured to files, and the tools linked against     */
+/*  this file decide what to do with the rest.                       */
+/*                                                                   */
+/*===================================================================*/
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "InfoNES_System_Host.h"
+#include "../InfoNES_pAPU.h"
+#include "../InfoNES_RomCache.h"
+#include "audio_mix.h"
+#include "../../src/rom_pack.h"
+
+#ifdef APU_THREAD
+#include <atomic>
+#include <thread>
+#endif
+
+/*-------------------------------------------------------------------*/
+/*  Global Variables ( Host specific )                               */
+/*-------------------------------------------------------------------*/
+
+BYTE SCREEN[NES_DISP_HEIGHT][NES_DISP_WIDTH];
+
+char szRomName[256];
+int Host_PackEntry;
+
+DWORD Host_Frames;
+DWORD Host_FrameLimit;
+int Host_Quiet;
+
+int (*Host_FrameHook)(DWORD dwFrame);
+void (*Host_PadHook)(DWORD dwFrame, DWORD *pdwPad1, DWORD *pdwPad2, DWORD *pdwSystem);
+void (*Host_SoundHook)(int samples, const BYTE *wave1, const BYTE *wave2,
+                       const BYTE *wave3, const BYTE *wave4, const BYTE *wave5,
+                       const BYTE *wave6);
+
+unsigned long long Host_Samples;
+int Host_SampleRate = 44100;
+
+/* Set once InfoNES_Video() managed to reset the cassette */
+static int bStarted;
+
+/* Audio capture ( Host_AudioCapture ) */
+static char szCaptureName[256];
+static int nCaptureFlags;
+static FILE *fpCapture;
+static FILE *fpCaptureWave[6];
+
+#ifdef ROM_LZ4
+/* The pack an LZ4 entry is decoded from, until InfoNES_ReleaseRom() */
+static BYTE *pLz4Pack;
+#endif
+
+#ifdef APU_THREAD
+/* The APU consumer, in place of the device's core1 loop */
+static std::thread ApuThread;
+static std::atomic<bool> bApuStop;
+
+static void ApuThreadMain()
+{
+  while (!bApuStop.load(std::memory_order_relaxed))
+  {
+    InfoNES_pAPUProcess();
+    std::this_thread::yield();
+  }
+}
+
+/* Let the consumer catch up, so the hooks see the same audio per frame */
+static void ApuThreadDrain()
+{
+  while (!InfoNES_pAPUIdle())
+    std::this_thread::yield();
+}
+#endif
+
+/* Palette data ( color indices, the display side owns the RGB table ) */
+const BYTE NesPalette[64] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f};
+
+/*===================================================================*/
+/*                                                                   */
+/*              Host_Run() : Run a cassette headless                 */
+/*                                                                   */
+/*===================================================================*/
+int Host_Run(const char *pszFileName, DWORD dwFrames)
+{
+  /*
+   *  Run a cassette headless
+   *
+   *  Parameters
+   *    const char *pszFileName            (Read)
+   *      File name of ROM image
+   *    DWORD dwFrames                     (Read)
+   *      Number of frames to emulate ( 0 : until a hook stops it )
+   *
+   *  Return values
+   *     0 : It was finished normally.
+   *    -1 : The cassette could not be started.
+   */
+
+  snprintf(szRomName, sizeof szRomName, "%s", pszFileName);
+  Host_FrameLimit = dwFrames;
+  Host_Frames = 0;
+  Host_Samples = 0;
+  bStarted = 0;
+
+  InfoNES_Main(true);
+
+  return bStarted ? 0 : -1;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*          Host_Nanoseconds() : Monotonic clock for the tools       */
+/*                                                                   */
+/*===================================================================*/
+unsigned long long Host_Nanoseconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        Host_WavOpen() / Host_WavWrite() / Host_WavClose() :       */
+/*                  16-bit PCM WAV output for the tools              */
+/*                                                                   */
+/*===================================================================*/
+static void WavPut(FILE *fp, DWORD dwValue, int nBytes)
+{
+  for (int i = 0; i < nBytes; ++i)
+    fputc((dwValue >> (8 * i)) & 0xff, fp);
+}
+
+FILE *Host_WavOpen(const char *pszFileName, int nRate, int nChannels, int nBits)
+{
+  FILE *fp = fopen(pszFileName, "wb");
+  if (fp == NULL)
+    return NULL;
+
+  const int nAlign = nChannels * nBits / 8;
+  fwrite("RIFF", 1, 4, fp);
+  WavPut(fp, 36, 4);              /* patched by Host_WavClose() */
+  fwrite("WAVEfmt ", 1, 8, fp);
+  WavPut(fp, 16, 4);              /* fmt chunk size */
+  WavPut(fp, 1, 2);               /* PCM */
+  WavPut(fp, nChannels, 2);
+  WavPut(fp, nRate, 4);
+  WavPut(fp, nRate * nAlign, 4);  /* bytes per second */
+  WavPut(fp, nAlign, 2);
+  WavPut(fp, nBits, 2);
+  fwrite("data", 1, 4, fp);
+  WavPut(fp, 0, 4);               /* patched by Host_WavClose() */
+  return fp;
+}
+
+void Host_WavWrite(FILE *fp, const void *pData, int nBytes)
+{
+  /* 16-bit samples are stored little-endian, like the host */
+  fwrite(pData, 1, nBytes, fp);
+}
+
+void Host_WavClose(FILE *fp)
+{
+  DWORD dwData = (DWORD)ftell(fp) - 44;
+  fseek(fp, 4, SEEK_SET);
+  WavPut(fp, 36 + dwData, 4);
+  fseek(fp, 40, SEEK_SET);
+  WavPut(fp, dwData, 4);
+  fclose(fp);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*                  InfoNES_Menu() : Menu screen                     */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_Menu()
+{
+  /* There is no menu on the host, always run szRomName */
+  return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*            InfoNES_Video() : Load and reset the cassette          */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_Video()
+{
+  if (InfoNES_Load(szRomName) < 0)
+  {
+    InfoNES_Error("Cannot start %s", szRomName);
+    return -1;
+  }
+  bStarted = 1;
+  return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        ReadRomPack() : Read Host_PackEntry of a ROM pack          */
+/*                                                                   */
+/*===================================================================*/
+static int ReadRomPack(FILE *fp)
+{
+  /* The whole pack goes through src/rom_pack.cpp, as it does from flash */
+  fseek(fp, 0, SEEK_END);
+  long lSize = ftell(fp);
+  rewind(fp);
+  BYTE *pPack = (BYTE *)malloc(lSize);
+  if (pPack == NULL || fread(pPack, lSize, 1, fp) != 1)
+  {
+    free(pPack);
+    return -1;
+  }
+
+  const rom_pack_header_t *pack = rom_pack_open(pPack, lSize);
+  if (pack == NULL || Host_PackEntry < 0 || Host_PackEntry >= pack->count ||
+      !rom_pack_verify(pack, rom_pack_index(pack)[Host_PackEntry]))
+  {
+    free(pPack);
+    return -1;
+  }
+  const rom_pack_entry_t &entry = rom_pack_index(pack)[Host_PackEntry];
+  const BYTE *pImage = rom_pack_image(pack, entry);
+
+  memcpy(&NesHeader, pImage, sizeof NesHeader);
+  const DWORD dwTrainer = (NesHeader.byInfo1 & 4) ? 512 : 0;
+
+  /* Mapper and mirroring from the pack's ROM database, as on the device */
+  const rom_db_record_t *pRecord = rom_pack_db_find(pack, entry.crc32);
+  if (pRecord != NULL)
+  {
+    RomInfo.byKnown = 1;
+    RomInfo.byMirroring = pRecord->mirroring;
+    RomInfo.wMapperNo = pRecord->mapper;
+    RomInfo.byBattery = (pRecord->flags & ROM_DB_BATTERY) ? 1 : 0;
+    RomInfo.dwQuirks = pRecord->flags >> ROM_DB_QUIRKS_SHIFT;
+  }
+
+  if (entry.flags & ROM_PACK_LZ4)
+  {
+#ifdef ROM_LZ4
+    /* Banks are decoded from the pack as the mapper maps them */
+    memset(SRAM, 0, SRAM_SIZE);
+    memcpy(&SRAM[0x1000], pImage + sizeof NesHeader, dwTrainer);
+    if (InfoNES_RomCacheOpen(pImage, entry.size) < 0)
+    {
+      free(pPack);
+      return -1;
+    }
+    pLz4Pack = pPack;
+    return 0;
+#else
+    free(pPack);
+    return -1;
+#endif
+  }
+
+  const DWORD dwRomSize = NesHeader.byRomSize * 0x4000;
+  const DWORD dwVRomSize = NesHeader.byVRomSize * 0x2000;
+  if (sizeof NesHeader + dwTrainer + dwRomSize + dwVRomSize > entry.size)
+  {
+    free(pPack);
+    return -1;
+  }
+  pImage += sizeof NesHeader;
+
+  memset(SRAM, 0, SRAM_SIZE);
+  memcpy(&SRAM[0x1000], pImage, dwTrainer);
+  pImage += dwTrainer;
+
+  ROM = (BYTE *)malloc(dwRomSize);
+  memcpy(ROM, pImage, dwRomSize);
+  pImage += dwRomSize;
+  if (dwVRomSize > 0)
+  {
+    VROM = (BYTE *)malloc(dwVRomSize);
+    memcpy(VROM, pImage, dwVRomSize);
+  }
+
+  free(pPack);
+  return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*               InfoNES_ReadRom() : Read ROM image file             */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_ReadRom(const char *pszFileName)
+{
+  /*
+   *  Read ROM image file
+   *
+   *  Parameters
+   *    const char *pszFileName          (Read)
+   *
+   *  Return values
+   *     0 : Normally
+   *    -1 : Error
+   */
+
+  FILE *fp;
+
+  /* Open ROM file */
+  fp = fopen(pszFileName, "rb");
+  if (fp == NULL)
+    return -1;
+
+  /* Read ROM Header */
+  if (fread(&NesHeader, sizeof NesHeader, 1, fp) != 1)
+  {
+    fclose(fp);
+    return -1;
+  }
+
+  /* A ROM pack instead of a single image */
+  if (memcmp(NesHeader.byID, "NESP", 4) == 0)
+  {
+    int nResult = ReadRomPack(fp);
+    fclose(fp);
+    return nResult;
+  }
+
+  if (memcmp(NesHeader.byID, "NES\x1a", 4) != 0)
+  {
+    /* not .nes file */
+    fclose(fp);
+    return -1;
+  }
+
+  /* Clear SRAM */
+  memset(SRAM, 0, SRAM_SIZE);
+
+  /* If trainer presents Read Triner at 0x7000-0x71ff */
+  if (NesHeader.byInfo1 & 4)
+  {
+    if (fread(&SRAM[0x1000], 512, 1, fp) != 1)
+    {
+      fclose(fp);
+      return -1;
+    }
+  }
+
+  /* Allocate Memory for ROM Image and read it */
+  ROM = (BYTE *)malloc(NesHeader.byRomSize * 0x4000);
+  if (fread(ROM, 0x4000, NesHeader.byRomSize, fp) != NesHeader.byRomSize)
+  {
+    free(ROM);
+    ROM = NULL;
+    fclose(fp);
+    return -1;
+  }
+
+  if (NesHeader.byVRomSize > 0)
+  {
+    /* Allocate Memory for VROM Image and read it */
+    VROM = (BYTE *)malloc(NesHeader.byVRomSize * 0x2000);
+    if (fread(VROM, 0x2000, NesHeader.byVRomSize, fp) != NesHeader.byVRomSize)
+    {
+      free(VROM);
+      VROM = NULL;
+      free(ROM);
+      ROM = NULL;
+      fclose(fp);
+      return -1;
+    }
+  }
+
+  /* File close */
+  fclose(fp);
+
+  /* Successful */
+  return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*           InfoNES_ReleaseRom() : Release a memory for ROM         */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_ReleaseRom()
+{
+  memset(&RomInfo, 0, sizeof RomInfo);
+
+#ifdef ROM_LZ4
+  InfoNES_RomCacheClose();
+  free(pLz4Pack);
+  pLz4Pack = NULL;
+#endif
+
+  free(ROM);
+  ROM = NULL;
+
+  free(VROM);
+  VROM = NULL;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*      InfoNES_LoadFrame() :                                        */
+/*           Transfer the contents of work frame on the screen       */
+/*                                                                   */
+/*===================================================================*/
+int InfoNES_LoadFrame()
+{
+  ++Host_Frames;
+
+#ifdef APU_THREAD
+  ApuThreadDrain();
+#endif
+
+  if (Host_FrameHook && Host_FrameHook(Host_Frames) < 0)
+    return -1;
+
+  if (Host_FrameLimit && Host_Frames >= Host_FrameLimit)
+    return -1;
+
+  return 0;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*             InfoNES_PadState() : Get a joypad state               */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_PadState(DWORD *pdwPad1, DWORD *pdwPad2, DWORD *pdwSystem)
+{
+  *pdwPad1 = *pdwPad2 = *pdwSystem = 0;
+
+  if (Host_PadHook)
+    Host_PadHook(Host_Frames, pdwPad1, pdwPad2, pdwSystem);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*        InfoNES_PreDrawLine() / InfoNES_PostDrawLine() :           */
+/*          Let the PPU render straight into the SCREEN row          */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_PreDrawLine(int line)
+{
+  InfoNES_SetLineBuffer(SCREEN[line], NES_DISP_WIDTH);
+}
+
+void InfoNES_PostDrawLine(int line)
+{
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*      Sound ( captured to files and handed to Host_SoundHook )     */
+/*                                                                   */
+/*===================================================================*/
+void Host_AudioCapture(const char *pszFileName, int nFlags)
+{
+  if (pszFileName)
+    snprintf(szCaptureName, sizeof szCaptureName, "%s", pszFileName);
+  else
+    szCaptureName[0] = '\0';
+  nCaptureFlags = nFlags;
+}
+
+void Host_Mix(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3,
+              const BYTE *wave4, const BYTE *wave5, const BYTE *wave6, short *psOut)
+{
+  /* The device mixer with its default stereo image and settings.snd_vol */
+  static audio_mix_t Mixer;
+  static bool bMixer;
+  if (!bMixer)
+  {
+    audio_mix_init(&Mixer);
+    bMixer = true;
+  }
+  audio_mix_run(&Mixer, samples, wave1, wave2, wave3, wave4, wave5, wave6, psOut);
+}
+
+static FILE *CaptureOpen(const char *pszFileName, int nRate, int nChannels, int nBits)
+{
+  FILE *fp = (nCaptureFlags & HOST_AUDIO_RAW) ? fopen(pszFileName, "wb")
+                                              : Host_WavOpen(pszFileName, nRate, nChannels, nBits);
+  if (fp == NULL)
+    InfoNES_Error("Cannot write %s", pszFileName);
+  return fp;
+}
+
+static void CaptureClose(FILE *fp)
+{
+  if (fp == NULL)
+    return;
+  if (nCaptureFlags & HOST_AUDIO_RAW)
+    fclose(fp);
+  else
+    Host_WavClose(fp);
+}
+
+void InfoNES_SoundInit()
+{
+}
+
+int InfoNES_SoundOpen(int samples_per_sync, int sample_rate)
+{
+  Host_SampleRate = sample_rate;
+
+#ifdef APU_THREAD
+  if (!ApuThread.joinable())
+  {
+    bApuStop = false;
+    ApuThread = std::thread(ApuThreadMain);
+  }
+#endif
+
+  /* Called again on every reset: keep the files of this run open */
+  if (!szCaptureName[0] || fpCapture)
+    return 0;
+
+  fpCapture = CaptureOpen(szCaptureName, sample_rate, 2, 16);
+  if (nCaptureFlags & HOST_AUDIO_CHANNELS)
+  {
+    for (int ch = 0; ch < 6; ++ch)
+    {
+      char szName[sizeof szCaptureName + 4];
+      snprintf(szName, sizeof szName, "%s.%d", szCaptureName, ch + 1);
+      fpCaptureWave[ch] = CaptureOpen(szName, sample_rate, 1, 8);
+    }
+  }
+  return 0;
+}
+
+void InfoNES_SoundClose()
+{
+#ifdef APU_THREAD
+  /* The last frames go out before the files close */
+  if (ApuThread.joinable())
+  {
+    ApuThreadDrain();
+    bApuStop = true;
+    ApuThread.join();
+  }
+#endif
+
+  CaptureClose(fpCapture);
+  fpCapture = NULL;
+  for (int ch = 0; ch < 6; ++ch)
+  {
+    CaptureClose(fpCaptureWave[ch]);
+    fpCaptureWave[ch] = NULL;
+  }
+}
+
+int InfoNES_GetSoundBufferSize()
+{
+  /* Same as src/main.cpp: two frames at the output rate */
+  return (AUDIO_OUTPUT_RATE / 60) * 2;
+}
+
+void InfoNES_SoundOutput(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3,
+                         const BYTE *wave4, const BYTE *wave5, const BYTE *wave6)
+{
+  Host_Samples += samples;
+
+  if (fpCapture)
+  {
+    short sMix[(44100 / 60) * 2 * 2];
+    for (int done = 0; done < samples;)
+    {
+      int n = samples - done;
+      if (n > (int)(sizeof sMix / sizeof sMix[0] / 2))
+        n = sizeof sMix / sizeof sMix[0] / 2;
+      Host_Mix(n, wave1 + done, wave2 + done, wave3 + done, wave4 + done, wave5 + done,
+               wave6 ? wave6 + done : NULL, sMix);
+      fwrite(sMix, sizeof sMix[0], n * 2, fpCapture);
+      done += n;
+    }
+  }
+
+  /* Without an expansion chip its file gets silence, so all six stay in step */
+  static const BYTE byNoWave[(44100 / 60) * 2] = {0};
+  const BYTE *pbyWave[6] = {wave1, wave2, wave3, wave4, wave5, wave6 ? wave6 : byNoWave};
+  for (int ch = 0; ch < 6; ++ch)
+    if (fpCaptureWave[ch])
+      fwrite(pbyWave[ch], 1, samples, fpCaptureWave[ch]);
+
+  if (Host_SoundHook)
+    Host_SoundHook(samples, wave1, wave2, wave3, wave4, wave5, wave6);
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*      InfoNES_PrefetchStart() : DPCM prefetch, a plain copy        */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_PrefetchStart(void *dest, const void *src, int count)
+{
+  memcpy(dest, src, count);
+}
+
+bool InfoNES_PrefetchBusy()
+{
+  return false;
+}
+
+/*===================================================================*/
+/*                                                                   */
+/*            InfoNES_MessageBox() / InfoNES_Error() :               */
+/*                     Print system message                          */
+/*                                                                   */
+/*===================================================================*/
+void InfoNES_MessageBox(const char *pszMsg, ...)
+{
+  va_list args;
+
+  if (Host_Quiet)
+    return;
+
+  va_start(args, pszMsg);
+  vfprintf(stderr, pszMsg, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+void InfoNES_Error(const char *pszMsg, ...)
+{
+  va_list args;
+
+  fprintf(stderr, "[Error] ");
+  va_start(args, pszMsg);
+  vfprintf(stderr, pszMsg, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+void InfoNES_DebugPrint(const char *pszMsg)
+{
+  fprintf(stderr, "%s\n", pszMsg);
+}
@@ -0,0 +1,101 @@
+/*===================================================================*/
+/*                                                                   */
+/*  InfoNES_System_Host.h : Headless host ( Linux ) system backend   */
+/*                                                                   */
+/*  Shared by the host tools ( nesbench, ... ). The backend renders  */
+/*  into SCREEN exactly like the Tufty firmware and lets the tool    */
+/*  hook frames, pads and sound.                                     */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef InfoNES_SYSTEM_HOST_H_INCLUDED
+#define InfoNES_SYSTEM_HOST_H_INCLUDED
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include <stdio.h>
+
+#include "../InfoNES.h"
+#include "../InfoNES_System.h"
+
+/*-------------------------------------------------------------------*/
+/*  Frame buffer                                                     */
+/*-------------------------------------------------------------------*/
+
+/* NES color indices, one byte per pixel ( same layout as src/main.cpp ) */
+extern BYTE SCREEN[NES_DISP_HEIGHT][NES_DISP_WIDTH];
+
+/*-------------------------------------------------------------------*/
+/*  Run control                                                      */
+/*-------------------------------------------------------------------*/
+
+/* ROM image file name used by InfoNES_Video() */
+extern char szRomName[256];
+
+/* Entry of szRomName to run when it is a ROM pack ( tools/convert_roms.py ) */
+extern int Host_PackEntry;
+
+/* Number of frames passed to InfoNES_LoadFrame() so far */
+extern DWORD Host_Frames;
+
+/* Stop the emulation after this many frames ( 0 : never ) */
+extern DWORD Host_FrameLimit;
+
+/* Silence InfoNES_MessageBox() output */
+extern int Host_Quiet;
+
+/* Samples passed to InfoNES_SoundOutput() so far, at the rate given to InfoNES_SoundOpen() */
+extern unsigned long long Host_Samples;
+extern int Host_SampleRate;
+
+/*-------------------------------------------------------------------*/
+/*  Hooks ( all optional )                                           */
+/*-------------------------------------------------------------------*/
+
+/* Called from InfoNES_LoadFrame() with the finished SCREEN; return <0 to stop */
+extern int (*Host_FrameHook)(DWORD dwFrame);
+
+/* Called from InfoNES_PadState() once per frame */
+extern void (*Host_PadHook)(DWORD dwFrame, DWORD *pdwPad1, DWORD *pdwPad2, DWORD *pdwSystem);
+
+/* Called from InfoNES_SoundOutput() with the five channel waves and the expansion wave ( or NULL ) */
+extern void (*Host_SoundHook)(int samples, const BYTE *wave1, const BYTE *wave2,
+                              const BYTE *wave3, const BYTE *wave4, const BYTE *wave5,
+                              const BYTE *wave6);
+
+/*-------------------------------------------------------------------*/
+/*  Function prototypes                                              */
+/*-------------------------------------------------------------------*/
+
+/* Run szRomName for Host_FrameLimit frames; returns -1 if the ROM could not start */
+int Host_Run(const char *pszFileName, DWORD dwFrames);
+
+/* Monotonic clock in nanoseconds */
+unsigned long long Host_Nanoseconds();
+
+/* PCM WAV files ( 8 or 16 bits ): open writes a placeholder header, close fills in the sizes */
+FILE *Host_WavOpen(const char *pszFileName, int nRate, int nChannels, int nBits);
+void Host_WavWrite(FILE *fp, const void *pData, int nBytes);
+void Host_WavClose(FILE *fp);
+
+/*-------------------------------------------------------------------*/
+/*  Audio capture                                                    */
+/*-------------------------------------------------------------------*/
+
+/* Raw little-endian PCM instead of WAV */
+#define HOST_AUDIO_RAW 1
+/* Also write the channel waves ( 8-bit mono ) to <name>.1 .. <name>.5, and the
+   expansion wave to <name>.6 ( silent without an expansion chip ) */
+#define HOST_AUDIO_CHANNELS 2
+
+/* Capture every InfoNES_SoundOutput() of the next Host_Run() to pszFileName
+   as 16-bit stereo, mixed like src/main.cpp ( NULL : stop capturing ) */
+void Host_AudioCapture(const char *pszFileName, int nFlags);
+
+/* Mix the channel waves to interleaved int16 stereo like src/main.cpp ( audio_mix_run ) */
+void Host_Mix(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3,
+              const BYTE *wave4, const BYTE *wave5, const BYTE *wave6, short *psOut);
+
+#endif /* !InfoNES_SYSTEM_HOST_H_INCLUDED */
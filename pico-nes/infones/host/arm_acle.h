@@ -0,0 +1,59 @@
+/*===================================================================*/
+/*                                                                   */
+/*  arm_acle.h : Host stand-in for the Cortex-M33 DSP intrinsics     */
+/*                                                                   */
+/*  Plain C versions of the ACLE SIMD32 intrinsics audio_mix.c uses, */
+/*  so nesmix can run the mixer's DSP path on the host.              */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef HOST_ARM_ACLE_H_INCLUDED
+#define HOST_ARM_ACLE_H_INCLUDED
+
+#include <stdint.h>
+
+static inline int32_t host_acle_lo(const uint32_t x) { return (int16_t)(x & 0xffff); }
+static inline int32_t host_acle_hi(const uint32_t x) { return (int16_t)(x >> 16); }
+
+static inline int32_t host_acle_sat16(const int32_t x)
+{
+  return x < -32768 ? -32768 : x > 32767 ? 32767 : x;
+}
+
+static inline uint32_t host_acle_pack(const int32_t lo, const int32_t hi)
+{
+  return ((uint32_t)lo & 0xffff) | ((uint32_t)hi << 16);
+}
+
+/* Dual 16-bit multiply, products added ( to acc ) */
+static inline int32_t __smuad(const uint32_t a, const uint32_t b)
+{
+  return host_acle_lo(a) * host_acle_lo(b) + host_acle_hi(a) * host_acle_hi(b);
+}
+
+static inline int32_t __smlad(const uint32_t a, const uint32_t b, const int32_t acc)
+{
+  return acc + __smuad(a, b);
+}
+
+/* Saturating 16-bit lane add / subtract */
+static inline uint32_t __qadd16(const uint32_t a, const uint32_t b)
+{
+  return host_acle_pack(host_acle_sat16(host_acle_lo(a) + host_acle_lo(b)),
+                        host_acle_sat16(host_acle_hi(a) + host_acle_hi(b)));
+}
+
+static inline uint32_t __qsub16(const uint32_t a, const uint32_t b)
+{
+  return host_acle_pack(host_acle_sat16(host_acle_lo(a) - host_acle_lo(b)),
+                        host_acle_sat16(host_acle_hi(a) - host_acle_hi(b)));
+}
+
+/* Bottom / top lane of a times bottom lane of b */
+static inline int32_t __smulbb(const uint32_t a, const uint32_t b) { return host_acle_lo(a) * host_acle_lo(b); }
+static inline int32_t __smultb(const uint32_t a, const uint32_t b) { return host_acle_hi(a) * host_acle_lo(b); }
+
+/* Only the 16-bit saturation audio_mix.c asks for */
+#define __ssat(x, bits) host_acle_sat16(x)
+
+#endif /* !HOST_ARM_ACLE_H_INCLUDED */
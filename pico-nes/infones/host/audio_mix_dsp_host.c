@@ -0,0 +1,16 @@
+/*===================================================================*/
+/*                                                                   */
+/*  audio_mix_dsp_host.c : audio_mix.c as the Cortex-M33 DSP path    */
+/*                                                                   */
+/*  drivers/audio/audio_mix.c compiled again under its own names for */
+/*  nesmix, which checks it against the SSE2 path of infones-host.   */
+/*                                                                   */
+/*===================================================================*/
+
+#define audio_mix_init audio_mix_init_dsp
+#define audio_mix_set_channel audio_mix_set_channel_dsp
+#define audio_mix_update audio_mix_update_dsp
+#define audio_mix_run audio_mix_run_dsp
+#define __ARM_FEATURE_SIMD32 1 /* through the arm_acle.h stand-in */
+
+#include "audio_mix.c"
@@ -0,0 +1,16 @@
+/*===================================================================*/
+/*                                                                   */
+/*  audio_mix_scalar_host.c : audio_mix.c as the plain C reference path*/
+/*                                                                   */
+/*  drivers/audio/audio_mix.c compiled again under its own names for */
+/*  nesmix, which checks it against the SSE2 path of infones-host.   */
+/*                                                                   */
+/*===================================================================*/
+
+#define audio_mix_init audio_mix_init_scalar
+#define audio_mix_set_channel audio_mix_set_channel_scalar
+#define audio_mix_update audio_mix_update_scalar
+#define audio_mix_run audio_mix_run_scalar
+#define AUDIO_MIX_SCALAR
+
+#include "audio_mix.c"
@@ -0,0 +1,66 @@
+/*===================================================================*/
+/*                                                                   */
+/*  audio_pwm_host.c : Host stand-in for the PWM audio driver        */
+/*                                                                   */
+/*  Same encoder and timer maths as drivers/audio/audio_pwm.c, with  */
+/*  the DMA replaced by pwm_audio_host_dma().                        */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_pwm_host.h"
+
+uint32_t pwm_audio_host_clk_sys = 150000000;
+uint64_t pwm_audio_host_rate_mhz;
+void (*pwm_audio_host_hook)(const audio_frame_t *frames, const uint32_t *duty, uint32_t count);
+
+static pwm_audio_config_t *pwm_config;
+static audio_ring_t *pwm_ring;
+static audio_frame_t *pwm_frames;
+
+void pwm_audio_init(pwm_audio_config_t *config)
+{
+  uint16_t num, den;
+
+  if (!config->bits)
+    config->bits = PWM_AUDIO_BITS;
+  pwm_audio_host_rate_mhz =
+      pwm_audio_timer_fraction(pwm_audio_host_clk_sys, config->sample_freq, &num, &den);
+
+  for (int i = 0; i < 2; i++)
+    config->dma_buf[i] = (uint32_t *)malloc(config->dma_trans_count * sizeof(uint32_t));
+  free(pwm_frames);
+  pwm_frames = (audio_frame_t *)malloc(config->dma_trans_count * sizeof(audio_frame_t));
+
+  /* The device driver panics here */
+  if (!config->dma_buf[0] || !config->dma_buf[1] || !pwm_frames)
+  {
+    fprintf(stderr, "pwm_audio_init: no memory for %u DMA frames\n", (unsigned)config->dma_trans_count);
+    abort();
+  }
+}
+
+void pwm_audio_start(pwm_audio_config_t *config, audio_ring_t *ring)
+{
+  pwm_config = config;
+  pwm_ring = ring;
+}
+
+void pwm_audio_host_dma(uint32_t blocks)
+{
+  while (blocks--)
+  {
+    /* pwm_audio_fill(): pop, then encode in place */
+    uint32_t *duty = pwm_config->dma_buf[0];
+    const uint32_t count = pwm_config->dma_trans_count;
+    audio_ring_pop(pwm_ring, duty, count);
+    memcpy(pwm_frames, duty, count * sizeof(audio_frame_t));
+    pwm_audio_encode(duty, count, pwm_config->bits, pwm_config->stereo, pwm_config->volume);
+
+    if (pwm_audio_host_hook)
+      pwm_audio_host_hook(pwm_frames, duty, count);
+  }
+}
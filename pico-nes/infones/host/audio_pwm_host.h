@@ -0,0 +1,38 @@
+/*===================================================================*/
+/*                                                                   */
+/*  audio_pwm_host.h : Host stand-in for the PWM audio driver        */
+/*                                                                   */
+/*  pwm_audio_init() / pwm_audio_start() keep the configuration and  */
+/*  the ring; nothing runs until the tool calls pwm_audio_host_dma(),*/
+/*  which plays the DMA IRQ for a number of blocks and hands every   */
+/*  block ( the frames popped and the duty words written to CC ) to  */
+/*  pwm_audio_host_hook.                                             */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef AUDIO_PWM_HOST_H_INCLUDED
+#define AUDIO_PWM_HOST_H_INCLUDED
+
+#include "audio_pwm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* clk_sys the stub paces the DMA timer from ( Hz ) */
+extern uint32_t pwm_audio_host_clk_sys;
+
+/* Sample rate the DMA timer fraction works out to ( mHz ) */
+extern uint64_t pwm_audio_host_rate_mhz;
+
+/* Called once per completed DMA block */
+extern void (*pwm_audio_host_hook)(const audio_frame_t *frames, const uint32_t *duty, uint32_t count);
+
+/* Run the DMA for this many blocks */
+void pwm_audio_host_dma(uint32_t blocks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !AUDIO_PWM_HOST_H_INCLUDED */
@@ -0,0 +1,99 @@
+/*===================================================================*/
+/*                                                                   */
+/*  ff.h : Host stand-in for FatFs                                   */
+/*                                                                   */
+/*  Maps the handful of FatFs calls used by save_state() and         */
+/*  load_state() onto stdio so states can be written on Linux.       */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef HOST_FF_H_INCLUDED
+#define HOST_FF_H_INCLUDED
+
+#include <stdio.h>
+#include <string.h>
+
+typedef unsigned int UINT;
+typedef unsigned char BYTE_FF;
+
+typedef enum
+{
+  FR_OK = 0,
+  FR_DISK_ERR,
+  FR_NO_FILE = 4,
+  FR_DENIED = 7,
+  FR_INVALID_OBJECT = 9
+} FRESULT;
+
+typedef struct
+{
+  int dummy;
+} FATFS;
+
+typedef struct
+{
+  FILE *fp;
+} FIL;
+
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_EXISTING 0x00
+#define FA_CREATE_NEW 0x04
+#define FA_CREATE_ALWAYS 0x08
+#define FA_OPEN_ALWAYS 0x10
+
+static inline FRESULT f_mount(FATFS *fs, const char *path, BYTE_FF opt)
+{
+  (void)fs;
+  (void)path;
+  (void)opt;
+  return FR_OK;
+}
+
+static inline FRESULT f_open(FIL *fp, const char *path, BYTE_FF mode)
+{
+  char name[256];
+  size_t i;
+
+  /* FatFs paths use '\' as separator */
+  for (i = 0; path[i] && i < sizeof(name) - 1; ++i)
+    name[i] = (path[i] == '\\') ? '/' : path[i];
+  name[i] = '\0';
+
+  fp->fp = fopen(name, (mode & FA_WRITE) ? "wb" : "rb");
+  if (!fp->fp)
+    return (mode & FA_WRITE) ? FR_DENIED : FR_NO_FILE;
+  return FR_OK;
+}
+
+static inline FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+  if (!fp->fp)
+  {
+    *br = 0;
+    return FR_INVALID_OBJECT;
+  }
+  *br = (UINT)fread(buff, 1, btr, fp->fp);
+  return FR_OK;
+}
+
+static inline FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+  if (!fp->fp)
+  {
+    *bw = 0;
+    return FR_INVALID_OBJECT;
+  }
+  *bw = (UINT)fwrite(buff, 1, btw, fp->fp);
+  return FR_OK;
+}
+
+static inline FRESULT f_close(FIL *fp)
+{
+  if (fp->fp)
+    fclose(fp->fp);
+  fp->fp = NULL;
+  return FR_OK;
+}
+
+#endif /* !HOST_FF_H_INCLUDED */
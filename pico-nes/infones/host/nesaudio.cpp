@@ -0,0 +1,228 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nesaudio.cpp : Audio ring / DMA drain simulator                  */
+/*                                                                   */
+/*  Usage: nesaudio <rom.nes> [options]                              */
+/*    -f <frames>   number of frames to run ( default 1800 )         */
+/*    -o <file>     write what the DAC played to a WAV file          */
+/*    -t <frames>   ring level to hold ( default 2 DMA blocks )      */
+/*    -d <ppm>      DAC clock error against APU_RATE                 */
+/*    -j <n>        every n-th frame runs half a frame late          */
+/*    -n            no rate control                                  */
+/*                                                                   */
+/*  The sound output of src/main.cpp is replayed on the host: every  */
+/*  InfoNES_SoundOutput() call is mixed to int16 stereo and pushed   */
+/*  through audio_ring_push_rate(), which resamples to APU_RATE with */
+/*  the ratio locked to AUDIO_REFRESH_MHZ, and a model of the DMA    */
+/*  IRQ pops one transfer at a time, one display frame of DAC time   */
+/*  per emulated frame. The tool reports the ring level, the rate    */
+/*  correction and the under / overrun counters.                     */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InfoNES_System_Host.h"
+#include "../InfoNES_pAPU.h"
+#include "audio_ring.h"
+
+/*-------------------------------------------------------------------*/
+/*  Ring and DMA model                                               */
+/*-------------------------------------------------------------------*/
+
+#define RING_FRAMES 4096
+#define DAC_RATE ((double)AUDIO_OUTPUT_RATE)
+#define REFRESH (AUDIO_REFRESH_MHZ / 1000.0)
+
+/* i2s_config.dma_trans_count in src/main.cpp */
+#define DMA_BLOCK (AUDIO_OUTPUT_RATE / 60)
+
+static audio_frame_t RingBuf[RING_FRAMES];
+static audio_ring_t Ring;
+static audio_rate_t Rate;
+
+static FILE *fpWav;
+static double dDacRate = DAC_RATE;
+static DWORD dwJitter;
+static bool bDraining;
+static double dOwed; /* DAC frames due since the last DMA block */
+static double dLate; /* frames the emulation currently lags behind */
+
+static unsigned long long qwPushed;
+static unsigned long long qwPlayed;
+static DWORD dwLevelMin = RING_FRAMES;
+static DWORD dwLevelMax;
+static double dLevelSum;
+static DWORD dwLevelCount;
+static int nPpmMin, nPpmMax;
+
+/* InfoNES_SoundOutput() of src/main.cpp */
+static void SoundHook(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3,
+                      const BYTE *wave4, const BYTE *wave5, const BYTE *wave6)
+{
+  /* InfoNES_SoundOpen() of src/main.cpp: the APU rate is known now */
+  static bool bLocked;
+  if (!bLocked)
+  {
+    audio_rate_set_ratio(&Rate, (uint64_t)ApuSamplesPerSync16 * (SCAN_VBLANK_END + 1), AUDIO_OUTPUT_RATE,
+                         AUDIO_REFRESH_MHZ);
+    bLocked = true;
+  }
+
+  audio_frame_t frames[64];
+  while (samples > 0)
+  {
+    const int n = samples < 64 ? samples : 64;
+    /* A frame is the left / right int16 pair in host ( little-endian ) order */
+    Host_Mix(n, wave1, wave2, wave3, wave4, wave5, wave6, (short *)frames);
+    wave1 += n;
+    wave2 += n;
+    wave3 += n;
+    wave4 += n;
+    wave5 += n;
+    if (wave6)
+      wave6 += n;
+    qwPushed += audio_ring_push_rate(&Ring, &Rate, frames, n);
+    samples -= n;
+  }
+
+  int nPpm = audio_rate_ppm(&Rate);
+  if (nPpm < nPpmMin)
+    nPpmMin = nPpm;
+  if (nPpm > nPpmMax)
+    nPpmMax = nPpm;
+}
+
+/* The DMA completion IRQ: one block per transfer */
+static void DmaDrain(double dFrames)
+{
+  dOwed += dFrames;
+  while (dOwed >= DMA_BLOCK)
+  {
+    audio_frame_t block[DMA_BLOCK];
+    audio_ring_pop(&Ring, block, DMA_BLOCK);
+    qwPlayed += DMA_BLOCK;
+    if (fpWav)
+      Host_WavWrite(fpWav, block, sizeof block);
+    dOwed -= DMA_BLOCK;
+  }
+}
+
+static int FrameHook(DWORD dwFrame)
+{
+  /* The DAC starts once the ring reaches the target */
+  if (!bDraining && audio_ring_above(&Ring, Rate.target ? Rate.target : DMA_BLOCK))
+    bDraining = true;
+  if (!bDraining)
+    return 0;
+
+  /* One display frame of DAC time passes; a late frame shifts it forward */
+  double dFrame = dDacRate / REFRESH;
+  if (dwJitter && dwFrame % dwJitter == 0)
+  {
+    DmaDrain(dFrame + dFrame / 2);
+    dLate = dFrame / 2;
+  }
+  else
+  {
+    DmaDrain(dFrame - dLate);
+    dLate = 0;
+  }
+
+  DWORD dwLevel = audio_ring_level(&Ring);
+  if (dwLevel < dwLevelMin)
+    dwLevelMin = dwLevel;
+  if (dwLevel > dwLevelMax)
+    dwLevelMax = dwLevel;
+  dLevelSum += dwLevel;
+  ++dwLevelCount;
+  return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/*  Main                                                             */
+/*-------------------------------------------------------------------*/
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s <rom.nes> [-f frames] [-o out.wav] [-t target] [-d ppm] [-j n] [-n]\n",
+          argv0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  DWORD dwFrames = 1800;
+  DWORD dwTarget = 2 * DMA_BLOCK;
+  const char *pszWav = NULL;
+  bool bRate = true;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+      dwFrames = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      pszWav = argv[++i];
+    else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+      dwTarget = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+      dDacRate = DAC_RATE * (1.0 + atof(argv[++i]) / 1e6);
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+      dwJitter = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-n") == 0)
+      bRate = false;
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (dwTarget >= RING_FRAMES)
+  {
+    fprintf(stderr, "target must be below %d frames\n", RING_FRAMES);
+    return 2;
+  }
+
+  audio_ring_init(&Ring, RingBuf, RING_FRAMES);
+  audio_rate_init(&Rate, dwTarget);
+  Rate.enabled = bRate;
+
+  if (pszWav && !(fpWav = Host_WavOpen(pszWav, (int)DAC_RATE, 2, 16)))
+  {
+    fprintf(stderr, "Cannot write %s\n", pszWav);
+    return 1;
+  }
+
+  Host_Quiet = 1;
+  Host_SoundHook = SoundHook;
+  Host_FrameHook = FrameHook;
+
+  int nResult = Host_Run(argv[1], dwFrames);
+  if (fpWav)
+    Host_WavClose(fpWav);
+  if (nResult < 0)
+    return 1;
+
+  const double count = dwLevelCount ? dwLevelCount : 1;
+  printf("rom            : %s (mapper %d)\n", argv[1], MapperNo);
+  printf("frames         : %lu\n", (unsigned long)Host_Frames);
+  printf("dac            : %.1f Hz, %d-frame DMA blocks\n", dDacRate, DMA_BLOCK);
+  printf("resampling     : %d Hz to %d Hz, locked to %.3f Hz\n", Host_SampleRate, AUDIO_OUTPUT_RATE,
+         REFRESH);
+  printf("target         : %lu frames (%.1f ms)%s\n", (unsigned long)dwTarget,
+         1000.0 * dwTarget / DAC_RATE, bRate ? "" : ", rate control off");
+  printf("ring level     : min %lu avg %.0f max %lu\n", (unsigned long)dwLevelMin,
+         dLevelSum / count, (unsigned long)dwLevelMax);
+  printf("rate           : %+d ppm now, %+d .. %+d ppm\n", audio_rate_ppm(&Rate), nPpmMin, nPpmMax);
+  printf("frames pushed  : %llu, played %llu\n", qwPushed, qwPlayed);
+  printf("underruns      : %lu\n", (unsigned long)Ring.underruns);
+  printf("overruns       : %lu frames\n", (unsigned long)Ring.overruns);
+
+  return Ring.underruns || Ring.overruns ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nesbench.cpp : Headless speed benchmark of the InfoNES core      */
+/*                                                                   */
+/*  Usage: nesbench <rom.nes> [frames] [options]                     */
+/*    -w <file>     capture the mixed sound ( 16-bit stereo WAV )    */
+/*    -c            also capture the five channels to <file>.1 .. 5  */
+/*    -r            raw PCM instead of WAV                           */
+/*                                                                   */
+/*  Runs the cassette as fast as possible with no display and no     */
+/*  sound device and reports emulated frames per second, nanoseconds */
+/*  per scanline, 6502 instructions per second, the share of clocks  */
+/*  skipped in idle loops and the audio samples produced per second  */
+/*  of wall time.                                                    */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InfoNES_System_Host.h"
+#include "../K6502.h"
+
+/* Scanlines per frame ( 0 .. SCAN_VBLANK_END ) */
+#define SCANLINES_PER_FRAME (SCAN_VBLANK_END + 1)
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "Usage: %s <rom.nes> [frames] [-w out.wav] [-c] [-r]\n", argv[0]);
+    return 2;
+  }
+
+  DWORD dwFrames = 3600;
+  const char *pszCapture = NULL;
+  int nCaptureFlags = 0;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+      pszCapture = argv[++i];
+    else if (strcmp(argv[i], "-c") == 0)
+      nCaptureFlags |= HOST_AUDIO_CHANNELS;
+    else if (strcmp(argv[i], "-r") == 0)
+      nCaptureFlags |= HOST_AUDIO_RAW;
+    else
+      dwFrames = strtoul(argv[i], NULL, 0);
+  }
+  if (dwFrames == 0)
+    dwFrames = 1;
+
+  Host_AudioCapture(pszCapture, nCaptureFlags);
+  Host_Quiet = 1;
+  g_dwInstructions = 0;
+  g_dwIdleClocks = 0;
+
+  unsigned long long start = Host_Nanoseconds();
+  if (Host_Run(argv[1], dwFrames) < 0)
+    return 1;
+  unsigned long long elapsed = Host_Nanoseconds() - start;
+
+  double sec = elapsed / 1e9;
+  double scanlines = (double)Host_Frames * SCANLINES_PER_FRAME;
+
+  printf("rom            : %s (mapper %d)\n", argv[1], MapperNo);
+  printf("frames         : %lu\n", (unsigned long)Host_Frames);
+  printf("elapsed        : %.3f s\n", sec);
+  printf("frames/sec     : %.1f (%.2fx realtime)\n", Host_Frames / sec, Host_Frames / sec / 60.0);
+  printf("ns/scanline    : %.1f\n", elapsed / scanlines);
+  printf("instructions   : %lu\n", (unsigned long)g_dwInstructions);
+  printf("instructions/s : %.0f\n", g_dwInstructions / sec);
+  printf("idle skipped   : %.1f%% of clocks\n",
+         100.0 * g_dwIdleClocks / (scanlines * STEP_PER_SCANLINE));
+  printf("samples        : %llu (%.0f/frame)\n", Host_Samples, (double)Host_Samples / Host_Frames);
+  printf("samples/sec    : %.0f (%.2fx realtime at %d Hz)\n", Host_Samples / sec,
+         Host_Samples / sec / Host_SampleRate, Host_SampleRate);
+
+  return 0;
+}
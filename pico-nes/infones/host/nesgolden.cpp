@@ -0,0 +1,289 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nesgolden.cpp : Golden-frame regression harness                  */
+/*                                                                   */
+/*  Usage: nesgolden <rom.nes> <golden.txt> [options]                */
+/*    -f <frames>   number of frames to run ( default 1800 when      */
+/*                  recording, the whole golden file when checking ) */
+/*    -i <script>   pad input script                                 */
+/*    -r            record the golden file instead of checking it    */
+/*    -p <prefix>   dump the first bad frame to <prefix><frame>.ppm  */
+/*                                                                   */
+/*  Every frame, SCREEN ( as filled through InfoNES_PreDrawLine /    */
+/*  InfoNES_PostDrawLine ) and the five wave buffers passed to       */
+/*  InfoNES_SoundOutput are hashed with FNV-1a. The golden file has  */
+/*  one line per frame:                                              */
+/*                                                                   */
+/*    <frame> <screen> <wave1> <wave2> <wave3> <wave4> <wave5>       */
+/*                                                                   */
+/*  and a <wave6> column, the expansion chip, when the cartridge has */
+/*  one.                                                             */
+/*                                                                   */
+/*  Input script: one "<frame> <pad1> [<pad2>]" entry per line, the  */
+/*  pad state holds until the next entry. A pad is a number ( 0x08 ) */
+/*  or button names joined with '+' ( A+B+START+SELECT+UP+DOWN+      */
+/*  LEFT+RIGHT ). '#' starts a comment.                              */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "InfoNES_System_Host.h"
+#include "nestool.h"
+
+/*-------------------------------------------------------------------*/
+/*  Hashes                                                           */
+/*-------------------------------------------------------------------*/
+
+struct FrameHash
+{
+  DWORD frame;
+  HASH screen;
+  HASH wave[6];
+};
+
+static HASH WaveHash[6];
+static bool bExtWave; /* The cartridge has an expansion chip */
+static std::vector<FrameHash> Frames;
+
+/*-------------------------------------------------------------------*/
+/*  Input script                                                     */
+/*-------------------------------------------------------------------*/
+
+static std::vector<PadEvent> Script;
+
+/*-------------------------------------------------------------------*/
+/*  PPM dump of SCREEN                                               */
+/*-------------------------------------------------------------------*/
+
+static const BYTE NesRGB[64][3] = {
+    {0x7c, 0x7c, 0x7c}, {0x00, 0x00, 0xfc}, {0x00, 0x00, 0xbc}, {0x44, 0x28, 0xbc},
+    {0x94, 0x00, 0x84}, {0xa8, 0x00, 0x20}, {0xa8, 0x10, 0x00}, {0x88, 0x14, 0x00},
+    {0x50, 0x30, 0x00}, {0x00, 0x78, 0x00}, {0x00, 0x68, 0x00}, {0x00, 0x58, 0x00},
+    {0x00, 0x40, 0x58}, {0x00, 0x00, 0x00}, {0x00, 0x00, 0x00}, {0x00, 0x00, 0x00},
+    {0xbc, 0xbc, 0xbc}, {0x00, 0x78, 0xf8}, {0x00, 0x58, 0xf8}, {0x68, 0x44, 0xfc},
+    {0xd8, 0x00, 0xcc}, {0xe4, 0x00, 0x58}, {0xf8, 0x38, 0x00}, {0xe4, 0x5c, 0x10},
+    {0xac, 0x7c, 0x00}, {0x00, 0xb8, 0x00}, {0x00, 0xa8, 0x00}, {0x00, 0xa8, 0x44},
+    {0x00, 0x88, 0x88}, {0x00, 0x00, 0x00}, {0x00, 0x00, 0x00}, {0x00, 0x00, 0x00},
+    {0xf8, 0xf8, 0xf8}, {0x3c, 0xbc, 0xfc}, {0x68, 0x88, 0xfc}, {0x98, 0x78, 0xf8},
+    {0xf8, 0x78, 0xf8}, {0xf8, 0x58, 0x98}, {0xf8, 0x78, 0x58}, {0xfc, 0xa0, 0x44},
+    {0xf8, 0xb8, 0x00}, {0xb8, 0xf8, 0x18}, {0x58, 0xd8, 0x54}, {0x58, 0xf8, 0x98},
+    {0x00, 0xe8, 0xd8}, {0x78, 0x78, 0x78}, {0x00, 0x00, 0x00}, {0x00, 0x00, 0x00},
+    {0xfc, 0xfc, 0xfc}, {0xa4, 0xe4, 0xfc}, {0xb8, 0xb8, 0xf8}, {0xd8, 0xb8, 0xf8},
+    {0xf8, 0xb8, 0xf8}, {0xf8, 0xa4, 0xc0}, {0xf0, 0xd0, 0xb0}, {0xfc, 0xe0, 0xa8},
+    {0xf8, 0xd8, 0x78}, {0xd8, 0xf8, 0x78}, {0xb8, 0xf8, 0xb8}, {0xb8, 0xf8, 0xd8},
+    {0x00, 0xfc, 0xfc}, {0xf8, 0xd8, 0xf8}, {0x00, 0x00, 0x00}, {0x00, 0x00, 0x00}};
+
+static const char *PpmPrefix;
+
+static void writePpm(DWORD frame)
+{
+  char path[512];
+  snprintf(path, sizeof path, "%s%lu.ppm", PpmPrefix, (unsigned long)frame);
+  FILE *fp = fopen(path, "wb");
+  if (!fp)
+    return;
+  fprintf(fp, "P6\n%d %d\n255\n", NES_DISP_WIDTH, NES_DISP_HEIGHT);
+  for (int y = 0; y < NES_DISP_HEIGHT; ++y)
+    for (int x = 0; x < NES_DISP_WIDTH; ++x)
+      fwrite(NesRGB[SCREEN[y][x] & 0x3f], 3, 1, fp);
+  fclose(fp);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Hooks                                                            */
+/*-------------------------------------------------------------------*/
+
+static int FrameHook(DWORD dwFrame)
+{
+  FrameHash fh;
+  fh.frame = dwFrame;
+  fh.screen = fnv1a(FNV_OFFSET, &SCREEN[0][0], sizeof SCREEN);
+  for (int i = 0; i < 6; ++i)
+  {
+    fh.wave[i] = WaveHash[i];
+    WaveHash[i] = FNV_OFFSET;
+  }
+  Frames.push_back(fh);
+  return 0;
+}
+
+static void PadHook(DWORD dwFrame, DWORD *pdwPad1, DWORD *pdwPad2, DWORD *pdwSystem)
+{
+  scriptPads(Script, dwFrame, pdwPad1, pdwPad2);
+}
+
+static void SoundHook(int samples, const BYTE *wave1, const BYTE *wave2,
+                      const BYTE *wave3, const BYTE *wave4, const BYTE *wave5,
+                      const BYTE *wave6)
+{
+  const BYTE *waves[5] = {wave1, wave2, wave3, wave4, wave5};
+  for (int i = 0; i < 5; ++i)
+    WaveHash[i] = fnv1a(WaveHash[i], waves[i], samples);
+  if (wave6)
+  {
+    WaveHash[5] = fnv1a(WaveHash[5], wave6, samples);
+    bExtWave = true;
+  }
+}
+
+/*-------------------------------------------------------------------*/
+/*  Main                                                             */
+/*-------------------------------------------------------------------*/
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s <rom.nes> <golden.txt> [-f frames] [-i script] [-r] [-p ppm-prefix]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  const char *romPath = argv[1];
+  const char *goldenPath = argv[2];
+  DWORD dwFrames = 1800;
+  bool framesGiven = false;
+  bool record = false;
+
+  for (int i = 3; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+    {
+      dwFrames = strtoul(argv[++i], NULL, 0);
+      framesGiven = true;
+    }
+    else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+    {
+      if (loadScript(argv[++i], Script) < 0)
+        return 2;
+    }
+    else if (strcmp(argv[i], "-r") == 0)
+      record = true;
+    else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+      PpmPrefix = argv[++i];
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  /* Load the golden file before running so a typo fails fast */
+  std::vector<FrameHash> golden;
+  if (!record)
+  {
+    FILE *fp = fopen(goldenPath, "r");
+    if (!fp)
+    {
+      fprintf(stderr, "cannot open golden file %s ( use -r to record it )\n", goldenPath);
+      return 2;
+    }
+    FrameHash fh;
+    unsigned long frame;
+    char line[256];
+    while (fgets(line, sizeof line, fp))
+    {
+      int n = sscanf(line, "%lu %llx %llx %llx %llx %llx %llx %llx", &frame, &fh.screen,
+                     &fh.wave[0], &fh.wave[1], &fh.wave[2], &fh.wave[3], &fh.wave[4], &fh.wave[5]);
+      if (n < 7)
+        break;
+      if (n == 7)
+        fh.wave[5] = FNV_OFFSET; /* No expansion chip: nothing hashed */
+      fh.frame = frame;
+      golden.push_back(fh);
+    }
+    fclose(fp);
+    if (golden.empty())
+    {
+      fprintf(stderr, "golden file %s has no frames\n", goldenPath);
+      return 2;
+    }
+    if (!framesGiven || dwFrames == 0 || golden.size() < dwFrames)
+      dwFrames = golden.size();
+  }
+
+  for (int i = 0; i < 6; ++i)
+    WaveHash[i] = FNV_OFFSET;
+
+  Host_Quiet = 1;
+  Host_FrameHook = FrameHook;
+  Host_PadHook = PadHook;
+  Host_SoundHook = SoundHook;
+
+  if (Host_Run(romPath, dwFrames) < 0)
+    return 1;
+
+  if (record)
+  {
+    FILE *fp = fopen(goldenPath, "w");
+    if (!fp)
+    {
+      fprintf(stderr, "cannot write golden file %s\n", goldenPath);
+      return 2;
+    }
+    for (const FrameHash &fh : Frames)
+    {
+      fprintf(fp, "%lu %016llx %016llx %016llx %016llx %016llx %016llx", (unsigned long)fh.frame,
+              fh.screen, fh.wave[0], fh.wave[1], fh.wave[2], fh.wave[3], fh.wave[4]);
+      if (bExtWave)
+        fprintf(fp, " %016llx", fh.wave[5]);
+      fprintf(fp, "\n");
+    }
+    fclose(fp);
+    printf("recorded %zu frames to %s\n", Frames.size(), goldenPath);
+    return 0;
+  }
+
+  size_t videoBad = 0, audioBad = 0;
+  long firstVideo = -1, firstAudio = -1;
+  for (size_t i = 0; i < Frames.size() && i < golden.size(); ++i)
+  {
+    if (Frames[i].screen != golden[i].screen)
+    {
+      if (firstVideo < 0)
+        firstVideo = Frames[i].frame;
+      ++videoBad;
+    }
+    for (int c = 0; c < 6; ++c)
+    {
+      if (Frames[i].wave[c] != golden[i].wave[c])
+      {
+        if (firstAudio < 0)
+        {
+          firstAudio = Frames[i].frame;
+          printf("audio: first mismatch at frame %lu, wave%d\n", (unsigned long)Frames[i].frame, c + 1);
+        }
+        ++audioBad;
+        break;
+      }
+    }
+  }
+
+  if (Frames.size() != golden.size())
+  {
+    printf("ran %zu of %zu golden frames\n", Frames.size(), golden.size());
+    return 1;
+  }
+
+  printf("frames %zu, video mismatches %zu (first %ld), audio mismatches %zu (first %ld)\n",
+         golden.size(), videoBad, firstVideo, audioBad, firstAudio);
+
+  if (firstVideo >= 0 && PpmPrefix)
+  {
+    /* Re-run up to the first bad frame to dump it */
+    Host_FrameHook = NULL;
+    Host_Run(romPath, firstVideo);
+    writePpm(firstVideo);
+    printf("video: wrote %s%ld.ppm\n", PpmPrefix, firstVideo);
+  }
+
+  return (videoBad || audioBad) ? 1 : 0;
+}
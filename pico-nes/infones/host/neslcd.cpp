@@ -0,0 +1,200 @@
+/*===================================================================*/
+/*                                                                   */
+/*  neslcd.cpp : ST7789 command-stream simulator                     */
+/*                                                                   */
+/*  Usage: neslcd <rom.nes> [options]                                */
+/*    -f <frames>   number of frames to run ( default 1800 )         */
+/*    -g <lines>    clean lines merged into a dirty run              */
+/*                  ( default ST7789_MERGE_GAP )                     */
+/*                                                                   */
+/*  Every frame is pushed to a model of the panel the way            */
+/*  refresh_lcd_lines() in drivers/st7789 does it: line hashes, the  */
+/*  same run planner, one CASET / RASET / RAMWR per run and two      */
+/*  bytes per pixel. The tool counts the bytes on the bus against a  */
+/*  full refresh_lcd() and checks the panel contents against SCREEN  */
+/*  after each frame.                                                */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InfoNES_System_Host.h"
+#include "st7789_dirty.h"
+
+/*-------------------------------------------------------------------*/
+/*  Panel model                                                      */
+/*-------------------------------------------------------------------*/
+
+#define LCD_WIDTH 320
+#define LCD_HEIGHT 240
+
+/* Where src/main.cpp puts the NES picture ( graphics_set_offset ) */
+#define LCD_OFFSET_X 32
+#define LCD_OFFSET_Y 0
+
+struct LcdSim
+{
+  BYTE byPanel[LCD_HEIGHT][LCD_WIDTH]; /* NES color index per panel pixel */
+  int nX0, nX1, nY0, nY1;              /* CASET / RASET window */
+  int nX, nY;                          /* RAMWR write position */
+  unsigned long long qwCmdBytes;
+  unsigned long long qwPixelBytes;
+  unsigned long long qwCommands;
+};
+
+static LcdSim Lcd;
+
+static void LcdCommand(const BYTE *pbyCmd, int nCount)
+{
+  Lcd.qwCommands++;
+  Lcd.qwCmdBytes += nCount;
+
+  switch (pbyCmd[0])
+  {
+  case 0x2a: /* CASET */
+    Lcd.nX0 = (pbyCmd[1] << 8) | pbyCmd[2];
+    Lcd.nX1 = (pbyCmd[3] << 8) | pbyCmd[4];
+    break;
+  case 0x2b: /* RASET */
+    Lcd.nY0 = (pbyCmd[1] << 8) | pbyCmd[2];
+    Lcd.nY1 = (pbyCmd[3] << 8) | pbyCmd[4];
+    break;
+  case 0x2c: /* RAMWR */
+    Lcd.nX = Lcd.nX0;
+    Lcd.nY = Lcd.nY0;
+    break;
+  }
+}
+
+static void LcdPixel(BYTE byColor)
+{
+  Lcd.qwPixelBytes += 2;
+  if (Lcd.nY <= Lcd.nY1 && Lcd.nY < LCD_HEIGHT && Lcd.nX < LCD_WIDTH)
+    Lcd.byPanel[Lcd.nY][Lcd.nX] = byColor;
+  if (++Lcd.nX > Lcd.nX1)
+  {
+    Lcd.nX = Lcd.nX0;
+    ++Lcd.nY;
+  }
+}
+
+/* lcd_set_window() + start_pixels() */
+static void LcdWindow(int nX, int nY, int nWidth, int nHeight)
+{
+  const int nRight = nX + nWidth - 1;
+  const int nBottom = nY + nHeight - 1;
+  const BYTE caset[] = {0x2a, (BYTE)(nX >> 8), (BYTE)nX, (BYTE)(nRight >> 8), (BYTE)nRight};
+  const BYTE raset[] = {0x2b, (BYTE)(nY >> 8), (BYTE)nY, (BYTE)(nBottom >> 8), (BYTE)nBottom};
+  const BYTE ramwr[] = {0x2c};
+  LcdCommand(caset, sizeof caset);
+  LcdCommand(raset, sizeof raset);
+  LcdCommand(ramwr, sizeof ramwr);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Frame hook                                                       */
+/*-------------------------------------------------------------------*/
+
+static DWORD dwMergeGap = ST7789_MERGE_GAP;
+static uint32_t GlassHash[NES_DISP_HEIGHT];
+static bool bGlassValid = false;
+static unsigned long long qwRuns;
+static unsigned long long qwLinesSent;
+static DWORD dwBadFrames;
+static long nFirstBad = -1;
+
+static int FrameHook(DWORD dwFrame)
+{
+  uint32_t LineHash[NES_DISP_HEIGHT];
+  for (int y = 0; y < NES_DISP_HEIGHT; ++y)
+    LineHash[y] = st7789_line_hash(SCREEN[y], NES_DISP_WIDTH);
+
+  if (!bGlassValid)
+  {
+    for (int y = 0; y < NES_DISP_HEIGHT; ++y)
+      GlassHash[y] = ~LineHash[y];
+    bGlassValid = true;
+  }
+
+  unsigned y = 0;
+  unsigned height;
+  while ((height = st7789_next_dirty_run(LineHash, GlassHash, NES_DISP_HEIGHT, &y, dwMergeGap)))
+  {
+    LcdWindow(LCD_OFFSET_X, LCD_OFFSET_Y + y, NES_DISP_WIDTH, height);
+    for (unsigned i = 0; i < height; ++i)
+      for (int x = 0; x < NES_DISP_WIDTH; ++x)
+        LcdPixel(SCREEN[y + i][x]);
+    ++qwRuns;
+    qwLinesSent += height;
+    y += height;
+  }
+
+  /* The panel must now show exactly this frame */
+  for (int y = 0; y < NES_DISP_HEIGHT; ++y)
+  {
+    if (memcmp(&Lcd.byPanel[LCD_OFFSET_Y + y][LCD_OFFSET_X], SCREEN[y], NES_DISP_WIDTH))
+    {
+      if (nFirstBad < 0)
+        nFirstBad = dwFrame;
+      ++dwBadFrames;
+      break;
+    }
+  }
+  return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/*  Main                                                             */
+/*-------------------------------------------------------------------*/
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s <rom.nes> [-f frames] [-g merge-gap]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  DWORD dwFrames = 1800;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+      dwFrames = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+      dwMergeGap = strtoul(argv[++i], NULL, 0);
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  Host_Quiet = 1;
+  Host_FrameHook = FrameHook;
+
+  if (Host_Run(argv[1], dwFrames) < 0)
+    return 1;
+
+  /* refresh_lcd(): one window and width * height - 1 pixels per frame */
+  const double fullBytes = 11.0 + 2.0 * (NES_DISP_WIDTH * NES_DISP_HEIGHT - 1);
+  const double frames = Host_Frames ? Host_Frames : 1;
+  const double bytes = Lcd.qwCmdBytes + Lcd.qwPixelBytes;
+
+  printf("rom            : %s (mapper %d)\n", argv[1], MapperNo);
+  printf("frames         : %lu\n", (unsigned long)Host_Frames);
+  printf("merge gap      : %lu lines\n", (unsigned long)dwMergeGap);
+  printf("commands       : %llu (%.1f/frame)\n", Lcd.qwCommands, Lcd.qwCommands / frames);
+  printf("runs           : %.2f/frame, %.1f lines/frame\n", qwRuns / frames, qwLinesSent / frames);
+  printf("bytes/frame    : %.0f (full refresh %.0f, %.1f%%)\n", bytes / frames, fullBytes,
+         100.0 * bytes / frames / fullBytes);
+  printf("panel mismatch : %lu frames (first %ld)\n", (unsigned long)dwBadFrames, nFirstBad);
+
+  return dwBadFrames ? 1 : 0;
+}
@@ -0,0 +1,175 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nesmix.cpp : Mixer path check                                    */
+/*                                                                   */
+/*  Usage: nesmix [-n <blocks>]                                      */
+/*    -n <blocks>   random blocks per setting ( default 200 )        */
+/*                                                                   */
+/*  drivers/audio/audio_mix.c has three paths: SSE2 on the host,     */
+/*  SMUAD / QADD16 on the Cortex-M33 and plain C. Runs all three on  */
+/*  the same waves, full scale and silence first, then random waves  */
+/*  in each channel's range, over a set of gains, pans and master    */
+/*  volumes, with and without an expansion wave. Any sample that     */
+/*  differs between the paths fails the check.                       */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_mix.h"
+
+/*-------------------------------------------------------------------*/
+/*  The paths                                                        */
+/*-------------------------------------------------------------------*/
+
+/* audio_mix_scalar_host.c / audio_mix_dsp_host.c */
+extern "C"
+{
+  void audio_mix_init_scalar(audio_mix_t *mix);
+  void audio_mix_run_scalar(const audio_mix_t *mix, int samples, const uint8_t *wave1, const uint8_t *wave2,
+                            const uint8_t *wave3, const uint8_t *wave4, const uint8_t *wave5,
+                            const uint8_t *wave6, int16_t *out);
+  void audio_mix_init_dsp(audio_mix_t *mix);
+  void audio_mix_run_dsp(const audio_mix_t *mix, int samples, const uint8_t *wave1, const uint8_t *wave2,
+                         const uint8_t *wave3, const uint8_t *wave4, const uint8_t *wave5,
+                         const uint8_t *wave6, int16_t *out);
+}
+
+/* Not a multiple of 8, so the SSE2 loop hands a tail to the C one */
+#define SAMPLES 1003
+
+/* Largest value of each wave: pulse, pulse, triangle, noise, DPCM, expansion */
+static const int WaveMax[AUDIO_MIX_CHANNELS] = {255, 255, 255, 15, 63, 255};
+
+static uint8_t Wave[AUDIO_MIX_CHANNELS][SAMPLES];
+
+/*-------------------------------------------------------------------*/
+/*  Settings                                                         */
+/*-------------------------------------------------------------------*/
+
+struct MixSetting
+{
+  const char *name;
+  int gain; /* Every channel */
+  int pan;  /* Pulse 1, the others mirror it */
+};
+
+static const MixSetting Settings[] = {
+    {"default", -1, 0},
+    {"centre", AUDIO_MIX_UNITY, 0},
+    {"hard left", AUDIO_MIX_UNITY, -256},
+    {"hard right", AUDIO_MIX_UNITY, 256},
+    {"half", AUDIO_MIX_UNITY / 2, 64},
+    {"quiet", 1, -32},
+};
+
+/* The same gains and volume in all three mixers ( their tables are built the same ) */
+static void setupMix(audio_mix_t *mix, const MixSetting &setting, int volume)
+{
+  if (setting.gain >= 0)
+  {
+    for (int ch = 0; ch < AUDIO_MIX_CHANNELS; ++ch)
+      audio_mix_set_channel(mix, ch, setting.gain, (ch & 1) ? -setting.pan : setting.pan);
+  }
+  mix->volume = volume;
+}
+
+/*-------------------------------------------------------------------*/
+/*  Check                                                            */
+/*-------------------------------------------------------------------*/
+
+static int checkBlock(const audio_mix_t *mix, const audio_mix_t *scalar, const audio_mix_t *dsp,
+                      bool ext, const char *what)
+{
+  static int16_t outSse[2 * SAMPLES], outScalar[2 * SAMPLES], outDsp[2 * SAMPLES];
+  const uint8_t *wave6 = ext ? Wave[AUDIO_MIX_EXT] : NULL;
+
+  audio_mix_run(mix, SAMPLES, Wave[0], Wave[1], Wave[2], Wave[3], Wave[4], wave6, outSse);
+  audio_mix_run_scalar(scalar, SAMPLES, Wave[0], Wave[1], Wave[2], Wave[3], Wave[4], wave6, outScalar);
+  audio_mix_run_dsp(dsp, SAMPLES, Wave[0], Wave[1], Wave[2], Wave[3], Wave[4], wave6, outDsp);
+
+  for (int i = 0; i < 2 * SAMPLES; ++i)
+  {
+    if (outSse[i] != outScalar[i] || outDsp[i] != outScalar[i])
+    {
+      const int s = i / 2;
+      printf("FAIL: %s, %s sample %d: C %d, SSE2 %d, DSP %d ( waves %d %d %d %d %d",
+             what, (i & 1) ? "right" : "left", s, outScalar[i], outSse[i], outDsp[i],
+             Wave[0][s], Wave[1][s], Wave[2][s], Wave[3][s], Wave[4][s]);
+      if (ext)
+        printf(" %d", Wave[AUDIO_MIX_EXT][s]);
+      printf(", volume %d )\n", mix->volume);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void fillWaves(int mode)
+{
+  for (int ch = 0; ch < AUDIO_MIX_CHANNELS; ++ch)
+  {
+    for (int i = 0; i < SAMPLES; ++i)
+    {
+      if (mode == 0)
+        Wave[ch][i] = WaveMax[ch];
+      else if (mode == 1)
+        Wave[ch][i] = 0;
+      else
+        Wave[ch][i] = rand() % (WaveMax[ch] + 1);
+    }
+  }
+}
+
+/*-------------------------------------------------------------------*/
+/*  Main                                                             */
+/*-------------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+  int nBlocks = 200;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      nBlocks = atoi(argv[++i]);
+    else
+    {
+      fprintf(stderr, "Usage: %s [-n blocks]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  static audio_mix_t Mix, Scalar, Dsp;
+  unsigned long nChecked = 0;
+  srand(1);
+
+  for (const MixSetting &setting : Settings)
+  {
+    for (int volume = 0; volume <= 2 * AUDIO_MIX_VOLUME_UNITY; ++volume)
+    {
+      audio_mix_init(&Mix);
+      audio_mix_init_scalar(&Scalar);
+      audio_mix_init_dsp(&Dsp);
+      setupMix(&Mix, setting, volume);
+      setupMix(&Scalar, setting, volume);
+      setupMix(&Dsp, setting, volume);
+
+      for (int block = 0; block < 2 + nBlocks; ++block)
+      {
+        fillWaves(block < 2 ? block : 2);
+        for (int ext = 0; ext < 2; ++ext)
+        {
+          if (checkBlock(&Mix, &Scalar, &Dsp, ext, setting.name) < 0)
+            return 1;
+          nChecked += 2 * SAMPLES;
+        }
+      }
+    }
+  }
+
+  printf("OK: %lu samples the same from the C, SSE2 and DSP paths\n", nChecked);
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nespack.cpp : ROM pack checker                                   */
+/*                                                                   */
+/*  Usage: nespack <roms.pack> [options]                             */
+/*    -e <entry>    run this entry of the pack                       */
+/*    -f <frames>   number of frames to run it ( default 600 )       */
+/*                                                                   */
+/*  Opens the pack written by tools/convert_roms.py through the      */
+/*  reader the firmware uses ( src/rom_pack.cpp ), lists the index   */
+/*  with each game's ROM database record and what the emulator       */
+/*  supports of its mapper, and checks the CRC-32 of every image.    */
+/*  With -e the entry is loaded from the pack and run headless,      */
+/*  like the ROM selector does on the device. LZ4 packed entries     */
+/*  ( convert_roms.py --lz4 ) run through the bank cache in a        */
+/*  -DROM_LZ4=ON build, which also reports how many banks it had to  */
+/*  decode.                                                          */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InfoNES_System_Host.h"
+#include "../../src/rom_pack.h"
+#include "../InfoNES_Mapper.h"
+#include "../InfoNES_RomCache.h"
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s <roms.pack> [-e entry] [-f frames]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  int nEntry = -1;
+  DWORD dwFrames = 600;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+      nEntry = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+      dwFrames = strtoul(argv[++i], NULL, 0);
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  FILE *fp = fopen(argv[1], "rb");
+  if (fp == NULL)
+  {
+    fprintf(stderr, "Cannot read %s\n", argv[1]);
+    return 1;
+  }
+  fseek(fp, 0, SEEK_END);
+  long lSize = ftell(fp);
+  rewind(fp);
+  BYTE *pPack = (BYTE *)malloc(lSize);
+  if (fread(pPack, lSize, 1, fp) != 1)
+    lSize = 0;
+  fclose(fp);
+
+  const rom_pack_header_t *pack = rom_pack_open(pPack, lSize);
+  if (pack == NULL)
+  {
+    fprintf(stderr, "%s: not a ROM pack, or its index is corrupt\n", argv[1]);
+    free(pPack);
+    return 1;
+  }
+
+  int nBad = 0;
+  printf("pack           : %s, %d ROMs, %d database records, %lu bytes\n", argv[1], pack->count, pack->db_count,
+         (unsigned long)pack->size);
+  for (int i = 0; i < pack->count; ++i)
+  {
+    const rom_pack_entry_t &entry = rom_pack_index(pack)[i];
+    const bool bGood = rom_pack_verify(pack, entry);
+    nBad += !bGood;
+    const unsigned long ulRaw = 16 + entry.prg_banks * 0x4000 + entry.chr_banks * 0x2000;
+    printf("%3d %-32s mapper %3d  PRG %4d KB  CHR %3d KB  at 0x%06lx  %3lu%%%s  CRC %08lX %s\n", i, entry.name,
+           entry.mapper, entry.prg_banks * 16, entry.chr_banks * 8, (unsigned long)entry.offset,
+           (unsigned long)entry.size * 100 / ulRaw, (entry.flags & ROM_PACK_LZ4) ? " lz4" : "    ",
+           (unsigned long)entry.crc32, bGood ? "ok" : "BAD");
+    const rom_db_record_t *pRecord = rom_pack_db_find(pack, entry.crc32);
+    if (pRecord != NULL)
+      printf("    database: mapper %d, %s mirroring, %d KB PRG RAM%s, quirks 0x%lx\n", pRecord->mapper,
+             pRecord->mirroring == ROM_DB_FOUR_SCREEN ? "four screen"
+             : pRecord->mirroring == ROM_DB_VERTICAL  ? "vertical"
+                                                      : "horizontal",
+             pRecord->prg_ram, (pRecord->flags & ROM_DB_BATTERY) ? ", battery" : "",
+             (unsigned long)(pRecord->flags >> ROM_DB_QUIRKS_SHIFT));
+    else
+      printf("    database: no record\n");
+    const MapperDesc_tag *pMapper = entry.mapper <= 0xff ? InfoNES_GetMapper(entry.mapper) : NULL;
+    if (pMapper != NULL && pMapper->pMapperInit != NULL)
+    {
+      // A serializer without a buffer only counts the bytes
+      struct InfoNES_State_tag State = {};
+      if (pMapper->pMapperState != NULL)
+        pMapper->pMapperState(&State);
+      printf("    mapper  : %s%s%s%s, %lu bytes in states\n", *pMapper->pszName ? pMapper->pszName : "no name",
+             (pMapper->byFlags & MAPPER_IRQ_MASK) == MAPPER_IRQ_SCANLINE ? ", scanline IRQ"
+             : (pMapper->byFlags & MAPPER_IRQ_MASK) == MAPPER_IRQ_CYCLE  ? ", CPU clock IRQ"
+                                                                         : "",
+             (pMapper->byFlags & MAPPER_PPU) ? ", watches the PPU" : "",
+             (pMapper->byFlags & MAPPER_EXT_AUDIO) ? ", sound chip" : "",
+             (unsigned long)State.dwSize);
+    }
+    else
+      printf("    mapper  : not supported\n");
+  }
+  free(pPack);
+
+  if (nEntry >= 0)
+  {
+    Host_PackEntry = nEntry;
+    Host_Quiet = 1;
+    if (Host_Run(argv[1], dwFrames) < 0)
+    {
+      fprintf(stderr, "Cannot start entry %d\n", nEntry);
+      return 1;
+    }
+    printf("entry %d        : %lu frames, mapper %d\n", nEntry, (unsigned long)Host_Frames, MapperNo);
+#ifdef ROM_LZ4
+    printf("bank cache     : %lu PRG, %lu CHR banks decoded ( %d / %d slots )\n",
+           (unsigned long)g_dwRomCacheFills[0], (unsigned long)g_dwRomCacheFills[1], ROM_CACHE_PRG, ROM_CACHE_CHR);
+#endif
+  }
+
+  return nBad ? 1 : 0;
+}
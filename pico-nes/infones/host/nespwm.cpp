@@ -0,0 +1,214 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nespwm.cpp : PWM audio backend simulator                         */
+/*                                                                   */
+/*  Usage: nespwm <rom.nes> [options]                                */
+/*    -f <frames>   number of frames to run ( default 1800 )         */
+/*    -o <file>     record the CC duty words ( 32-bit LE, one per    */
+/*                  sample )                                         */
+/*    -b <bits>     duty resolution ( default PWM_AUDIO_BITS )       */
+/*    -s            stereo on both channels of the slice             */
+/*    -v <shift>    volume shift ( default 0 )                       */
+/*    -c <MHz>      clk_sys for the carrier and the DMA timer        */
+/*                  ( default 150 )                                  */
+/*                                                                   */
+/*  The sound path of src/main.cpp with PWM_AUDIO_PIN set is         */
+/*  replayed: mixed frames go through the audio ring and the host    */
+/*  stub of drivers/audio/audio_pwm.c drains it at the DMA timer     */
+/*  rate. Every duty word is decoded back and checked against the    */
+/*  frame it came from; the tool reports the carrier, the paced      */
+/*  sample rate, the duty range and the encoding errors.             */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "InfoNES_System_Host.h"
+#include "../InfoNES_pAPU.h"
+#include "audio_pwm_host.h"
+
+/*-------------------------------------------------------------------*/
+/*  Ring and PWM model                                               */
+/*-------------------------------------------------------------------*/
+
+#define RING_FRAMES 4096
+#define REFRESH (AUDIO_REFRESH_MHZ / 1000.0)
+
+static audio_frame_t RingBuf[RING_FRAMES];
+static audio_ring_t Ring;
+static audio_rate_t Rate;
+static pwm_audio_config_t Pwm;
+static bool bStarted;
+static double dOwed; /* samples due since the last DMA block */
+
+static FILE *fpDuty;
+static unsigned long long qwSamples;
+static unsigned long long qwBadDuty;
+static unsigned long long qwClipped;
+static DWORD dwDutyMin = 0xffff;
+static DWORD dwDutyMax;
+
+static void SoundHook(int samples, const BYTE *wave1, const BYTE *wave2, const BYTE *wave3,
+                      const BYTE *wave4, const BYTE *wave5, const BYTE *wave6)
+{
+  audio_frame_t frames[64];
+  while (samples > 0)
+  {
+    const int n = samples < 64 ? samples : 64;
+    Host_Mix(n, wave1, wave2, wave3, wave4, wave5, wave6, (short *)frames);
+    wave1 += n;
+    wave2 += n;
+    wave3 += n;
+    wave4 += n;
+    wave5 += n;
+    if (wave6)
+      wave6 += n;
+    audio_ring_push_rate(&Ring, &Rate, frames, n);
+    samples -= n;
+  }
+}
+
+/* Check one duty half against the level it encodes */
+static void CheckDuty(DWORD dwDuty, int nLevel)
+{
+  const int nStep = 1 << (16 - Pwm.bits);
+  const int nDecoded = pwm_audio_level(dwDuty, Pwm.bits);
+
+  if (nDecoded > nLevel || nLevel - nDecoded >= nStep)
+    ++qwBadDuty;
+  if (dwDuty == 0 || dwDuty == (1u << Pwm.bits) - 1)
+    ++qwClipped;
+  if (dwDuty < dwDutyMin)
+    dwDutyMin = dwDuty;
+  if (dwDuty > dwDutyMax)
+    dwDutyMax = dwDuty;
+}
+
+static void PwmHook(const audio_frame_t *frames, const uint32_t *duty, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    int nLeft = audio_frame_left(frames[i]) >> Pwm.volume;
+    int nRight = audio_frame_right(frames[i]) >> Pwm.volume;
+    if (!Pwm.stereo)
+      nLeft = nRight = (nLeft + nRight) >> 1;
+    CheckDuty(duty[i] & 0xffff, nLeft);
+    CheckDuty(duty[i] >> 16, nRight);
+  }
+  if (fpDuty)
+    fwrite(duty, sizeof duty[0], count, fpDuty);
+  qwSamples += count;
+}
+
+static int FrameHook(DWORD dwFrame)
+{
+  /* InfoNES_SoundOpen() has run: start the backend at the output rate */
+  if (!Pwm.sample_freq)
+  {
+    Pwm.sample_freq = AUDIO_OUTPUT_RATE;
+    Pwm.dma_trans_count = AUDIO_OUTPUT_RATE / 60;
+    pwm_audio_init(&Pwm);
+    audio_rate_init(&Rate, 2 * Pwm.dma_trans_count);
+    audio_rate_set_ratio(&Rate, (uint64_t)ApuSamplesPerSync16 * (SCAN_VBLANK_END + 1), AUDIO_OUTPUT_RATE,
+                         AUDIO_REFRESH_MHZ);
+  }
+  if (!bStarted && audio_ring_above(&Ring, Rate.target))
+  {
+    pwm_audio_start(&Pwm, &Ring);
+    bStarted = true;
+  }
+  if (!bStarted)
+    return 0;
+
+  dOwed += pwm_audio_host_rate_mhz / 1000.0 / REFRESH;
+  DWORD dwBlocks = (DWORD)(dOwed / Pwm.dma_trans_count);
+  dOwed -= (double)dwBlocks * Pwm.dma_trans_count;
+  pwm_audio_host_dma(dwBlocks);
+  return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/*  Main                                                             */
+/*-------------------------------------------------------------------*/
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s <rom.nes> [-f frames] [-o duty.raw] [-b bits] [-s] [-v shift] [-c MHz]\n",
+          argv0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  DWORD dwFrames = 1800;
+  const char *pszDuty = NULL;
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+      dwFrames = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      pszDuty = argv[++i];
+    else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+      Pwm.bits = (uint8_t)strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-s") == 0)
+      Pwm.stereo = 1;
+    else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc)
+      Pwm.volume = (uint8_t)strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+      pwm_audio_host_clk_sys = (uint32_t)(atof(argv[++i]) * 1e6);
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (Pwm.bits > 16 || Pwm.volume > 16)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  if (pszDuty && !(fpDuty = fopen(pszDuty, "wb")))
+  {
+    fprintf(stderr, "Cannot write %s\n", pszDuty);
+    return 1;
+  }
+
+  audio_ring_init(&Ring, RingBuf, RING_FRAMES);
+  audio_rate_init(&Rate, 2 * (AUDIO_OUTPUT_RATE / 60));
+
+  Host_Quiet = 1;
+  Host_SoundHook = SoundHook;
+  Host_FrameHook = FrameHook;
+  pwm_audio_host_hook = PwmHook;
+
+  int nResult = Host_Run(argv[1], dwFrames);
+  if (fpDuty)
+    fclose(fpDuty);
+  if (nResult < 0)
+    return 1;
+
+  const double halves = qwSamples ? 2.0 * qwSamples : 1;
+  printf("rom            : %s (mapper %d)\n", argv[1], MapperNo);
+  printf("frames         : %lu\n", (unsigned long)Host_Frames);
+  printf("pwm            : %d bits, %s, carrier %.1f kHz at %.1f MHz\n", Pwm.bits,
+         Pwm.stereo ? "stereo" : "mono", pwm_audio_host_clk_sys / 1e3 / (1 << Pwm.bits),
+         pwm_audio_host_clk_sys / 1e6);
+  printf("sample clock   : %.3f Hz for %lu Hz (%+.0f ppm), %d-sample DMA blocks\n",
+         pwm_audio_host_rate_mhz / 1000.0, (unsigned long)Pwm.sample_freq,
+         (pwm_audio_host_rate_mhz / 1000.0 / Pwm.sample_freq - 1.0) * 1e6, Pwm.dma_trans_count);
+  printf("samples        : %llu\n", qwSamples);
+  printf("duty           : %lu .. %lu, %.3f%% clipped\n", (unsigned long)dwDutyMin,
+         (unsigned long)dwDutyMax, 100.0 * qwClipped / halves);
+  printf("underruns      : %lu\n", (unsigned long)Ring.underruns);
+  printf("overruns       : %lu frames\n", (unsigned long)Ring.overruns);
+  printf("encoding errors: %llu\n", qwBadDuty);
+
+  return qwBadDuty ? 1 : 0;
+}
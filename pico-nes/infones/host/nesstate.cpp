@@ -0,0 +1,186 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nesstate.cpp : Save state round-trip check                       */
+/*                                                                   */
+/*  Usage: nesstate <rom.nes> [options]                              */
+/*    -s <frame>    frame to save the state at ( default 300 )       */
+/*    -n <frames>   frames to run past it ( default 300 )            */
+/*    -i <script>   pad input script, as nesgolden's                 */
+/*    -o <file>     also write the state to <file>                   */
+/*    -e <entry>    game of a ROM pack to run ( default 0 )          */
+/*                                                                   */
+/*  Runs the game to the save frame and saves a state, runs <frames> */
+/*  more hashing SCREEN, then loads the state and runs them again.   */
+/*  The state must save back to the same bytes once loaded, and the  */
+/*  second run must draw the same frames as the first. The input     */
+/*  script follows the game's own frame count, so both runs see the  */
+/*  same pads. Sound is not compared: a load restarts the channels   */
+/*  from their registers, not from where their waves were.           */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "InfoNES_System_Host.h"
+#include "nestool.h"
+#include "../InfoNES_State.h"
+
+/*-------------------------------------------------------------------*/
+/*  Round trip                                                       */
+/*-------------------------------------------------------------------*/
+
+static std::vector<PadEvent> Script;
+
+static DWORD dwSaveFrame = 300;
+static DWORD dwRunFrames = 300;
+
+/* Frames the load took the game back, so the script follows the game */
+static DWORD dwRewind;
+
+static std::vector<BYTE> Saved;
+static std::vector<BYTE> Resaved;
+static std::vector<HASH> FirstRun;
+static std::vector<HASH> SecondRun;
+static bool bLoadFailed;
+
+static int saveInto(std::vector<BYTE> &state)
+{
+  state.resize(InfoNES_StateSize());
+  DWORD dwSize = InfoNES_SaveState(state.data(), state.size());
+  state.resize(dwSize);
+  return dwSize ? 0 : -1;
+}
+
+static int FrameHook(DWORD dwFrame)
+{
+  DWORD dwGame = dwFrame - dwRewind;
+
+  if (dwGame > dwSaveFrame)
+  {
+    HASH h = fnv1a(FNV_OFFSET, &SCREEN[0][0], sizeof SCREEN);
+    (dwRewind ? SecondRun : FirstRun).push_back(h);
+  }
+
+  if (dwGame == dwSaveFrame && !dwRewind)
+    return saveInto(Saved);
+
+  if (dwGame == dwSaveFrame + dwRunFrames)
+  {
+    if (dwRewind)
+      return -1;
+
+    if (InfoNES_LoadState(Saved.data(), Saved.size()) < 0)
+    {
+      bLoadFailed = true;
+      return -1;
+    }
+    dwRewind = dwRunFrames;
+    return saveInto(Resaved);
+  }
+  return 0;
+}
+
+static void PadHook(DWORD dwFrame, DWORD *pdwPad1, DWORD *pdwPad2, DWORD *pdwSystem)
+{
+  scriptPads(Script, dwFrame - dwRewind, pdwPad1, pdwPad2);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Main                                                             */
+/*-------------------------------------------------------------------*/
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s <rom.nes> [-s frame] [-n frames] [-i script] [-o state-file] [-e entry]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  const char *romPath = argv[1];
+  const char *statePath = NULL;
+
+  for (int i = 2; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+      dwSaveFrame = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      dwRunFrames = strtoul(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+    {
+      if (loadScript(argv[++i], Script) < 0)
+        return 2;
+    }
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      statePath = argv[++i];
+    else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+      Host_PackEntry = atoi(argv[++i]);
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (dwSaveFrame == 0 || dwRunFrames == 0)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  Host_Quiet = 1;
+  Host_FrameHook = FrameHook;
+  Host_PadHook = PadHook;
+
+  if (Host_Run(romPath, 0) < 0)
+    return 1;
+
+  if (Saved.empty())
+  {
+    fprintf(stderr, "could not save a state at frame %lu\n", (unsigned long)dwSaveFrame);
+    return 1;
+  }
+  if (statePath)
+  {
+    FILE *fp = fopen(statePath, "wb");
+    if (!fp || fwrite(Saved.data(), 1, Saved.size(), fp) != Saved.size())
+    {
+      fprintf(stderr, "cannot write state file %s\n", statePath);
+      return 2;
+    }
+    fclose(fp);
+  }
+  if (bLoadFailed)
+  {
+    fprintf(stderr, "the state saved at frame %lu does not load\n", (unsigned long)dwSaveFrame);
+    return 1;
+  }
+  if (Resaved != Saved)
+  {
+    size_t nAt = 0;
+    while (nAt < Saved.size() && nAt < Resaved.size() && Saved[nAt] == Resaved[nAt])
+      ++nAt;
+    printf("FAIL: the loaded state saves back differently, from byte %zu of %zu\n", nAt, Saved.size());
+    return 1;
+  }
+
+  for (size_t i = 0; i < FirstRun.size(); ++i)
+  {
+    if (i >= SecondRun.size() || SecondRun[i] != FirstRun[i])
+    {
+      printf("FAIL: frame %lu differs after loading the state\n", (unsigned long)(dwSaveFrame + 1 + i));
+      return 1;
+    }
+  }
+
+  printf("OK: %lu bytes saved at frame %lu, %zu frames match after loading\n",
+         (unsigned long)Saved.size(), (unsigned long)dwSaveFrame, FirstRun.size());
+  return 0;
+}
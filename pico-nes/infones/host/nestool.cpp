@@ -0,0 +1,99 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nestool.cpp : Frame hashes and pad scripts shared by the tools   */
+/*                                                                   */
+/*===================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "nestool.h"
+
+/*-------------------------------------------------------------------*/
+/*  Input script                                                     */
+/*-------------------------------------------------------------------*/
+
+static const struct
+{
+  const char *name;
+  DWORD bit;
+} ButtonNames[] = {
+    {"A", 1 << 0}, {"B", 1 << 1}, {"SELECT", 1 << 2}, {"START", 1 << 3},
+    {"UP", 1 << 4}, {"DOWN", 1 << 5}, {"LEFT", 1 << 6}, {"RIGHT", 1 << 7}};
+
+static int parsePad(const char *tok, DWORD *pad)
+{
+  if (isdigit((unsigned char)tok[0]))
+  {
+    *pad = strtoul(tok, NULL, 0);
+    return 0;
+  }
+
+  *pad = 0;
+  char buf[128];
+  snprintf(buf, sizeof buf, "%s", tok);
+  for (char *name = strtok(buf, "+"); name; name = strtok(NULL, "+"))
+  {
+    size_t i;
+    for (i = 0; i < sizeof ButtonNames / sizeof ButtonNames[0]; ++i)
+    {
+      if (strcasecmp(name, ButtonNames[i].name) == 0)
+      {
+        *pad |= ButtonNames[i].bit;
+        break;
+      }
+    }
+    if (i == sizeof ButtonNames / sizeof ButtonNames[0])
+      return -1;
+  }
+  return 0;
+}
+
+int loadScript(const char *path, std::vector<PadEvent> &script)
+{
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+  {
+    fprintf(stderr, "cannot open input script %s\n", path);
+    return -1;
+  }
+
+  char line[256];
+  int lineNo = 0;
+  while (fgets(line, sizeof line, fp))
+  {
+    ++lineNo;
+    char *hash = strchr(line, '#');
+    if (hash)
+      *hash = '\0';
+
+    char frame[64], pad1[128], pad2[128] = "0";
+    int n = sscanf(line, "%63s %127s %127s", frame, pad1, pad2);
+    if (n <= 0)
+      continue;
+
+    PadEvent ev;
+    ev.frame = strtoul(frame, NULL, 0);
+    if (n < 2 || parsePad(pad1, &ev.pad1) < 0 || parsePad(pad2, &ev.pad2) < 0)
+    {
+      fprintf(stderr, "%s:%d: bad input entry\n", path, lineNo);
+      fclose(fp);
+      return -1;
+    }
+    script.push_back(ev);
+  }
+  fclose(fp);
+  return 0;
+}
+
+void scriptPads(const std::vector<PadEvent> &script, DWORD dwFrame, DWORD *pdwPad1, DWORD *pdwPad2)
+{
+  for (size_t i = 0; i < script.size() && script[i].frame <= dwFrame; ++i)
+  {
+    *pdwPad1 = script[i].pad1;
+    *pdwPad2 = script[i].pad2;
+  }
+}
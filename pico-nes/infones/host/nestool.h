@@ -0,0 +1,58 @@
+/*===================================================================*/
+/*                                                                   */
+/*  nestool.h : Frame hashes and pad scripts shared by the tools     */
+/*                                                                   */
+/*  Input script: one "<frame> <pad1> [<pad2>]" entry per line, the  */
+/*  pad state holds until the next entry. A pad is a number ( 0x08 ) */
+/*  or button names joined with '+' ( A+B+START+SELECT+UP+DOWN+      */
+/*  LEFT+RIGHT ). '#' starts a comment.                              */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef NESTOOL_H_INCLUDED
+#define NESTOOL_H_INCLUDED
+
+/*-------------------------------------------------------------------*/
+/*  Include files                                                    */
+/*-------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <vector>
+
+#include "../InfoNES_Types.h"
+
+/*-------------------------------------------------------------------*/
+/*  Hashes                                                           */
+/*-------------------------------------------------------------------*/
+
+typedef unsigned long long HASH;
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+/* FNV-1a of n bytes, continued from h ( FNV_OFFSET to start ) */
+static inline HASH fnv1a(HASH h, const BYTE *p, size_t n)
+{
+  while (n--)
+    h = (h ^ *p++) * FNV_PRIME;
+  return h;
+}
+
+/*-------------------------------------------------------------------*/
+/*  Input script                                                     */
+/*-------------------------------------------------------------------*/
+
+struct PadEvent
+{
+  DWORD frame;
+  DWORD pad1;
+  DWORD pad2;
+};
+
+/* Append the entries of the script at path; returns -1 ( and says why ) on error */
+int loadScript(const char *path, std::vector<PadEvent> &script);
+
+/* Set the pads to the last entry at or before dwFrame, leave them as is before the first */
+void scriptPads(const std::vector<PadEvent> &script, DWORD dwFrame, DWORD *pdwPad1, DWORD *pdwPad2);
+
+#endif /* !NESTOOL_H_INCLUDED */
@@ -0,0 +1,28 @@
+/*===================================================================*/
+/*                                                                   */
+/*  pico.h : Host stand-in for the Pico SDK base header              */
+/*                                                                   */
+/*  Only the section/placement attributes used by the InfoNES core   */
+/*  are provided; they expand to nothing on the host.                */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef HOST_PICO_H_INCLUDED
+#define HOST_PICO_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __no_inline_not_in_flash_func(func_name) __attribute__((noinline)) func_name
+#define __time_critical_func(func_name) func_name
+#define __scratch_x(group)
+#define __scratch_y(group)
+
+#ifndef __unreachable
+#define __unreachable() __builtin_unreachable()
+#endif
+
+#endif /* !HOST_PICO_H_INCLUDED */
@@ -0,0 +1,12 @@
+/*===================================================================*/
+/*                                                                   */
+/*  pico/runtime.h : Host stand-in for the Pico SDK runtime header   */
+/*                                                                   */
+/*===================================================================*/
+
+#ifndef HOST_PICO_RUNTIME_H_INCLUDED
+#define HOST_PICO_RUNTIME_H_INCLUDED
+
+#include "../pico.h"
+
+#endif /* !HOST_PICO_RUNTIME_H_INCLUDED */
@@ -372,3 +372,22 @@ void Map1_Write( WORD wAddr, BYTE byData )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 1 State Function                                          */
+/*-------------------------------------------------------------------*/
+void Map1_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map1_Regs );
+  InfoNES_StateField( pState, Map1_Cnt );
+  InfoNES_StateField( pState, Map1_Latch );
+  InfoNES_StateField( pState, Map1_Last_Write_Addr );
+  InfoNES_StateField( pState, Map1_256K_base );
+  InfoNES_StateField( pState, Map1_swap );
+  InfoNES_StateField( pState, Map1_bank1 );
+  InfoNES_StateField( pState, Map1_bank2 );
+  InfoNES_StateField( pState, Map1_bank3 );
+  InfoNES_StateField( pState, Map1_bank4 );
+  InfoNES_StateField( pState, Map1_HI1 );
+  InfoNES_StateField( pState, Map1_HI2 );
+}
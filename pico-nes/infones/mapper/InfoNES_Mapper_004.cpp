@@ -360,3 +360,26 @@ void Map4_Set_PPU_Banks()
     }
   }    
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 4 State Function                                          */
+/*-------------------------------------------------------------------*/
+void Map4_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map4_Regs );
+  InfoNES_StateField( pState, Map4_Rom_Bank );
+  InfoNES_StateField( pState, Map4_Prg0 );
+  InfoNES_StateField( pState, Map4_Prg1 );
+  InfoNES_StateField( pState, Map4_Chr01 );
+  InfoNES_StateField( pState, Map4_Chr23 );
+  InfoNES_StateField( pState, Map4_Chr4 );
+  InfoNES_StateField( pState, Map4_Chr5 );
+  InfoNES_StateField( pState, Map4_Chr6 );
+  InfoNES_StateField( pState, Map4_Chr7 );
+  InfoNES_StateField( pState, Map4_IRQ_Enable );
+  InfoNES_StateField( pState, Map4_IRQ_Cnt );
+  InfoNES_StateField( pState, Map4_IRQ_Latch );
+  InfoNES_StateField( pState, Map4_IRQ_Request );
+  InfoNES_StateField( pState, Map4_IRQ_Present );
+  InfoNES_StateField( pState, Map4_IRQ_Present_Vbl );
+}
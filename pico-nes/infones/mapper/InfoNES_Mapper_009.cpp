@@ -229,3 +229,16 @@ void Map9_PPU( WORD wAddr )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 9 State Function                                          */
+/*-------------------------------------------------------------------*/
+void Map9_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, latch1.lo_bank );
+  InfoNES_StateField( pState, latch1.hi_bank );
+  InfoNES_StateField( pState, latch1.state );
+  InfoNES_StateField( pState, latch2.lo_bank );
+  InfoNES_StateField( pState, latch2.hi_bank );
+  InfoNES_StateField( pState, latch2.state );
+}
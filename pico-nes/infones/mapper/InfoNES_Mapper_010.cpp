@@ -231,3 +231,16 @@ void Map10_PPU( WORD wAddr )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 10 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map10_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, latch3.lo_bank );
+  InfoNES_StateField( pState, latch3.hi_bank );
+  InfoNES_StateField( pState, latch3.state );
+  InfoNES_StateField( pState, latch4.lo_bank );
+  InfoNES_StateField( pState, latch4.hi_bank );
+  InfoNES_StateField( pState, latch4.state );
+}
@@ -184,3 +184,14 @@ void Map16_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 16 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map16_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map16_Regs );
+  InfoNES_StateField( pState, Map16_IRQ_Enable );
+  InfoNES_StateField( pState, Map16_IRQ_Cnt );
+  InfoNES_StateField( pState, Map16_IRQ_Latch );
+}
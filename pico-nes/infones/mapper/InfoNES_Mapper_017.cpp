@@ -192,3 +192,13 @@ void Map17_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 17 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map17_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map17_IRQ_Enable );
+  InfoNES_StateField( pState, Map17_IRQ_Cnt );
+  InfoNES_StateField( pState, Map17_IRQ_Latch );
+}
@@ -266,3 +266,14 @@ void Map18_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 18 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map18_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map18_Regs );
+  InfoNES_StateField( pState, Map18_IRQ_Enable );
+  InfoNES_StateField( pState, Map18_IRQ_Latch );
+  InfoNES_StateField( pState, Map18_IRQ_Cnt );
+}
@@ -10,6 +10,15 @@ BYTE Map19_Regs[2];
 BYTE Map19_IRQ_Enable;
 DWORD Map19_IRQ_Cnt;
 
+/* Namco 163 sound: 128 bytes of RAM through $f800 ( address ) / $4800 ( data ) */
+BYTE Map19_Snd_Addr; /* bit 7: increment after each access */
+BYTE Map19_Snd_Ram[ 0x80 ];
+
+/* The chip's copy of the RAM, updated in render order, and its channels */
+BYTE Map19_Snd_Wave[ 0x80 ];
+DWORD Map19_Snd_Phase[ 8 ];
+DWORD Map19_Snd_Skip[ 8 ];
+
 /* The address of 1Kbytes unit of the Map19 Chr RAM */
 #define Map19_VROMPAGE(a) &Map19_Chr_Ram[(a)*0x400]
 
@@ -73,6 +82,11 @@ void Map19_Init()
   Map19_Regs[0] = 0x00;
   Map19_Regs[1] = 0x00;
 
+  /* Expansion sound */
+  Map19_Snd_Addr = 0;
+  InfoNES_MemorySet(Map19_Snd_Ram, 0, sizeof Map19_Snd_Ram);
+  Map19_Sound_Init();
+
   /* Set up wiring of the interrupt pin */
   K6502_Set_Int_Wiring(1, 1);
 }
@@ -258,11 +272,8 @@ void Map19_Write(WORD wAddr, BYTE byData)
     ROMBANK2 = ROMPAGE(byData);
     break;
 
-  case 0xf800: /* $e800-efff */
-    if (wAddr == 0xf800)
-    {
-      // Extra Sound
-    }
+  case 0xf800: /* $f800-ffff */
+    Map19_Snd_Addr = byData;
     break;
   }
 }
@@ -274,10 +285,12 @@ void Map19_Apu(WORD wAddr, BYTE byData)
 {
   switch (wAddr & 0xf800)
   {
-  case 0x4800:
-    if (wAddr == 0x4800)
+  case 0x4800: /* $4800-4fff */
+    Map19_Snd_Ram[Map19_Snd_Addr & 0x7f] = byData;
+    InfoNES_pAPUWriteExt(Map19_Snd_Addr & 0x7f, byData);
+    if (Map19_Snd_Addr & 0x80)
     {
-      // Extra Sound
+      Map19_Snd_Addr = 0x80 | ((Map19_Snd_Addr + 1) & 0x7f);
     }
     break;
 
@@ -299,12 +312,15 @@ BYTE Map19_ReadApu(WORD wAddr)
 {
   switch (wAddr & 0xf800)
   {
-  case 0x4800:
-    if (wAddr == 0x4800)
+  case 0x4800: /* $4800-4fff */
+  {
+    BYTE byRet = Map19_Snd_Ram[Map19_Snd_Addr & 0x7f];
+    if (Map19_Snd_Addr & 0x80)
     {
-      // Extra Sound
+      Map19_Snd_Addr = 0x80 | ((Map19_Snd_Addr + 1) & 0x7f);
     }
-    return (BYTE)(wAddr >> 8);
+    return byRet;
+  }
 
   case 0x5000: /* $5000-57ff */
     return (BYTE)(Map19_IRQ_Cnt & 0x00ff);
@@ -341,3 +357,126 @@ void Map19_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 19 Sound Functions ( up to 8 wavetable channels )         */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  Channel c has its registers at $40 + 8 * c; $7f also holds the
+ *  number of channels, the last ones of the eight. The chip updates
+ *  one channel every 15 clocks, adding its 18-bit frequency to its
+ *  24-bit phase, and plays them in turn, so each sample is the mean
+ *  of the active channels. The phase here advances once per sample.
+ */
+int Map19_Sound_Channels()
+{
+  return ((Map19_Snd_Wave[0x7f] >> 4) & 0x07) + 1;
+}
+
+void Map19_Sound_Freq(int nCh)
+{
+  const BYTE *pbyRegs = &Map19_Snd_Wave[0x40 + (nCh << 3)];
+  DWORD dwFreq = ((DWORD)(pbyRegs[4] & 0x03) << 16) | ((DWORD)pbyRegs[2] << 8) | pbyRegs[0];
+  Map19_Snd_Skip[nCh] =
+      (DWORD)((uint64_t)dwFreq * ApuCycleRate / (65536ULL * 15 * Map19_Sound_Channels()));
+}
+
+void Map19_Sound_Reset()
+{
+  InfoNES_MemorySet(Map19_Snd_Wave, 0, sizeof Map19_Snd_Wave);
+  for (int nCh = 0; nCh < 8; ++nCh)
+  {
+    Map19_Snd_Phase[nCh] = 0;
+    Map19_Snd_Skip[nCh] = 0;
+  }
+}
+
+void Map19_Sound_Write(BYTE byReg, BYTE byData)
+{
+  Map19_Snd_Wave[byReg] = byData;
+  if (byReg < 0x40)
+    return;
+
+  int nCh = (byReg - 0x40) >> 3;
+  const BYTE *pbyRegs = &Map19_Snd_Wave[0x40 + (nCh << 3)];
+  switch (byReg & 0x07)
+  {
+  case 0: /* Frequency */
+  case 2:
+  case 4: /* and wave length */
+    Map19_Sound_Freq(nCh);
+    break;
+
+  case 1: /* Phase */
+  case 3:
+  case 5:
+    Map19_Snd_Phase[nCh] = ((DWORD)pbyRegs[5] << 16) | ((DWORD)pbyRegs[3] << 8) | pbyRegs[1];
+    break;
+
+  case 7: /* Volume; $7f also sets the channel count */
+    if (byReg == 0x7f)
+    {
+      for (int nIdx = 0; nIdx < 8; ++nIdx)
+        Map19_Sound_Freq(nIdx);
+    }
+    break;
+  }
+}
+
+void __not_in_flash_func(Map19_Sound_Render)(BYTE *pbyWave, int nSamples)
+{
+  const int nChannels = Map19_Sound_Channels();
+  const int nFirst = 8 - nChannels;
+
+  /* The mean of the channels, halved: 0..112 */
+  const int nScale = 32768 / nChannels;
+
+  for (int i = 0; i < nSamples; ++i)
+  {
+    int nSum = 0;
+    for (int nCh = nFirst; nCh < 8; ++nCh)
+    {
+      const BYTE *pbyRegs = &Map19_Snd_Wave[0x40 + (nCh << 3)];
+      const DWORD dwLength = (DWORD)(256 - (pbyRegs[4] & 0xfc)) << 16;
+
+      DWORD dwPhase = Map19_Snd_Phase[nCh] + Map19_Snd_Skip[nCh];
+      if (dwPhase >= dwLength)
+        dwPhase %= dwLength;
+      Map19_Snd_Phase[nCh] = dwPhase;
+
+      /* 4-bit samples, low nibble first */
+      BYTE bySample = (BYTE)((dwPhase >> 16) + pbyRegs[6]);
+      BYTE byNibble = (Map19_Snd_Wave[bySample >> 1] >> ((bySample & 1) << 2)) & 0x0f;
+      nSum += byNibble * (pbyRegs[7] & 0x0f);
+    }
+    pbyWave[i] = (BYTE)((nSum * nScale) >> 16);
+  }
+}
+
+const ApuExt_t Map19_N163 = {Map19_Sound_Reset, Map19_Sound_Write, Map19_Sound_Render};
+
+void Map19_Sound_Init()
+{
+  InfoNES_pAPUSetExt(&Map19_N163);
+}
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 19 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map19_State(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateMemory(pState, Map19_Chr_Ram, sizeof Map19_Chr_Ram);
+  InfoNES_StateField(pState, Map19_Regs);
+  InfoNES_StateField(pState, Map19_IRQ_Enable);
+  InfoNES_StateField(pState, Map19_IRQ_Cnt);
+  InfoNES_StateField(pState, Map19_Snd_Addr);
+  InfoNES_StateField(pState, Map19_Snd_Ram);
+
+  /* The chip's side is rebuilt from the sound RAM */
+  if (pState->byLoad)
+  {
+    for (int nReg = 0; nReg < 0x80; ++nReg)
+      InfoNES_pAPUWriteExt(nReg, Map19_Snd_Ram[nReg]);
+  }
+}
@@ -273,3 +273,14 @@ void Map21_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 21 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map21_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map21_Regs );
+  InfoNES_StateField( pState, Map21_IRQ_Enable );
+  InfoNES_StateField( pState, Map21_IRQ_Cnt );
+  InfoNES_StateField( pState, Map21_IRQ_Latch );
+}
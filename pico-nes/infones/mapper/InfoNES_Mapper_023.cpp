@@ -291,3 +291,14 @@ void Map23_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 23 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map23_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map23_Regs );
+  InfoNES_StateField( pState, Map23_IRQ_Enable );
+  InfoNES_StateField( pState, Map23_IRQ_Cnt );
+  InfoNES_StateField( pState, Map23_IRQ_Latch );
+}
@@ -8,6 +8,14 @@ BYTE Map24_IRQ_Count;
 BYTE Map24_IRQ_State;
 BYTE Map24_IRQ_Latch;
 
+/* VRC6 sound: $9000-$9003, $a000-$a002, $b000-$b002 as 0-3, 4-6, 8-10 */
+BYTE Map24_Snd_Regs[ 12 ];
+uint32_t Map24_Snd_Skip[ 3 ];
+uint32_t Map24_Snd_Index[ 3 ];
+
+/* The registers as the CPU last wrote them; the chip's copy may lag behind */
+BYTE Map24_Snd_Latch[ 12 ];
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 24                                             */
 /*-------------------------------------------------------------------*/
@@ -49,6 +57,9 @@ void Map24_Init()
   ROMBANK2 = ROMLASTPAGE( 1 );
   ROMBANK3 = ROMLASTPAGE( 0 );
 
+  /* Expansion sound */
+  Map24_Sound_Init();
+
   /* Set up wiring of the interrupt pin */
   K6502_Set_Int_Wiring( 1, 1 ); 
 }
@@ -58,6 +69,8 @@ void Map24_Init()
 /*-------------------------------------------------------------------*/
 void Map24_Write( WORD wAddr, BYTE byData )
 {
+  Map24_Sound( wAddr, byData );
+
   switch ( wAddr )
   {
     case 0x8000:
@@ -176,3 +189,140 @@ void Map24_HSync()
 		}
 	}
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 24 Sound Functions ( 2 pulse, 1 sawtooth )                */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  Each channel steps on the CPU clock every ( Freq + 1 ) clocks. The
+ *  position is a 32-bit phase accumulator advanced once per sample: 16
+ *  pulse steps in the top 4 bits, one sawtooth period of 14 steps in
+ *  all 32.
+ */
+void Map24_Sound_Reset()
+{
+  InfoNES_MemorySet( Map24_Snd_Regs, 0, sizeof Map24_Snd_Regs );
+  for ( int nCh = 0; nCh < 3; ++nCh )
+  {
+    Map24_Snd_Skip[ nCh ] = 0;
+    Map24_Snd_Index[ nCh ] = 0;
+  }
+}
+
+void Map24_Sound_Write( BYTE byReg, BYTE byData )
+{
+  Map24_Snd_Regs[ byReg ] = byData;
+
+  int nCh = byReg >> 2;
+  BYTE *pbyRegs = &Map24_Snd_Regs[ nCh << 2 ];
+  DWORD dwPeriod = ( ( (DWORD)( pbyRegs[ 2 ] & 0x0f ) << 8 ) | pbyRegs[ 1 ] ) + 1;
+
+  if ( nCh < 2 )
+  {
+    Map24_Snd_Skip[ nCh ] = (uint32_t)( ( (uint64_t)ApuCycleRate << 12 ) / dwPeriod );
+  }
+  else
+  {
+    Map24_Snd_Skip[ nCh ] = (uint32_t)( ( (uint64_t)ApuCycleRate << 16 ) / ( 14 * dwPeriod ) );
+  }
+
+  /* A disabled channel restarts from its first step */
+  if ( !( pbyRegs[ 2 ] & 0x80 ) )
+  {
+    Map24_Snd_Index[ nCh ] = 0;
+  }
+}
+
+void __not_in_flash_func(Map24_Sound_Render)( BYTE *pbyWave, int nSamples )
+{
+  const BYTE *pbyRegs = Map24_Snd_Regs;
+
+  /* $9003 bit 0 halts all three */
+  const bool bHalt = pbyRegs[ 3 ] & 0x01;
+  uint32_t dwSkip1 = ( ( pbyRegs[ 2 ] & 0x80 ) && !bHalt ) ? Map24_Snd_Skip[ 0 ] : 0;
+  uint32_t dwSkip2 = ( ( pbyRegs[ 6 ] & 0x80 ) && !bHalt ) ? Map24_Snd_Skip[ 1 ] : 0;
+  uint32_t dwSkip3 = ( ( pbyRegs[ 10 ] & 0x80 ) && !bHalt ) ? Map24_Snd_Skip[ 2 ] : 0;
+
+  /* Pulse: high while the step is at most the duty, always in digitized mode */
+  int nVol1 = ( pbyRegs[ 2 ] & 0x80 ) ? pbyRegs[ 0 ] & 0x0f : 0;
+  int nVol2 = ( pbyRegs[ 6 ] & 0x80 ) ? pbyRegs[ 4 ] & 0x0f : 0;
+  DWORD dwDuty1 = ( pbyRegs[ 0 ] & 0x80 ) ? 15 : ( pbyRegs[ 0 ] >> 4 ) & 0x07;
+  DWORD dwDuty2 = ( pbyRegs[ 4 ] & 0x80 ) ? 15 : ( pbyRegs[ 4 ] >> 4 ) & 0x07;
+
+  /* Sawtooth: the accumulator adds the rate on every other step, 7 times */
+  int nRate = ( pbyRegs[ 10 ] & 0x80 ) ? pbyRegs[ 8 ] & 0x3f : 0;
+
+  uint32_t dwIndex1 = Map24_Snd_Index[ 0 ];
+  uint32_t dwIndex2 = Map24_Snd_Index[ 1 ];
+  uint32_t dwIndex3 = Map24_Snd_Index[ 2 ];
+  for ( int i = 0; i < nSamples; ++i )
+  {
+    dwIndex1 += dwSkip1;
+    dwIndex2 += dwSkip2;
+    dwIndex3 += dwSkip3;
+
+    int nLevel = ( ( dwIndex1 >> 28 ) <= dwDuty1 ? nVol1 : 0 ) +
+                 ( ( dwIndex2 >> 28 ) <= dwDuty2 ? nVol2 : 0 ) +
+                 ( ( ( ( ( dwIndex3 >> 16 ) * 7 ) >> 16 ) * nRate & 0xff ) >> 3 );
+
+    /* 0..61: a pulse at full volume is 60, as loud as an APU pulse */
+    pbyWave[ i ] = nLevel << 2;
+  }
+  Map24_Snd_Index[ 0 ] = dwIndex1;
+  Map24_Snd_Index[ 1 ] = dwIndex2;
+  Map24_Snd_Index[ 2 ] = dwIndex3;
+}
+
+const ApuExt_t Map24_Vrc6 = { Map24_Sound_Reset, Map24_Sound_Write, Map24_Sound_Render };
+
+void Map24_Sound_Init()
+{
+  InfoNES_MemorySet( Map24_Snd_Latch, 0, sizeof Map24_Snd_Latch );
+  InfoNES_pAPUSetExt( &Map24_Vrc6 );
+}
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 24 Sound Register Write Function                          */
+/*-------------------------------------------------------------------*/
+void Map24_Sound( WORD wAddr, BYTE byData )
+{
+  if ( wAddr < 0x9000 || wAddr > 0xb002 )
+    return;
+
+  BYTE byReg = (BYTE)( ( ( ( wAddr >> 12 ) - 0x9 ) << 2 ) | ( wAddr & 0x03 ) );
+  if ( byReg != 7 && byReg != 11 && !( wAddr & 0x0ffc ) )
+  {
+    Map24_Snd_Latch[ byReg ] = byData;
+    InfoNES_pAPUWriteExt( byReg, byData );
+  }
+}
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 24 Sound State Function                                   */
+/*-------------------------------------------------------------------*/
+void Map24_Sound_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map24_Snd_Latch );
+
+  /* The chip's side is rebuilt from the registers */
+  if ( pState->byLoad )
+  {
+    for ( int nReg = 0; nReg < 12; ++nReg )
+    {
+      if ( nReg != 7 && nReg != 11 )
+        InfoNES_pAPUWriteExt( nReg, Map24_Snd_Latch[ nReg ] );
+    }
+  }
+}
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 24 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map24_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map24_IRQ_Count );
+  InfoNES_StateField( pState, Map24_IRQ_State );
+  InfoNES_StateField( pState, Map24_IRQ_Latch );
+  Map24_Sound_State( pState );
+}
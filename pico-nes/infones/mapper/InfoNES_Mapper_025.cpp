@@ -192,3 +192,15 @@ void Map25_HSync()
     Map25_IRQ_Count = Map25_IRQ_Latch;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 25 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map25_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map25_Bank_Selector );
+  InfoNES_StateField( pState, Map25_VBank );
+  InfoNES_StateField( pState, Map25_IRQ_Count );
+  InfoNES_StateField( pState, Map25_IRQ_State );
+  InfoNES_StateField( pState, Map25_IRQ_Latch );
+}
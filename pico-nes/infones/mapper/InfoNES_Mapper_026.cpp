@@ -61,6 +61,9 @@ void Map26_Init()
   Map26_IRQ_Enable = 0;
   Map26_IRQ_Cnt = 0;
 
+  /* Expansion sound ( VRC6, see Mapper 24 ) */
+  Map24_Sound_Init();
+
   /* Set up wiring of the interrupt pin */
   K6502_Set_Int_Wiring( 1, 1 ); 
 }
@@ -70,6 +73,9 @@ void Map26_Init()
 /*-------------------------------------------------------------------*/
 void Map26_Write( WORD wAddr, BYTE byData )
 {
+  /* A0 and A1 are swapped on this board */
+  Map24_Sound( ( wAddr & 0xfffc ) | ( ( wAddr & 0x01 ) << 1 ) | ( ( wAddr & 0x02 ) >> 1 ), byData );
+
   switch ( wAddr )
   {
     /* Set ROM Banks */
@@ -198,3 +204,14 @@ void Map26_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 26 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map26_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map26_IRQ_Enable );
+  InfoNES_StateField( pState, Map26_IRQ_Cnt );
+  InfoNES_StateField( pState, Map26_IRQ_Latch );
+  Map24_Sound_State( pState );
+}
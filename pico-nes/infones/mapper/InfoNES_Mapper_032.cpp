@@ -105,3 +105,11 @@ void Map32_Write( WORD wAddr, BYTE byData )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 32 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map32_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map32_Saved );
+}
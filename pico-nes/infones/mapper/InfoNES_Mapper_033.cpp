@@ -196,3 +196,14 @@ void Map33_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 33 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map33_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map33_Regs );
+  InfoNES_StateField( pState, Map33_Switch );
+  InfoNES_StateField( pState, Map33_IRQ_Enable );
+  InfoNES_StateField( pState, Map33_IRQ_Cnt );
+}
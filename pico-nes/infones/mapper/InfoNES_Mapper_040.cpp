@@ -109,3 +109,12 @@ void Map40_HSync()
 }
 
 /* End of InfoNES_Mapper_40.cpp */
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 40 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map40_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map40_IRQ_Enable );
+  InfoNES_StateField( pState, Map40_Line_To_IRQ );
+}
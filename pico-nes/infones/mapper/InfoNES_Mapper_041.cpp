@@ -118,3 +118,11 @@ void Map41_Sram( WORD wAddr, BYTE byData )
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 41 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map41_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map41_Regs );
+}
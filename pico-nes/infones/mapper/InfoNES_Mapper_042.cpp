@@ -115,3 +115,12 @@ void Map42_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 42 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map42_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map42_IRQ_Cnt );
+  InfoNES_StateField( pState, Map42_IRQ_Enable );
+}
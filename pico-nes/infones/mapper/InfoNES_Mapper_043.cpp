@@ -71,7 +71,7 @@ BYTE Map43_ReadApu( WORD wAddr )
 {
   if ( 0x5000 <= wAddr && wAddr < 0x6000 ) 
   {
-    return ROM[ 0x2000*8 + 0x1000 + (wAddr - 0x5000) ];
+    return ( ROMPAGE( 8 ) )[ 0x1000 + (wAddr - 0x5000) ];
   }
   return (BYTE)(wAddr >> 8);
 }
@@ -136,3 +136,12 @@ void Map43_HSync()
 		}
 	}
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 43 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map43_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map43_IRQ_Cnt );
+  InfoNES_StateField( pState, Map43_IRQ_Enable );
+}
@@ -294,3 +294,23 @@ void Map44_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 44 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map44_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map44_Regs );
+  InfoNES_StateField( pState, Map44_Rom_Bank );
+  InfoNES_StateField( pState, Map44_Prg0 );
+  InfoNES_StateField( pState, Map44_Prg1 );
+  InfoNES_StateField( pState, Map44_Chr01 );
+  InfoNES_StateField( pState, Map44_Chr23 );
+  InfoNES_StateField( pState, Map44_Chr4 );
+  InfoNES_StateField( pState, Map44_Chr5 );
+  InfoNES_StateField( pState, Map44_Chr6 );
+  InfoNES_StateField( pState, Map44_Chr7 );
+  InfoNES_StateField( pState, Map44_IRQ_Enable );
+  InfoNES_StateField( pState, Map44_IRQ_Cnt );
+  InfoNES_StateField( pState, Map44_IRQ_Latch );
+}
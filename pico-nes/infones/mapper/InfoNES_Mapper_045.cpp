@@ -377,3 +377,28 @@ void Map45_Set_PPU_Banks()
 		InfoNES_SetupChr();
 	}
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 45 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map45_State(struct InfoNES_State_tag *pState)
+{
+  InfoNES_StateField(pState, Map45_Regs);
+  InfoNES_StateField(pState, Map45_P);
+  InfoNES_StateField(pState, Map45_Prg0);
+  InfoNES_StateField(pState, Map45_Prg1);
+  InfoNES_StateField(pState, Map45_Prg2);
+  InfoNES_StateField(pState, Map45_Prg3);
+  InfoNES_StateField(pState, Map45_C);
+  InfoNES_StateField(pState, Map45_Chr0);
+  InfoNES_StateField(pState, Map45_Chr1);
+  InfoNES_StateField(pState, Map45_Chr2);
+  InfoNES_StateField(pState, Map45_Chr3);
+  InfoNES_StateField(pState, Map45_Chr4);
+  InfoNES_StateField(pState, Map45_Chr5);
+  InfoNES_StateField(pState, Map45_Chr6);
+  InfoNES_StateField(pState, Map45_Chr7);
+  InfoNES_StateField(pState, Map45_IRQ_Enable);
+  InfoNES_StateField(pState, Map45_IRQ_Cnt);
+  InfoNES_StateField(pState, Map45_IRQ_Latch);
+}
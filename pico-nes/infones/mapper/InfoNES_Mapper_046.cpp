@@ -96,3 +96,11 @@ void Map46_Set_ROM_Banks()
   PPUBANK[ 7 ] = VROMPAGE( ( ( Map46_Regs[ 1 ] << 6 ) + ( Map46_Regs[ 3 ] << 3 ) + 7 ) % ( NesHeader.byVRomSize << 3 ) ); 
   InfoNES_SetupChr();
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 46 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map46_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map46_Regs );
+}
@@ -289,3 +289,23 @@ void Map47_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 47 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map47_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map47_Regs );
+  InfoNES_StateField( pState, Map47_Rom_Bank );
+  InfoNES_StateField( pState, Map47_Prg0 );
+  InfoNES_StateField( pState, Map47_Prg1 );
+  InfoNES_StateField( pState, Map47_Chr01 );
+  InfoNES_StateField( pState, Map47_Chr23 );
+  InfoNES_StateField( pState, Map47_Chr4 );
+  InfoNES_StateField( pState, Map47_Chr5 );
+  InfoNES_StateField( pState, Map47_Chr6 );
+  InfoNES_StateField( pState, Map47_Chr7 );
+  InfoNES_StateField( pState, Map47_IRQ_Enable );
+  InfoNES_StateField( pState, Map47_IRQ_Cnt );
+  InfoNES_StateField( pState, Map47_IRQ_Latch );
+}
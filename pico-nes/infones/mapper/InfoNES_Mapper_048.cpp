@@ -173,3 +173,13 @@ void Map48_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 48 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map48_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map48_Regs );
+  InfoNES_StateField( pState, Map48_IRQ_Enable );
+  InfoNES_StateField( pState, Map48_IRQ_Cnt );
+}
@@ -290,3 +290,22 @@ void Map49_Set_PPU_Banks()
     InfoNES_SetupChr();
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 49 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map49_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map49_Regs );
+  InfoNES_StateField( pState, Map49_Prg0 );
+  InfoNES_StateField( pState, Map49_Prg1 );
+  InfoNES_StateField( pState, Map49_Chr01 );
+  InfoNES_StateField( pState, Map49_Chr23 );
+  InfoNES_StateField( pState, Map49_Chr4 );
+  InfoNES_StateField( pState, Map49_Chr5 );
+  InfoNES_StateField( pState, Map49_Chr6 );
+  InfoNES_StateField( pState, Map49_Chr7 );
+  InfoNES_StateField( pState, Map49_IRQ_Enable );
+  InfoNES_StateField( pState, Map49_IRQ_Cnt );
+  InfoNES_StateField( pState, Map49_IRQ_Latch );
+}
@@ -102,3 +102,11 @@ void Map50_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 50 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map50_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map50_IRQ_Enable );
+}
@@ -121,3 +121,11 @@ void Map51_Set_CPU_Banks()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 51 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map51_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map51_Mode );
+  InfoNES_StateField( pState, Map51_Bank );
+}
@@ -121,3 +121,10 @@ void Map57_Write( WORD wAddr, BYTE byData )
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 57 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map57_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map57_Reg );
+}
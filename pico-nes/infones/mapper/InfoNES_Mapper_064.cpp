@@ -222,3 +222,13 @@ void Map64_Write( WORD wAddr, BYTE byData )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 64 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map64_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map64_Cmd );
+  InfoNES_StateField( pState, Map64_Prg );
+  InfoNES_StateField( pState, Map64_Chr );
+}
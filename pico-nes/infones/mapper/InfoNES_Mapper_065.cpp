@@ -170,3 +170,13 @@ void Map65_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 65 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map65_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map65_IRQ_Enable );
+  InfoNES_StateField( pState, Map65_IRQ_Cnt );
+  InfoNES_StateField( pState, Map65_IRQ_Latch );
+}
@@ -175,3 +175,13 @@ void Map67_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 67 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map67_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map67_IRQ_Enable );
+  InfoNES_StateField( pState, Map67_IRQ_Cnt );
+  InfoNES_StateField( pState, Map67_IRQ_Latch );
+}
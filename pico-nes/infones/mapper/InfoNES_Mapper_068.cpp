@@ -168,3 +168,11 @@ void Map68_SyncMirror( void )
     InfoNES_Mirroring( Map68_Regs[ 1 ] );
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 68 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map68_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map68_Regs );
+}
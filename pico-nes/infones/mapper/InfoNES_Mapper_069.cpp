@@ -8,6 +8,30 @@ BYTE  Map69_IRQ_Enable;
 DWORD Map69_IRQ_Cnt;
 BYTE  Map69_Regs[ 1 ];
 
+/* Sunsoft 5B sound: registers $00-$0d, selected through $c000 */
+BYTE  Map69_Snd_Addr;
+BYTE  Map69_Snd_Regs[ 16 ];
+uint32_t Map69_Snd_Skip[ 3 ];
+uint32_t Map69_Snd_Index[ 3 ];
+DWORD Map69_Snd_NoiseSkip;
+DWORD Map69_Snd_NoiseIndex;
+DWORD Map69_Snd_NoiseSr;
+DWORD Map69_Snd_EnvSkip;
+DWORD Map69_Snd_EnvIndex;
+int   Map69_Snd_EnvPos;
+BYTE  Map69_Snd_EnvAttack;
+BYTE  Map69_Snd_EnvHold;
+
+/* The registers as the CPU last wrote them; the chip's copy may lag behind */
+BYTE  Map69_Snd_Latch[ 14 ];
+
+/* 32 levels 1.5 dB apart; three channels at full volume sum to 255 */
+const BYTE Map69_Snd_Level[ 32 ] =
+{
+   0,  0,  1,  1,  1,  1,  1,  1,  2,  2,  2,  3,  3,  4,  5,  5,
+   6,  8,  9, 11, 13, 15, 18, 21, 25, 30, 36, 43, 51, 60, 72, 85,
+};
+
 /*-------------------------------------------------------------------*/
 /*  Initialize Mapper 69                                             */
 /*-------------------------------------------------------------------*/
@@ -61,6 +85,11 @@ void Map69_Init()
   Map69_IRQ_Enable = 0;
   Map69_IRQ_Cnt    = 0;
 
+  /* Expansion sound */
+  Map69_Snd_Addr = 0;
+  InfoNES_MemorySet( Map69_Snd_Latch, 0, sizeof Map69_Snd_Latch );
+  Map69_Sound_Init();
+
   /* Set up wiring of the interrupt pin */
   K6502_Set_Int_Wiring( 1, 1 ); 
 }
@@ -76,6 +105,19 @@ void Map69_Write( WORD wAddr, BYTE byData )
       Map69_Regs[ 0 ] = byData & 0x0f;
       break;
 
+    /* Sound register select / write */
+    case 0xC000:
+      Map69_Snd_Addr = byData & 0x0f;
+      break;
+
+    case 0xE000:
+      if ( Map69_Snd_Addr < 0x0e )
+      {
+        Map69_Snd_Latch[ Map69_Snd_Addr ] = byData;
+        InfoNES_pAPUWriteExt( Map69_Snd_Addr, byData );
+      }
+      break;
+
     case 0xA000:
       switch ( Map69_Regs[ 0 ] )
       {
@@ -174,3 +216,177 @@ void Map69_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 69 Sound Functions ( 3 square, noise, envelope )          */
+/*-------------------------------------------------------------------*/
+
+/*
+ *  The chip runs at half the CPU clock: a square of period P lasts
+ *  32 * P CPU clocks, the noise shifts every 32 * P, the envelope
+ *  steps every 16 * P. Squares are 32-bit phase accumulators with the
+ *  level in the top bit; noise and envelope count whole steps in 16.16.
+ */
+void Map69_Sound_Write( BYTE byReg, BYTE byData )
+{
+  Map69_Snd_Regs[ byReg ] = byData;
+
+  switch ( byReg )
+  {
+    /* Square periods, 12 bits */
+    case 0x00:
+    case 0x01:
+    case 0x02:
+    case 0x03:
+    case 0x04:
+    case 0x05:
+    {
+      int nCh = byReg >> 1;
+      DWORD dwPeriod = ( (DWORD)( Map69_Snd_Regs[ ( nCh << 1 ) + 1 ] & 0x0f ) << 8 ) |
+                       Map69_Snd_Regs[ nCh << 1 ];
+      if ( !dwPeriod )
+        dwPeriod = 1;
+      Map69_Snd_Skip[ nCh ] = (uint32_t)( ( (uint64_t)ApuCycleRate << 16 ) / ( 32 * dwPeriod ) );
+      break;
+    }
+
+    /* Noise period, 5 bits */
+    case 0x06:
+      Map69_Snd_NoiseSkip = ApuCycleRate / ( 32 * ( ( byData & 0x1f ) ? byData & 0x1f : 1 ) );
+      break;
+
+    /* Envelope period, 16 bits */
+    case 0x0b:
+    case 0x0c:
+    {
+      DWORD dwPeriod = ( (DWORD)Map69_Snd_Regs[ 0x0c ] << 8 ) | Map69_Snd_Regs[ 0x0b ];
+      Map69_Snd_EnvSkip = ApuCycleRate / ( 16 * ( dwPeriod ? dwPeriod : 1 ) );
+      break;
+    }
+
+    /* Envelope shape: restarts it */
+    case 0x0d:
+      Map69_Snd_EnvPos = 0;
+      Map69_Snd_EnvIndex = 0;
+      Map69_Snd_EnvAttack = ( byData & 0x04 ) ? 1 : 0;
+      Map69_Snd_EnvHold = 0;
+      break;
+  }
+}
+
+void Map69_Sound_Reset()
+{
+  InfoNES_MemorySet( Map69_Snd_Regs, 0, sizeof Map69_Snd_Regs );
+  for ( int nCh = 0; nCh < 3; ++nCh )
+    Map69_Snd_Index[ nCh ] = 0;
+  Map69_Snd_NoiseIndex = 0;
+  Map69_Snd_NoiseSr = 1;
+
+  /* Derive the steps from the cleared registers */
+  for ( BYTE byReg = 0; byReg < 0x0e; ++byReg )
+    Map69_Sound_Write( byReg, 0 );
+}
+
+void __not_in_flash_func(Map69_Sound_Envelope)()
+{
+  if ( Map69_Snd_EnvHold || ++Map69_Snd_EnvPos < 32 )
+    return;
+
+  BYTE byShape = Map69_Snd_Regs[ 0x0d ];
+  if ( !( byShape & 0x08 ) )
+  {
+    /* One ramp, then silence */
+    Map69_Snd_EnvAttack = 0;
+    Map69_Snd_EnvPos = 31;
+    Map69_Snd_EnvHold = 1;
+  }
+  else if ( byShape & 0x01 )
+  {
+    /* Hold the end of the ramp, or its start when alternating */
+    Map69_Snd_EnvAttack ^= ( byShape & 0x02 ) ? 1 : 0;
+    Map69_Snd_EnvPos = 31;
+    Map69_Snd_EnvHold = 1;
+  }
+  else
+  {
+    Map69_Snd_EnvAttack ^= ( byShape & 0x02 ) ? 1 : 0;
+    Map69_Snd_EnvPos = 0;
+  }
+}
+
+void __not_in_flash_func(Map69_Sound_Render)( BYTE *pbyWave, int nSamples )
+{
+  const BYTE *pbyRegs = Map69_Snd_Regs;
+  const BYTE byMixer = pbyRegs[ 0x07 ];
+
+  /* A channel uses the envelope when bit 4 of its volume is set */
+  const bool bEnv = ( pbyRegs[ 0x08 ] | pbyRegs[ 0x09 ] | pbyRegs[ 0x0a ] ) & 0x10;
+  const bool bNoise = ( byMixer & 0x38 ) != 0x38;
+
+  for ( int i = 0; i < nSamples; ++i )
+  {
+    if ( bNoise )
+    {
+      Map69_Snd_NoiseIndex += Map69_Snd_NoiseSkip;
+      while ( Map69_Snd_NoiseIndex >= 0x10000 )
+      {
+        Map69_Snd_NoiseIndex -= 0x10000;
+        Map69_Snd_NoiseSr = ( Map69_Snd_NoiseSr >> 1 ) |
+                            ( ( ( Map69_Snd_NoiseSr ^ ( Map69_Snd_NoiseSr >> 3 ) ) & 1 ) << 16 );
+      }
+    }
+    if ( bEnv )
+    {
+      Map69_Snd_EnvIndex += Map69_Snd_EnvSkip;
+      while ( Map69_Snd_EnvIndex >= 0x10000 )
+      {
+        Map69_Snd_EnvIndex -= 0x10000;
+        Map69_Sound_Envelope();
+      }
+    }
+    int nEnv = Map69_Snd_EnvAttack ? Map69_Snd_EnvPos : 31 - Map69_Snd_EnvPos;
+    DWORD dwNoise = Map69_Snd_NoiseSr & 1;
+
+    int nLevel = 0;
+    for ( int nCh = 0; nCh < 3; ++nCh )
+    {
+      Map69_Snd_Index[ nCh ] += Map69_Snd_Skip[ nCh ];
+
+      /* Disabled tone or noise counts as high */
+      DWORD dwTone = ( Map69_Snd_Index[ nCh ] >> 31 ) | ( byMixer >> nCh );
+      DWORD dwHigh = dwTone & ( dwNoise | ( byMixer >> ( nCh + 3 ) ) ) & 1;
+      if ( dwHigh )
+      {
+        BYTE byVol = pbyRegs[ 0x08 + nCh ];
+        nLevel += Map69_Snd_Level[ ( byVol & 0x10 ) ? nEnv : ( byVol & 0x0f ) ? ( ( byVol & 0x0f ) << 1 ) + 1 : 0 ];
+      }
+    }
+    pbyWave[ i ] = nLevel;
+  }
+}
+
+const ApuExt_t Map69_5B = { Map69_Sound_Reset, Map69_Sound_Write, Map69_Sound_Render };
+
+void Map69_Sound_Init()
+{
+  InfoNES_pAPUSetExt( &Map69_5B );
+}
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 69 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map69_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map69_IRQ_Enable );
+  InfoNES_StateField( pState, Map69_IRQ_Cnt );
+  InfoNES_StateField( pState, Map69_Regs );
+  InfoNES_StateField( pState, Map69_Snd_Addr );
+  InfoNES_StateField( pState, Map69_Snd_Latch );
+
+  /* The chip's side is rebuilt from the registers */
+  if ( pState->byLoad )
+  {
+    for ( int nReg = 0; nReg < 0x0e; ++nReg )
+      InfoNES_pAPUWriteExt( nReg, Map69_Snd_Latch[ nReg ] );
+  }
+}
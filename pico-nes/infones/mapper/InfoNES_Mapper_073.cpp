@@ -125,3 +125,12 @@ void Map73_HSync()
   }
 #endif
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 73 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map73_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map73_IRQ_Enable );
+  InfoNES_StateField( pState, Map73_IRQ_Cnt );
+}
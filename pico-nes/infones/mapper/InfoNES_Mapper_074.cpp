@@ -342,3 +342,25 @@ void Map74_Set_PPU_Banks()
   }    
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 74 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map74_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map74_Regs );
+  InfoNES_StateField( pState, Map74_Rom_Bank );
+  InfoNES_StateField( pState, Map74_Prg0 );
+  InfoNES_StateField( pState, Map74_Prg1 );
+  InfoNES_StateField( pState, Map74_Chr01 );
+  InfoNES_StateField( pState, Map74_Chr23 );
+  InfoNES_StateField( pState, Map74_Chr4 );
+  InfoNES_StateField( pState, Map74_Chr5 );
+  InfoNES_StateField( pState, Map74_Chr6 );
+  InfoNES_StateField( pState, Map74_Chr7 );
+  InfoNES_StateField( pState, Map74_IRQ_Enable );
+  InfoNES_StateField( pState, Map74_IRQ_Cnt );
+  InfoNES_StateField( pState, Map74_IRQ_Latch );
+  InfoNES_StateField( pState, Map74_IRQ_Request );
+  InfoNES_StateField( pState, Map74_IRQ_Present );
+  InfoNES_StateField( pState, Map74_IRQ_Present_Vbl );
+}
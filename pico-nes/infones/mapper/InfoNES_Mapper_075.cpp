@@ -133,3 +133,11 @@ void Map75_Write( WORD wAddr, BYTE byData )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 75 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map75_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map75_Regs );
+}
@@ -118,3 +118,11 @@ void Map76_Write( WORD wAddr, BYTE byData )
       break;
   }  
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 76 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map76_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map76_Reg );
+}
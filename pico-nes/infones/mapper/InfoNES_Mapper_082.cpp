@@ -179,3 +179,11 @@ void Map82_Sram( WORD wAddr, BYTE byData )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 82 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map82_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map82_Regs );
+}
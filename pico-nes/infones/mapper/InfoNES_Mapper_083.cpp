@@ -313,3 +313,14 @@ void Map83_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 83 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map83_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map83_Regs );
+  InfoNES_StateField( pState, Map83_Chr_Bank );
+  InfoNES_StateField( pState, Map83_IRQ_Cnt );
+  InfoNES_StateField( pState, Map83_IRQ_Enabled );
+}
@@ -125,3 +125,11 @@ void Map88_Write( WORD wAddr, BYTE byData )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 88 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map88_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map88_Regs );
+}
@@ -412,3 +412,26 @@ void Map90_Sync_Prg_Banks( void )
       break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 90 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map90_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map90_Prg_Reg );
+  InfoNES_StateField( pState, Map90_Chr_Low_Reg );
+  InfoNES_StateField( pState, Map90_Chr_High_Reg );
+  InfoNES_StateField( pState, Map90_Nam_Low_Reg );
+  InfoNES_StateField( pState, Map90_Nam_High_Reg );
+  InfoNES_StateField( pState, Map90_Prg_Bank_Size );
+  InfoNES_StateField( pState, Map90_Prg_Bank_6000 );
+  InfoNES_StateField( pState, Map90_Prg_Bank_E000 );
+  InfoNES_StateField( pState, Map90_Chr_Bank_Size );
+  InfoNES_StateField( pState, Map90_Mirror_Mode );
+  InfoNES_StateField( pState, Map90_Mirror_Type );
+  InfoNES_StateField( pState, Map90_Value1 );
+  InfoNES_StateField( pState, Map90_Value2 );
+  InfoNES_StateField( pState, Map90_IRQ_Enable );
+  InfoNES_StateField( pState, Map90_IRQ_Cnt );
+  InfoNES_StateField( pState, Map90_IRQ_Latch );
+}
@@ -221,3 +221,19 @@ void Map95_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 95 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map95_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map95_Regs );
+  InfoNES_StateField( pState, Map95_Prg0 );
+  InfoNES_StateField( pState, Map95_Prg1 );
+  InfoNES_StateField( pState, Map95_Chr01 );
+  InfoNES_StateField( pState, Map95_Chr23 );
+  InfoNES_StateField( pState, Map95_Chr4 );
+  InfoNES_StateField( pState, Map95_Chr5 );
+  InfoNES_StateField( pState, Map95_Chr6 );
+  InfoNES_StateField( pState, Map95_Chr7 );
+}
@@ -99,3 +99,10 @@ void Map96_Set_Banks()
   InfoNES_SetupChr();
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 96 State Function                                         */
+/*-------------------------------------------------------------------*/
+void Map96_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map96_Reg );
+}
@@ -289,3 +289,25 @@ void Map100_Set_PPU_Banks()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 100 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map100_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map100_Reg );
+  InfoNES_StateField( pState, Map100_Prg0 );
+  InfoNES_StateField( pState, Map100_Prg1 );
+  InfoNES_StateField( pState, Map100_Prg2 );
+  InfoNES_StateField( pState, Map100_Prg3 );
+  InfoNES_StateField( pState, Map100_Chr0 );
+  InfoNES_StateField( pState, Map100_Chr1 );
+  InfoNES_StateField( pState, Map100_Chr2 );
+  InfoNES_StateField( pState, Map100_Chr3 );
+  InfoNES_StateField( pState, Map100_Chr4 );
+  InfoNES_StateField( pState, Map100_Chr5 );
+  InfoNES_StateField( pState, Map100_Chr6 );
+  InfoNES_StateField( pState, Map100_Chr7 );
+  InfoNES_StateField( pState, Map100_IRQ_Enable );
+  InfoNES_StateField( pState, Map100_IRQ_Cnt );
+  InfoNES_StateField( pState, Map100_IRQ_Latch );
+}
@@ -165,3 +165,15 @@ void Map105_HSync()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 105 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map105_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map105_Init_State );
+  InfoNES_StateField( pState, Map105_Write_Count );
+  InfoNES_StateField( pState, Map105_Bits );
+  InfoNES_StateField( pState, Map105_Reg );
+  InfoNES_StateField( pState, Map105_IRQ_Enable );
+  InfoNES_StateField( pState, Map105_IRQ_Counter );
+}
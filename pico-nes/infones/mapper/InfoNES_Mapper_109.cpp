@@ -132,3 +132,17 @@ void Map109_Set_PPU_Banks()
     InfoNES_SetupChr();
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 109 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map109_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map109_Reg );
+  InfoNES_StateField( pState, Map109_Chr0 );
+  InfoNES_StateField( pState, Map109_Chr1 );
+  InfoNES_StateField( pState, Map109_Chr2 );
+  InfoNES_StateField( pState, Map109_Chr3 );
+  InfoNES_StateField( pState, Map109_Chrmode0 );
+  InfoNES_StateField( pState, Map109_Chrmode1 );
+}
@@ -140,3 +140,12 @@ void Map110_Apu( WORD wAddr, BYTE byData )
     break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 110 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map110_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map110_Reg0 );
+  InfoNES_StateField( pState, Map110_Reg1 );
+}
@@ -298,3 +298,22 @@ void Map112_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 112 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map112_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map112_Regs );
+  InfoNES_StateField( pState, Map112_Prg0 );
+  InfoNES_StateField( pState, Map112_Prg1 );
+  InfoNES_StateField( pState, Map112_Chr01 );
+  InfoNES_StateField( pState, Map112_Chr23 );
+  InfoNES_StateField( pState, Map112_Chr4 );
+  InfoNES_StateField( pState, Map112_Chr5 );
+  InfoNES_StateField( pState, Map112_Chr6 );
+  InfoNES_StateField( pState, Map112_Chr7 );
+  InfoNES_StateField( pState, Map112_IRQ_Enable );
+  InfoNES_StateField( pState, Map112_IRQ_Cnt );
+  InfoNES_StateField( pState, Map112_IRQ_Latch );
+}
@@ -333,3 +333,22 @@ void Map114_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 114 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map114_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map114_Regs );
+  InfoNES_StateField( pState, Map114_Prg0 );
+  InfoNES_StateField( pState, Map114_Prg1 );
+  InfoNES_StateField( pState, Map114_Chr01 );
+  InfoNES_StateField( pState, Map114_Chr23 );
+  InfoNES_StateField( pState, Map114_Chr4 );
+  InfoNES_StateField( pState, Map114_Chr5 );
+  InfoNES_StateField( pState, Map114_Chr6 );
+  InfoNES_StateField( pState, Map114_Chr7 );
+  InfoNES_StateField( pState, Map114_IRQ_Enable );
+  InfoNES_StateField( pState, Map114_IRQ_Cnt );
+  InfoNES_StateField( pState, Map114_IRQ_Latch );
+}
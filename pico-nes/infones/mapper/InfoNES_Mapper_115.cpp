@@ -266,3 +266,29 @@ void Map115_Set_PPU_Banks()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 115 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map115_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map115_Reg );
+  InfoNES_StateField( pState, Map115_Prg0 );
+  InfoNES_StateField( pState, Map115_Prg1 );
+  InfoNES_StateField( pState, Map115_Prg2 );
+  InfoNES_StateField( pState, Map115_Prg3 );
+  InfoNES_StateField( pState, Map115_Prg0L );
+  InfoNES_StateField( pState, Map115_Prg1L );
+  InfoNES_StateField( pState, Map115_Chr0 );
+  InfoNES_StateField( pState, Map115_Chr1 );
+  InfoNES_StateField( pState, Map115_Chr2 );
+  InfoNES_StateField( pState, Map115_Chr3 );
+  InfoNES_StateField( pState, Map115_Chr4 );
+  InfoNES_StateField( pState, Map115_Chr5 );
+  InfoNES_StateField( pState, Map115_Chr6 );
+  InfoNES_StateField( pState, Map115_Chr7 );
+  InfoNES_StateField( pState, Map115_IRQ_Enable );
+  InfoNES_StateField( pState, Map115_IRQ_Counter );
+  InfoNES_StateField( pState, Map115_IRQ_Latch );
+  InfoNES_StateField( pState, Map115_ExPrgSwitch );
+  InfoNES_StateField( pState, Map115_ExChrSwitch );
+}
@@ -237,3 +237,29 @@ void Map116_Set_PPU_Banks()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 116 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map116_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map116_Reg );
+  InfoNES_StateField( pState, Map116_Prg0 );
+  InfoNES_StateField( pState, Map116_Prg1 );
+  InfoNES_StateField( pState, Map116_Prg2 );
+  InfoNES_StateField( pState, Map116_Prg3 );
+  InfoNES_StateField( pState, Map116_Prg0L );
+  InfoNES_StateField( pState, Map116_Prg1L );
+  InfoNES_StateField( pState, Map116_Chr0 );
+  InfoNES_StateField( pState, Map116_Chr1 );
+  InfoNES_StateField( pState, Map116_Chr2 );
+  InfoNES_StateField( pState, Map116_Chr3 );
+  InfoNES_StateField( pState, Map116_Chr4 );
+  InfoNES_StateField( pState, Map116_Chr5 );
+  InfoNES_StateField( pState, Map116_Chr6 );
+  InfoNES_StateField( pState, Map116_Chr7 );
+  InfoNES_StateField( pState, Map116_IRQ_Enable );
+  InfoNES_StateField( pState, Map116_IRQ_Counter );
+  InfoNES_StateField( pState, Map116_IRQ_Latch );
+  InfoNES_StateField( pState, Map116_ExPrgSwitch );
+  InfoNES_StateField( pState, Map116_ExChrSwitch );
+}
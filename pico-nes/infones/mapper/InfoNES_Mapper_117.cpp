@@ -165,3 +165,13 @@ void Map117_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 117 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map117_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map117_IRQ_Line );
+  InfoNES_StateField( pState, Map117_IRQ_Enable1 );
+  InfoNES_StateField( pState, Map117_IRQ_Enable2 );
+}
@@ -283,3 +283,24 @@ void Map118_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 118 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map118_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map118_Regs );
+  InfoNES_StateField( pState, Map118_Prg0 );
+  InfoNES_StateField( pState, Map118_Prg1 );
+  InfoNES_StateField( pState, Map118_Chr0 );
+  InfoNES_StateField( pState, Map118_Chr1 );
+  InfoNES_StateField( pState, Map118_Chr2 );
+  InfoNES_StateField( pState, Map118_Chr3 );
+  InfoNES_StateField( pState, Map118_Chr4 );
+  InfoNES_StateField( pState, Map118_Chr5 );
+  InfoNES_StateField( pState, Map118_Chr6 );
+  InfoNES_StateField( pState, Map118_Chr7 );
+  InfoNES_StateField( pState, Map118_IRQ_Enable );
+  InfoNES_StateField( pState, Map118_IRQ_Cnt );
+  InfoNES_StateField( pState, Map118_IRQ_Latch );
+}
@@ -247,3 +247,22 @@ void Map119_Set_PPU_Banks()
   InfoNES_SetupChr();
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 119 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map119_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map119_Reg );
+  InfoNES_StateField( pState, Map119_Prg0 );
+  InfoNES_StateField( pState, Map119_Prg1 );
+  InfoNES_StateField( pState, Map119_Chr01 );
+  InfoNES_StateField( pState, Map119_Chr23 );
+  InfoNES_StateField( pState, Map119_Chr4 );
+  InfoNES_StateField( pState, Map119_Chr5 );
+  InfoNES_StateField( pState, Map119_Chr6 );
+  InfoNES_StateField( pState, Map119_Chr7 );
+  InfoNES_StateField( pState, Map119_WeSram );
+  InfoNES_StateField( pState, Map119_IRQ_Enable );
+  InfoNES_StateField( pState, Map119_IRQ_Counter );
+  InfoNES_StateField( pState, Map119_IRQ_Latch );
+}
@@ -111,3 +111,13 @@ void Map134_Apu( WORD wAddr, BYTE byData )
 
   //Map134_Wram[ wAddr & 0x1fff ] = byData;
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 134 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map134_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map134_Cmd );
+  InfoNES_StateField( pState, Map134_Prg );
+  InfoNES_StateField( pState, Map134_Chr );
+}
@@ -129,3 +129,16 @@ void	Map135_Set_PPU_Banks()
   PPUBANK[ 7 ] = VROMPAGE( (((1|(Map135_Chr1h<<1)|(Map135_Chrch<<4))<<1) + 1) % (NesHeader.byVRomSize << 3) );
   InfoNES_SetupChr();
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 135 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map135_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map135_Cmd );
+  InfoNES_StateField( pState, Map135_Chr0l );
+  InfoNES_StateField( pState, Map135_Chr1l );
+  InfoNES_StateField( pState, Map135_Chr0h );
+  InfoNES_StateField( pState, Map135_Chr1h );
+  InfoNES_StateField( pState, Map135_Chrch );
+}
@@ -309,3 +309,14 @@ void Map160_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 160 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map160_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map160_IRQ_Enable );
+  InfoNES_StateField( pState, Map160_IRQ_Cnt );
+  InfoNES_StateField( pState, Map160_IRQ_Latch );
+  InfoNES_StateField( pState, Map160_Refresh_Type );
+}
@@ -171,3 +171,13 @@ void Map182_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 182 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map182_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map182_Regs );
+  InfoNES_StateField( pState, Map182_IRQ_Enable );
+  InfoNES_StateField( pState, Map182_IRQ_Cnt );
+}
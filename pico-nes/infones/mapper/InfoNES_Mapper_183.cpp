@@ -226,3 +226,13 @@ void Map183_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 183 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map183_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map183_Reg );
+  InfoNES_StateField( pState, Map183_IRQ_Enable );
+  InfoNES_StateField( pState, Map183_IRQ_Counter );
+}
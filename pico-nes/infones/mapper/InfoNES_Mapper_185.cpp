@@ -86,3 +86,11 @@ void Map185_Write( WORD wAddr, BYTE byData )
     InfoNES_SetupChr();
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 185 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map185_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateRegion( pState, Map185_Dummy_Chr_Rom, sizeof Map185_Dummy_Chr_Rom );
+}
@@ -291,3 +291,21 @@ void Map187_Set_PPU_Banks()
   PPUBANK[ 7 ] = VROMPAGE(((Map187_Chr[7]<<3)+7) % (NesHeader.byVRomSize<<3));
   InfoNES_SetupChr();
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 187 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map187_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map187_Prg );
+  InfoNES_StateField( pState, Map187_Chr );
+  InfoNES_StateField( pState, Map187_Bank );
+  InfoNES_StateField( pState, Map187_ExtMode );
+  InfoNES_StateField( pState, Map187_ChrMode );
+  InfoNES_StateField( pState, Map187_ExtEnable );
+  InfoNES_StateField( pState, Map187_IRQ_Enable );
+  InfoNES_StateField( pState, Map187_IRQ_Counter );
+  InfoNES_StateField( pState, Map187_IRQ_Latch );
+  InfoNES_StateField( pState, Map187_IRQ_Occur );
+  InfoNES_StateField( pState, Map187_LastWrite );
+}
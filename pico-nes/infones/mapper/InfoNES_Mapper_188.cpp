@@ -93,3 +93,11 @@ void Map188_Write( WORD wAddr, BYTE byData )
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 188 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map188_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateRegion( pState, Map188_Dummy, sizeof Map188_Dummy );
+}
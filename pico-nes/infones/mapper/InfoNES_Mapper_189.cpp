@@ -183,3 +183,14 @@ void Map189_HSync()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 189 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map189_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map189_Regs );
+  InfoNES_StateField( pState, Map189_IRQ_Cnt );
+  InfoNES_StateField( pState, Map189_IRQ_Latch );
+  InfoNES_StateField( pState, Map189_IRQ_Enable );
+}
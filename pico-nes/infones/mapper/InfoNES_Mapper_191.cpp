@@ -139,3 +139,18 @@ void	Map191_Set_PPU_Banks()
     InfoNES_SetupChr();
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 191 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map191_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map191_Reg );
+  InfoNES_StateField( pState, Map191_Prg0 );
+  InfoNES_StateField( pState, Map191_Prg1 );
+  InfoNES_StateField( pState, Map191_Chr0 );
+  InfoNES_StateField( pState, Map191_Chr1 );
+  InfoNES_StateField( pState, Map191_Chr2 );
+  InfoNES_StateField( pState, Map191_Chr3 );
+  InfoNES_StateField( pState, Map191_Highbank );
+}
@@ -93,3 +93,11 @@ void Map226_Write( WORD wAddr, BYTE byData )
     ROMBANK3 = ROMPAGE(((byBank<<2)+3) % (NesHeader.byRomSize<<1));
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 226 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map226_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map226_Reg );
+}
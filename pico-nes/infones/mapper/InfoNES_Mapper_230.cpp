@@ -92,3 +92,11 @@ void Map230_Write( WORD wAddr, BYTE byData )
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 230 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map230_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map230_RomSw );
+}
@@ -71,3 +71,11 @@ void Map232_Write( WORD wAddr, BYTE byData )
   ROMBANK2= ROMPAGE((((Map232_Regs[0]|0x03)<<1)+0) % (NesHeader.byRomSize<<1));
   ROMBANK3= ROMPAGE((((Map232_Regs[0]|0x03)<<1)+1) % (NesHeader.byRomSize<<1));
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 232 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map232_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map232_Regs );
+}
@@ -111,4 +111,10 @@ void Map234_Set_Banks()
   InfoNES_SetupChr();
 }
 
-
+/*-------------------------------------------------------------------*/
+/*  Mapper 234 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map234_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map234_Reg );
+}
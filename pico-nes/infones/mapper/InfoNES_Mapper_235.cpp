@@ -124,3 +124,10 @@ void Map235_Write( WORD wAddr, BYTE byData )
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 235 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map235_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateRegion( pState, DRAM, DRAM_SIZE );
+}
@@ -103,3 +103,12 @@ void Map236_Write( WORD wAddr, BYTE byData )
     break;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 236 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map236_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map236_Bank );
+  InfoNES_StateField( pState, Map236_Mode );
+}
@@ -131,3 +131,11 @@ void Map243_Apu( WORD wAddr, BYTE byData )
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 243 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map243_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map243_Regs );
+}
@@ -229,3 +229,24 @@ void SetBank_PPU()
   }
 }
 #endif
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 245 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map245_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map245_Reg );
+  InfoNES_StateField( pState, Map245_Prg0 );
+  InfoNES_StateField( pState, Map245_Prg1 );
+  InfoNES_StateField( pState, Map245_Chr01 );
+  InfoNES_StateField( pState, Map245_Chr23 );
+  InfoNES_StateField( pState, Map245_Chr4 );
+  InfoNES_StateField( pState, Map245_Chr5 );
+  InfoNES_StateField( pState, Map245_Chr6 );
+  InfoNES_StateField( pState, Map245_Chr7 );
+  InfoNES_StateField( pState, Map245_WeSram );
+  InfoNES_StateField( pState, Map245_IRQ_Enable );
+  InfoNES_StateField( pState, Map245_IRQ_Counter );
+  InfoNES_StateField( pState, Map245_IRQ_Latch );
+  InfoNES_StateField( pState, Map245_IRQ_Request );
+}
@@ -233,3 +233,24 @@ void Map248_Set_PPU_Banks()
     }
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 248 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map248_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map248_Reg );
+  InfoNES_StateField( pState, Map248_Prg0 );
+  InfoNES_StateField( pState, Map248_Prg1 );
+  InfoNES_StateField( pState, Map248_Chr01 );
+  InfoNES_StateField( pState, Map248_Chr23 );
+  InfoNES_StateField( pState, Map248_Chr4 );
+  InfoNES_StateField( pState, Map248_Chr5 );
+  InfoNES_StateField( pState, Map248_Chr6 );
+  InfoNES_StateField( pState, Map248_Chr7 );
+  InfoNES_StateField( pState, Map248_WeSram );
+  InfoNES_StateField( pState, Map248_IRQ_Enable );
+  InfoNES_StateField( pState, Map248_IRQ_Counter );
+  InfoNES_StateField( pState, Map248_IRQ_Latch );
+  InfoNES_StateField( pState, Map248_IRQ_Request );
+}
@@ -323,3 +323,15 @@ void Map249_HSync()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 249 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map249_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map249_Spdata );
+  InfoNES_StateField( pState, Map249_Reg );
+  InfoNES_StateField( pState, Map249_IRQ_Enable );
+  InfoNES_StateField( pState, Map249_IRQ_Counter );
+  InfoNES_StateField( pState, Map249_IRQ_Latch );
+  InfoNES_StateField( pState, Map249_IRQ_Request );
+}
@@ -153,3 +153,12 @@ void Map251_Set_Banks()
     ROMBANK3 = ROMPAGE(nPrg[3] % (NesHeader.byRomSize<<1));
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 251 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map251_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map251_Reg );
+  InfoNES_StateField( pState, Map251_Breg );
+}
@@ -216,3 +216,15 @@ void Map252_HSync()
   }
 }
 
+/*-------------------------------------------------------------------*/
+/*  Mapper 252 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map252_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map252_Reg );
+  InfoNES_StateField( pState, Map252_IRQ_Enable );
+  InfoNES_StateField( pState, Map252_IRQ_Counter );
+  InfoNES_StateField( pState, Map252_IRQ_Latch );
+  InfoNES_StateField( pState, Map252_IRQ_Occur );
+  InfoNES_StateField( pState, Map252_IRQ_Clock );
+}
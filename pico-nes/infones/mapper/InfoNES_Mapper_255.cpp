@@ -131,3 +131,11 @@ BYTE Map255_ReadApu( WORD wAddr )
     return	wAddr>>8;
   }
 }
+
+/*-------------------------------------------------------------------*/
+/*  Mapper 255 State Function                                        */
+/*-------------------------------------------------------------------*/
+void Map255_State( struct InfoNES_State_tag *pState )
+{
+  InfoNES_StateField( pState, Map255_Reg );
+}
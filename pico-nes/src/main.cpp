@@ -1,11 +1,13 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdarg>
+#include <atomic>
 
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
 #include "hardware/vreg.h"
 #include "hardware/watchdog.h"
 #include <hardware/sync.h>
@@ -15,15 +17,17 @@
 
 #include <InfoNES.h>
 #include <InfoNES_System.h>
+#include <InfoNES_pAPU.h>
 
 #include "InfoNES_Mapper.h"
 
 #include "graphics.h"
 
 #include "audio.h"
+#include "audio_pwm.h"
 
 #ifdef TUFTY2350
-#include "rom_table.h"
+#include "rom_pack.h"
 #endif
 
 #ifndef TUFTY2350
@@ -61,11 +65,16 @@ uint32_t get_rom4prog() { return (uint32_t)rom; }
 #endif // !TUFTY2350
 
 #ifdef TUFTY2350
-// Multi-ROM support - pointer set by ROM selector menu
+// Multi-ROM support - the ROM pack ( tools/convert_roms.py ) is flashed on
+// its own at ROM_PACK_OFFSET, the pointer is set by the ROM selector menu
+#define ROM_PACK_LIMIT (FLASH_SIZE * 1024 - ROM_PACK_OFFSET)
+static const rom_pack_header_t* rom_pack = nullptr;
 static int current_rom_index = 0;
-const uint8_t* rom = rom_table[0].data;
-size_t get_rom4prog_size() { return rom_table[current_rom_index].size; }
+const uint8_t* rom = nullptr;
+size_t get_rom4prog_size() { return rom ? rom_pack_index(rom_pack)[current_rom_index].size : 0; }
 uint32_t get_rom4prog() { return (uint32_t)rom; }
+// Banks packed one LZ4 block each ( convert_roms.py --lz4 ), for ROM_LZ4 builds
+static bool rom_is_lz4() { return rom && rom_pack_index(rom_pack)[current_rom_index].flags & ROM_PACK_LZ4; }
 #endif
 
 bool cursor_blink_state = false;
@@ -86,8 +95,33 @@ enum menu_type_e {
 };
 
 struct semaphore vga_start_semaphore;
-uint8_t SCREEN[NES_DISP_HEIGHT][NES_DISP_WIDTH]; // 61440 bytes
-uint16_t linebuffer[256];
+
+// Triple-buffered frame store: core0 renders into one buffer, core1 pushes
+// another to the LCD, the third holds the newest complete frame.
+#define FRAME_BUFFERS 3
+#define FRAME_INDEX   0x3
+#define FRAME_FRESH   0x4
+uint8_t FRAMES[FRAME_BUFFERS][NES_DISP_HEIGHT][NES_DISP_WIDTH]; // 3 * 61440 bytes
+// First buffer, also the text mode buffer
+uint8_t (&SCREEN)[NES_DISP_HEIGHT][NES_DISP_WIDTH] = FRAMES[0];
+
+// Newest complete frame ( index | FRAME_FRESH until core1 takes it )
+static std::atomic<uint32_t> frame_ready { 1 };
+static uint32_t frame_render = 0; // core0 only
+static uint32_t frame_shown = 2;  // core1 only
+static uint64_t frame_done_us[FRAME_BUFFERS];
+// st7789_line_hash() of every rendered line, for changed-line LCD updates
+static uint32_t frame_line_hash[FRAME_BUFFERS][NES_DISP_HEIGHT];
+
+// Emulation-to-glass latency: frame completed on core0 -> last pixel sent
+struct frame_stats_t {
+    uint32_t shown;
+    uint32_t dropped;
+    uint32_t latency_us;
+    uint32_t latency_avg_us;
+    uint32_t latency_max_us;
+};
+frame_stats_t frame_stats;
 
 SETTINGS settings = {
     .version = 3,
@@ -426,18 +460,15 @@ extern "C" {
 #endif
 
 inline bool checkNESMagic(const uint8_t* data) {
-    bool ok = false;
-    int nIdx;
-    if (memcmp(data, "NES\x1a", 4) == 0) {
-        uint8_t MapperNo = *(data + 6) >> 4;
-        for (nIdx = 0; MapperTable[nIdx].nMapperNo != -1; ++nIdx) {
-            if (MapperTable[nIdx].nMapperNo == MapperNo) {
-                ok = true;
-                break;
-            }
-        }
+    if (memcmp(data, "NES\x1a", 4) != 0) {
+        return false;
+    }
+    // The ROM database's mapper, else the header's as InfoNES_Reset() reads it
+    int MapperNo = RomInfo.byKnown ? RomInfo.wMapperNo : data[6] >> 4;
+    if (!RomInfo.byKnown && !data[12] && !data[13] && !data[14] && !data[15]) {
+        MapperNo |= data[7] & 0xf0;
     }
-    return ok;
+    return MapperNo <= 0xff && InfoNES_GetMapper(MapperNo)->pMapperInit;
 }
 
 static int rapidFireMask = 0;
@@ -495,12 +526,47 @@ void InfoNES_Error(const char* pszMsg, ...) {
 
 bool parseROM(const uint8_t* nesFile) {
     memcpy(&NesHeader, nesFile, sizeof(NesHeader));
+#ifdef TUFTY2350
+    // Mapper and mirroring from the pack's ROM database, whatever the header says
+    RomInfo = {};
+    const rom_db_record_t* record =
+        rom ? rom_pack_db_find(rom_pack, rom_pack_index(rom_pack)[current_rom_index].crc32) : nullptr;
+    if (record) {
+        RomInfo.byKnown = 1;
+        RomInfo.byMirroring = record->mirroring;
+        RomInfo.wMapperNo = record->mapper;
+        RomInfo.byBattery = record->flags & ROM_DB_BATTERY ? 1 : 0;
+        RomInfo.dwQuirks = record->flags >> ROM_DB_QUIRKS_SHIFT;
+    }
+#endif
     if (!checkNESMagic(NesHeader.byID)) {
         return false;
     }
+#ifdef TUFTY2350
+    if (rom_is_lz4()) {
+#ifdef ROM_LZ4
+        // PRG and CHR stay packed in flash, InfoNES_RomPage() decodes them on demand
+        memset(SRAM, 0, SRAM_SIZE);
+        if (NesHeader.byInfo1 & 4) {
+            memcpy(&SRAM[0x1000], nesFile + sizeof(NesHeader), 512);
+        }
+        ROM = nullptr;
+        VROM = nullptr;
+        return InfoNES_RomCacheOpen(nesFile, get_rom4prog_size()) == 0;
+#else
+        return false;
+#endif
+    }
+#endif
+    // The header must not point past the image
+    const size_t trainer = NesHeader.byInfo1 & 4 ? 512 : 0;
+    if (sizeof(NesHeader) + trainer + NesHeader.byRomSize * 0x4000 + NesHeader.byVRomSize * 0x2000 >
+        get_rom4prog_size()) {
+        return false;
+    }
     nesFile += sizeof(NesHeader);
     memset(SRAM, 0, SRAM_SIZE);
-    if (NesHeader.byInfo1 & 4) {
+    if (trainer) {
         memcpy(&SRAM[0x1000], nesFile, 512);
         nesFile += 512;
     }
@@ -516,65 +582,137 @@ bool parseROM(const uint8_t* nesFile) {
 }
 
 void InfoNES_ReleaseRom() {
+    RomInfo = {};
+#ifdef ROM_LZ4
+    InfoNES_RomCacheClose();
+#endif
     ROM = nullptr;
     VROM = nullptr;
 }
 
+// Audio goes out over I2S, or on Tufty over the PWM backend when a pin is given
+#if !defined(TUFTY2350) || defined(PWM_AUDIO_PIN)
+#define AUDIO_OUTPUT
+#endif
+
+#ifdef AUDIO_OUTPUT
+// Emulation pushes here, the output DMA IRQ drains it ( drivers/audio/audio_ring.h )
+#define AUDIO_RING_FRAMES 4096
+static audio_frame_t audio_ring_buf[AUDIO_RING_FRAMES];
+static audio_ring_t audio_ring;
+static audio_rate_t audio_rate;
+static audio_mix_t audio_mixer;
+#ifdef TUFTY2350
+static pwm_audio_config_t pwm_audio_config;
+#endif
+static bool audio_started = false;
+#endif
+
 void InfoNES_SoundInit() {
+}
+
+int InfoNES_SoundOpen(int samples_per_sync, int sample_rate) {
+#ifdef AUDIO_OUTPUT
+    // Called on every reset; the backend keeps running across them
+    if (audio_started) {
+        return 0;
+    }
+    audio_started = true;
+
+    // The APU runs at sample_rate ( 1789773 / 40 or / 80 ); the ring
+    // carries AUDIO_OUTPUT_RATE ( APU_RATE ), one DMA block per frame
+    const uint16_t block = (uint16_t)(AUDIO_OUTPUT_RATE / 60);
 #ifndef TUFTY2350
     i2s_config = i2s_get_default_config();
-    i2s_config.sample_freq = 44100;
-    i2s_config.dma_trans_count = (uint16_t)i2s_config.sample_freq / 60;
+    i2s_config.sample_freq = AUDIO_OUTPUT_RATE;
+    i2s_config.dma_trans_count = block;
     i2s_volume(&i2s_config, 0);
     i2s_init(&i2s_config);
+#else
+    pwm_audio_config.pin = PWM_AUDIO_PIN;
+    pwm_audio_config.sample_freq = AUDIO_OUTPUT_RATE;
+    pwm_audio_config.dma_trans_count = block;
+    pwm_audio_init(&pwm_audio_config);
 #endif
-}
 
-int InfoNES_SoundOpen(int samples_per_sync, int sample_rate) {
+    audio_mix_init(&audio_mixer);
+    audio_mixer.volume = settings.snd_vol;
+
+    // Hold two DMA blocks ( ~33 ms ) in the ring: a long frame is covered.
+    // The resampler makes AUDIO_OUTPUT_RATE / refresh frames out of every
+    // emulated frame, so only the clock errors are left to the controller
+    audio_ring_init(&audio_ring, audio_ring_buf, AUDIO_RING_FRAMES);
+    audio_rate_init(&audio_rate, 2 * block);
+    audio_rate_set_ratio(&audio_rate, (uint64_t)ApuSamplesPerSync16 * (SCAN_VBLANK_END + 1), AUDIO_OUTPUT_RATE,
+                         AUDIO_REFRESH_MHZ);
+#ifndef TUFTY2350
+    i2s_dma_start_ring(&i2s_config, &audio_ring);
+#else
+    pwm_audio_start(&pwm_audio_config, &audio_ring);
+#endif
+#endif
     return 0;
 }
 
 void InfoNES_SoundClose() {
 }
 
-#define buffermax ((44100 / 60)*2)
+// Two frames at the output rate: caps the samples one scanline may ask for
+#define buffermax ((AUDIO_OUTPUT_RATE / 60) * 2)
 int __not_in_flash_func(InfoNES_GetSoundBufferSize)() { return buffermax; }
 
+// DPCM prefetch ( InfoNES_pAPU.cpp ): one DMA channel copies samples out
+// of XIP flash while the CPU keeps emulating
+static int prefetch_dma = -1;
+
+void __not_in_flash_func(InfoNES_PrefetchStart)(void* dest, const void* src, int count) {
+    if (prefetch_dma < 0) {
+        prefetch_dma = dma_claim_unused_channel(true);
+    }
+    dma_channel_wait_for_finish_blocking(prefetch_dma);
+    dma_channel_config c = dma_channel_get_default_config(prefetch_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    dma_channel_configure(prefetch_dma, &c, dest, src, count, true);
+}
+
+bool __not_in_flash_func(InfoNES_PrefetchBusy)() {
+    return prefetch_dma >= 0 && dma_channel_is_busy(prefetch_dma);
+}
+
 
 void InfoNES_SoundOutput(int samples, const BYTE* wave1, const BYTE* wave2, const BYTE* wave3, const BYTE* wave4,
-                         const BYTE* wave5) {
-#ifndef TUFTY2350
-    static int16_t samples_out[2][buffermax * 2];
-    static int i_active_buf = 0;
-    static int inx = 0;
-    for (int i = 0; i < samples; i++) {
-        int w1 = *wave1++;
-        int w2 = *wave2++;
-        int w3 = *wave3++;
-        int w4 = *wave4++;
-        int w5 = *wave5++;
-        int l = w1 * 6 + w2 * 3 + w3 * 5 + w4 * 3 * 17 + w5 * 2 * 32;
-        int r = w1 * 3 + w2 * 6 + w3 * 5 + w4 * 3 * 17 + w5 * 2 * 32;
-        l -= 4000;
-        r -= 4000;
-        samples_out[i_active_buf][inx * 2] = (int16_t)l * settings.snd_vol;
-        samples_out[i_active_buf][inx * 2 + 1] = (int16_t)r * settings.snd_vol;
-        if (inx++ >= i2s_config.dma_trans_count) {
-            inx = 0;
-            i2s_dma_write(&i2s_config, reinterpret_cast<const int16_t *>(samples_out[i_active_buf]));
-            i_active_buf ^= 1;
+                         const BYTE* wave5, const BYTE* wave6) {
+#ifdef AUDIO_OUTPUT
+    audio_frame_t frames[64];
+    while (samples > 0) {
+        const int n = samples < 64 ? samples : 64;
+        // Frames are the left / right int16 pair the mixer writes
+        audio_mix_run(&audio_mixer, n, wave1, wave2, wave3, wave4, wave5, wave6, (int16_t *)frames);
+        wave1 += n;
+        wave2 += n;
+        wave3 += n;
+        wave4 += n;
+        wave5 += n;
+        if (wave6) {
+            wave6 += n;
         }
+        // Never blocks: a full ring drops and counts, the DMA IRQ does the rest
+        audio_ring_push_rate(&audio_ring, &audio_rate, frames, n);
+        samples -= n;
     }
 #endif
-    // On Tufty: silently discard audio
+    // On Tufty without PWM_AUDIO_PIN: silently discard audio
 }
 
 void __not_in_flash_func(InfoNES_PreDrawLine)(int line) {
-    InfoNES_SetLineBuffer(linebuffer, NES_DISP_WIDTH);
+    // The PPU writes NES color indices straight into the frame row
+    InfoNES_SetLineBuffer(FRAMES[frame_render][line], NES_DISP_WIDTH);
 }
 
 void __not_in_flash_func(InfoNES_PostDrawLine)(int line) {
-    for (int x = 0; x < NES_DISP_WIDTH; x++) SCREEN[line][x] = (uint8_t)linebuffer[x];
+    frame_line_hash[frame_render][line] = st7789_line_hash(FRAMES[frame_render][line], NES_DISP_WIDTH);
 }
 
 /* Renderer loop on Pico's second core */
@@ -592,13 +730,33 @@ void __scratch_x("render") render_core() {
     graphics_set_flashmode(settings.flash_line, settings.flash_frame);
     sem_acquire_blocking(&vga_start_semaphore);
 
-    // 60 FPS loop
+    // Push each frame InfoNES_LoadFrame() completes; while no frames arrive
+    // ( text mode, menus ) redraw on the 60 Hz tick
 #define frame_tick (16666)
     uint64_t tick = time_us_64();
     uint64_t last_renderer_tick = tick;
     uint64_t last_input_tick = tick;
     while (true) {
-        if (tick >= last_renderer_tick + frame_tick) {
+        if (frame_ready.load(std::memory_order_relaxed) & FRAME_FRESH) {
+            frame_shown = frame_ready.exchange(frame_shown, std::memory_order_acq_rel) & FRAME_INDEX;
+            graphics_set_buffer(&FRAMES[frame_shown][0][0], NES_DISP_WIDTH, NES_DISP_HEIGHT);
+            refresh_lcd_lines(frame_line_hash[frame_shown]);
+
+            tick = time_us_64();
+            const uint32_t latency = tick - frame_done_us[frame_shown];
+            frame_stats.shown++;
+            frame_stats.latency_us = latency;
+            frame_stats.latency_avg_us += ((int32_t)latency - (int32_t)frame_stats.latency_avg_us) / 16;
+            if (latency > frame_stats.latency_max_us)
+                frame_stats.latency_max_us = latency;
+            if (settings.show_fps && frame_stats.shown % 600 == 0) {
+                printf("lcd: %lu shown, %lu dropped, latency %lu us ( avg %lu, max %lu )\n",
+                       frame_stats.shown, frame_stats.dropped, frame_stats.latency_us,
+                       frame_stats.latency_avg_us, frame_stats.latency_max_us);
+            }
+            last_renderer_tick = tick;
+        }
+        else if (tick >= last_renderer_tick + frame_tick) {
             refresh_lcd();
             last_renderer_tick = tick;
         }
@@ -617,6 +775,10 @@ void __scratch_x("render") render_core() {
         }
         tick = time_us_64();
 
+#ifdef APU_THREAD
+        // The APU channels are synthesized here from core0's write log
+        InfoNES_pAPUProcess();
+#endif
         tuh_task();
         tight_loop_contents();
     }
@@ -630,6 +792,15 @@ bool filebrowser_loadfile(const char pathname[256]) { return false; }
 #endif
 
 #ifdef TUFTY2350
+// Rows 6 .. 26 of the text screen list the ROMs, the rest scroll
+#define ROM_MENU_ROWS 21
+
+// The entry's mapper is the ROM database's, so this is what InfoNES_Reset() will look up
+static const MapperDesc_tag* rom_mapper(const rom_pack_entry_t& entry) {
+    const MapperDesc_tag* mapper = entry.mapper <= 0xff ? InfoNES_GetMapper(entry.mapper) : nullptr;
+    return mapper && mapper->pMapperInit ? mapper : nullptr;
+}
+
 int tufty_rom_select() {
     graphics_set_mode(TEXTMODE_DEFAULT);
     sleep_ms(50);
@@ -637,11 +808,32 @@ int tufty_rom_select() {
     // Clear the text buffer
     memset(&SCREEN[0][0], 0, sizeof(SCREEN));
 
-    int sel = 0;
+    // The pack is flashed separately from the firmware, it may be missing
+    if (!rom_pack) {
+        rom_pack = rom_pack_open(reinterpret_cast<const void *>(XIP_BASE + ROM_PACK_OFFSET), ROM_PACK_LIMIT);
+    }
+    if (!rom_pack || !rom_pack->count) {
+        draw_text("NES ROM Selector", 18, 2, 15, 0);
+        draw_text("No ROM pack in flash", 16, 8, 12, 0);
+        draw_text("Run ./flash_tufty.sh --roms", 13, 10, 7, 0);
+        while (true) {
+            sleep_ms(1000);
+        }
+    }
+    const rom_pack_entry_t* index = rom_pack_index(rom_pack);
+    const int count = rom_pack->count;
+
+    int sel = current_rom_index < count ? current_rom_index : 0;
+    int first = 0;
     bool redraw = true;
+    const char* status = nullptr;
 
     while (true) {
         if (redraw) {
+            // Keep the selection on screen
+            if (sel < first) first = sel;
+            if (sel >= first + ROM_MENU_ROWS) first = sel - ROM_MENU_ROWS + 1;
+
             // Clear screen
             memset(&SCREEN[0][0], 0, sizeof(SCREEN));
 
@@ -655,21 +847,36 @@ int tufty_rom_select() {
             draw_text(sep, 10, 4, 7, 0);
 
             // ROM list
-            for (int i = 0; i < ROM_COUNT; i++) {
+            for (int i = first; i < count && i < first + ROM_MENU_ROWS; i++) {
                 char line[TEXTMODE_COLS + 1];
                 memset(line, 0, sizeof(line));
 
                 if (i == sel) {
-                    snprintf(line, sizeof(line), "> %s", rom_table[i].name);
-                    draw_text(line, 8, 6 + i, 14, 1);  // yellow on blue
+                    snprintf(line, sizeof(line) - 8, "> %s", index[i].name);
+                    draw_text(line, 8, 6 + i - first, 14, 1);  // yellow on blue
                 } else {
-                    snprintf(line, sizeof(line), "  %s", rom_table[i].name);
-                    draw_text(line, 8, 6 + i, 15, 0);  // white on black
+                    snprintf(line, sizeof(line) - 8, "  %s", index[i].name);
+                    // white on black, dark grey when the mapper is not supported
+                    draw_text(line, 8, 6 + i - first, rom_mapper(index[i]) ? 15 : 8, 0);
                 }
             }
 
-            // Instructions
-            draw_text("A=Select  UP/DOWN=Navigate", 13, 28, 7, 0);
+            // The selected game's mapper
+            char info[TEXTMODE_COLS + 1];
+            if (const MapperDesc_tag* mapper = rom_mapper(index[sel])) {
+                snprintf(info, sizeof(info) - 13, "Mapper %d %s", index[sel].mapper, mapper->pszName);
+                draw_text(info, 13, 27, 7, 0);
+            } else {
+                snprintf(info, sizeof(info) - 13, "Mapper %d not supported", index[sel].mapper);
+                draw_text(info, 13, 27, 12, 0);
+            }
+
+            // Instructions, or why the last pick did not start
+            if (status) {
+                draw_text(status, 13, 28, 12, 0);
+            } else {
+                draw_text("A=Select  UP/DOWN=Navigate", 13, 28, 7, 0);
+            }
 
             redraw = false;
         }
@@ -684,25 +891,39 @@ int tufty_rom_select() {
 
         if (btn_up) {
             if (sel > 0) sel--;
-            else sel = ROM_COUNT - 1;
+            else sel = count - 1;
+            status = nullptr;
             redraw = true;
             sleep_ms(200);
         }
         if (btn_down) {
-            if (sel < ROM_COUNT - 1) sel++;
+            if (sel < count - 1) sel++;
             else sel = 0;
+            status = nullptr;
             redraw = true;
             sleep_ms(200);
         }
         if (btn_a) {
             sleep_ms(200);
-            break;
+            // A pack flashed halfway is caught here rather than crashing the game
+            if (!rom_mapper(index[sel])) {
+                status = "Mapper not supported";
+            } else if (!rom_pack_verify(rom_pack, index[sel])) {
+                status = "CRC error, reflash the ROM pack";
+#ifndef ROM_LZ4
+            } else if (index[sel].flags & ROM_PACK_LZ4) {
+                status = "LZ4 pack, build with ROM_LZ4=ON";
+#endif
+            } else {
+                break;
+            }
+            redraw = true;
         }
     }
 
     // Set the selected ROM
     current_rom_index = sel;
-    rom = rom_table[sel].data;
+    rom = rom_pack_image(rom_pack, index[sel]);
 
     // Switch back to graphics mode
     graphics_set_mode(GRAPHICSMODE_DEFAULT);
@@ -752,6 +973,13 @@ void lock_start() {}
 #endif
 
 int InfoNES_LoadFrame() {
+    // Publish the finished frame and take the free buffer back. A frame
+    // core1 never picked up is replaced by this one.
+    frame_done_us[frame_render] = time_us_64();
+    const uint32_t prev = frame_ready.exchange(frame_render | FRAME_FRESH, std::memory_order_acq_rel);
+    if (prev & FRAME_FRESH)
+        frame_stats.dropped++;
+    frame_render = prev & FRAME_INDEX;
     frames++;
     return 0;
 }
@@ -804,7 +1032,7 @@ int main() {
 
     tuh_init(BOARD_TUH_RHPORT);
 
-    memset(&SCREEN[0][0], 0, sizeof SCREEN);
+    memset(FRAMES, 0, sizeof FRAMES);
 
 #ifndef TUFTY2350
 #if USE_PS2_KBD
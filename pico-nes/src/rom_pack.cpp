@@ -0,0 +1,74 @@
+#include "rom_pack.h"
+
+#include <string.h>
+
+// Built on first use, in RAM: the flash copy would compete with the
+// image being checked for the XIP cache
+static uint32_t crc_table[256];
+
+uint32_t rom_pack_crc32(const void* data, size_t size, uint32_t crc) {
+    if (!crc_table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+    }
+
+    const uint8_t* p = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+    while (size--)
+        crc = crc_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+const rom_pack_header_t* rom_pack_open(const void* base, const size_t limit) {
+    const auto* pack = static_cast<const rom_pack_header_t *>(base);
+    if (limit < sizeof(rom_pack_header_t) || pack->magic != ROM_PACK_MAGIC || pack->version != ROM_PACK_VERSION)
+        return nullptr;
+
+    // Erased flash reads 0xff: the sizes are checked before they are used
+    const size_t index_size = pack->count * sizeof(rom_pack_entry_t) + pack->db_count * sizeof(rom_db_record_t);
+    const size_t index_end = sizeof(rom_pack_header_t) + index_size;
+    if (pack->size > limit || index_end > pack->size)
+        return nullptr;
+    const rom_pack_entry_t* index = rom_pack_index(pack);
+    if (rom_pack_crc32(index, index_size) != pack->index_crc)
+        return nullptr;
+
+    // rom_pack_db_find() relies on the order
+    const rom_db_record_t* db = rom_pack_db(pack);
+    for (int i = 1; i < pack->db_count; i++) {
+        if (db[i - 1].crc32 >= db[i].crc32)
+            return nullptr;
+    }
+
+    for (int i = 0; i < pack->count; i++) {
+        const rom_pack_entry_t& entry = index[i];
+        if (entry.offset % ROM_PACK_ALIGN || entry.offset < index_end || entry.offset > pack->size || entry.size < 16 ||
+            entry.size > pack->size - entry.offset || !memchr(entry.name, 0, ROM_PACK_NAME))
+            return nullptr;
+    }
+    return pack;
+}
+
+const rom_db_record_t* rom_pack_db_find(const rom_pack_header_t* pack, const uint32_t crc32) {
+    const rom_db_record_t* db = rom_pack_db(pack);
+    int lo = 0, hi = pack->db_count;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (db[mid].crc32 < crc32)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < pack->db_count && db[lo].crc32 == crc32 ? &db[lo] : nullptr;
+}
+
+bool rom_pack_verify(const rom_pack_header_t* pack, const rom_pack_entry_t& entry) {
+    const uint8_t* image = rom_pack_image(pack, entry);
+    if (memcmp(image, "NES\x1a", 4) != 0)
+        return false;
+    return rom_pack_crc32(image + 16, entry.size - 16) == entry.image_crc;
+}
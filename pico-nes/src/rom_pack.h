@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+ * ROM pack: every game of the set in one binary blob, built by
+ * tools/convert_roms.py and flashed on its own at ROM_PACK_OFFSET, so
+ * changing games needs neither a recompile nor a firmware reflash.
+ *
+ *   rom_pack_header_t                         20 bytes
+ *   rom_pack_entry_t[count]                   64 bytes each
+ *   rom_db_record_t[db_count]                 12 bytes each, by crc32
+ *   iNES images, each at a ROM_PACK_ALIGN boundary ( a flash sector )
+ *
+ * All fields are little-endian, the byte order of both the RP2350 and the
+ * host. The images are run in place through XIP, nothing is copied.
+ *
+ * An entry with ROM_PACK_LZ4 keeps the iNES header and trainer, then a
+ * bank table instead of PRG and CHR: one offset ( from the image start )
+ * per 8 KB PRG bank and per 1 KB CHR bank, and one past the last block.
+ * Every bank is an LZ4 block of its own, or stored as is when LZ4 would
+ * not make it smaller, so a bank is decoded without touching the others
+ * ( infones/InfoNES_RomCache.cpp, ROM_LZ4 builds ).
+ *
+ * The ROM database holds what the game needs, whatever its iNES header
+ * says: tools/romdb.csv where the game is listed there, the header as
+ * convert_roms.py cleaned it up otherwise. One record per distinct
+ * crc32 of the set, sorted, so the loader finds a game's record by
+ * binary search and never parses the header for it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ROM_PACK_MAGIC 0x5053454e // "NESP"
+#define ROM_PACK_VERSION 3
+#define ROM_PACK_ALIGN 4096
+#define ROM_PACK_NAME 40
+
+// rom_pack_entry_t::flags
+#define ROM_PACK_LZ4 0x1
+
+// rom_db_record_t::mirroring
+#define ROM_DB_HORIZONTAL 0
+#define ROM_DB_VERTICAL 1
+#define ROM_DB_FOUR_SCREEN 2
+
+// rom_db_record_t::flags, the quirks from bit 8 up are InfoNES' ROMINFO_* >> 8
+#define ROM_DB_BATTERY 0x1       // PRG RAM is saved
+#define ROM_DB_QUIRKS_SHIFT 8
+#define ROM_DB_NO_IDLE_SKIP 0x100 // quirk: run idle loops instruction by instruction
+
+struct rom_pack_header_t {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;     // entries in the index
+    uint32_t size;      // whole pack in bytes
+    uint32_t index_crc; // rom_pack_crc32() of the index and the database
+    uint16_t db_count;  // records in the database
+    uint16_t reserved;
+};
+
+struct rom_pack_entry_t {
+    char name[ROM_PACK_NAME]; // display name, NUL-terminated
+    uint32_t offset;          // iNES image, from the start of the pack
+    uint32_t size;            // image bytes as stored
+    uint32_t crc32;           // rom_pack_crc32() of PRG + CHR as dumped, no header or trainer
+    uint32_t image_crc;       // rom_pack_crc32() of the stored image past the iNES header
+    uint16_t mapper;
+    uint8_t prg_banks;        // 16 KB
+    uint8_t chr_banks;        // 8 KB, 0 for CHR RAM
+    uint32_t flags;
+};
+
+struct rom_db_record_t {
+    uint32_t crc32;    // PRG + CHR, as rom_pack_entry_t::crc32
+    uint16_t mapper;
+    uint8_t mirroring;
+    uint8_t prg_ram;   // KB
+    uint32_t flags;
+};
+
+static_assert(sizeof(rom_pack_header_t) == 20, "rom_pack_header_t layout");
+static_assert(sizeof(rom_pack_entry_t) == 64, "rom_pack_entry_t layout");
+static_assert(sizeof(rom_db_record_t) == 12, "rom_db_record_t layout");
+
+// The pack at base, or nullptr when there is none or its index is corrupt.
+// limit is the room the pack may take; every entry is bounds-checked
+// against it once here, so the accessors below need no checks.
+const rom_pack_header_t* rom_pack_open(const void* base, size_t limit);
+
+static inline const rom_pack_entry_t* rom_pack_index(const rom_pack_header_t* pack) {
+    return reinterpret_cast<const rom_pack_entry_t *>(pack + 1);
+}
+
+static inline const uint8_t* rom_pack_image(const rom_pack_header_t* pack, const rom_pack_entry_t& entry) {
+    return reinterpret_cast<const uint8_t *>(pack) + entry.offset;
+}
+
+static inline const rom_db_record_t* rom_pack_db(const rom_pack_header_t* pack) {
+    return reinterpret_cast<const rom_db_record_t *>(rom_pack_index(pack) + pack->count);
+}
+
+// The database record of a game, nullptr when it has none
+const rom_db_record_t* rom_pack_db_find(const rom_pack_header_t* pack, uint32_t crc32);
+
+// Check the stored image against entry.image_crc: a pack flashed
+// halfway, or over by something else, is caught before the game runs
+bool rom_pack_verify(const rom_pack_header_t* pack, const rom_pack_entry_t& entry);
+
+// CRC-32 ( IEEE, as zlib ), continued from crc
+uint32_t rom_pack_crc32(const void* data, size_t size, uint32_t crc = 0);
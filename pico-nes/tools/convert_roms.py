@@ -1,22 +1,48 @@
 #!/usr/bin/env python3
-"""Convert NES ROM files to C byte arrays for embedding in firmware."""
+"""Pack NES ROM files into one binary blob for the firmware's ROM selector.
 
-import os
-import sys
-import re
+The pack is flashed on its own at ROM_PACK_OFFSET ( see flash_tufty.sh ),
+so changing the ROM set needs no firmware rebuild. Layout ( src/rom_pack.h ):
 
-ROM_DIR = os.path.join(os.path.dirname(__file__), '..', 'ROMs')
-OUTPUT = os.path.join(os.path.dirname(__file__), '..', 'src', 'rom_table.h')
-MAX_SIZE = 1024 * 1024  # Skip ROMs > 1MB
+    header   magic "NESP", version, count, pack size, CRC-32 of the index
+    index    64 bytes per ROM: name, offset, size, CRC-32 of PRG + CHR,
+             CRC-32 of the stored image, mapper, PRG / CHR bank counts,
+             flags
+    database 12 bytes per distinct game, sorted by CRC-32 of PRG + CHR:
+             mapper, mirroring, PRG RAM size, battery and quirk flags
+    images   the iNES files, each at a 4 KB flash sector boundary
 
+The database takes its values from tools/romdb.csv for the games listed
+there, and from the iNES header otherwise, so a bad header is fixed by
+adding the game to romdb.csv.
 
-def sanitize_name(filename):
-    """Convert filename to a valid C identifier."""
-    name = os.path.splitext(filename)[0]
-    name = re.sub(r'[^a-zA-Z0-9_]', '_', name)
-    if name[0].isdigit():
-        name = 'rom_' + name
-    return name.lower()
+With --lz4 every 8 KB PRG and 1 KB CHR bank is compressed on its own, for
+firmware built with -DROM_LZ4=ON.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+TOOLS_DIR = os.path.dirname(__file__)
+ROM_DIR = os.path.join(TOOLS_DIR, '..', 'ROMs')
+OUTPUT = os.path.join(TOOLS_DIR, '..', 'roms.pack')
+ROM_DB = os.path.join(TOOLS_DIR, 'romdb.csv')
+
+MAGIC = b'NESP'
+VERSION = 3
+ALIGN = 4096
+NAME_SIZE = 40
+HEADER = struct.Struct('<4sHHIIHH')
+ENTRY = struct.Struct(f'<{NAME_SIZE}sIIIIHBBI')
+RECORD = struct.Struct('<IHBBI')
+FLAG_LZ4 = 0x1
+MIRRORING = {'h': 0, 'v': 1, '4': 2}
+DB_FLAGS = {'battery': 0x1, 'no-idle-skip': 0x100}
+# 16 MB flash, the pack at 4 MB
+MAX_PACK = 12 * 1024 * 1024
 
 
 def display_name(filename):
@@ -25,68 +51,195 @@ def display_name(filename):
     # Capitalize first letter, keep the rest as-is
     if name:
         name = name[0].upper() + name[1:]
-    return name
+    return name.encode('utf-8')[:NAME_SIZE - 1].decode('utf-8', 'ignore')
+
+
+def parse_ines(data):
+    """Return ( image, mapper, prg_banks, chr_banks, crc, record ) or raise ValueError.
+
+    record is ( mapper, mirroring, PRG RAM KB, flags ) as the header has it.
+    """
+    if len(data) < 16 or data[:4] != b'NES\x1a':
+        raise ValueError('not an iNES file')
+    prg_banks, chr_banks, flags6, flags7 = data[4], data[5], data[6], data[7]
+    mapper = (flags6 >> 4) | (flags7 & 0xf0)
+    prg_ram = 8 * max(data[8], 1)
+    if flags7 & 0x0c == 0x08:
+        # NES 2.0: mapper bits 8-11, PRG RAM and NVRAM as 64 << shift bytes
+        mapper |= (data[8] & 0x0f) << 8
+        prg_ram = sum(64 << n for n in (data[10] & 0x0f, data[10] >> 4) if n) // 1024
+    elif any(data[12:16]):
+        # iNES 1.0 with a ripper's tag in the padding, bytes 7-8 are garbage too
+        mapper &= 0x0f
+        prg_ram = 8
+    skip = 16 + (512 if flags6 & 4 else 0)
+    end = skip + prg_banks * 0x4000 + chr_banks * 0x2000
+    if prg_banks == 0 or len(data) < end:
+        raise ValueError(f'{len(data)} bytes, the header needs {end}')
+    mirroring = 2 if flags6 & 8 else flags6 & 1
+    record = (mapper, mirroring, min(prg_ram, 255), DB_FLAGS['battery'] if flags6 & 2 else 0)
+    # Trailing bytes past CHR are dropped, so the CRC covers exactly PRG + CHR
+    return data[:end], mapper, prg_banks, chr_banks, zlib.crc32(data[skip:end]), record
+
+
+def describe(record):
+    mapper, mirroring, prg_ram, flags = record
+    names = [name for name, bit in DB_FLAGS.items() if flags & bit]
+    return f"mapper {mapper}, {'HV4'[mirroring]}, {prg_ram} KB PRG RAM" + ''.join(', ' + name for name in names)
+
+
+def load_db(path):
+    """crc -> ( mapper, mirroring, PRG RAM KB, flags ) from romdb.csv."""
+    db = {}
+    if not os.path.exists(path):
+        return db
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            fields = [field.strip() for field in line.split('#')[0].split(',')]
+            if fields == ['']:
+                continue
+            try:
+                crc, mapper, mirroring, prg_ram = int(fields[0], 16), int(fields[1]), fields[2], int(fields[3])
+                flags = 0
+                for flag in filter(None, fields[4].split('|') if len(fields) > 4 else []):
+                    flags |= DB_FLAGS[flag]
+                db[crc] = (mapper, MIRRORING[mirroring], prg_ram, flags)
+            except (IndexError, KeyError, ValueError):
+                raise SystemExit(f"{path}:{number}: expected crc32,mapper,h|v|4,prg_ram_kb[,flag|flag]")
+    return db
+
+
+def lz4_block(data):
+    """Compress data as one LZ4 block ( greedy, 64 KB window )."""
+    out = bytearray()
+    n = len(data)
+    table = {}
+    anchor = pos = 0
+    # The format wants the last match to start 12 bytes before the end and
+    # the last 5 bytes to be literals
+    limit = n - 12
+    while pos < limit:
+        key = data[pos:pos + 4]
+        ref = table.get(key)
+        table[key] = pos
+        if ref is None or pos - ref > 0xffff:
+            pos += 1
+            continue
+        length = 4
+        while pos + length < n - 5 and data[ref + length] == data[pos + length]:
+            length += 1
+        lit = pos - anchor
+        token = (min(lit, 15) << 4) | min(length - 4, 15)
+        out.append(token)
+        if lit >= 15:
+            out += b'\xff' * ((lit - 15) // 255) + bytes([(lit - 15) % 255])
+        out += data[anchor:pos]
+        out += struct.pack('<H', pos - ref)
+        if length - 4 >= 15:
+            out += b'\xff' * ((length - 19) // 255) + bytes([(length - 19) % 255])
+        pos += length
+        anchor = pos
+    lit = n - anchor
+    out.append(min(lit, 15) << 4)
+    if lit >= 15:
+        out += b'\xff' * ((lit - 15) // 255) + bytes([(lit - 15) % 255])
+    out += data[anchor:]
+    return bytes(out)
+
+
+def lz4_image(image, prg_banks, chr_banks):
+    """The iNES header and trainer, the bank table, then one block per bank."""
+    skip = 16 + (512 if image[6] & 4 else 0)
+    banks = [(0x2000, n) for n in range(prg_banks * 2)] + [(0x400, n) for n in range(chr_banks * 8)]
+    base = skip
+    blocks = []
+    for size, n in banks:
+        raw = image[base:base + size]
+        base += size
+        packed = lz4_block(raw)
+        # Stored as is when LZ4 does not help: the reader tells by the length
+        blocks.append(packed if len(packed) < size else raw)
+    offset = skip + 4 * (len(blocks) + 1)
+    table = []
+    for block in blocks:
+        table.append(offset)
+        offset += len(block)
+    table.append(offset)
+    return image[:skip] + struct.pack(f'<{len(table)}I', *table) + b''.join(blocks)
+
+
+def align(n):
+    return (n + ALIGN - 1) & ~(ALIGN - 1)
 
 
 def main():
-    rom_files = sorted([f for f in os.listdir(ROM_DIR) if f.lower().endswith('.nes')])
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-d', '--rom-dir', default=ROM_DIR, help='directory of .nes files')
+    parser.add_argument('-o', '--output', default=OUTPUT, help='pack to write')
+    parser.add_argument('-m', '--max-size', type=int, default=MAX_PACK, help='flash room for the pack in bytes')
+    parser.add_argument('-z', '--lz4', action='store_true', help='compress every bank ( ROM_LZ4 firmware )')
+    parser.add_argument('--db', default=ROM_DB, help='ROM database overriding the iNES headers')
+    args = parser.parse_args()
+
+    rom_files = sorted([f for f in os.listdir(args.rom_dir) if f.lower().endswith('.nes')])
+    romdb = load_db(args.db)
 
     entries = []
+    records = {}
     for fname in rom_files:
-        path = os.path.join(ROM_DIR, fname)
-        size = os.path.getsize(path)
-        if size > MAX_SIZE:
-            print(f"  Skipping {fname} ({size} bytes > {MAX_SIZE})")
+        with open(os.path.join(args.rom_dir, fname), 'rb') as f:
+            data = f.read()
+        try:
+            image, mapper, prg_banks, chr_banks, crc, record = parse_ines(data)
+        except ValueError as e:
+            print(f"  Skipping {fname}: {e}")
             continue
-        entries.append((fname, path, size))
+        if crc in romdb:
+            if romdb[crc] != record:
+                print(f"  {fname}: header says {describe(record)}, romdb.csv {describe(romdb[crc])}")
+            record = romdb[crc]
+        records[crc] = record
+        entries.append((display_name(fname), image, record[0], prg_banks, chr_banks, crc))
 
     if not entries:
         print("No ROM files found!")
         sys.exit(1)
 
-    print(f"Converting {len(entries)} ROMs to {OUTPUT}")
-
-    with open(OUTPUT, 'w') as out:
-        out.write("// Auto-generated by tools/convert_roms.py - DO NOT EDIT\n")
-        out.write("#pragma once\n\n")
-        out.write("#include <stdint.h>\n\n")
-
-        # Write each ROM as a byte array
-        for fname, path, size in entries:
-            cname = sanitize_name(fname)
-            print(f"  {fname} -> {cname} ({size} bytes)")
-
-            with open(path, 'rb') as f:
-                data = f.read()
+    print(f"Packing {len(entries)} ROMs into {args.output}")
 
-            out.write(f"// {fname} ({size} bytes)\n")
-            out.write(f"const unsigned char {cname}_data[] = {{\n")
+    flags = FLAG_LZ4 if args.lz4 else 0
+    if args.lz4:
+        entries = [(name, lz4_image(image, prg_banks, chr_banks), mapper, prg_banks, chr_banks, crc)
+                   for name, image, mapper, prg_banks, chr_banks, crc in entries]
 
-            for i in range(0, len(data), 16):
-                chunk = data[i:i+16]
-                hex_str = ', '.join(f'0x{b:02x}' for b in chunk)
-                out.write(f"  {hex_str},\n")
+    db = b''.join(RECORD.pack(crc, *records[crc]) for crc in sorted(records))
 
-            out.write("};\n\n")
+    index = b''
+    offset = align(HEADER.size + len(entries) * ENTRY.size + len(db))
+    for name, image, mapper, prg_banks, chr_banks, crc in entries:
+        print(f"  {name}: mapper {mapper}, PRG {prg_banks * 16} KB, CHR {chr_banks * 8} KB, "
+              f"CRC {crc:08X}, {len(image)} bytes at 0x{offset:06x}")
+        index += ENTRY.pack(name.encode('utf-8'), offset, len(image), crc, zlib.crc32(image[16:]), mapper,
+                            prg_banks, chr_banks, flags)
+        offset = align(offset + len(image))
 
-        # Write the ROM table struct and array
-        out.write("struct rom_entry {\n")
-        out.write("    const char* name;\n")
-        out.write("    const unsigned char* data;\n")
-        out.write("    unsigned int size;\n")
-        out.write("};\n\n")
-
-        out.write(f"#define ROM_COUNT {len(entries)}\n\n")
-
-        out.write("const struct rom_entry rom_table[ROM_COUNT] = {\n")
-        for fname, path, size in entries:
-            cname = sanitize_name(fname)
-            dname = display_name(fname)
-            out.write(f'    {{ "{dname}", {cname}_data, sizeof({cname}_data) }},\n')
-        out.write("};\n")
+    size = offset
+    if size > args.max_size:
+        print(f"Pack is {size} bytes, only {args.max_size} fit")
+        sys.exit(1)
 
-    total = sum(size for _, _, size in entries)
-    print(f"Done! {len(entries)} ROMs, {total} bytes total ({total/1024:.1f} KB)")
+    with open(args.output, 'wb') as out:
+        out.write(HEADER.pack(MAGIC, VERSION, len(entries), size, zlib.crc32(index + db), len(records), 0))
+        out.write(index)
+        out.write(db)
+        for _, image, *_ in entries:
+            out.write(b'\xff' * (align(out.tell()) - out.tell()))
+            out.write(image)
+        # Pad the last image to a whole sector, like erased flash
+        out.write(b'\xff' * (size - out.tell()))
+
+    total = sum(len(image) for _, image, *_ in entries)
+    print(f"Done! {len(entries)} ROMs, {total} bytes of images, {size} bytes packed ({size/1024:.1f} KB)")
 
 
 if __name__ == '__main__':